@@ -0,0 +1,460 @@
+// calibration_driver : the calibration of all ladders in a list, replacing template_v1/run.sh and re_run_cal.sh
+//
+// run.sh made a copy of calibration_ana_code_multi.c with "data_index" replaced by sed for each file, and
+// re_run_cal.sh started run.sh by nohup for every ladder at once with sleeps between them.
+// Here the data files of each ladder are taken by a glob, and the macro is called with the index of the file.
+// The ROOT processes are run by JobScheduler (general_codes/functions), so only a given number of them run at the same time.
+//
+// Tasks :
+//   calibration : calibration_ana_code_multi_copy for a file. The files of a ladder are done one by one in the order of total_file.txt,
+//                 because each of them reads and rewrites multi_run_status.txt of the ladder. Ladders run in parallel.
+//   summary     : ladder_summary.c for a ladder after all files (with -s). output_cut_value.txt of cut_finder has to be in the ladder folder.
+// A ladder is skipped if the stamps of all files are newer than the data files and the macros, and total_file.txt has the same files.
+// A stamp (folder_<file>/calibration_done, summary_done) is written after the task succeeded and its output is found,
+// since the macros make their ROOT files at the start, and a stopped task leaves a new but broken file.
+// Otherwise all files of the ladder are done again from the first one, since multi_run_status.txt is made through all files.
+// The time of each task and the total of each stage are written to the report.
+//
+// Each ROOT process fits channels by (cores / jobs) threads, so the machine isn't oversubscribed.
+//
+// Build : g++ -std=c++17 -O2 -pthread -o calibration_driver calibration_driver.cc
+// Usage : ./calibration_driver [options] ladder_list.txt
+//   -d folder   the folder of the ladder folders                  (default: ladder_files)
+//   -t folder   the folder of calibration_ana_code_multi.c        (default: template_v1)
+//   -f folder   the folder of SCurveFitter and CalibrationRecord  (default: ../../general_codes/functions)
+//   -g glob     the data files in each ladder folder              (default: *.root)
+//   -m module   port ID for ladders without it in the list        (default: 8)
+//   -j jobs     ROOT processes running at the same time           (default: the number of cores)
+//   -r report   the file of the timing report                     (default: calibration_report.txt)
+//   -s          ladder_summary.c is run for each ladder
+//   -F          all ladders are done even if they are up to date
+//   -n          the tasks are shown but not run
+// A line of the ladder list is "ladder_name" or "ladder_name port_ID".
+//
+// The arguments of calibration_ana_code_multi_copy are the same as run.sh :
+//   folder, port ID, run_option = true, assembly_check = false, noise_level_check = 0, new_check = true,
+//   unbound_check = false, noise_channel_check = false, multi_run = true, and the index of the file and the number of threads.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "../../general_codes/functions/JobScheduler.hh"
+
+struct driver_option
+{
+	string ladder_folder = "ladder_files";
+	string template_folder = "template_v1";
+	string functions_folder = "../../general_codes/functions";
+	string data_glob = "*.root";
+	string report = "calibration_report.txt";
+	int module = 8;
+	int jobs = 0;
+	int threads = 1; // threads of each ROOT process
+	bool summary = false;
+	bool force = false;
+	bool dry_run = false;
+};
+
+struct ladder_task
+{
+	string name;
+	string folder;
+	int module = 8;
+	vector<string> files;
+	bool run_calibration = false;
+	bool run_summary = false;
+};
+
+// tasks which are not run because the outputs are up to date
+struct skipped_task
+{
+	string stage;
+	string name;
+};
+
+// The modification time, 0 if the file doesn't exist
+time_t modified_time(const string &path)
+{
+	struct stat buffer;
+	if (stat(path.c_str(), &buffer) != 0)
+		return 0;
+
+	return buffer.st_mtime;
+}
+
+string absolute_path(const string &path)
+{
+	char *resolved = realpath(path.c_str(), nullptr);
+	if (resolved == nullptr)
+		return path;
+
+	string result = resolved;
+	free(resolved);
+	return result;
+}
+
+string summary_file(const ladder_task &ladder, const string &file)
+{
+	return ladder.folder + "/folder_" + file + "/" + file + "_summary.root";
+}
+
+// The stamps of the finished tasks, see write_stamp
+string calibration_stamp(const ladder_task &ladder, const string &file)
+{
+	return ladder.folder + "/folder_" + file + "/calibration_done";
+}
+
+string summary_stamp(const ladder_task &ladder)
+{
+	return ladder.folder + "/summary_done";
+}
+
+// The stamp is written when a task is done. Its modification time is the time of the task for plan_ladder.
+void write_stamp(const string &path)
+{
+	ofstream stamp(path.c_str());
+	time_t now = time(nullptr);
+	stamp << "done " << ctime(&now);
+	if (!stamp)
+		throw runtime_error("fail to write " + path);
+}
+
+// The data files in the ladder folder, sorted as "ls" does.
+// The output folders (folder_*.root/) and bad_channel_summary.root made by ladder_summary.c aren't data.
+vector<string> find_files(const string &folder, const string &pattern)
+{
+	vector<string> files;
+	glob_t result;
+	if (glob((folder + "/" + pattern).c_str(), GLOB_MARK, nullptr, &result) == 0)
+	{
+		for (size_t i = 0; i < result.gl_pathc; i++)
+		{
+			string name = result.gl_pathv[i];
+			if (name.back() == '/')
+				continue;
+
+			name = name.substr(name.find_last_of('/') + 1);
+			if (name == "bad_channel_summary.root")
+				continue;
+
+			files.push_back(name);
+		}
+	}
+
+	globfree(&result);
+	sort(files.begin(), files.end());
+	return files;
+}
+
+vector<string> read_words(const string &path)
+{
+	vector<string> words;
+	ifstream input(path.c_str());
+	string word;
+	while (input >> word)
+		words.push_back(word);
+
+	return words;
+}
+
+// The command is run by the shell, and its output is added to the log. An exception is thrown if it failed.
+void run_command(const string &command, const string &log)
+{
+	string line = command + " >> \"" + log + "\" 2>&1";
+	int status = system(line.c_str());
+	if (status == -1 || WIFEXITED(status) == false || WEXITSTATUS(status) != 0)
+		throw runtime_error("exit status " + to_string(WIFEXITED(status) ? WEXITSTATUS(status) : status) + ", see " + log);
+}
+
+void submit_calibration(JobScheduler &scheduler, const driver_option &option, const ladder_task &ladder, int index);
+
+void submit_summary(JobScheduler &scheduler, const driver_option &option, const ladder_task &ladder)
+{
+	scheduler.Submit("summary " + ladder.name, [&option, &ladder]()
+	{
+		string output = ladder.folder + "/bad_channel_summary.root";
+		remove(summary_stamp(ladder).c_str());
+		time_t start = time(nullptr);
+		string command = "root -l -b -q"
+			" -e 'gInterpreter->AddIncludePath(\"" + option.functions_folder + "\")'"
+			" -e 'gROOT->LoadMacro(\"" + option.template_folder + "/ladder_summary.c\")'"
+			" -e 'ladder_summary(\"" + ladder.folder + "\")'";
+		run_command(command, ladder.folder + "/run_output.txt");
+		if (modified_time(output) < start)
+			throw runtime_error(output + " is not made");
+
+		write_stamp(summary_stamp(ladder));
+		return true;
+	});
+}
+
+// The calibration of the file, and the next file or the summary is submitted when it's done
+void submit_calibration(JobScheduler &scheduler, const driver_option &option, const ladder_task &ladder, int index)
+{
+	const string &file = ladder.files[index];
+	scheduler.Submit("calibration " + ladder.name + " [" + to_string(index) + "] " + file, [&scheduler, &option, &ladder, index, file]()
+	{
+		string log = ladder.folder + "/run_output.txt";
+		string call = "calibration_ana_code_multi_copy(\"" + ladder.folder + "\"," + to_string(ladder.module)
+			+ ",true,false,0,true,false,false,true," + to_string(index) + "," + to_string(option.threads) + ")";
+		string command = "root -l -b -q"
+			" -e 'gInterpreter->AddIncludePath(\"" + option.functions_folder + "\")'"
+			" -e 'gROOT->LoadMacro(\"" + option.template_folder + "/calibration_ana_code_multi.c\")'"
+			" -e '" + call + "'";
+
+		time_t start = time(nullptr);
+		run_command(command, log);
+		if (modified_time(summary_file(ladder, file)) < start)
+			throw runtime_error(summary_file(ladder, file) + " is not made, see " + log);
+
+		write_stamp(calibration_stamp(ladder, file));
+
+		if (index + 1 < (int)ladder.files.size())
+			submit_calibration(scheduler, option, ladder, index + 1);
+		else if (ladder.run_summary)
+			submit_summary(scheduler, option, ladder);
+
+		return true;
+	});
+}
+
+// Which tasks of the ladder have to be run
+void plan_ladder(const driver_option &option, ladder_task &ladder, vector<skipped_task> &skipped)
+{
+	string macro = option.template_folder + "/calibration_ana_code_multi.c";
+	time_t code_time = max({modified_time(macro),
+							modified_time(option.functions_folder + "/SCurveFitter.hh"),
+							modified_time(option.functions_folder + "/SCurveFitter.cc"),
+							modified_time(option.functions_folder + "/CalibrationRecord.hh"),
+							modified_time(option.functions_folder + "/CalibrationRecord.cc")});
+
+	ladder.run_calibration = option.force || read_words(ladder.folder + "/total_file.txt") != ladder.files;
+	time_t newest_output = 0;
+	for (auto &file : ladder.files)
+	{
+		time_t output_time = modified_time(calibration_stamp(ladder, file));
+		if (output_time < max(code_time, modified_time(ladder.folder + "/" + file)))
+			ladder.run_calibration = true;
+
+		newest_output = max(newest_output, output_time);
+	}
+
+	if (ladder.run_calibration == false)
+		for (auto &file : ladder.files)
+			skipped.push_back({"calibration", ladder.name + " " + file});
+
+	if (option.summary == false)
+		return;
+
+	string cut_value = ladder.folder + "/output_cut_value.txt";
+	if (modified_time(cut_value) == 0)
+	{
+		cerr << ladder.name << " : " << cut_value << " is not found, ladder_summary.c is not run" << endl;
+		return;
+	}
+
+	time_t input_time = max({newest_output, modified_time(cut_value), modified_time(option.template_folder + "/ladder_summary.c")});
+	ladder.run_summary = option.force || ladder.run_calibration || modified_time(summary_stamp(ladder)) < input_time;
+	if (ladder.run_summary == false)
+		skipped.push_back({"summary", ladder.name});
+}
+
+// The time of each stage, and the time and the status of each task by JobScheduler
+void write_report(const string &path, JobScheduler &scheduler, const vector<skipped_task> &skipped, double seconds, ostream &os)
+{
+	struct stage_time
+	{
+		int tasks = 0;
+		int failed = 0;
+		int skipped = 0;
+		double total = 0;
+		double longest = 0;
+	};
+
+	map<string, stage_time> stages;
+	for (int i = 0; i < scheduler.GetJobNum(); i++)
+	{
+		JobRecord record = scheduler.GetRecord(i);
+		stage_time &stage = stages[record.name.substr(0, record.name.find(' '))];
+		stage.tasks++;
+		stage.total += record.seconds;
+		stage.longest = max(stage.longest, record.seconds);
+		if (record.status == JobRecord::kFailed)
+			stage.failed++;
+	}
+
+	for (auto &task : skipped)
+		stages[task.stage].skipped++;
+
+	ofstream report(path.c_str());
+	for (ostream *output : {(ostream *)&report, &os})
+	{
+		*output << setw(14) << "stage" << setw(8) << "tasks" << setw(8) << "failed" << setw(9) << "skipped"
+				<< setw(12) << "total [s]" << setw(12) << "mean [s]" << setw(12) << "max [s]" << endl;
+		for (auto &stage : stages)
+		{
+			*output << setw(14) << stage.first << setw(8) << stage.second.tasks << setw(8) << stage.second.failed << setw(9) << stage.second.skipped
+					<< fixed << setprecision(1)
+					<< setw(12) << stage.second.total
+					<< setw(12) << (stage.second.tasks == 0 ? 0 : stage.second.total / stage.second.tasks)
+					<< setw(12) << stage.second.longest << endl;
+			output->unsetf(ios::fixed);
+		}
+		*output << "elapsed " << fixed << setprecision(1) << seconds << " s with " << scheduler.GetMaxRunning() << " jobs" << endl;
+		output->unsetf(ios::fixed);
+	}
+
+	report << endl;
+	scheduler.Print(report);
+	for (auto &task : skipped)
+		report << "| up to date " << task.stage << " " << task.name << endl;
+}
+
+void show_usage(const char *program)
+{
+	cerr << "Usage : " << program << " [-d ladder_folder] [-t template_folder] [-f functions_folder] [-g glob] [-m port_ID]" << endl
+		 << "        [-j jobs] [-r report] [-s] [-F] [-n] ladder_list.txt" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	driver_option option;
+	int flag;
+	while ((flag = getopt(argc, argv, "d:t:f:g:m:j:r:sFnh")) != -1)
+	{
+		switch (flag)
+		{
+		case 'd': option.ladder_folder = optarg; break;
+		case 't': option.template_folder = optarg; break;
+		case 'f': option.functions_folder = optarg; break;
+		case 'g': option.data_glob = optarg; break;
+		case 'm': option.module = atoi(optarg); break;
+		case 'j': option.jobs = atoi(optarg); break;
+		case 'r': option.report = optarg; break;
+		case 's': option.summary = true; break;
+		case 'F': option.force = true; break;
+		case 'n': option.dry_run = true; break;
+		default: show_usage(argv[0]); return 1;
+		}
+	}
+
+	if (optind + 1 != argc)
+	{
+		show_usage(argv[0]);
+		return 1;
+	}
+
+	// the processes are started in the ladder folders, so all paths are absolute
+	option.ladder_folder = absolute_path(option.ladder_folder);
+	option.template_folder = absolute_path(option.template_folder);
+	option.functions_folder = absolute_path(option.functions_folder);
+
+	// the ladders are kept in this vector until the end, the tasks refer to them
+	vector<ladder_task> ladders;
+	ifstream ladder_list(argv[optind]);
+	if (!ladder_list)
+	{
+		cerr << "Fail to open file: " << argv[optind] << endl;
+		return 1;
+	}
+
+	string line;
+	while (getline(ladder_list, line))
+	{
+		istringstream words(line);
+		ladder_task ladder;
+		if (!(words >> ladder.name) || ladder.name[0] == '#')
+			continue;
+
+		if (!(words >> ladder.module))
+			ladder.module = option.module;
+
+		ladder.folder = option.ladder_folder + "/" + ladder.name;
+		ladder.files = find_files(ladder.folder, option.data_glob);
+		if (ladder.files.size() == 0)
+		{
+			cerr << ladder.name << " : no files of " << option.data_glob << " in " << ladder.folder << ", skipped" << endl;
+			continue;
+		}
+
+		ladders.push_back(ladder);
+	}
+
+	vector<skipped_task> skipped;
+	int running_ladders = 0;
+	for (auto &ladder : ladders)
+	{
+		plan_ladder(option, ladder, skipped);
+		if (ladder.run_calibration || ladder.run_summary)
+			running_ladders++;
+
+		cout << setw(12) << ladder.name << " : port " << ladder.module << ", " << ladder.files.size() << " files, calibration "
+			 << (ladder.run_calibration ? "to be done" : "up to date");
+		if (option.summary)
+			cout << ", summary " << (ladder.run_summary ? "to be done" : "up to date / skipped");
+		cout << endl;
+	}
+
+	// files of a ladder are done one by one, so more jobs than ladders don't help.
+	// The cores are shared by the threads of the jobs.
+	int cores = max(1u, thread::hardware_concurrency());
+	if (option.jobs <= 0)
+		option.jobs = cores;
+	option.jobs = max(1, min(option.jobs, running_ladders));
+	option.threads = max(1, cores / option.jobs);
+	cout << running_ladders << " ladders to be done by " << option.jobs << " jobs with " << option.threads << " threads each" << endl;
+
+	if (option.dry_run)
+		return 0;
+
+	auto start = chrono::steady_clock::now();
+	JobScheduler scheduler(option.jobs);
+	for (auto &ladder : ladders)
+	{
+		if (ladder.run_calibration)
+		{
+			// the same as run.sh did before the first file
+			ofstream total_file((ladder.folder + "/total_file.txt").c_str());
+			for (auto &file : ladder.files)
+				total_file << file << endl;
+			total_file.close();
+
+			remove((ladder.folder + "/multi_run_status.txt").c_str());
+			remove((ladder.folder + "/run_output.txt").c_str());
+
+			// the old stamps aren't kept for the files which fail this time
+			for (auto &file : ladder.files)
+				remove(calibration_stamp(ladder, file).c_str());
+			submit_calibration(scheduler, option, ladder, 0);
+		}
+		else if (ladder.run_summary)
+		{
+			submit_summary(scheduler, option, ladder);
+		}
+	}
+
+	bool is_ok = scheduler.WaitAll();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	write_report(option.report, scheduler, skipped, seconds, cout);
+	if (is_ok == false)
+		scheduler.Print(cerr);
+
+	return is_ok ? 0 : 1;
+}
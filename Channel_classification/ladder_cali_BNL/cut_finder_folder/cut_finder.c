@@ -1,3 +1,5 @@
+#include "../../../general_codes/functions/CalibrationRecord.hh"
+
 void cut_finder ()
 {
         TString folder_name = "/home/cwshih/INTT_cal/INTT_cal_test/ladder_cali/cut_finder_folder/";
@@ -5,45 +7,10 @@ void cut_finder ()
 
 	TFile *f1 = TFile::Open(Form("%s/sum_up_all.root",folder_name.Data()));
 
-	TTree *chan_gaus_width = (TTree *)f1->Get("chan_gaus_width"); //value_W
-	TTree *chan_entry = (TTree *)f1->Get("chan_entry"); //value_E
-	TTree *ampl_channel_entries = (TTree *)f1->Get("ampl_channel_entries"); //value_EA
-	TTree *chan_thre_position = (TTree *)f1->Get("chan_thre_position"); //value_TP
-	TTree *chan_adc_study = (TTree *)f1->Get("chan_adc_study"); //value_adc_0
-	TTree *chan_study = (TTree *)f1->Get("chan_study"); //value_slope_chi, value_width_chi
-	TTree *chan_err_width = (TTree *)f1->Get("chan_err_width"); //
-	TTree *chan_err_mean = (TTree *)f1->Get("chan_err_mean"); //
-
-	int chip_W, chan_W;
-	double value_W, value_W02, value_W13;
-
-	int chip_E, chan_E;
-	int value_E;
-
-	int chip_EA, chan_EA;
-	int value_EA;
-
-	int chip_TP, chan_TP;
-	double value_TP;
-
-	int chip_adc, chan_adc;
-	double value_adc_0;
-	double value_adc_0N;
-
-	int chip_chi, chan_chi;
-	double value_slope_chi, value_width_chi;
-	double value_slope_value, value_width_value;
-
-	int chip_width, chan_width;
-	double value_width0, value_width1;
-	double value_width2, value_width3;
-	double value_pvalue;
-	
-	int chip_mean, chan_mean;
-	double value_mean0, value_mean1;
-	double value_mean2, value_mean3;
-	
-	
+	// the channels of all files, only the columns used here are read
+	TTree *calibration_record = (TTree *)f1->Get(CalibrationRecordTree::kTreeName);
+	CalibrationRecordTree records;
+	const CalibrationRecord &record = records.record_;
 
 	TCanvas * c1 = new TCanvas ("c1","c1",1800,1800);
 	c1->SetLogy();
@@ -51,71 +18,11 @@ void cut_finder ()
 	TCanvas * c2 = new TCanvas ("c2","c2",1600,800);
 	// c2->SetLogy();
 
-	chan_gaus_width->SetBranchAddress("chip_id", &chip_W);
-	chan_gaus_width->SetBranchAddress("chan_id", &chan_W);
-	chan_gaus_width->SetBranchAddress("Gaus_width", &value_W);
-	chan_gaus_width->SetBranchAddress("Gaus_width02", &value_W02);
-	chan_gaus_width->SetBranchAddress("Gaus_width13", &value_W13);
-
-	chan_entry->SetBranchAddress("chip_id",&chip_E);
-	chan_entry->SetBranchAddress("chan_id",&chan_E);
-	chan_entry->SetBranchAddress("chan_entry",&value_E);
-
-	ampl_channel_entries->SetBranchAddress("chip_id",&chip_EA);
-	ampl_channel_entries->SetBranchAddress("chan_id",&chan_EA);
-	ampl_channel_entries->SetBranchAddress("chan_entry",&value_EA);
-
-	chan_thre_position->SetBranchAddress("chip_id",&chip_TP);
-	chan_thre_position->SetBranchAddress("chan_id",&chan_TP);
-	chan_thre_position->SetBranchAddress("TP_turnon",&value_TP);
-
-	chan_adc_study->SetBranchAddress("chip_id",&chip_adc);
-	chan_adc_study->SetBranchAddress("chan_id",&chan_adc);
-	chan_adc_study->SetBranchAddress("adc0",&value_adc_0);
-	chan_adc_study->SetBranchAddress("adc0N",&value_adc_0N);
-
-	chan_study->SetBranchAddress("chip_id",&chip_chi);
-	chan_study->SetBranchAddress("chan_id",&chan_chi);
-	chan_study->SetBranchAddress("slope_value",&value_slope_value);
-	chan_study->SetBranchAddress("slope_rchi2",&value_slope_chi);
-	chan_study->SetBranchAddress("width_value",&value_width_value);
-	chan_study->SetBranchAddress("width_rchi2",&value_width_chi);
-
-
-	chan_err_width->SetBranchAddress("chip_id",&chip_width);
-	chan_err_width->SetBranchAddress("chan_id",&chan_width);
-	chan_err_width->SetBranchAddress("err_width0",&value_width0);
-	chan_err_width->SetBranchAddress("err_width1",&value_width1);
-	chan_err_width->SetBranchAddress("err_width2",&value_width2);
-	chan_err_width->SetBranchAddress("err_width3",&value_width3);
-	chan_err_width->SetBranchAddress("err_pvalue",&value_pvalue);
-
-
-	chan_err_mean->SetBranchAddress("chip_id",&chip_width);
-	chan_err_mean->SetBranchAddress("chan_id",&chan_width);
-	chan_err_mean->SetBranchAddress("err_mean0",&value_mean0);
-	chan_err_mean->SetBranchAddress("err_mean1",&value_mean1);
-	chan_err_mean->SetBranchAddress("err_mean2",&value_mean2);
-	chan_err_mean->SetBranchAddress("err_mean3",&value_mean3);
+	records.SetBranchAddresses(calibration_record, "Gaus_width,Gaus_width02,Gaus_width13,chan_entry,ampl_chan_entry,TP_turnon,adc0,adc0N,"
+		"slope_value,slope_rchi2,width_value,width_rchi2,err_width0,err_width1,err_width2,err_width3,err_mean0,err_mean1,err_mean2,err_mean3");
 
-	
-	int total_size_W = chan_gaus_width->GetEntriesFast();
-	int total_size_E = chan_entry->GetEntriesFast();
-	int total_size_EA = ampl_channel_entries->GetEntriesFast();
-	int total_size_TP = chan_thre_position->GetEntriesFast();
-	int total_size_adc = chan_adc_study->GetEntriesFast();
-	int total_size_chi = chan_study->GetEntriesFast();
-	int total_size_width = chan_err_width->GetEntriesFast();
-	int total_size_mean = chan_err_mean->GetEntriesFast();
-	
-	cout<<"width :              "<<total_size_W<<endl;
-	cout<<"entry :              "<<total_size_E<<endl;
-	cout<<"ampl entry :         "<<total_size_EA<<endl;
-	cout<<"threshold position : "<<total_size_TP<<endl;
-	cout<<"adc :                "<<total_size_adc<<endl;
-	cout<<"rchi2 :              "<<total_size_chi<<endl;
-	cout<<"err_width :          "<<total_size_width<<endl;
-	cout<<"err_mean :          "<<total_size_mean<<endl;
+	int total_size = calibration_record->GetEntries();
+	cout<<"channels :           "<<total_size<<endl;
 	
 	cout<<" "<<endl;
 
@@ -243,57 +150,50 @@ void cut_finder ()
 	TF1 * fit_err_mean3 = new TF1 ("fit_err_mean3","gaus",30,70);
 
 
-	for (int i = 0; i < total_size_W; i++)
+	for (int i = 0; i < total_size; i++)
 	{
-		chan_gaus_width->GetEntry(i);
-		chan_entry->GetEntry(i);
-		ampl_channel_entries->GetEntry(i);
-		chan_thre_position->GetEntry(i);
-		chan_adc_study->GetEntry(i);
-		chan_study->GetEntry(i);
-		chan_err_width->GetEntry(i);
-		chan_err_mean->GetEntry(i);
+		records.GetEntry(calibration_record, i);
 
 		
-		width_1D->Fill(value_W);
-		width_1D02->Fill(value_W02);
-		width_1D13->Fill(value_W13);
+		width_1D->Fill(record.Gaus_width);
+		width_1D02->Fill(record.Gaus_width02);
+		width_1D13->Fill(record.Gaus_width13);
 
-		entry_1D->Fill(value_E);
-		entry_ampl_1D->Fill(value_EA);
-		TP_1D->Fill(value_TP);
-		adc_0_1D->Fill(value_adc_0);
-		adc_0_1DN->Fill(value_adc_0N);
-		width_rchi2_1D->Fill(value_width_chi);
-		width_value_1D->Fill(value_width_value);
-		slope_rchi2_1D->Fill(value_slope_chi);
-		slope_value_1D->Fill(value_slope_value);
+		entry_1D->Fill(record.chan_entry);
+		entry_ampl_1D->Fill(record.ampl_chan_entry);
+		TP_1D->Fill(record.TP_turnon);
+		adc_0_1D->Fill(record.adc0);
+		adc_0_1DN->Fill(record.adc0N);
+		width_rchi2_1D->Fill(record.width_rchi2);
+		width_value_1D->Fill(record.width_value);
+		slope_rchi2_1D->Fill(record.slope_rchi2);
+		slope_value_1D->Fill(record.slope_value);
 
-		slopevalue_chip_2D->Fill(chip_chi,value_slope_value);
+		slopevalue_chip_2D->Fill(record.chip_id,record.slope_value);
 
-		width_pvalue_1D->Fill(TMath::Prob(value_width_chi, 3));
+		width_pvalue_1D->Fill(TMath::Prob(record.width_rchi2, 3));
 
-		h_err_width_sum->Fill(value_width0);
-		h_err_width_sum->Fill(value_width1);
-		h_err_width_sum->Fill(value_width2);
-		h_err_width_sum->Fill(value_width3);
+		h_err_width_sum->Fill(record.err_width0);
+		h_err_width_sum->Fill(record.err_width1);
+		h_err_width_sum->Fill(record.err_width2);
+		h_err_width_sum->Fill(record.err_width3);
 
-		h_err_mean0->Fill(value_mean0);
-		h_err_mean1->Fill(value_mean1);
-		h_err_mean2->Fill(value_mean2);
-		h_err_mean3->Fill(value_mean3);
+		h_err_mean0->Fill(record.err_mean0);
+		h_err_mean1->Fill(record.err_mean1);
+		h_err_mean2->Fill(record.err_mean2);
+		h_err_mean3->Fill(record.err_mean3);
 
 
 		
-		if (TMath::Prob(value_width_chi, 3) < 0.0000006)
+		if (TMath::Prob(record.width_rchi2, 3) < 0.0000006)
 		{
-			cout<<"width : "<<i<<" "<<chip_chi<<" "<<chan_chi<<" "<<Form("%.10f",TMath::Prob(value_width_chi, 3))<<endl;
+			cout<<"width : "<<i<<" "<<record.chip_id<<" "<<record.chan_id<<" "<<Form("%.10f",TMath::Prob(record.width_rchi2, 3))<<endl;
 		}
 		
-		slope_pvalue_1D->Fill(TMath::Prob(value_slope_chi, 2));
-		if (TMath::Prob(value_slope_chi, 2) < 0.0000006)
+		slope_pvalue_1D->Fill(TMath::Prob(record.slope_rchi2, 2));
+		if (TMath::Prob(record.slope_rchi2, 2) < 0.0000006)
 		{
-			cout<<"slope : "<<i<<" "<<chip_chi<<" "<<chan_chi<<" "<<Form("%.10f",TMath::Prob(value_slope_chi, 2))<<endl;
+			cout<<"slope : "<<i<<" "<<record.chip_id<<" "<<record.chan_id<<" "<<Form("%.10f",TMath::Prob(record.slope_rchi2, 2))<<endl;
 		}
 		
 	}
@@ -570,18 +470,15 @@ void cut_finder ()
 	c2->Clear();
 
 
-	for (int i = 0; i < total_size_W; i++)
+	// only the slope is needed for the correction
+	records.SetBranchAddresses(calibration_record, "slope_value");
+	for (int i = 0; i < total_size; i++)
 	{
-		chan_gaus_width->GetEntry(i);
-		chan_entry->GetEntry(i);
-		ampl_channel_entries->GetEntry(i);
-		chan_thre_position->GetEntry(i);
-		chan_adc_study->GetEntry(i);
-		chan_study->GetEntry(i);
+		records.GetEntry(calibration_record, i);
 
-		slope_value_1D_F->Fill(value_slope_value-    ((pol1_13->GetParameter(1)+pol1_26->GetParameter(1))/2. * chip_chi)   );
+		slope_value_1D_F->Fill(record.slope_value-    ((pol1_13->GetParameter(1)+pol1_26->GetParameter(1))/2. * record.chip_id)   );
 
-		slopevalue_chip_2D_F->Fill(chip_chi,value_slope_value - ((pol1_13->GetParameter(1)+pol1_26->GetParameter(1))/2. * chip_chi));
+		slopevalue_chip_2D_F->Fill(record.chip_id,record.slope_value - ((pol1_13->GetParameter(1)+pol1_26->GetParameter(1))/2. * record.chip_id));
 	}
 
 	c1->cd();
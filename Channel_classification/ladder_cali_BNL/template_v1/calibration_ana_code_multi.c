@@ -37,6 +37,13 @@
 #include <TH1D.h>
 #include <TF1.h>
 #include <TLorentzVector.h>
+#include <TROOT.h>
+#include <Math/MinimizerOptions.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../../../general_codes/functions/SCurveFitter.hh"
+#include "../../../general_codes/functions/CalibrationRecord.hh"
 //#include <iomanip>
 //#include "untuplizer.h"
 //#include "sigmaEff.h"
@@ -62,12 +69,402 @@ double shifted_hist(TH1F* h_org, TH1F* h_new, float offset = 0)
   return 0;
 }
 
+// The same as calling hist->Fill(x) count times. The bin contents, the errors, the entries, and the mean are the same.
+void fill_count(TH1 *hist, double x, unsigned int count)
+{
+	if (count == 0)
+		return;
+
+	double entries = hist->GetEntries();
+	int bin = hist->Fill(x, count);
+
+	// the weight turns on Sumw2 and adds count^2, it should be count as Fill(x) count times
+	if (bin >= 0 && hist->GetSumw2N() != 0)
+		hist->GetSumw2()->fArray[bin] -= double(count) * count - count;
+
+	hist->SetEntries(entries + count);
+}
+
+void fill_count(TH2 *hist, double x, double y, unsigned int count)
+{
+	if (count == 0)
+		return;
+
+	double entries = hist->GetEntries();
+	int bin = hist->Fill(x, y, count);
+	if (bin >= 0 && hist->GetSumw2N() != 0)
+		hist->GetSumw2()->fArray[bin] -= double(count) * count - count;
 
+	hist->SetEntries(entries + count);
+}
+
+// The number of hits of the module for each chip, channel, ampl, and adc.
+// It's filled in one pass over the tree and all checks read it, instead of keeping every hit in vectors.
+struct channel_count
+{
+	static const int n_chip = 26;
+	static const int n_chan = 128;
+	static const int n_ampl = 128; // 7 bits
+	static const int n_adc = 8;	   // 3 bits
+
+	vector<unsigned int> count; // [chip_id - 1][chan_id][ampl][adc], 13 MB
+	int hits[n_chip][n_chan];	// all hits of the channel
+
+	channel_count() : count(n_chip * n_chan * n_ampl * n_adc, 0)
+	{
+		for (int i = 0; i < n_chip; i++)
+			for (int i1 = 0; i1 < n_chan; i1++)
+				hits[i][i1] = 0;
+	}
+
+	void fill(int chip_index, int chan, int ampl, int adc)
+	{
+		hits[chip_index][chan] += 1;
+		if (ampl < 0 || ampl >= n_ampl || adc < 0 || adc >= n_adc)
+			return;
+
+		count[((chip_index * n_chan + chan) * n_ampl + ampl) * n_adc + adc] += 1;
+	}
+
+	unsigned int get(int chip_index, int chan, int ampl, int adc) const
+	{
+		return count[((chip_index * n_chan + chan) * n_ampl + ampl) * n_adc + adc];
+	}
+};
+
+// Parameters, errors, and chi2 of a fit. They are set to the fit function to draw it.
+struct fit_values
+{
+	double par[3] = {0, 0, 0};
+	double err[3] = {0, 0, 0};
+	double chi2 = 0;
+	int ndf = 0;
+
+	void get(TF1 *function)
+	{
+		for (int i = 0; i < function->GetNpar() && i < 3; i++)
+		{
+			par[i] = function->GetParameter(i);
+			err[i] = function->GetParError(i);
+		}
+		chi2 = function->GetChisquare();
+		ndf = function->GetNDF();
+	}
+
+	void set(TF1 *function) const
+	{
+		for (int i = 0; i < function->GetNpar() && i < 3; i++)
+		{
+			function->SetParameter(i, par[i]);
+			function->SetParError(i, err[i]);
+		}
+		function->SetChisquare(chi2);
+		function->SetNDF(ndf);
+	}
+};
+
+// Results of all fits of a channel. The names in the comments are the fit functions in calibration_ana_code_multi_copy.
+struct channel_fit
+{
+	fit_values ef_adc[5];	   // ef_fit_adc0-4, erf of ADC >= 0-4
+	fit_values ef_adc_acum;	   // ef_fit_adc_acum, erf of ADC >= 0 + ADC >= 1-3 shifted
+	fit_values pol0_adc;	   // polynomial0_adc, erf widths of ADC >= 0-3
+	fit_values gaus_adc[5];	   // chan_ADC_fit and chan_ADC0-4_fit, gaus of ADC 0-4
+	fit_values pol1;		   // polynomial1, gaus means of ADC 0-3
+	fit_values pol0;		   // polynomial0, gaus widths of ADC 0-3
+	fit_values slope;		   // slope, ampl vs adc
+	fit_values gaus_offset[3]; // gaus_fit_new, gaus_fit_new_02, gaus_fit_new_13, offset ampl of all, even, odd ADC
+	fit_values ef;			   // ef_fit, erf of all ADC
+};
+
+// Histograms and fit functions of a thread. Their names have the index of the thread, so nothing is shared between threads.
+// The fits are the same as the ones in calibration_ana_code_multi_copy, but the fit functions are reset before each channel,
+// so the results don't depend on the channel fitted before.
+// The erf fits are done by SCurveFitter (general_codes/functions), which starts from the turn on and the width of the curve itself.
+struct channel_fitter
+{
+	TH1F *adc[5];	  // ADC == 0-4
+	TH1F *adc_on[5];  // ADC >= 0-4
+	TH1F *shifted[3]; // ADC >= 1-3 shifted to the turn on of ADC >= 0
+	TH1F *acum;		  // ADC >= 0 + shifted
+	TH1F *ampl_1D;
+	TH1F *offset[3]; // offset ampl of all, even, odd ADC
+	TH2F *ampladc;
+	SCurveFitter scurve;
+	TF1 *gaus;
+	TF1 *pol0;
+	TF1 *pol1;
+	TF1 *slope;
+
+	channel_fitter(int index)
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			adc[i] = new TH1F(Form("fitter%d_adc%d", index, i), "", 70, 0, 70);
+			adc_on[i] = new TH1F(Form("fitter%d_adc%d_on", index, i), "", 70, 0, 70);
+			adc_on[i]->Sumw2();
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			shifted[i] = new TH1F(Form("fitter%d_shifted%d", index, i + 1), "", 70, 0, 70);
+			offset[i] = new TH1F(Form("fitter%d_offset%d", index, i), "", 70, 0, 70);
+		}
+		acum = new TH1F(Form("fitter%d_acum", index), "", 70, 0, 70);
+		acum->Sumw2();
+		ampl_1D = new TH1F(Form("fitter%d_ampl_1D", index), "", 70, 0, 70);
+		ampladc = new TH2F(Form("fitter%d_ampladc", index), "", 70, 0, 70, 8, 0, 8);
+
+		for (auto hist : {adc[0], adc[1], adc[2], adc[3], adc[4], adc_on[0], adc_on[1], adc_on[2], adc_on[3], adc_on[4],
+						  shifted[0], shifted[1], shifted[2], offset[0], offset[1], offset[2], acum, ampl_1D})
+			hist->SetDirectory(0);
+		ampladc->SetDirectory(0);
+
+		gaus = new TF1(Form("fitter%d_gaus", index), "gaus", 0, 70);
+		pol0 = new TF1(Form("fitter%d_pol0", index), "pol0", -1, 10);
+		pol1 = new TF1(Form("fitter%d_pol1", index), "pol1", 0, 70);
+		slope = new TF1(Form("fitter%d_slope", index), RC_eq1, 0, 70, 2);
+	}
+
+	~channel_fitter()
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			delete adc[i];
+			delete adc_on[i];
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			delete shifted[i];
+			delete offset[i];
+		}
+		delete acum;
+		delete ampl_1D;
+		delete ampladc;
+		delete gaus;
+		delete pol0;
+		delete pol1;
+		delete slope;
+	}
+
+	void reset(TF1 *function)
+	{
+		for (int i = 0; i < function->GetNpar(); i++)
+		{
+			function->SetParameter(i, 0);
+			function->SetParError(i, 0);
+		}
+		function->SetChisquare(0);
+		function->SetNDF(0);
+	}
+
+	// [0] turn_on, [1] width, [2] height
+	void fit_erf(TH1F *hist, double height_min, double height_max, double width_max, fit_values &result)
+	{
+		result = fit_values();
+		if (hist->GetEntries() == 0)
+		{
+			result.par[0] = 10;
+			result.par[2] = 1;
+			return;
+		}
+
+		scurve.SetLimits(SCurveFitter::kHeight, height_min, height_max);
+		scurve.SetLimits(SCurveFitter::kWidth, 0.2, width_max);
+		SCurveResult fitted = scurve.Fit(hist);
+		for (int i = 0; i < 3; i++)
+		{
+			result.par[i] = fitted.par[i];
+			result.err[i] = fitted.err[i];
+		}
+		result.chi2 = fitted.chi2;
+		result.ndf = fitted.ndf;
+	}
+
+	void fit(const channel_count &hit_count, int chip_index, int chan, const double *slope_seed, channel_fit &result)
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			adc[i]->Reset("ICESM");
+			adc_on[i]->Reset("ICESM");
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			shifted[i]->Reset("ICESM");
+			offset[i]->Reset("ICESM");
+		}
+		acum->Reset("ICESM");
+		ampl_1D->Reset("ICESM");
+		ampladc->Reset("ICESM");
+
+		double sum_adc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		double count_adc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+		for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++) // ampl > 0
+		{
+			for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
+			{
+				unsigned int n = hit_count.get(chip_index, chan, i_ampl, i_adc);
+				if (n == 0)
+					continue;
+
+				fill_count(ampladc, i_ampl, i_adc, n);
+				fill_count(ampl_1D, i_ampl, n);
+				if (i_adc < 5)
+					fill_count(adc[i_adc], i_ampl, n);
+
+				for (int i = 0; i < 5 && i <= i_adc; i++)
+					fill_count(adc_on[i], i_ampl, n);
+
+				sum_adc[i_adc] += double(i_ampl) * n;
+				count_adc[i_adc] += n;
+			}
+		}
+
+		// erf of ADC >= 0-4
+		for (int i = 0; i < 5; i++)
+			fit_erf(adc_on[i], 9.9, 12, 10, result.ef_adc[i]);
+
+		// ADC >= 1-3 shifted by the difference of the turn on are added to ADC >= 0
+		acum->Add(adc_on[0]);
+		for (int i = 0; i < 3; i++)
+		{
+			shifted_hist(adc_on[i + 1], shifted[i], result.ef_adc[i + 1].par[0] - result.ef_adc[0].par[0]);
+			acum->Add(shifted[i]);
+		}
+		fit_erf(acum, 40, 50, 10, result.ef_adc_acum);
+
+		// the erf widths of ADC >= 0-3 should be the same
+		double x[4] = {0, 1, 2, 3};
+		double ex[4] = {0, 0, 0, 0};
+		double width_erf[4], width_erf_error[4];
+		for (int i = 0; i < 4; i++)
+		{
+			width_erf[i] = result.ef_adc[i].par[1];
+			width_erf_error[i] = result.ef_adc[i].err[1];
+		}
+		TGraphErrors width_erf_graph(4, x, width_erf, ex, width_erf_error);
+		reset(pol0);
+		width_erf_graph.Fit(pol0, "NQ");
+		result.pol0_adc.get(pol0);
+
+		// gaus of ADC 0-4
+		for (int i = 0; i < 5; i++)
+		{
+			reset(gaus);
+			if (adc[i]->GetEntries() != 0)
+				adc[i]->Fit(gaus, "NQ");
+
+			result.gaus_adc[i].get(gaus);
+		}
+
+		// linearity of the gaus means and consistency of the gaus widths of ADC 0-3
+		reset(pol1);
+		reset(pol0);
+		if (adc[1]->GetEntries() != 0)
+		{
+			double mean[4], mean_error[4], width[4], width_error[4];
+			for (int i = 0; i < 4; i++)
+			{
+				mean[i] = result.gaus_adc[i].par[1];
+				mean_error[i] = result.gaus_adc[i].err[1];
+				width[i] = result.gaus_adc[i].par[2];
+				width_error[i] = result.gaus_adc[i].err[2];
+			}
+			TGraphErrors mean_graph(4, x, mean, ex, mean_error);
+			mean_graph.Fit(pol1, "NQ");
+			TGraphErrors width_graph(4, x, width, ex, width_error);
+			width_graph.Fit(pol0, "NQ");
+		}
+		else
+		{
+			pol1->SetChisquare(1000000);
+			pol1->SetNDF(1);
+			pol0->SetChisquare(1000000);
+			pol0->SetNDF(1);
+		}
+		result.pol1.get(pol1);
+		result.pol0.get(pol0);
+
+		// ampl vs adc, it starts from the fit of the chip
+		reset(slope);
+		slope->SetParameters(slope_seed[0], slope_seed[1]);
+		ampladc->Fit(slope, "NQ");
+		result.slope.get(slope);
+
+		// gaus of the ampl corrected by the average ampl of each ADC
+		double average_adc[8];
+		for (int i = 0; i < 8; i++)
+			average_adc[i] = count_adc[i] == 0 ? sum_adc[i] : sum_adc[i] / count_adc[i];
+
+		for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++)
+		{
+			for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
+			{
+				unsigned int n = hit_count.get(chip_index, chan, i_ampl, i_adc);
+				if (n == 0)
+					continue;
+
+				double offset_ampl = i_ampl - (average_adc[i_adc] - average_adc[0]);
+				fill_count(offset[0], offset_ampl, n);
+				fill_count(offset[i_adc % 2 == 0 ? 1 : 2], offset_ampl, n);
+			}
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			reset(gaus);
+			if (offset[i]->GetEntries() != 0)
+				offset[i]->Fit(gaus, "NQ");
+
+			result.gaus_offset[i].get(gaus);
+		}
+
+		// erf of all ADC
+		fit_erf(ampl_1D, 9.9, 10.5, 10.5, result.ef);
+	}
+};
+
+// All channels are fitted by n_threads threads (all cores for 0). Each thread takes the next channel from the queue,
+// and the results are stored at the index of the channel (chip_index * 128 + chan), so they are the same for any n_threads.
+void fit_channels(const channel_count &hit_count, const double slope_seed[][2], vector<channel_fit> &fits, int n_threads)
+{
+	if (n_threads <= 0)
+		n_threads = std::thread::hardware_concurrency();
+	if (n_threads <= 0)
+		n_threads = 1;
+
+	// TMinuit can't be used by threads at the same time
+	ROOT::EnableThreadSafety();
+	ROOT::Math::MinimizerOptions::SetDefaultMinimizer("Minuit2");
+
+	fits.assign(channel_count::n_chip * channel_count::n_chan, channel_fit());
+	std::atomic<int> next_channel(0);
+	auto work = [&](int thread_index)
+	{
+		channel_fitter fitter(thread_index);
+		while (true)
+		{
+			int index = next_channel++;
+			if (index >= (int)fits.size())
+				break;
+
+			int chip_index = index / channel_count::n_chan;
+			fitter.fit(hit_count, chip_index, index % channel_count::n_chan, slope_seed[chip_index], fits[index]);
+		}
+	};
+
+	vector<std::thread> threads;
+	for (int i = 1; i < n_threads; i++)
+		threads.push_back(std::thread(work, i));
+
+	work(0);
+	for (auto &thread : threads)
+		thread.join();
+}
 
 
 
 //void name with "copy" is correct
-void calibration_ana_code_multi_copy(TString folder_name, int module_number, bool run_option, bool assembly_check, int noise_level_check, bool new_check, bool unbound_check, bool noise_channel_check, bool multi_run)
+void calibration_ana_code_multi_copy(TString folder_name, int module_number, bool run_option, bool assembly_check, int noise_level_check, bool new_check, bool unbound_check, bool noise_channel_check, bool multi_run, int file_index, int n_threads = 0)
 {
 	//===============criteria variable===================
 
@@ -102,7 +499,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	}
 
 	cout << "test list size : " << list_array.size() << endl;
-	int run_file = data_index; // data index is not declared, it has to be changed by .sh file
+	int run_file = file_index; // the index in total_file.txt, given by calibration_driver
 	the_name = list_array[run_file];
 
 	cout << Form(" !!! The input data name : %s", the_name.Data()) << endl;
@@ -139,140 +536,23 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	// vector<double>D_EE; D_EE.clear();
 
 
-	int chip_ER, chan_ER;
-	int chip_ERM, chan_ERM;
-
-	
-	int chip_N, chan_N;
-	int chip_E, chan_E, level_E;
-	int chip_U, chan_U;
-	int chip_W, chan_W;
-	int chip_CE, chan_CE, level_CE;
-	int chip_CE_ampl, chan_CE_ampl, level_CE_ampl;
-	int chip_TP, chan_TP;
-	int chip_rchi2, chan_rchi2;
-	int chip_adc_root, chan_adc_root;
-	double slope_value, slope_rchi2, width_value, width_rchi2;
-	double root_adc_0, root_adc_1, root_adc_2, root_adc_3, root_adc_4;
-	double root_adc_0N, root_adc_1N, root_adc_2N, root_adc_3N, root_adc_4N;
-
-
-	double level_N, level_U, level_W, level_W02, level_W13, level_ADC0, level_ADC1, level_ADC2, level_ADC3, level_pvalue, mean_ADC0, mean_ADC1, mean_ADC2, mean_ADC3;
-	//TString source_name;
-
-	double entries_mean, entries_width;
-	double entries_mean_ampl, entries_width_ampl;
-
-	double TP_turnon, TP_width, TP_height;
-
 	TFile *file_output = new TFile(Form("%s/folder_%s/%s_summary.root", folder_name.Data(), the_name.Data(), the_name.Data()), "RECREATE");
 	//file_output->cd();
-	TTree *tree_output1 = new TTree("Noise_check", Form("With bias 100V, noise level > %1.f",Gaus_width_cut));
-	TTree *tree_output2 = new TTree("Entries_check", Form("With bias 100V, Entries > %d or entries < %d",entry_cut_h,entry_cut_l));
-	TTree *tree_output3 = new TTree("Unbonded_check", Form("Without bias, Noise level < %1.f",Gaus_width_cut));
-	TTree *tree_output4 = new TTree("chan_gaus_width", "gaus width of each channel");
-	TTree *tree_output5 = new TTree("Total_entries", "Total entries distribution");
-	TTree *tree_output6 = new TTree("chan_entry", "entry of each channel");
-	TTree *tree_output7 = new TTree("ampl_total_entries", "Total entries distribution after ampl cut");
-	TTree *tree_output8 = new TTree("ampl_channel_entries", "entry of each channel after ampl cut");
-	TTree *tree_output9 = new TTree("chan_thre_position", "threshold_position of each channel");
-	TTree *tree_output10 = new TTree("chan_study", "slop, width, chi2 of each channel");
-	TTree *tree_output11 = new TTree("chan_adc_study", "mean of each adc of each channel");
-	TTree *tree_output12 = new TTree("chan_err_width", "err width of each channel");
-	TTree *tree_output13 = new TTree("chan_err_mean", "err mean of each channel");
-
-
-
-
-	tree_output12->Branch("source_id", &run_file);
-	tree_output12->Branch("chip_id", &chip_ER);
-	tree_output12->Branch("chan_id", &chan_ER);
-	tree_output12->Branch("err_width0", &level_ADC0);  // the ADC0 "err fit width" of each channel (3328 channels)
-	tree_output12->Branch("err_width1", &level_ADC1); // the ADC1 "err fit width" of each channel (3328 channels)
-	tree_output12->Branch("err_width2", &level_ADC2); // the ADC2 "err fit width" of each channel (3328 channels)
-	tree_output12->Branch("err_width3", &level_ADC3); // the ADC3 "err fit width" of each channel (3328 channels)
-	tree_output12->Branch("err_pvalue", &level_pvalue); 
-
-	
-	tree_output13->Branch("source_id", &run_file);
-	tree_output13->Branch("chip_id", &chip_ERM);
-	tree_output13->Branch("chan_id", &chan_ERM);
-	tree_output13->Branch("err_mean0", &mean_ADC0);  // the ADC0 "err fit mean" of each channel (3328 channels)
-	tree_output13->Branch("err_mean1", &mean_ADC1); // the ADC1 "err fit mean" of each channel (3328 channels)
-	tree_output13->Branch("err_mean2", &mean_ADC2); // the ADC2 "err fit mean" of each channel (3328 channels)
-	tree_output13->Branch("err_mean3", &mean_ADC3); // the ADC3 "err fit mean" of each channel (3328 channels)
 
-	
+	// all results of a channel are kept in records[(chip_id - 1) * 128 + chan_id], and they are written as one tree at the end
+	// (they were 13 trees : chan_gaus_width, chan_entry, Noise_check, and so on)
+	vector<CalibrationRecord> records(26 * 128);
+	for (int i = 0; i < 26 * 128; i++)
+	{
+		records[i].source_id = run_file;
+		records[i].module = module_number;
+		records[i].chip_id = i / 128 + 1;
+		records[i].chan_id = i % 128;
+	}
 
-	tree_output1->Branch("source_id", &run_file);
-	tree_output1->Branch("chip_id", &chip_N);
-	tree_output1->Branch("chan_id", &chan_N);
-	tree_output1->Branch("noise_level", &level_N); // the channel whose fit gaussian width is > 4 
-
-	tree_output2->Branch("source_id", &run_file);
-	tree_output2->Branch("chip_id", &chip_E);
-	tree_output2->Branch("chan_id", &chan_E);
-	tree_output2->Branch("entries", &level_E); // the channel whose # of entry > 400 or entry < 280 (with no ampl cut)
-
-	tree_output3->Branch("source_id", &run_file);
-	tree_output3->Branch("chip_id", &chip_U);
-	tree_output3->Branch("chan_id", &chan_U);
-	tree_output3->Branch("noise_level", &level_U); // the channel whose fit gaussian width is < 4
-
-	tree_output4->Branch("source_id", &run_file);
-	tree_output4->Branch("chip_id", &chip_W);
-	tree_output4->Branch("chan_id", &chan_W);
-	tree_output4->Branch("Gaus_width", &level_W); // the "gaussian fit width" of each channel (3328 channels)
-	tree_output4->Branch("Gaus_width02", &level_W02); // the ADC0 and ADC2 "gaussian fit width" of each channel (3328 channels)
-	tree_output4->Branch("Gaus_width13", &level_W13); // the ADC1 and ADC3 "gaussian fit width" of each channel (3328 channels)
-
-
-	tree_output5->Branch("source_id", &run_file);
-	tree_output5->Branch("entries_mean", &entries_mean);
-	tree_output5->Branch("entries_width", &entries_width); // the "mean and width " of channel entry from 1D hist (all channels in hist) 
-
-	tree_output6->Branch("source_id", &run_file);
-	tree_output6->Branch("chip_id", &chip_CE);
-	tree_output6->Branch("chan_id", &chan_CE);     //entry of each channel without ampl cut
-	tree_output6->Branch("chan_entry", &level_CE); //the # of event of each channel (3328 channels)
-
-	tree_output7->Branch("source_id", &run_file);
-	tree_output7->Branch("entries_mean", &entries_mean_ampl);
-	tree_output7->Branch("entries_width", &entries_width_ampl); // the "mean and width " of channel entry from 1D hist (all channels in hist) 
-
-	tree_output8->Branch("source_id", &run_file);
-	tree_output8->Branch("chip_id", &chip_CE_ampl);
-	tree_output8->Branch("chan_id", &chan_CE_ampl);     //entry of each channel after ampl cut
-	tree_output8->Branch("chan_entry", &level_CE_ampl); //the # of event of each channel (3328 channels)
-
-	tree_output9->Branch("source_id", &run_file);
-	tree_output9->Branch("chip_id", &chip_TP);
-	tree_output9->Branch("chan_id", &chan_TP);
-	tree_output9->Branch("TP_turnon", &TP_turnon); 
-	tree_output9->Branch("TP_width", &TP_width);   // threshold_position of each channel (3328 channels)
-	tree_output9->Branch("TP_height", &TP_height); // chan_ampl_1D all channels
-
-	tree_output10->Branch("source_id", &run_file);
-	tree_output10->Branch("chip_id", &chip_rchi2);
-	tree_output10->Branch("chan_id", &chan_rchi2);
-	tree_output10->Branch("slope_value", &slope_value); //linearity study, slope value of each channel (3328 channels)
-	tree_output10->Branch("slope_rchi2", &slope_rchi2); //linearity study, reduced chi2 of slope of each channel (3328 channels)
-	tree_output10->Branch("width_value", &width_value); //"width consistence" study, average width value of each channel (3328 channels)
-	tree_output10->Branch("width_rchi2", &width_rchi2); //"width consistence" study, reduced chi2 of pol1 fit of each channel. (3328 channels)
-
-	tree_output11->Branch("source_id", &run_file);
-	tree_output11->Branch("chip_id", &chip_adc_root);
-	tree_output11->Branch("chan_id", &chan_adc_root);
-	tree_output11->Branch("adc0", &root_adc_0);  // mean of ADC0 distribution of each channel (3328 channels)
-	tree_output11->Branch("adc1", &root_adc_1);
-	tree_output11->Branch("adc2", &root_adc_2);
-	tree_output11->Branch("adc3", &root_adc_3);
-	tree_output11->Branch("adc4", &root_adc_4);
-	tree_output11->Branch("adc0N", &root_adc_0N);  // numeric mean of ADC0 distribution of each channel (3328 channels)
-	tree_output11->Branch("adc1N", &root_adc_1N);
-	tree_output11->Branch("adc2N", &root_adc_2N);
-	tree_output11->Branch("adc3N", &root_adc_3N);
-	tree_output11->Branch("adc4N", &root_adc_4N);
+	TTree *tree_output = new TTree(CalibrationRecordTree::kTreeName, Form("calibration results of each channel, noise level cut %1.f, entries cut %d-%d", Gaus_width_cut, entry_cut_l, entry_cut_h));
+	CalibrationRecordTree record_tree;
+	record_tree.Book(tree_output);
 
 
 
@@ -407,8 +687,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	vector<int> event_memory;
 	event_memory.clear();
 
-	vector<int> chip_adc[26][128];	//chip_adc.clear();
-	vector<int> chip_ampl[26][128]; //chip_ampl.clear();
+	channel_count hit_count; // the hits of the module
 	vector<double> ampl_adc_slope[26];
 	vector<double> ampl_adc_offset[26];
 	vector<double> ampl_adc_chiNDF[26];
@@ -434,23 +713,11 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	vector<int> entries_entries;
 	entries_entries.clear();
 
-	vector<int> Centries_chip;
-	Centries_chip.clear();
-	vector<int> Centries_channel;
-	Centries_channel.clear();
-	vector<int> Centries_entries;
-	Centries_entries.clear();
-
 	for (int i = 0; i < 26; i++)
 	{
 		ampl_adc_slope[i].clear();
 		ampl_adc_offset[i].clear();
 		ampl_adc_chiNDF[i].clear();
-		for (int i1 = 0; i1 < 128; i1++)
-		{
-			chip_adc[i][i1].clear();
-			chip_ampl[i][i1].clear();
-		}
 	}
 
 	Gettree->SetBranchAddress("adc", &adc);
@@ -474,8 +741,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 		//if (chan_id == 127)cout << event <<" : "<< ampl <<" : "<< adc <<" : "<< chip_id <<" : "<< chan_id<<endl;
 		if (chip_id > 0 && chip_id < 27 && chan_id > -1 && chan_id < 128 && module == module_number)
 		{
-			chip_ampl[chip_id - 1][chan_id].push_back(ampl);
-			chip_adc[chip_id - 1][chan_id].push_back(adc);
+			hit_count.fill(chip_id - 1, chan_id, ampl, adc);
 		}
 		else
 		{
@@ -535,6 +801,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	chip_slope.clear();
 	vector<double> chip_index;
 	chip_index.clear();
+	double chip_slope_seed[26][2]; // the initial values of the slope fit of the channels
 
 	int threshold_cut_array[26][128];
 
@@ -559,18 +826,22 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 		for (int i2 = 0; i2 < 128; i2++)
 		{
-			for (int i3 = 0; i3 < chip_ampl[i4][i2].size(); i3++)
+			for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++) // ampl > 0
 			{
-				if (chip_ampl[i4][i2][i3] > 0)
+				for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
 				{
-					ampl_adc[i4]->Fill(chip_ampl[i4][i2][i3], chip_adc[i4][i2][i3]);
-					if (chip_adc[i4][i2][i3] == noise_level_check)
+					unsigned int n = hit_count.get(i4, i2, i_ampl, i_adc);
+					if (n == 0)
+						continue;
+
+					fill_count(ampl_adc[i4], i_ampl, i_adc, n);
+					if (i_adc == noise_level_check)
 					{
-						noise_level->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(noise_level, i_ampl, n);
 					}
-					if (chip_ampl[i4][i2][i3]>threshold_cut)
+					if (i_ampl>threshold_cut)
 					{
-						threshold_cut_array[i4][i2]+=1;
+						threshold_cut_array[i4][i2]+=n;
 					}
 				}
 			}
@@ -584,6 +855,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 		//cout<<"TESTTESTTEST"<<endl;
 		slope->Draw("lsame");
 		chip_slope.push_back(slope->GetParameter(0));
+		chip_slope_seed[i4][0] = slope->GetParameter(0);
+		chip_slope_seed[i4][1] = slope->GetParameter(1);
 		chip_index.push_back(i4 + 1);
 		//cout<<"TESTTESTTEST"<<endl;
 		//c1 -> cd(); tex111 -> DrawLatex (0.12, 0.80-(i4*0.03), Form("chip_id=%d,  slope : %.4f,  offset : %.3f,  chi2/NDF : %.2f",i4+1,slope->GetParameter(0),slope->GetParameter(1),slope->GetChisquare()/slope->GetNDF()));
@@ -656,15 +929,15 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 		for (int i2 = 0; i2 < 128; i2++)
 		{
-			if (chip_ampl[i4][i2].size() > 700 || chip_ampl[i4][i2].size() < 200)
-				cout << " Need to check, the entries of each channel, chip : " << i4 + 1 << " channel : " << i2 << " " << chip_ampl[i4][i2].size() << endl;
-			for (int i3 = 0; i3 < chip_ampl[i4][i2].size(); i3++)
+			if (hit_count.hits[i4][i2] > 700 || hit_count.hits[i4][i2] < 200)
+				cout << " Need to check, the entries of each channel, chip : " << i4 + 1 << " channel : " << i2 << " " << hit_count.hits[i4][i2] << endl;
+			for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++) // ampl > 0
 			{
-				if (chip_ampl[i4][i2][i3] > 0)
+				for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
 				{
-					//if (i4+1==16 && i2==0) cout<<i2<<" "<<chip_ampl[i4][i2][i3]<<" "<<chip_adc[i4][i2][i3]<<endl;
-					chan_ampl[i4]->Fill(i2, chip_ampl[i4][i2][i3]);
-					chan_adc[i4]->Fill(i2, chip_adc[i4][i2][i3]);
+					unsigned int n = hit_count.get(i4, i2, i_ampl, i_adc);
+					fill_count(chan_ampl[i4], i2, i_ampl, n);
+					fill_count(chan_adc[i4], i2, i_adc, n);
 				}
 			}
 		}
@@ -816,7 +1089,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	c2->SetRightMargin(0.075);
 	gStyle->SetOptStat(111111);
 
-	double average_adc[8];
+	double average_adc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 	// double average_adc1;
 	// double average_adc2;
 	// double average_adc3;
@@ -825,7 +1098,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	// double average_adc6;
 	// double average_adc7;
 
-	double sum_adc[8];
+	double sum_adc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 	// double sum_adc1;
 	// double sum_adc2;
 	// double sum_adc3;
@@ -834,7 +1107,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 	// double sum_adc6;
 	// double sum_adc7;
 
-	double count_adc[8];
+	double count_adc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 	// double count_adc1;
 	// double count_adc2;
 	// double count_adc3;
@@ -1009,7 +1282,11 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 	TF1 * polynomial1 = new TF1 ("polynomial1","pol1",0,70);
 
-
+	// all fits of the channels are done here by threads, they are only set to the fit functions below to draw them
+	auto fit_start = std::chrono::steady_clock::now();
+	vector<channel_fit> channel_fits;
+	fit_channels(hit_count, chip_slope_seed, channel_fits, n_threads);
+	cout << " fitting " << channel_fits.size() << " channels : " << std::chrono::duration<double>(std::chrono::steady_clock::now() - fit_start).count() << " s" << endl;
 
 	for (int i4 = 0; i4 < 26; i4++)
 	{
@@ -1060,6 +1337,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 		}
 		for (int i2 = 0; i2 < 128; i2++)
 		{	
+			const channel_fit &fits = channel_fits[i4 * 128 + i2];
+			CalibrationRecord &record = records[i4 * 128 + i2];
 
 			ampladc_detail->SetTitle(Form("chip_id=%d, chan_id = %d", i4 + 1, i2));
 			check_new->SetTitle(Form("chip_id=%d, chan_id = %d", i4 + 1, i2));
@@ -1090,77 +1369,73 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			adc_stack->SetTitle(Form("chip_id=%d, chan_id = %d", i4 + 1, i2));
 
 			//if (chip_ampl[i4][i2].size()>700 || chip_ampl[i4][i2].size()<200) cout<<" Need to check, the entries of each channel, chip : "<<i4+1<<" channel : "<<i2<<" " <<chip_ampl[i4][i2].size()<<endl;
-			for (int i3 = 0; i3 < chip_ampl[i4][i2].size(); i3++)
+			for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++) // ampl > 0
 			{
-				if (chip_ampl[i4][i2][i3] > 0)
+				for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
 				{
-					//if (i4+1==16 && i2==0) cout<<i2<<" "<<chip_ampl[i4][i2][i3]<<" "<<chip_adc[i4][i2][i3]<<endl;
-					ampladc_detail->Fill(chip_ampl[i4][i2][i3], chip_adc[i4][i2][i3]);
-					chan_ampl_1D->Fill(chip_ampl[i4][i2][i3]);
+					unsigned int n = hit_count.get(i4, i2, i_ampl, i_adc);
+					if (n == 0)
+						continue;
 
-					if (chip_adc[i4][i2][i3] == 0)
+					fill_count(ampladc_detail, i_ampl, i_adc, n);
+					fill_count(chan_ampl_1D, i_ampl, n);
+
+					if (i_adc == 0)
 					{
-						channel_ADC_0->Fill(chip_ampl[i4][i2][i3]);
-												
+						fill_count(channel_ADC_0, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 1)
+					if (i_adc == 1)
 					{
-						channel_ADC_1->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_1, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 2)
+					if (i_adc == 2)
 					{
-						channel_ADC_2->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_2, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 3)
+					if (i_adc == 3)
 					{
-						channel_ADC_3->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_3, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 4)
+					if (i_adc == 4)
 					{
-						channel_ADC_4->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_4, i_ampl, n);
 					}
 					//-----------------------------------------------
 
-					
-					if (chip_adc[i4][i2][i3] == 0 || chip_adc[i4][i2][i3] == 1 || chip_adc[i4][i2][i3] == 2 || chip_adc[i4][i2][i3] == 3 || chip_adc[i4][i2][i3] == 4 || chip_adc[i4][i2][i3] == 5 || chip_adc[i4][i2][i3] == 6 || chip_adc[i4][i2][i3] == 7)
-					{
-					  
-					  channel_ADC_0_on->Fill(chip_ampl[i4][i2][i3]);
-					  channel_ADC_0_on_clone->Fill(chip_ampl[i4][i2][i3]);
-					}
-					
-					
-					if (chip_adc[i4][i2][i3] == 1 || chip_adc[i4][i2][i3] == 2 || chip_adc[i4][i2][i3] == 3 || chip_adc[i4][i2][i3] == 4 || chip_adc[i4][i2][i3] == 5 || chip_adc[i4][i2][i3] == 6 || chip_adc[i4][i2][i3] == 7)
+					// the accumulated distributions, ADC >= 0, 1, 2, 3, and 4
+					fill_count(channel_ADC_0_on, i_ampl, n);
+					fill_count(channel_ADC_0_on_clone, i_ampl, n);
+
+					if (i_adc >= 1)
 					{
-					  channel_ADC_1_on->Fill(chip_ampl[i4][i2][i3]);
-					  channel_ADC_1_on_clone->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_1_on, i_ampl, n);
+						fill_count(channel_ADC_1_on_clone, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 2 || chip_adc[i4][i2][i3] == 3 || chip_adc[i4][i2][i3] == 4 || chip_adc[i4][i2][i3] == 5 || chip_adc[i4][i2][i3] == 6 || chip_adc[i4][i2][i3] == 7)
+					if (i_adc >= 2)
 					{
-						channel_ADC_2_on->Fill(chip_ampl[i4][i2][i3]);
-						channel_ADC_2_on_clone->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_2_on, i_ampl, n);
+						fill_count(channel_ADC_2_on_clone, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 3 || chip_adc[i4][i2][i3] == 4 || chip_adc[i4][i2][i3] == 5 || chip_adc[i4][i2][i3] == 6 || chip_adc[i4][i2][i3] == 7)
+					if (i_adc >= 3)
 					{
-						channel_ADC_3_on->Fill(chip_ampl[i4][i2][i3]);
-						channel_ADC_3_on_clone->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_3_on, i_ampl, n);
+						fill_count(channel_ADC_3_on_clone, i_ampl, n);
 					}
 
-					if (chip_adc[i4][i2][i3] == 4 || chip_adc[i4][i2][i3] == 5 || chip_adc[i4][i2][i3] == 6 || chip_adc[i4][i2][i3] == 7)
+					if (i_adc >= 4)
 					{
-						channel_ADC_4_on->Fill(chip_ampl[i4][i2][i3]);
-						channel_ADC_4_on_clone->Fill(chip_ampl[i4][i2][i3]);
+						fill_count(channel_ADC_4_on, i_ampl, n);
+						fill_count(channel_ADC_4_on_clone, i_ampl, n);
 					}
 
-					
-					sum_adc[chip_adc[i4][i2][i3]] += chip_ampl[i4][i2][i3];
-					count_adc[chip_adc[i4][i2][i3]] += 1;
+					sum_adc[i_adc] += double(i_ampl) * n;
+					count_adc[i_adc] += n;
 				}
 			}
 
@@ -1177,22 +1452,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			channel_ADC_0_on->Draw("hist");
 			//chan_ADC0_fit_on->Draw("lsame");
 			
-			if (channel_ADC_0_on->GetEntries() ==0)
-			  {
-			    ef_fit_adc0->SetParameter(0,10); //turn on
-			    ef_fit_adc0->SetParameter(1,0); //slope
-			    ef_fit_adc0->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc0->SetParameters(30, 2, 12); 
-			    ef_fit_adc0->SetParLimits(2,9.9,12);
-			    ef_fit_adc0->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_0_on->Fit("ef_fit_adc0", "NQ");	
-			  }
+			fits.ef_adc[0].set(ef_fit_adc0);
 			c15->cd();
 			ef_fit_adc0->Draw("lsame");
 			c15->cd();
@@ -1209,22 +1469,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			c15->cd();
 			channel_ADC_1_on->Draw("hist");
 			
-			if (channel_ADC_1_on->GetEntries() ==0)
-			  {
-			    ef_fit_adc1->SetParameter(0,10); //turn on
-			    ef_fit_adc1->SetParameter(1,0); //slope
-			    ef_fit_adc1->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc1->SetParameters(35, 2, 12); 
-			    ef_fit_adc1->SetParLimits(2,9.9,12);
-			    ef_fit_adc1->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_1_on->Fit("ef_fit_adc1", "NQ");	
-			  }
+			fits.ef_adc[1].set(ef_fit_adc1);
 			c15->cd();
 			ef_fit_adc1->Draw("lsame");
 			c15->cd();
@@ -1241,22 +1486,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			c15->cd();
 			channel_ADC_2_on->Draw("hist");
 			
-			if (channel_ADC_2_on->GetEntries() ==0)
-			  {
-			    ef_fit_adc2->SetParameter(0,10); //turn on
-			    ef_fit_adc2->SetParameter(1,0); //slope
-			    ef_fit_adc2->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc2->SetParameters(40, 2, 12); 
-			    ef_fit_adc2->SetParLimits(2,9.9,12);
-			    ef_fit_adc2->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_2_on->Fit("ef_fit_adc2", "NQ");	
-			  }
+			fits.ef_adc[2].set(ef_fit_adc2);
 			c15->cd();
 			ef_fit_adc2->Draw("lsame");
 			c15->cd();
@@ -1273,22 +1503,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			c15->cd();
 			channel_ADC_3_on->Draw("hist");
 			
-			if (channel_ADC_3_on->GetEntries() ==0)
-			  {
-			    ef_fit_adc3->SetParameter(0,10); //turn on
-			    ef_fit_adc3->SetParameter(1,0); //slope
-			    ef_fit_adc3->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc3->SetParameters(45, 2, 12); 
-			    ef_fit_adc3->SetParLimits(2,9.9,12);
-			    ef_fit_adc3->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_3_on->Fit("ef_fit_adc3", "NQ");	
-			  }
+			fits.ef_adc[3].set(ef_fit_adc3);
 			c15->cd();
 			ef_fit_adc3->Draw("lsame");
 			c15->cd();
@@ -1305,22 +1520,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			c15->cd();
 			channel_ADC_4_on->Draw("hist");
 			
-			if (channel_ADC_4_on->GetEntries() ==0)
-			  {
-			    ef_fit_adc4->SetParameter(0,10); //turn on
-			    ef_fit_adc4->SetParameter(1,0); //slope
-			    ef_fit_adc4->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc4->SetParameters(50, 2, 12); 
-			    ef_fit_adc4->SetParLimits(2,9.9,12);
-			    ef_fit_adc4->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_4_on->Fit("ef_fit_adc4", "NQ");	
-			  }
+			fits.ef_adc[4].set(ef_fit_adc4);
 			c15->cd();
 			ef_fit_adc4->Draw("lsame");
 			c15->cd();
@@ -1400,22 +1600,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			channel_ADC_0_on_clone->Draw("hist");
 			//chan_ADC0_fit_on->Draw("lsame");
 			
-			if (channel_ADC_0_on_clone->GetEntries() ==0)
-			  {
-			    ef_fit_adc_acum->SetParameter(0,10); //turn on
-			    ef_fit_adc_acum->SetParameter(1,0); //slope
-			    ef_fit_adc_acum->SetParameter(2,1);//height
-			  }
-			else 
-			  {
-			    ef_fit_adc_acum->SetParameters(30, 2, 20); 
-			    ef_fit_adc_acum->SetParLimits(2,40,50);
-			    ef_fit_adc_acum->SetParLimits(1,0.2,10);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-			    channel_ADC_0_on_clone->Fit("ef_fit_adc_acum","NQ");	
-			  }
+			fits.ef_adc_acum.set(ef_fit_adc_acum);
 			c17->cd();
 			ef_fit_adc_acum->Draw("lsame");
 			c17->cd();
@@ -1450,7 +1635,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			compactor_width->Draw("apl");
 
 			
-			compactor_width->Fit("polynomial0_adc","NQ");	
+			fits.pol0_adc.set(polynomial0_adc);
 			c18->cd();
 			polynomial0_adc->Draw("lsame");
 			
@@ -1474,19 +1659,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			
 			c8->cd();
 			channel_ADC_0->Draw("hist");
-			if (channel_ADC_0->GetEntries()==0.)
-			{
-				chan_ADC_fit->SetParameter(2,0);
-				chan_ADC_fit->SetParameter(1,0);
-
-				chan_ADC0_fit->SetParameter(2,0);
-				chan_ADC0_fit->SetParameter(1,0);
-			}
-			else 
-			{
-				channel_ADC_0->Fit("chan_ADC_fit","NQ");
-				channel_ADC_0->Fit("chan_ADC0_fit","NQ");
-			}
+			fits.gaus_adc[0].set(chan_ADC_fit);
+			fits.gaus_adc[0].set(chan_ADC0_fit);
 			c8->cd();
 			chan_ADC_fit->Draw("lsame");
 			chan_ADC_mean.push_back(chan_ADC_fit->GetParameter(1));
@@ -1506,19 +1680,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c8->cd();
 			channel_ADC_1->Draw("hist");
-			if (channel_ADC_1->GetEntries()==0.)
-			{
-				chan_ADC_fit->SetParameter(2,0);
-				chan_ADC_fit->SetParameter(1,0);
-
-				chan_ADC1_fit->SetParameter(2,0);
-				chan_ADC1_fit->SetParameter(1,0);
-			}
-			else 
-			{
-				channel_ADC_1->Fit("chan_ADC_fit","NQ");
-				channel_ADC_1->Fit("chan_ADC1_fit","NQ");
-			}
+			fits.gaus_adc[1].set(chan_ADC_fit);
+			fits.gaus_adc[1].set(chan_ADC1_fit);
 			c8->cd();
 			chan_ADC_fit->Draw("lsame");
 			chan_ADC_mean.push_back(chan_ADC_fit->GetParameter(1));
@@ -1538,19 +1701,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c8->cd();
 			channel_ADC_2->Draw("hist");
-			if (channel_ADC_2->GetEntries()==0.)
-			{
-				chan_ADC_fit->SetParameter(2,0);
-				chan_ADC_fit->SetParameter(1,0);
-
-				chan_ADC2_fit->SetParameter(2,0);
-				chan_ADC2_fit->SetParameter(1,0);
-			}
-			else 
-			{
-				channel_ADC_2->Fit("chan_ADC_fit","NQ");
-				channel_ADC_2->Fit("chan_ADC2_fit","NQ");
-			}
+			fits.gaus_adc[2].set(chan_ADC_fit);
+			fits.gaus_adc[2].set(chan_ADC2_fit);
 			c8->cd();
 			chan_ADC_fit->Draw("lsame");
 			chan_ADC_mean.push_back(chan_ADC_fit->GetParameter(1));
@@ -1570,20 +1722,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c8->cd();
 			channel_ADC_3->Draw("hist");
-			if (channel_ADC_3->GetEntries()==0.)
-			{
-				chan_ADC_fit->SetParameter(2,0);
-				chan_ADC_fit->SetParameter(1,0);
-
-				chan_ADC3_fit->SetParameter(2,0);
-				chan_ADC3_fit->SetParameter(1,0);
-
-			}
-			else 
-			{
-				channel_ADC_3->Fit("chan_ADC_fit","NQ");
-				channel_ADC_3->Fit("chan_ADC3_fit","NQ");
-			}
+			fits.gaus_adc[3].set(chan_ADC_fit);
+			fits.gaus_adc[3].set(chan_ADC3_fit);
 			c8->cd();
 			chan_ADC_fit->Draw("lsame");
 			chan_ADC_mean.push_back(chan_ADC_fit->GetParameter(1));
@@ -1603,20 +1743,8 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c8->cd();
 			channel_ADC_4->Draw("hist");
-			if (channel_ADC_4->GetEntries()==0.)
-			{
-				chan_ADC_fit->SetParameter(2,0);
-				chan_ADC_fit->SetParameter(1,0);
-
-				chan_ADC4_fit->SetParameter(2,0);
-				chan_ADC4_fit->SetParameter(1,0);
-
-			}
-			else 
-			{
-				channel_ADC_4->Fit("chan_ADC_fit","NQ");
-				channel_ADC_4->Fit("chan_ADC4_fit","NQ");
-			}
+			fits.gaus_adc[4].set(chan_ADC_fit);
+			fits.gaus_adc[4].set(chan_ADC4_fit);
 
 			c8->cd();
 			chan_ADC_fit->Draw("lsame");
@@ -1646,21 +1774,17 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 
 			
-			chip_adc_root = i4+1;
-			chan_adc_root = i2;
-			root_adc_0 = chan_ADC0_fit->GetParameter(1);
-			root_adc_1 = chan_ADC1_fit->GetParameter(1);
-			root_adc_2 = chan_ADC2_fit->GetParameter(1);
-			root_adc_3 = chan_ADC3_fit->GetParameter(1);
-			root_adc_4 = chan_ADC4_fit->GetParameter(1);
-
-			root_adc_0N = channel_ADC_0->GetMean();
-			root_adc_1N = channel_ADC_1->GetMean();
-			root_adc_2N = channel_ADC_2->GetMean();
-			root_adc_3N = channel_ADC_3->GetMean();
-			root_adc_4N = channel_ADC_4->GetMean();
-
-			tree_output11->Fill();
+			record.adc0 = chan_ADC0_fit->GetParameter(1);
+			record.adc1 = chan_ADC1_fit->GetParameter(1);
+			record.adc2 = chan_ADC2_fit->GetParameter(1);
+			record.adc3 = chan_ADC3_fit->GetParameter(1);
+			record.adc4 = chan_ADC4_fit->GetParameter(1);
+
+			record.adc0N = channel_ADC_0->GetMean();
+			record.adc1N = channel_ADC_1->GetMean();
+			record.adc2N = channel_ADC_2->GetMean();
+			record.adc3N = channel_ADC_3->GetMean();
+			record.adc4N = channel_ADC_4->GetMean();
 
 			c11->cd();
 			channel_ADC_all->SetStats(0);
@@ -1717,16 +1841,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c9->cd();
 			chan_ADC_ampl_plot->Draw("apl");
-			if (channel_ADC_1->GetEntries() !=0)
-			{
-				chan_ADC_ampl_plot->Fit("polynomial1","NQ");	
-			}
-			else 
-			{
-				polynomial1->SetParameter(1,0);
-				polynomial1->SetChisquare(1000000);
-				polynomial1->SetNDF(1);
-			}
+			fits.pol1.set(polynomial1);
 			c9->cd();
 			polynomial1->Draw("lsame");
 			
@@ -1759,16 +1874,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c10->cd();
 			chan_ADC_width_plot->Draw("apl");
-			if (channel_ADC_1->GetEntries() !=0)
-			{
-				chan_ADC_width_plot->Fit("polynomial0","NQ");	
-			}
-			else 
-			{
-				polynomial0->SetParameter(0,0);
-				polynomial0->SetChisquare(1000000);
-				polynomial0->SetNDF(1);
-			}
+			fits.pol0.set(polynomial0);
 			c10->cd();
 			polynomial0->Draw("lsame");
 			tex_adc_width->DrawLatex(0.12, 0.750, Form("p0 : %.4f", polynomial0->GetParameter(0)));
@@ -1778,13 +1884,10 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			c10->Clear();
 
 
-			chip_rchi2 = i4+1;
-			chan_rchi2 =  i2;
-			slope_value = polynomial1->GetParameter(1);
-			slope_rchi2 = polynomial1->GetChisquare()/polynomial1->GetNDF();
-			width_value = polynomial0->GetParameter(0);
-			width_rchi2 = polynomial0->GetChisquare()/polynomial0->GetNDF();
-			tree_output10->Fill();
+			record.slope_value = polynomial1->GetParameter(1);
+			record.slope_rchi2 = polynomial1->GetChisquare()/polynomial1->GetNDF();
+			record.width_value = polynomial0->GetParameter(0);
+			record.width_rchi2 = polynomial0->GetChisquare()/polynomial0->GetNDF();
 
 			width_rchi2_1D->Fill(polynomial0->GetChisquare()/polynomial0->GetNDF());
 			slope_rchi2_1D->Fill(polynomial1->GetChisquare()/polynomial1->GetNDF());
@@ -1803,31 +1906,31 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 				}
 			}
 
-			for (int i13 = 0; i13 < chip_ampl[i4][i2].size(); i13++)
+			for (int i_ampl = 1; i_ampl < channel_count::n_ampl; i_ampl++) // ampl > 0
 			{
-				if (chip_ampl[i4][i2][i13] > 0)
+				for (int i_adc = 0; i_adc < channel_count::n_adc; i_adc++)
 				{
-					//cout<<"line : 427 check "<<endl;
-					check_new->Fill(chip_ampl[i4][i2][i13] - (average_adc[chip_adc[i4][i2][i13]] - average_adc[0]));
-					
-					if (chip_adc[i4][i2][i13] == 0 || chip_adc[i4][i2][i13] == 2 || chip_adc[i4][i2][i13] == 4 || chip_adc[i4][i2][i13] == 6 )
+					unsigned int n = hit_count.get(i4, i2, i_ampl, i_adc);
+					if (n == 0)
+						continue;
+
+					double offset_ampl = i_ampl - (average_adc[i_adc] - average_adc[0]);
+					fill_count(check_new, offset_ampl, n);
+
+					if (i_adc % 2 == 0)
 					{
-						offset_width_1D_02->Fill(chip_ampl[i4][i2][i13] - (average_adc[chip_adc[i4][i2][i13]] - average_adc[0]));
+						fill_count(offset_width_1D_02, offset_ampl, n);
 					}
-
-					if (chip_adc[i4][i2][i13] == 1 || chip_adc[i4][i2][i13] == 3 || chip_adc[i4][i2][i13] == 5 || chip_adc[i4][i2][i13] == 7)
+					else
 					{
-						offset_width_1D_13->Fill(chip_ampl[i4][i2][i13] - (average_adc[chip_adc[i4][i2][i13]] - average_adc[0]));
+						fill_count(offset_width_1D_13, offset_ampl, n);
 					}
-
 				}
-
-
 			}
 
 			c1->cd();
 			ampladc_detail->Draw("COLZ0");
-			ampladc_detail->Fit("slope", "NQ");
+			fits.slope.set(slope);
 			c1->cd();
 			slope->Draw("lsame");
 			slope_TH2->Fill(i2, slope->GetParameter(0));
@@ -1884,14 +1987,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c6->cd();
 			check_new->Draw("hist");
-			if (check_new->GetEntries() ==0)
-			{
-				gaus_fit_new->SetParameter(2,0);
-			}
-			else 
-			{
-				check_new->Fit("gaus_fit_new", "NQ");	
-			}
+			fits.gaus_offset[0].set(gaus_fit_new);
 			
 			
 			c6->cd();
@@ -1908,14 +2004,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c13->cd();
 			offset_width_1D_02->Draw("hist");
-			if (offset_width_1D_02->GetEntries() ==0)
-			{
-				gaus_fit_new_02->SetParameter(2,0);
-			}
-			else 
-			{
-				offset_width_1D_02->Fit("gaus_fit_new_02", "NQ");	
-			}
+			fits.gaus_offset[1].set(gaus_fit_new_02);
 			c13->cd();
 			gaus_fit_new_02->Draw("lsame");
 			c13->cd();
@@ -1930,14 +2019,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			c14->cd();
 			offset_width_1D_13->Draw("hist");
-			if (offset_width_1D_13->GetEntries() ==0)
-			{
-				gaus_fit_new_13->SetParameter(2,0);
-			}
-			else 
-			{
-				offset_width_1D_13->Fit("gaus_fit_new_13", "NQ");	
-			}
+			fits.gaus_offset[2].set(gaus_fit_new_13);
 			c14->cd();
 			gaus_fit_new_13->Draw("lsame");
 			c14->cd();
@@ -1949,22 +2031,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 
 
-			if (chan_ampl_1D->GetEntries() ==0)
-			{
-				ef_fit->SetParameter(0,10); //turn on
-				ef_fit->SetParameter(1,0); //slope
-				ef_fit->SetParameter(2,1);//height
-			}
-			else 
-			{
-				ef_fit->SetParameters(30,2, 10); 
-				ef_fit->SetParLimits(2,9.9,10.5);
-				ef_fit->SetParLimits(1,0.2,10.5);
-				// [0] turn_on
-				// [1] slope
-				// [2] height 
-				chan_ampl_1D->Fit("ef_fit", "NQ");	
-			}
+			fits.ef.set(ef_fit);
 
 			c12->cd();		
 			adc_stack->Add(channel_ADC_0);
@@ -1991,21 +2058,16 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 			TP_turnon_1D->Fill(ef_fit->GetParameter(0));
 
-			chip_TP = i4+1;
-			chan_TP = i2;
-			TP_turnon = ef_fit->GetParameter(0); 
-			TP_width = ef_fit->GetParameter(1);
-			TP_height = ef_fit->GetParameter(2);
-			tree_output9->Fill();
+			record.TP_turnon = ef_fit->GetParameter(0);
+			record.TP_width = ef_fit->GetParameter(1);
+			record.TP_height = ef_fit->GetParameter(2);
 
 			response_width[i4].push_back(gaus_fit_new->GetParameter(2));
 			response_width02[i4].push_back(gaus_fit_new_02->GetParameter(2));
 			response_width13[i4].push_back(gaus_fit_new_13->GetParameter(2));
 			channel_entries_check->Fill(check_new->GetEntries());
 
-			Centries_chip.push_back(i4 + 1);
-			Centries_channel.push_back(i2);
-			Centries_entries.push_back(check_new->GetEntries());
+			record.chan_entry = check_new->GetEntries();
 
 			if (check_new->GetEntries() < entry_cut_l || check_new->GetEntries() > entry_cut_h)
 			{
@@ -2014,6 +2076,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 				entries_channel.push_back(i2);
 				entries_entries.push_back(check_new->GetEntries());
 				channel_entries_outsider += 1;
+				record.is_entries_out = true;
 			}
 
 			if (new_check == true)
@@ -2252,32 +2315,21 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 			//cout<<"TESTTEST : "<<response_width[i9].size()<<endl;
 			if (true == true)
 			{
-				chip_W = i9 + 1;
-				chan_W = i10;
-				level_W = response_width[i9][i10];
-				level_W02 = response_width02[i9][i10];
-				level_W13 = response_width13[i9][i10];
-				tree_output4->Fill();
-
-
+				CalibrationRecord &record = records[i9 * 128 + i10];
+				record.Gaus_width = response_width[i9][i10];
+				record.Gaus_width02 = response_width02[i9][i10];
+				record.Gaus_width13 = response_width13[i9][i10];
 
-				chip_ER = i9 + 1;
-				chan_ER = i10;
-				level_ADC0 = response_width0[i9][i10];
-				level_ADC1 = response_width1[i9][i10];
-				level_ADC2 = response_width2[i9][i10];
-				level_ADC3 = response_width3[i9][i10];
-				level_pvalue = response_pvalue[i9][i10];
-				tree_output12->Fill();
+				record.err_width0 = response_width0[i9][i10];
+				record.err_width1 = response_width1[i9][i10];
+				record.err_width2 = response_width2[i9][i10];
+				record.err_width3 = response_width3[i9][i10];
+				record.err_pvalue = response_pvalue[i9][i10];
 
-
-				chip_ERM = i9 + 1;
-				chan_ERM = i10;
-				mean_ADC0 = response_mean0[i9][i10];
-				mean_ADC1 = response_mean1[i9][i10];
-				mean_ADC2 = response_mean2[i9][i10];
-				mean_ADC3 = response_mean3[i9][i10];
-				tree_output13->Fill();
+				record.err_mean0 = response_mean0[i9][i10];
+				record.err_mean1 = response_mean1[i9][i10];
+				record.err_mean2 = response_mean2[i9][i10];
+				record.err_mean3 = response_mean3[i9][i10];
 
 
 				
@@ -2286,12 +2338,14 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 					unbound_chip.push_back(i9 + 1);
 					unbound_channel.push_back(i10);
 					unbound_width.push_back(response_width[i9][i10]);
+					record.is_unbonded = true;
 				}
 				else /* (response_width[i9][i10] > Gaus_width_cut)*/
 				{
 					noise_chip.push_back(i9 + 1);
 					noise_channel.push_back(i10);
 					noise_width.push_back(response_width[i9][i10]);
+					record.is_noise = true;
 				}
 			}
 		}
@@ -2371,41 +2425,6 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 	//fp.close();//Ãö³¬ÀÉ®×
 
-	for (int i11 = 0; i11 < noise_channel.size(); i11++)
-	{
-		//source_name=Form("%s",the_name.Data());
-		chip_N = noise_chip[i11];
-		chan_N = noise_channel[i11];
-		level_N = noise_width[i11];
-		tree_output1->Fill();
-	}
-	for (int i11 = 0; i11 < entries_entries.size(); i11++)
-	{
-		//source_name=Form("%s",the_name.Data());
-		chip_E = entries_chip[i11];
-		chan_E = entries_channel[i11];
-		level_E = entries_entries[i11];
-		tree_output2->Fill();
-	}
-
-	for (int i11 = 0; i11 < unbound_chip.size(); i11++)
-	{
-		//source_name=Form("%s",the_name.Data());
-		chip_U = unbound_chip[i11];
-		chan_U = unbound_channel[i11];
-		level_U = unbound_width[i11];
-		tree_output3->Fill();
-	}
-
-	for (int i11 = 0; i11 < Centries_chip.size(); i11++)
-	{
-		//source_name=Form("%s",the_name.Data());
-		chip_CE = Centries_chip[i11];
-		chan_CE = Centries_channel[i11];
-		level_CE = Centries_entries[i11];
-		tree_output6->Fill();
-	}
-
 	if (unbound_check == true)
 	{
 		cout << "======unbound_check======" << endl;
@@ -2438,11 +2457,7 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 		for(int i112=0; i112<128; i112++)
 		{
 			threshold_cut_hist->Fill(threshold_cut_array[i111][i112]);
-			chip_CE_ampl = i111+1;
-			chan_CE_ampl = i112;
-			level_CE_ampl = threshold_cut_array[i111][i112];
-			tree_output8->Fill();
-
+			records[i111 * 128 + i112].ampl_chan_entry = threshold_cut_array[i111][i112];
 		}	
 	}
 
@@ -2473,13 +2488,13 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 
 	//##################################################################
 
-	entries_mean = channel_entries_check->GetMean();
-	entries_width = channel_entries_check->GetStdDev();
-	tree_output5->Fill();
-
-	entries_mean_ampl = threshold_cut_hist->GetMean();
-	entries_width_ampl = threshold_cut_hist->GetStdDev();
-	tree_output7->Fill();
+	for (int i = 0; i < records.size(); i++)
+	{
+		records[i].entries_mean = channel_entries_check->GetMean();
+		records[i].entries_width = channel_entries_check->GetStdDev();
+		records[i].ampl_entries_mean = threshold_cut_hist->GetMean();
+		records[i].ampl_entries_width = threshold_cut_hist->GetStdDev();
+	}
 
 	//##################################################################
 
@@ -2517,19 +2532,11 @@ void calibration_ana_code_multi_copy(TString folder_name, int module_number, boo
 		// }
 	}
 
-	tree_output1->Write("", TObject::kOverwrite);
-	tree_output2->Write("", TObject::kOverwrite);
-	tree_output3->Write("", TObject::kOverwrite);
-	tree_output4->Write("", TObject::kOverwrite);
-	tree_output5->Write("", TObject::kOverwrite);
-	tree_output6->Write("", TObject::kOverwrite);
-	tree_output7->Write("", TObject::kOverwrite);
-	tree_output8->Write("", TObject::kOverwrite);
-	tree_output9->Write("", TObject::kOverwrite);
-	tree_output10->Write("", TObject::kOverwrite);
-	tree_output11->Write("", TObject::kOverwrite);
-	tree_output12->Write("", TObject::kOverwrite);
-	tree_output13->Write("", TObject::kOverwrite);
+	for (int i = 0; i < records.size(); i++)
+		record_tree.Add(records[i]);
+
+	record_tree.Fill(tree_output);
+	tree_output->Write("", TObject::kOverwrite);
 	// delete tree_output1;
 	// delete tree_output2;
 
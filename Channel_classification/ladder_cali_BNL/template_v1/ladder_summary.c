@@ -1,3 +1,5 @@
+#include "../../../general_codes/functions/CalibrationRecord.hh"
+
 void ladder_summary (TString folder_name)
 {
 	//=================cut variable=================
@@ -178,33 +180,9 @@ void ladder_summary (TString folder_name)
 
 	TFile *f1;// = TFile::Open(Form("cut_finder_folder/sum_up_all.root"));
 
-	TTree *chan_gaus_width;// = (TTree *)f1->Get("chan_gaus_width"); //value_W
-	TTree *chan_entry;// = (TTree *)f1->Get("chan_entry"); //value_E
-	TTree *ampl_channel_entries;// = (TTree *)f1->Get("ampl_channel_entries"); //value_EA
-	TTree *chan_thre_position;// = (TTree *)f1->Get("chan_thre_position"); //value_TP
-	TTree *chan_adc_study;// = (TTree *)f1->Get("chan_adc_study"); //value_adc_0
-	TTree *chan_study ;// = (TTree *)f1->Get("chan_study"); //value_slope_chi, value_width_chi
-
-
-	int chip_W, chan_W;
-	double value_W, value_W02, value_W13;
-
-	int chip_E, chan_E;
-	int value_E;
-
-	int chip_EA, chan_EA;
-	int value_EA;
-
-	int chip_TP, chan_TP;
-	double value_TP;
-
-	int chip_adc, chan_adc;
-	double value_adc_0;
-	double value_adc_0N;
-
-	int chip_chi, chan_chi;
-	double value_slope_chi, value_width_chi;
-	double value_slope_value, value_width_value;
+	TTree *calibration_record;// = (TTree *)f1->Get("calibration_record");
+	CalibrationRecordTree records;
+	const CalibrationRecord &record = records.record_;
 
 	int bad_chan_0=0;
 	int bad_chan_1=0;
@@ -261,58 +239,12 @@ void ladder_summary (TString folder_name)
 			//cout<<"test : "<<file_ID<<endl;
 			f1 = TFile::Open(Form("%s/folder_%s/%s_summary.root",folder_name.Data(),list_array[file_ID].Data(),list_array[file_ID].Data()));
 
-			chan_gaus_width = (TTree *)f1->Get("chan_gaus_width"); //value_W
-			chan_entry = (TTree *)f1->Get("chan_entry"); //value_E
-			ampl_channel_entries = (TTree *)f1->Get("ampl_channel_entries"); //value_EA
-			chan_thre_position = (TTree *)f1->Get("chan_thre_position"); //value_TP
-			chan_adc_study = (TTree *)f1->Get("chan_adc_study"); //value_adc_0
-			chan_study = (TTree *)f1->Get("chan_study"); //value_slope_chi, value_width_chi
-
-			chan_gaus_width->SetBranchAddress("chip_id", &chip_W);
-			chan_gaus_width->SetBranchAddress("chan_id", &chan_W);
-			chan_gaus_width->SetBranchAddress("Gaus_width", &value_W);
-			chan_gaus_width->SetBranchAddress("Gaus_width02", &value_W02);
-			chan_gaus_width->SetBranchAddress("Gaus_width13", &value_W13);
-
-
-			chan_entry->SetBranchAddress("chip_id",&chip_E);
-			chan_entry->SetBranchAddress("chan_id",&chan_E);
-			chan_entry->SetBranchAddress("chan_entry",&value_E);
-
-			ampl_channel_entries->SetBranchAddress("chip_id",&chip_EA);
-			ampl_channel_entries->SetBranchAddress("chan_id",&chan_EA);
-			ampl_channel_entries->SetBranchAddress("chan_entry",&value_EA);
-
-			chan_thre_position->SetBranchAddress("chip_id",&chip_TP);
-			chan_thre_position->SetBranchAddress("chan_id",&chan_TP);
-			chan_thre_position->SetBranchAddress("TP_turnon",&value_TP);
-
-			chan_adc_study->SetBranchAddress("chip_id",&chip_adc);
-			chan_adc_study->SetBranchAddress("chan_id",&chan_adc);
-			chan_adc_study->SetBranchAddress("adc0",&value_adc_0);
-			chan_adc_study->SetBranchAddress("adc0N",&value_adc_0N);
-
-
-			chan_study->SetBranchAddress("chip_id",&chip_chi);
-			chan_study->SetBranchAddress("chan_id",&chan_chi);
-			chan_study->SetBranchAddress("slope_value",&value_slope_value);
-			chan_study->SetBranchAddress("slope_rchi2",&value_slope_chi);
-			chan_study->SetBranchAddress("width_value",&value_width_value);
-			chan_study->SetBranchAddress("width_rchi2",&value_width_chi);
-
-			int total_size_W = chan_gaus_width->GetEntriesFast();
-			int total_size_E = chan_entry->GetEntriesFast();
-			int total_size_EA = ampl_channel_entries->GetEntriesFast();
-			int total_size_TP = chan_thre_position->GetEntriesFast();
-			int total_size_adc = chan_adc_study->GetEntriesFast();
-			int total_size_chi = chan_study->GetEntriesFast();
-
-			cout<<"width :              "<<total_size_W<<endl;
-			cout<<"entry :              "<<total_size_E<<endl;
-			cout<<"ampl entry :         "<<total_size_EA<<endl;
-			cout<<"threshold position : "<<total_size_TP<<endl;
-			cout<<"adc :                "<<total_size_adc<<endl;
-			cout<<"rchi2 :              "<<total_size_chi<<endl;
+			// only the columns for the cuts are read
+			calibration_record = (TTree *)f1->Get(CalibrationRecordTree::kTreeName);
+			records.SetBranchAddresses(calibration_record, "Gaus_width02,chan_entry,ampl_chan_entry,TP_turnon,adc0N,slope_value,slope_rchi2,width_rchi2");
+
+			int total_size = calibration_record->GetEntries();
+			cout<<"channels :           "<<total_size<<endl;
 			cout<<" "<<endl;
 
 			// if (i1==0)
@@ -336,55 +268,52 @@ void ladder_summary (TString folder_name)
 
 			if (1==1) 
 			{				
-				for (int i2=0; i2<total_size_chi; i2++)
+				for (int i2=0; i2<total_size; i2++)
 				{
-					chan_gaus_width->GetEntry(i2);
-					chan_entry->GetEntry(i2);
-					ampl_channel_entries->GetEntry(i2);
-					chan_thre_position->GetEntry(i2);
-					chan_adc_study->GetEntry(i2);
-					chan_study->GetEntry(i2);
+					records.GetEntry(calibration_record, i2);
+					int chip_W = record.chip_id;
+					int chan_W = record.chan_id;
 
 					// if (value_W<width_noise_cut_low || value_W>width_noise_cut_high)//1
 					// {
 					// 	all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x01;
 					// }
-					if (value_E<entry_cut_low || value_E>entry_cut_high )
+					if (record.chan_entry<entry_cut_low || record.chan_entry>entry_cut_high )
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x02;
 					}
 
-					if (value_EA<ampl_entry_cut_low || value_EA>ampl_entry_cut_high )
+					if (record.ampl_chan_entry<ampl_entry_cut_low || record.ampl_chan_entry>ampl_entry_cut_high )
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x04;
 					}
 
-					if (value_adc_0N<adc0_cut_lowN || value_adc_0N>adc0_cut_highN )
+					if (record.adc0N<adc0_cut_lowN || record.adc0N>adc0_cut_highN )
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x08;
 					}
 
-					if (TMath::Prob(value_slope_chi, 2)<slope_pvalue_cut)
+					if (TMath::Prob(record.slope_rchi2, 2)<slope_pvalue_cut)
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x020;
 					}
 
-					if (TMath::Prob(value_width_chi, 3)<width_pvalue_cut)
+					if (TMath::Prob(record.width_rchi2, 3)<width_pvalue_cut)
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x40;
 					}
 					
-					if (value_TP < TP_cut_low|| value_TP > TP_cut_high)
+					if (record.TP_turnon < TP_cut_low|| record.TP_turnon > TP_cut_high)
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x80;	
 					}
 
-					if ( (value_slope_value-(slope_correction*chip_chi)) < slope_cut_low|| (value_slope_value-(slope_correction*chip_chi)) > slope_cut_high)
+					if ( (record.slope_value-(slope_correction*record.chip_id)) < slope_cut_low|| (record.slope_value-(slope_correction*record.chip_id)) > slope_cut_high)
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x100;	
 					}
 
-					if (value_W02<width_noise_cut_low02 || value_W02>width_noise_cut_high02	)
+					if (record.Gaus_width02<width_noise_cut_low02 || record.Gaus_width02>width_noise_cut_high02	)
 					{
 						all_in_one[i][chip_W-1][chan_W]=all_in_one[i][chip_W-1][chan_W]^0x200;
 					}
@@ -0,0 +1,42 @@
+/*!
+  @file build_events.cc
+  @brief Hits in the ROOT files made by MakeTree from several FELIX servers (FEMs) are merged into events by bco_full.
+  @details See functions/BcoEventBuilder.hh for the details. The output has "event_tree" with one entry per event, and "event_builder_stats".
+*/
+
+#include "functions/BcoEventBuilder.hh"
+
+/*!
+  @fn int build_events
+  @param fnames Names of the ROOT files separated by ",", for example, "data/felix1.root,data/felix2.root"
+  @param output A name of the output file. If it's "", "<first file>_events.root" is used.
+  @param window Fragments within this number of BCOs from the first one are merged into an event
+*/
+int build_events
+(
+ string fnames = "data/felix1.root,data/felix2.root",
+ string output = "",
+ int window = 0
+ )
+{
+  // "a.root,b.root" -> "a.root b.root"
+  replace( fnames.begin(), fnames.end(), ',', ' ' );
+  istringstream iss( fnames );
+
+  BcoEventBuilder builder;
+  builder.SetWindow( window );
+
+  string fname;
+  while( iss >> fname ){
+    if( builder.AddFile( fname ) == false )
+      return -1;
+
+    if( output == "" )
+      output = fname.substr( 0, fname.find_last_of( "." ) ) + "_events.root";
+  }
+
+  builder.Build( output );
+  builder.Print();
+  cout << "output: " << output << endl;
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include "functions/DrawPlots.hh"
 #include "functions/FindLatestFile.hh"
 #include "functions/INTTHit.hh"
+#include "functions/INTTClusterer.hh"
 
 #include "functions/DrawHitMap.c"
 
@@ -760,34 +761,37 @@ void MakeCluster(
 
   int dac[8] = {10, 23, 48, 98, 148, 172, 223, 248};
 
+  // Hits are sorted and clustered in one sweep instead of INTTHit::Clustering for every pair (see functions/INTTClusterer.hh).
+  // It's static to reuse the memory for the following events.
+  static INTTClusterer clusterer;
+  clusterer.Clear();
+
   bool there_is_noise = false;
   const int kHit_num = adcs.size();
-  INTTHit* hits[kHit_num];		//vector < INTTHit* > hits;
   for( int i=0; i<kHit_num; i++ )
     {
-      hits[i] = new INTTHit(adcs[i], ampls[i], chip_ids[i], fpga_ids[i],
-			    modules[i], chan_ids[i], fem_ids[i], bcos[i],
-			    bco_fulls[i], events[i], dac);
+      clusterer.Add( adcs[i], ampls[i], chip_ids[i], fpga_ids[i],
+		     modules[i], chan_ids[i], fem_ids[i], bcos[i],
+		     bco_fulls[i], events[i], INTTHit::GetADCVoltage( adcs[i], dac ) );
 
       // Note: condition for the moment:
       //   fem_id == 8, fpga_id == 0, module == 6, ampl == 0, 
       if( ampls[i] != 0 || fpga_ids[i] != 0 || modules[i] != module || fem_ids[i] != 8 )
 	{
-	  hits[i]->SetIgnored( true );
+	  clusterer.SetIgnored( i );
 	  //cout << "it's noise!" << endl;
-	  //hits[i]->Print();
 	  there_is_noise = true;
 	}
 
       if( there_is_noise )
 	if( 1 < kHit_num )
-	  hits[i]->PrintInOneLine();
+	  INTTHit( adcs[i], ampls[i], chip_ids[i], fpga_ids[i],
+		   modules[i], chan_ids[i], fem_ids[i], bcos[i],
+		   bco_fulls[i], events[i], dac ).PrintInOneLine();
 
     }
 
-  for( int i=0; i<kHit_num; i++ )
-    for( int j=i+1; j<kHit_num; j++ )
-      hits[i]->Clustering( hits[j] );
+  int cluster_num = clusterer.Run();
 
   
 #if defined( __linux__ ) || defined( __APPLE__)
@@ -805,35 +809,40 @@ void MakeCluster(
   events.erase	( events.begin()	, events.end()     );
   nhits_in_cluster.erase(nhits_in_cluster.begin(), nhits_in_cluster.end() );
 
-  for( int i=0; i<kHit_num; i++ )
+  // a cluster is represented by its first hit, the values of the hit are added to vectors
+  for( int i=0; i<cluster_num; i++ )
     {
-      // if this INTTHit isn't included to another INTTHit to form a cluster, add data to vectors
-      if (hits[i]->GetClusteringStatus() > -1 )
-	{
+      const INTTClusterHit& hit = clusterer.GetHit( clusterer.GetHead( i ) );
 
-	  if( there_is_noise )
-	    if( 1 < kHit_num )
-	      hits[i]->Print();
-	  
-	bcos.			push_back( hits[i]->bco_ );
-	adcs.			push_back( hits[i]->adc_ );
-	adc_voltages.		push_back( hits[i]->GetClusterADCVoltage() );
-	ampls.			push_back( hits[i]->ampl_ );
-	chip_ids.		push_back( hits[i]->chip_id_ );
-	fpga_ids.		push_back( hits[i]->fpga_id_ );
-	modules.		push_back( hits[i]->module_ );
-	fem_ids.		push_back( hits[i]->fem_id_ );
-	chan_ids.		push_back( hits[i]->chan_id_ );
-	bco_fulls.		push_back( hits[i]->bco_full_ );
-	events.			push_back( hits[i]->event_ );
-	nhits_in_cluster.	push_back( hits[i]->cluster_channels_.size() );
-
-	if( hits[i]->fem_id_ != 8 )
+      if( there_is_noise )
+	if( 1 < kHit_num )
 	  {
-	    //cout << "@@@@@@@@@@@@@@@@@@@@@@@@" << endl;
-	    //hits[i]->Print();
+	    // an INTTHit is made only to show the cluster in the same way as before
+	    INTTHit cluster( hit.adc, hit.ampl, hit.chip_id, hit.fpga_id, hit.module, hit.chan_id,
+			     hit.fem_id, hit.bco, hit.bco_full, hit.event, dac );
+	    for( int j=1; j<clusterer.GetSize( i ); j++ )
+	      {
+		const INTTClusterHit& member = clusterer.GetHit( clusterer.GetMember( i, j ) );
+		cluster.cluster_geometry_.push_back( pair < int, int >( member.chip_id, member.chan_id ) );
+		cluster.cluster_channels_.push_back( member.chan_id );
+		cluster.cluster_adc_voltages_.push_back( member.adc_voltage );
+		cluster.SetClusteringStatus( 1 );
+	      }
+	    cluster.Print();
 	  }
-	}
+	  
+      bcos.			push_back( hit.bco );
+      adcs.			push_back( hit.adc );
+      adc_voltages.		push_back( clusterer.GetADCVoltage( i ) );
+      ampls.			push_back( hit.ampl );
+      chip_ids.			push_back( hit.chip_id );
+      fpga_ids.			push_back( hit.fpga_id );
+      modules.			push_back( hit.module );
+      fem_ids.			push_back( hit.fem_id );
+      chan_ids.			push_back( hit.chan_id );
+      bco_fulls.		push_back( hit.bco_full );
+      events.			push_back( hit.event );
+      nhits_in_cluster.		push_back( clusterer.GetSize( i ) );
     }
 
   //  if( there_is_noise )
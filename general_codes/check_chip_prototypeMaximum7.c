@@ -9,13 +9,14 @@
 #include <algorithm>
 #include <iomanip>
 #include "functions/getFileSize.hh"
+#include "functions/FelixDecoder.hh"
 #include "functions/DrawPlots.hh"
 #include "functions/DrawHitMap.c"
 
 // Data in a .dat file is decode and filled to a TTree. A path to the ROOT file is returned. If error occured, "" is returned.
 // string MakeTree(string fname, int usemod = 3, int maxbuf = 0, int n_meas = 64, float maxscale = 200., bool decoded_output = false);
 //string MakeTree(string fname, int usemod = 3, int maxbuf = 0, bool decoded_output = false);
-string MakeTree(string fname, int usemod = 3, string mode = "calib", string cut = "", bool decoded_output = false);
+string MakeTree(string fname, int usemod = 3, string mode = "calib", string cut = "", bool decoded_output = false, int nthreads = 1, int verbosity = DecodeStats::kSummary, string format = "", string mask = "");
 		   
 void ShowMessage();
 
@@ -45,6 +46,9 @@ vector < int > GetModules( string usemod )
   @param fname A name of dat file OR a path to the directory. 
   @param usemod The module ID
   @param mode Mode of data taking, "calib", "external", "camac", "camac_clustering" are acceped
+  @param nthreads The number of threads to decode the data. 1 means the serial decoding.
+  @param verbosity 0: quiet, 1: summary of the decoding (default), 2: a line for each record, 3: a line for each hit (see DecodeStats)
+  @param mask Bad channels not to be filled, "module=bad_channel_summary.root[:ladder_id]" separated by "," (see ChannelMask)
   @details The feature of this version is
   - The latest file in a directory can be selected automatically.
   If the given string end with ".dat", it's treated as a .dat file and processed.
@@ -61,7 +65,10 @@ int check_chip_prototypeMaximum7
  string fname = "C:\root_5.34.36\macros", // a path to the data file
  string usemod = "3", // ID of the module
  string mode = "calib",
- string cut = ""
+ string cut = "",
+ int nthreads = 1, // number of threads to decode the data
+ int verbosity = DecodeStats::kSummary, // console outputs of the decoding
+ string mask = "" // bad channels, for example "5=ladder_files/B1L101/bad_channel_summary.root:0"
  //	int maxbuf = 0,
  //int n_meas = 64,
  //	float maxscale = 200.
@@ -86,7 +93,7 @@ int check_chip_prototypeMaximum7
   string file_suffix = file_name.substr( file_name.find_last_of( "." ) + 1 , file_name.size() - file_name.find_last_of( "." ) );
 
   //const string root_file = MakeTree(fname, usemod, maxbuf, n_meas, maxscale, decoded_out);
-  string root_file = MakeTree(fname, 0, mode, cut, decoded_out);
+  string root_file = MakeTree(fname, 0, mode, cut, decoded_out, nthreads, verbosity, "", mask);
 
   vector < int > modules = GetModules( usemod );  
   // If there was no error in MakeTree, draw some plots!
@@ -107,11 +114,18 @@ int check_chip_prototypeMaximum7
   //	@param int maxbuf
   //      @param int n_meas
   @param float maxscale
+  @param nthreads If it's more than 1, records are decoded by the threads in parallel (see DecodeFelixInParallel)
+  @param verbosity Console outputs of the decoding, see DecodeStats::Verbosity. The statistics are saved as the TTree "decode_stats" in any case.
+  @param format "" for the usual tree, "compact[:algorithm[:level[:basket_size[:auto_flush]]]]" for tree_compact with narrow types (see CompactHitTree).
+  DrawPlots needs the usual tree, so the compact format is for the storage.
+  @param mask Hits in the channels masked by ChannelMask::Load( mask ) are not filled. Nothing is masked if it's "".
+  @details The event index "<name>.idx" is written next to the ROOT file to jump to events (see EventIndex).
+  The numbers of hits for each module, chip, channel, amplitude, and ADC are saved as the TTree "count_cube" (see HitCountCube).
   @retval A path to the ROOT file or "" in the case of an error
-  @details Some unused parameters and etc. are remained for the moment.
+  Some unused parameters and etc. are remained for the moment.
 */
 //string MakeTree(string fname, int usemod, int maxbuf, int n_meas, float maxscale, bool decoded_output)
-string MakeTree(string fname, int usemod, string mode, string cut, bool decoded_output)
+string MakeTree(string fname, int usemod, string mode, string cut, bool decoded_output, int nthreads, int verbosity, string format, string mask)
 {
 
   int maxbuf = 0; // no need to take argument, I think
@@ -132,87 +146,51 @@ string MakeTree(string fname, int usemod, string mode, string cut, bool decoded_
 
   // save TTree into a root file
   const char* filename = output.c_str();
-  return filename;
   TFile *file = new TFile(filename, "RECREATE");
 
   //--------------------------------------------------------------------------------------------------
-  // made TTree to be filled with data
-  UInt_t command;
-  int bco, adc, ampl, col_raw, col, chip_id, fpga_id, module, mchip;
-  int chan_id;
-  int nhit_event, nchip_event, fem_id;
-  int chiphit[8];
-  int bco_full, old_bco_full, old_bco;
-  int ievent = 0, event;
-  
-  vector < int >  adcs, ampls, chip_ids, fpga_ids, modules, chan_ids, fem_ids, bcos,  bco_fulls, events, nhits_in_cluster;
-  vector < float > adc_voltages;
-  bool is_INTT = true, is_single_bco_event = false;
-  
-  vector < int > camac_adcs, camac_tdcs;
-
-  // made branches for each column
-  TTree *tree = new TTree("tree", "chip info");
-  tree->Branch("adc", &adc, "adc/I");
-  tree->Branch("ampl", &ampl, "ampl/I");
-  tree->Branch("chip_id", &chip_id, "chip_id/I");
-  tree->Branch("fpga_id", &fpga_id, "fpga_id/I");
-  tree->Branch("module", &module, "module/I");
-  tree->Branch("chan_id", &chan_id, "chan_id/I");
-  tree->Branch("fem_id", &fem_id, "fem_id/I");
-  tree->Branch("bco", &bco, "bco/I");
-  tree->Branch("bco_full", &bco_full, "bco_full/I");
-  tree->Branch("event", &ievent, "event/I");
-  tree->Branch("command", &command, "command/i" );
-  
-  //--------------------------------------------------------------------------------------------------
-  TTree* tree_camac = new TTree( "tree_camac", "CAMAC data" );
-  tree_camac->Branch("camac_adc", &camac_adcs);
-  tree_camac->Branch("camac_tdc", &camac_tdcs);
-  tree_camac->Branch("INTT_event", &is_INTT, "is_INTT/O");
-	
-
-  //--------------------------------------------------------------------------------------------------
-  TTree* tree_both = new TTree( "tree_both", "CAMAC-wise TTree for CAMAC events and INTT events" );
-  tree_both->Branch("camac_adc", &camac_adcs);
-  tree_both->Branch("camac_tdc", &camac_tdcs);
-  tree_both->Branch("INTT_event", &is_INTT, "is_INTT/O");
-
-  if( mode == "camac" || mode == "camac_clustering" ){
-
-    if( mode == "camac_clustering" )
-      {
-	tree_both->Branch("nhit_in_cluster", &nhits_in_cluster );
-      }
-
-    tree_both->Branch("adc", &adcs );
-    tree_both->Branch("adc_vol", &adc_voltages);
-    tree_both->Branch("ampl", &ampls );
-    tree_both->Branch("chip_id", &chip_ids );
-    tree_both->Branch("fpga_id", &fpga_ids );
-    tree_both->Branch("module", &modules );
-    tree_both->Branch("chan_id", &chan_ids );
-    tree_both->Branch("fem_id", &fem_ids );
-    tree_both->Branch("bco", &bcos );
-    tree_both->Branch("bco_full", &bco_fulls );
-    tree_both->Branch("single_bco_event", &is_single_bco_event, "single_bco_event/O" );
-    tree_both->Branch("event", &events );
+  // Records in the data file are read one by one, the whole file isn't loaded to the memory.
+  // In the modes with CAMAC data, CAMAC words follow each record.
+  // only for some data (taken at the beginning of the implementation), the number of ADC and TDC words is given at once
+  bool is_old_camac_format = ( fname.find( "nwu_fphx_raw_20201113-0137_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201113-1355_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201116-1112_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201116-1208_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201117-1801_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201117-1908_0.dat" ) != string::npos || 
+			       fname.find( "nwu_fphx_raw_20201118-1435_0.dat" ) != string::npos );
+
+  // hot and dead channels found by the channel classification are dropped here
+  ChannelMask channel_mask;
+  if( mask != "" ){
+    if( channel_mask.Load( mask ) < 0 )
+      return "";
+
+    channel_mask.Print();
   }
-  
-	
-  //--------------------------------------------------------------------------------------------------
 
-  // open the data file
-  std::ifstream f(fname.c_str(), std::ifstream::binary);
+  // the event number, FEM event counter, and bco_full to the record offset and the TTree entry
+  EventIndex event_index;
+
+  // counts of hits for each module, chip, channel, amplitude, and ADC for QA plots without reading the hits (see HitCountCube)
+  HitCountCube count_cube;
+
+  // made TTrees (tree, tree_camac, and tree_both) to be filled with data
+  FelixDecoder decoder( mode, is_old_camac_format );
+  decoder.verbosity_ = verbosity;
+  if( decoder.SetUp( file, format, mask != "" ? &channel_mask : nullptr, &event_index, &count_cube ) == false )
+    return "";
+
+  RawRecordReader reader;
+  if( mode == "camac" || mode == "camac_clustering" )
+    reader.SetTrailerType( is_old_camac_format ? RawRecordReader::kCamacTrailerOld : RawRecordReader::kCamacTrailer );
 
   // quit this function if the data file cannot be opened
-  if (!f.is_open()) {
-    std::cerr << "Failed to open input file " << fname << std::endl;
+  if( reader.Open( fname ) == false )
     return "";
-  }
 
   // get size of file
-  int size = getFileSize(f);
+  Long64_t size = reader.GetFileSize();
   std::cout << "Input file " << fname << std::endl;
   std::cout << "Number of bytes in file = " << size << std::endl;
 
@@ -221,458 +199,41 @@ string MakeTree(string fname, int usemod, string mode, string cut, bool decoded_
     return "";
   }
 
-  // Brute force approach: allocate a single array to hold the entire
-  // contents of the file
-  UInt_t* data = new UInt_t[size / sizeof(UInt_t)];
-
-  // read the data file and put all data into the array UInt_t* data
-  f.read((char*)data, size);
-
-  // if reading data failed, quit
-  if (f.fail()) {
-    std::cerr << "eof, fail, or bad condition during read" << std::endl;
-    delete[] data;
-    return "";
+  //--------------------------------------------------------------------------------------------------
+  // loop over all data
+  if( nthreads > 1 ){
+    // two-phase mode: record headers are scanned first, then ranges of records are decoded in parallel
+    if( DecodeFelixInParallel( fname, decoder, nthreads ) == false )
+      return "";
   }
+  else{
+    for (int bufcnt = 0; reader.Next(); bufcnt++) {
+      if (maxbuf && bufcnt >= maxbuf)
+	break;
 
-  // close the data file since it's no longer needed
-  f.close();
+      decoder.Decode( reader.GetRecord(), bufcnt, true, reader.GetRecordOffset() );
+    }
 
-  // Counter to count the number of hits for each channel and amplitude, not used, why?
-  int nhits[128][128] = { { 0 } };
+    if( reader.IsPartial() ){
+      decoder.stats_.partial_buffers_++;
+      std::cout << "Partial buffer detected at byte " << reader.GetOffset() << ", bailing" << std::endl;
+    }
+  }
 
-  // Extract bco, channel, amplitude, and adc from each hit, and count the number of
-  // hits at each amplitude for each channel:
+  if( verbosity >= DecodeStats::kSummary )
+    decoder.stats_.Print();
 
-  //  int ievent           = 0;
-  int bufcnt = 0;
-  int event_fem = -999, old_event_fem = -999;
-  int inoise = 0, ihealthy = 0;
+  cout << "inoise   = " << decoder.inoise_ << endl;
+  cout << "ihealthy = " << decoder.ihealthy_ << endl;
 
-  int clock_data_num = 0;
+  cout << "Tree entries: " << decoder.tree_->GetEntries() << endl;
 
-  int counter = 0;
-  //--------------------------------------------------------------------------------------------------
-  // loop over all data
-  for (int index = 0; index < size / sizeof(int); bufcnt++) { // note: value of index is changed not only here
-
-    // init variables for branches
-    command = 0;
-    adc = ampl = chip_id = fpga_id = module = chan_id = bco = bco_full = event = -1;
-    is_INTT = true;
-    is_single_bco_event = false;
-
-    // erase elements in vectors
-    camac_adcs.erase	( camac_adcs.begin()		, camac_adcs.end()		);
-    camac_tdcs.erase	( camac_tdcs.begin()		, camac_tdcs.end()		);
-    bcos.erase		( bcos.begin()			, bcos.end()			);
-    adcs.erase		( adcs.begin()			, adcs.end()			);
-    adc_voltages.erase  ( adc_voltages.begin()		, adc_voltages.end()		);
-    ampls.erase		( ampls.begin()			, ampls.end()			);
-    chip_ids.erase	( chip_ids.begin()		, chip_ids.end()		);
-    fpga_ids.erase	( fpga_ids.begin()		, fpga_ids.end()		);
-    modules.erase	( modules.begin()		, modules.end()			);
-    fem_ids.erase	( fem_ids.begin()		, fem_ids.end()			);
-    chan_ids.erase	( chan_ids.begin()		, chan_ids.end()		);
-    bco_fulls.erase	( bco_fulls.begin()		, bco_fulls.end()		);
-    events.erase	( events.begin()		, events.end()			);
-    nhits_in_cluster.erase(nhits_in_cluster.begin()	, nhits_in_cluster.end()	);
-    
-    if (maxbuf && bufcnt >= maxbuf)
-      break;
-
-#ifdef OLD
-    // Get record size
-    int start = index;
-    int cnt = data[start];
-    // Unpack the record
-    int word1 = data[start + 1];
-    int word2 = data[start + 2];
-#else
-    // here is used now
-    int buflen = data[index];
-    int bufid = data[index + 1];
-    int cnt = buflen - 1;
-    int start = index + 2;
-
-    // Fake the old fmt logic
-    int word1 = 0xFFFFFFFF;
-    int word2 = 0xFFFFFFFF;
-
-    if (bufid == 100) {
-      word1 = 100;
-    }
-    else if (bufid == 101) {
-      word1 = 0xFFFFFFFF;
-      word2 = 0xFFFFFFFF;
-    }
-    else if (bufid == 102)
-      {
-	word1 = 102;
-      }
-
-#endif
-
-    if (word1 == 0xFFFFFFFF && word2 == 0xFFFFFFFF) {
-      if (bufid == 101) {
-	// This record is a time stamp
-	// Format of timestamp record is
-	//   data[0] = word count, excluding this word and checksum
-	//   data[1] = 0xFFFFFFFF
-	//   data[2] = 0xFFFFFFFF
-	//   data[3] = time in clock ticks for cpu
-	//   data[4] = CLOCKS_PER_SEC taken from the system value
-	//   data[5] = checksum for buffer
-	//std::cout << "Buffer " << bufcnt << ": Timestamp" << std::endl;
-
-#ifdef OLD
-	index = start + cnt + 2;
-#else
-	index = start + cnt;
-#endif
-	//index = start + cnt + 2;
-	continue;
-
-      }
-
-    } // end of if(word1==0xFFFFFFFF && word2==0xFFFFFFFF){
-    else if (word1 == 100) {
-      // This buffer is a configuration record
-      std::cout << "Buffer " << bufcnt << ": Configuration " << std::endl;
-
-      index += 2;
-      int runno = data[index++];
-
-      // print the run number
-      std::cout << "    Run " << runno << std::endl;
-
-      unsigned short* p = (unsigned short*)&data[index];
-
-      int n = 0;
-      for (n = 0; n < 9; ) {
-	unsigned short chipid = p[n++];
-	unsigned short masks[8];
-
-	for (int m = 0; m < 8; m++, n++)
-	  masks[m] = p[n];
-
-	std::cout << "    Chip " << chipid << std::endl;
-	std::cout << "      enable masks ";
-
-	for (int m = 0; m < 8; m++)
-	  std::cout << "0x" << std::hex << masks[m] << " ";
-
-	std::cout << std::dec << std::endl;
-      }
-
-      unsigned short* p2 = &p[n];
-      for (n = 0; n < 16; n++) {
-	std::cout << "      Reg " << n << ": " << (int)p2[n] << std::endl;
-      }
-#ifdef OLD
-      index = start + cnt + 2;
-#else
-      index = start + cnt;
-#endif
-    } // end of if( word1 == 100 )
-    else {
-
-      // Format of record is
-      //   data[0] = # of data words
-      //   data[1..n] = data words
-      //   data[n+1] = checksum for buffer
-      if (bufcnt < 10)
-	std::cout << "Buffer " << bufcnt << ": Data record, "
-		  << "nwords = " << cnt << " checksum = "
-		  << "0x" << std::hex << data[index + cnt + 1] << std::dec << std::endl;
-
-      int checksum = 0;
-
-      int index_camac = start + cnt;
-
-      if( mode != "calib" && mode != "external" )
-	{
-
-	  //cout << "------------------------------------------=" << endl;
-	  
-	  int camac_ADC_num = data[index_camac];
-	  //cout << "CAMAC ADC num: " << camac_ADC_num << endl;
-	  // only for some data (taken at the beginning of the implementation)
-	  if( fname.find( "nwu_fphx_raw_20201113-0137_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201113-1355_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201116-1112_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201116-1208_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201117-1801_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201117-1908_0.dat" ) != string::npos || 
-	      fname.find( "nwu_fphx_raw_20201118-1435_0.dat" ) != string::npos	      
-	      )
-	    {
-
-	      int camac_data_num = data[index_camac];
-	      if (camac_data_num % 2 != 0) {
-		cerr << "A number of camac data \"" << camac_data_num << "\" is odd. It's not expected (for the moment)" << endl;
-		cerr << "Consider modfy this macro or use even number of channels (normaly #ADC = #TDC)" << endl;
-	      }
-	      
-	      for (int i=0; i < camac_data_num / 2; i++)
-		{
-		  index_camac++;
-		  camac_adcs.push_back(data[index_camac]);
-		  //cout << "ADCs " << camac_adcs[i] << endl;
-		}
-	      
-	      for (int i = 0; i < camac_data_num / 2; i++)
-		{ 
-		  index_camac++;
-		  camac_tdcs.push_back(data[index_camac]);
-		  //cout << "TDCs: " << camac_tdcs[i] << endl;
-		}
-	      
-	    }
-	  else
-	    {
-	      for (int i=0; i < camac_ADC_num; i++)
-		{
-		  index_camac++;
-		  camac_adcs.push_back(data[index_camac]);
-		  //cout << "ADCs " << camac_adcs[i] << endl;
-		}
-	      
-	      index_camac++;
-	      int camac_TDC_num = data[index_camac];
-	      //cout << "CAMAC TDC num: " << camac_TDC_num << endl;
-	      for (int i = 0; i < camac_TDC_num; i++)
-		{ 
-		  index_camac++;
-		  camac_tdcs.push_back(data[index_camac]);
-		  //cout << "TDCs: " << camac_tdcs[i] << endl;
-		}
-	    }
-	}
-      // loop over data in this event group until the next event group shows up
-#ifdef OLD
-      for (index++; index < start + cnt + 1; index++)
-#else
-	for (index += 2; index < start + cnt - 1; index++)
-#endif
-	  {
-	    if ((index + 1) * sizeof(unsigned int) > size) {
-	      // Safety belt against a partially-written buffer (it will have the full length
-	      // field, but the whole buffer hasn't been read in).  This can happen, for instance,
-	      // if we are reading a file that is actively being written.
-	      std::cout << "Partial buffer detected, bailing" << std::endl;
-	      break;
-	    }
-
-	    // ^= means XOR
-	    checksum ^= data[index];
-
-	    command = data[index];
-	    int rawchip = -1;
-
-	    // Check whether this word holds an event#, a full 16-bit BCO# or hit data:
-	    if ((data[index] & 0xFFFF) == 1) {
-	      event_fem = (data[index] & 0xFFFF0000) >> 16;
-	      //cout  <<  "event_fem = "  <<  event_fem  << endl;
-	      continue;
-
-	    }
-	    else if ((data[index] & 0xFFFF) == 2) {
-	      bco_full = (data[index] & 0xFFFF0000) >> 16;
-	      //cout  <<  "bco_full = "  <<  bco_full  <<  endl;
-	      continue;
-	    }
-	    else {
-	      //check if this is a FEM_ID (bottom 12 bits = 0) or a data word:
-	      if ((data[index] & 0xfff) == 0) {
-		fem_id = (data[index] & 0xf000) >> 12;
-		//cout << "fem_id = " << fem_id << endl;
-		continue;
-	      }
-	      else {
-		rawchip = (data[index] >> 3) & 0x3F;
-
-		if (rawchip < 27)
-		  chip_id = rawchip;
-		else
-		  chip_id = rawchip - 26;
-
-		fpga_id = 0;
-
-		if (fem_id == 1) {
-		  if (rawchip < 27)
-		    module = 1;
-		  else
-		    module = 2;
-		}
-		else if (fem_id == 2) {
-		  if (rawchip < 27)
-		    module = 3;
-		  else
-		    module = 4;
-		}
-		else if (fem_id == 4) {
-		  if (rawchip < 27)
-		    module = 7;
-		  else
-		    module = 8;
-		}
-		else if (fem_id == 8) {
-		  if (rawchip < 27)
-		    module = 5;
-		  else
-		    module = 6;
-		}
-	       
-		// assign data to each variable to fill TTree
-		mchip = 0;
-		ampl = (data[index] >> 24) & 0x7F;
-		bco = (data[index] >> 16) & 0x7F;
-		chan_id = (data[index] >> 9) & 0x7F; //((data[index] & 0x200) >>3) | ((data[index] & 0xFC00)>>10); //data[index]>>9) & 0x7F; //
-		adc = (data[index] & 0x07);
-
-		/*
-		  if( chan_id<0 || chan_id>=128 || ampl<0 || ampl>=64 ){
-		  cout << "---" << chan_id << " " << ampl << endl;
-		  }
-		*/
-		nhits[chan_id][ampl]++;
-	      }
-	    }
-
-	    int noise; //,inoise,ihealthy;
-
-	    if (ampl != 0)
-	      noise = 1;
-	    else if (chip_id == 0 || chip_id > 26)
-	      noise = 1;
-	    else if (chan_id == 0 || chan_id > 126)
-	      noise = 1;
-	    else if (fem_id != 4 || module != 7)
-	      noise = 1;
-	    else
-	      noise = 0;
-
-	    if (noise != 0)
-	      inoise++;
-	    else if (noise == 0)
-	      ihealthy++;
-
-	    if (event_fem != old_event_fem) {
-
-	      if (old_event_fem >= 0) {
-
-		for (int ichip = 0; ichip < 8; ichip++) {
-		  if (chiphit[ichip] != 0)
-		    nchip_event++;
-
-		}
-
-	      } // end of if( old_event_fem >= 0 )
-
-	      nhit_event = 1;
-	      nchip_event = 0;
-
-	      for (int ichip = 0; ichip < 8; ichip++) {
-		chiphit[ichip] = 0;
-	      }
-
-	      if ((chip_id < 9) && (chip_id != 0)) {
-		chiphit[chip_id - 1]++;
-	      }
-
-	      old_event_fem = event_fem;
-	      old_bco = bco;
-	      old_bco_full = bco_full;
-	    } // end of if( event_fem != old_event_fem )
-	    else {
-	      nhit_event++;
-	      if ((chip_id < 9) && (chip_id != 0))
-		chiphit[chip_id - 1]++;
-	    }
-
-	    bcos      .push_back( bco      );
-	    adcs      .push_back( adc      );
-	    ampls.     push_back( ampl     );
-	    chip_ids  .push_back( chip_id  );
-	    fpga_ids  .push_back( fpga_id  );
-	    modules   .push_back( module   );
-	    fem_ids   .push_back( fem_id   );
-	    chan_ids  .push_back( chan_id  );
-	    bco_fulls .push_back( bco_full );
-	    events    .push_back( ievent    );
-
-	    cout << ievent << "\t" << adc << endl;
-	    tree->Fill();
-
-	    //Note:  we seem to get some odd chip_ids out of the new DAQ VHDL code
-	    //after the event gets larger than some value.  Need to understand this:
-
-	    ievent++;
-	  }  //for loop on 	for (index += 2; index < start + cnt - 1; index++)
-
-
-      // If there are only CAMAC data but no INTT data, fill CAMAC data to the tree
-      // -1 is filled to the branches for INTT events in this case. 
-      if (cnt == 1) {
-	is_INTT = false;
-      } else {
-	is_INTT = true;
-      }
-      
-      // make flag whether is event consists of a single bco or not
-      if( bcos.size() != 0 ) // skip here if no INTT event is 
-	{
-	  
-	  int first_bco = bcos[0];
-	  int bco_min = *min_element( bcos.begin(), bcos.end() );
-	  int bco_max = *max_element( bcos.begin(), bcos.end() );
-
-	  if( bco_max - bco_min < 2 )
-	    is_single_bco_event = true;
-	  else
-	    is_single_bco_event = false;
-	  
-	}
-
-      tree_both->Fill();
-      
-      // fill TTree for only CAMAC data if CAMAC data exits
-      if( mode != "calib" && mode != "external" )
-	tree_camac->Fill();
-
-      //if ( checksum != data[index] )
-      //std::cout << "WARNING: bad checksum = "
-      //      << std::hex << checksum << std::dec << std::endl;
-#ifdef OLD
-      index = start + cnt + 2;
-#else
-
-      // set the index for the next data group in the case of calibration data or external trigger mode (without CAMAC data)
-      if( mode == "calib" || mode == "external" )
-	index = start + cnt;
-      else if( mode == "camac" || mode == "camac_clustering" ) // in the case of with CAMAC data
-	index = index_camac + 1;
-#endif
-
-    }  // if block on record type
-  }  //Loop over data
-
-  cout << "inoise   = " << inoise << endl;
-  cout << "ihealthy = " << ihealthy << endl;
-
-  cout << "Tree entries: " << tree->GetEntries() << endl;
-  cout << "Clock data num: " << clock_data_num << endl;
-
-  tree->Write();
-
-  if( mode == "camac" || mode == "camac_clustering" ){
-    tree_camac->Write();
-    tree_both->Write();
-  }
+  decoder.Write();
 	
   file->Close();
 
+  event_index.Write( GetEventIndexName( output ) );
+
   return filename;
 }
 
@@ -0,0 +1,146 @@
+/*!
+  @file compact_format_report.cc
+  @brief Size and throughput of the compact hit format (functions/CompactHitTree.hh) are compared for some settings
+  @details "tree" in a ROOT file made by MakeTree is converted to "tree_compact" with each setting in a temporary file.
+  The file size, the writing speed, and the reading speed are shown together with those of the original tree.
+  The hits are read from the original tree in blocks, and the time to read a block and the time to write it are measured separately,
+  so the write time doesn't include the reading of the original tree, which is shown in its own column.
+  Usage: root -l -b -q 'compact_format_report.cc+O( "data/calib_packv1_220927_1700.root" )'
+*/
+
+#include <chrono>
+#include "functions/CompactHitTree.hh"
+
+/*!
+  @fn int compact_format_report
+  @param fname A ROOT file made by MakeTree
+  @param settings Settings of the compact format separated by ",", see CompactFormat
+*/
+int compact_format_report
+(
+ string fname = "data/calib_packv1_220927_1700.root",
+ string settings = "compact:zlib:1,compact:lz4:4,compact:zstd:5,compact:zstd:5:256000:-100000000,compact:lzma:6"
+ )
+{
+  TFile* tf = new TFile( fname.c_str(), "READ" );
+  TTree* tree = (TTree*)tf->Get( "tree" );
+  if( tree == nullptr ){
+    cerr << "tree is not found in " << fname << endl;
+    return -1;
+  }
+
+  int adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full;
+  tree->SetBranchAddress( "adc", &adc );
+  tree->SetBranchAddress( "ampl", &ampl );
+  tree->SetBranchAddress( "chip_id", &chip_id );
+  tree->SetBranchAddress( "fpga_id", &fpga_id );
+  tree->SetBranchAddress( "module", &module );
+  tree->SetBranchAddress( "chan_id", &chan_id );
+  tree->SetBranchAddress( "fem_id", &fem_id );
+  tree->SetBranchAddress( "bco", &bco );
+  tree->SetBranchAddress( "bco_full", &bco_full );
+
+  Long64_t nhits = tree->GetEntries();
+  auto seconds_since = []( std::chrono::steady_clock::time_point start ){
+    return std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+  };
+
+  // the original tree is read as a reference
+  auto start = std::chrono::steady_clock::now();
+  Long64_t checksum = 0;
+  for( Long64_t i=0; i<nhits; i++ ){
+    tree->GetEntry( i );
+    checksum += chan_id;
+  }
+  double read_time = seconds_since( start );
+  double original_size = tree->GetZipBytes();
+
+  // input: the time to read the original tree while the compact tree is written, not included in write
+  cout << setw(40) << "format" << setw(12) << "size [MB]" << setw(10) << "ratio" << setw(12) << "input [s]"
+       << setw(12) << "write [s]" << setw(16) << "write [Mhit/s]" << setw(12) << "read [s]" << setw(16) << "read [Mhit/s]" << endl;
+  cout << setw(40) << "tree (32-bit int branches)" << setw(12) << fixed << setprecision(2) << original_size / 1e6 << setw(10) << 1.0
+       << setw(12) << "-" << setw(12) << "-" << setw(16) << "-" << setw(12) << read_time << setw(16) << nhits / read_time / 1e6 << endl;
+
+  replace( settings.begin(), settings.end(), ',', ' ' );
+  istringstream iss( settings );
+  string setting;
+  while( iss >> setting ){
+
+    CompactFormat format;
+    if( format.Parse( setting ) == false ){
+      cerr << setting << " is skipped" << endl;
+      continue;
+    }
+
+    string temp_name = fname.substr( 0, fname.find_last_of( "." ) ) + "_compact_temp.root";
+
+    // writing. A block of hits is read from the original tree (the input time) and then written (the write time).
+    const Long64_t block = 100000;
+    vector < int > adcs( block ), ampls( block ), chip_ids( block ), fpga_ids( block ), modules( block ), chan_ids( block ), fem_ids( block ), bcos( block ), bco_fulls( block );
+    double input_time = 0, write_time = 0;
+    start = std::chrono::steady_clock::now();
+    TFile* tf_out = new TFile( temp_name.c_str(), "RECREATE" );
+    tf_out->SetCompressionSettings( format.GetCompressionSettings() );
+    TTree* tree_out = new TTree( "tree_compact", "chip info in the compact format" );
+    CompactHitTree compact;
+    compact.Book( tree_out, format );
+    write_time += seconds_since( start );
+    for( Long64_t first=0; first<nhits; first+=block ){
+      Long64_t n = std::min( block, nhits - first );
+
+      start = std::chrono::steady_clock::now();
+      for( Long64_t i=0; i<n; i++ ){
+	tree->GetEntry( first + i );
+	adcs[i] = adc;
+	ampls[i] = ampl;
+	chip_ids[i] = chip_id;
+	fpga_ids[i] = fpga_id;
+	modules[i] = module;
+	chan_ids[i] = chan_id;
+	fem_ids[i] = fem_id;
+	bcos[i] = bco;
+	bco_fulls[i] = bco_full;
+      }
+      input_time += seconds_since( start );
+
+      start = std::chrono::steady_clock::now();
+      for( Long64_t i=0; i<n; i++ )
+	compact.AddHit( tree_out, adcs[i], ampls[i], chip_ids[i], fpga_ids[i], modules[i], chan_ids[i], fem_ids[i], bcos[i], bco_fulls[i] );
+      write_time += seconds_since( start );
+    }
+
+    start = std::chrono::steady_clock::now();
+    compact.Flush( tree_out );
+    tree_out->Write();
+    double size = tree_out->GetZipBytes();
+    tf_out->Close();
+    delete tf_out;
+    write_time += seconds_since( start );
+
+    // reading
+    start = std::chrono::steady_clock::now();
+    TFile* tf_in = new TFile( temp_name.c_str(), "READ" );
+    TTree* tree_in = (TTree*)tf_in->Get( "tree_compact" );
+    CompactHitTree compact_in;
+    compact_in.SetBranchAddresses( tree_in );
+    Long64_t checksum_in = 0;
+    for( Long64_t i=0; i<tree_in->GetEntries(); i++ ){
+      compact_in.GetEntry( tree_in, i );
+      for( UInt_t j=0; j<compact_in.nhits_; j++ )
+	checksum_in += compact_in.chan_ids_[j];
+    }
+    double read_time_compact = seconds_since( start );
+    tf_in->Close();
+    delete tf_in;
+    gSystem->Unlink( temp_name.c_str() );
+
+    if( checksum_in != checksum )
+      cerr << "Channels read from " << setting << " are different from the original ones" << endl;
+
+    cout << setw(40) << format.GetName() << setw(12) << size / 1e6 << setw(10) << size / original_size << setw(12) << input_time
+	 << setw(12) << write_time << setw(16) << nhits / write_time / 1e6 << setw(12) << read_time_compact << setw(16) << nhits / read_time_compact / 1e6 << endl;
+  }
+
+  tf->Close();
+  return 0;
+}
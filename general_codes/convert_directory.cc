@@ -0,0 +1,41 @@
+/*!
+  @file convert_directory.cc
+  @brief All .dat files in a directory (a run campaign) are converted to ROOT files. Files converted before are skipped.
+  @details See functions/BatchConverter.hh for the details. The manifest "convert_manifest.txt" and the log "convert_log.txt" are made in the directory.
+  Usage: root -l -b -q 'convert_directory.cc+O( "data/campaign/", "calib", 4 )'
+*/
+
+#include "functions/BatchConverter.hh"
+
+/*!
+  @fn int convert_directory
+  @param dir A path to the directory
+  @param mode Mode of data taking, "calib", "external", "camac", "camac_clustering" are accepted
+  @param nworkers The number of files converted at the same time
+  @param format "" for the usual tree, "compact[:algorithm[:level[:basket_size[:auto_flush]]]]" for the compact format (see CompactHitTree)
+  @param force If true, all files are converted again
+  @param min_age Files modified within this number of seconds are skipped since the DAQ may still write them
+  @param verbosity 0: quiet, 1: a line for each file (default), 2: the statistics of each record
+*/
+int convert_directory
+(
+ string dir = "data/",
+ string mode = "calib",
+ int nworkers = 2,
+ string format = "",
+ bool force = false,
+ double min_age = 0,
+ int verbosity = DecodeStats::kSummary
+ )
+{
+  BatchConverter converter( dir, mode, nworkers );
+  converter.verbosity_ = verbosity;
+  converter.SetForce( force );
+  converter.SetMinimumAge( min_age );
+  if( converter.SetFormat( format ) == false ){
+    cerr << "Format \"" << format << "\" is not supported." << endl;
+    return -1;
+  }
+
+  return converter.Run();
+}
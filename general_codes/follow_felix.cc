@@ -0,0 +1,60 @@
+/*!
+  @file follow_felix.cc
+  @brief A .dat file which is still written by the DAQ is decoded incrementally for the online QA.
+  @details Only the records appended since the last poll are decoded (see functions/FelixFollower.hh), so it costs the new data rather than the whole run.
+  The ROOT file can be drawn by check_felix.cc at any time.
+*/
+
+#include "functions/FindLatestFile.hh"
+#include "functions/FelixFollower.hh"
+
+/*!
+  @fn int follow_felix
+  @brief The data file is polled and new records are decoded into the ROOT file.
+  @param fname A name of the .dat file OR a path to the directory (ending with "/"). The latest .dat file in the directory is used for a directory.
+  @param mode Mode of data taking, "calib", "external", "camac", "camac_clustering" are accepted
+  @param interval Seconds between polls
+  @param timeout It stops if the file doesn't grow for this seconds. A negative value means forever.
+  @param per_chunk If true, each poll makes a new ROOT file "<name>_chunkNNNN.root" instead of appending to "<name>.root"
+  @param reset If true, the output with the checkpoint is removed and the file is decoded from the beginning
+  @param verbosity 0: quiet, 1: a line for each poll (default), 2: the statistics of each poll, 3: a line for each hit
+  @param format "" for the usual tree, "compact..." for tree_compact, the same as MakeTree
+  @param mask Bad channels not to be filled, "module=bad_channel_summary.root[:ladder_id]" separated by "," (see ChannelMask), the same as MakeTree
+*/
+int follow_felix
+(
+ string fname = "data/",
+ string mode = "calib",
+ double interval = 5,
+ double timeout = 600,
+ bool per_chunk = false,
+ bool reset = false,
+ int verbosity = DecodeStats::kSummary,
+ string format = "",
+ string mask = ""
+ )
+{
+  if( fname.size() < 4 || fname.substr( fname.size() - 4 ) != ".dat" ){
+    fname = FindLatestFile( fname );
+    if( fname == "" )
+      return -1;
+  }
+
+  cout << "Follow " << fname << endl;
+  FelixFollower follower( fname, mode, false, per_chunk );
+  follower.verbosity_ = verbosity;
+  if( follower.SetFormat( format ) == false ){
+    cerr << "Format \"" << format << "\" is not supported." << endl;
+    return -1;
+  }
+
+  if( follower.SetMask( mask ) == false )
+    return -1;
+
+  if( reset )
+    follower.Reset();
+
+  Long64_t nrecords = follower.Follow( interval, timeout );
+  cout << nrecords << " records were decoded. " << follower.GetRecords() << " records in total (" << follower.GetOffset() << " bytes)" << endl;
+  return 0;
+}
@@ -0,0 +1,301 @@
+#include "BatchConverter.hh"
+
+ULong64_t GetContentHash( string fname )
+{
+  ifstream ifs( fname.c_str(), ios::binary );
+  if( ifs.fail() )
+    return 0;
+
+  // FNV-1a on 64-bit words, the remaining bytes at the end are taken one by one
+  const ULong64_t prime = 0x100000001b3ULL;
+  ULong64_t hash = 0xcbf29ce484222325ULL;
+  vector < ULong64_t > buffer( 1 << 19 ); // 4 MB
+  while( ifs ){
+    ifs.read( (char*)&buffer[0], buffer.size() * sizeof(ULong64_t) );
+    std::streamsize bytes = ifs.gcount();
+
+    size_t nwords = bytes / sizeof(ULong64_t);
+    for( size_t i=0; i<nwords; i++ ){
+      hash ^= buffer[i];
+      hash *= prime;
+    }
+
+    const unsigned char* rest = (const unsigned char*)&buffer[nwords];
+    for( std::streamsize i=0; i<bytes % (std::streamsize)sizeof(ULong64_t); i++ ){
+      hash ^= rest[i];
+      hash *= prime;
+    }
+  }
+
+  return hash;
+}
+
+BatchConverter::BatchConverter( string dir, string mode, int nworkers, bool is_old_camac_format )
+{
+  dir_ = dir;
+  if( dir_.size() > 0 && dir_[ dir_.size()-1 ] != '/' )
+    dir_ += "/";
+
+  mode_ = mode;
+  nworkers_ = nworkers > 0 ? nworkers : 1;
+  is_old_camac_format_ = is_old_camac_format;
+}
+
+bool BatchConverter::SetFormat( string format )
+{
+  // only for the check
+  FelixDecoder decoder( mode_ );
+  if( decoder.SetFormat( format ) == false )
+    return false;
+
+  format_ = format;
+  return true;
+}
+
+bool BatchConverter::LoadManifest()
+{
+  manifest_.clear();
+  ifstream ifs( this->GetManifestName().c_str() );
+  if( ifs.fail() )
+    return false;
+
+  // "name size mtime hash format seconds" in each line, lines starting with # are comments
+  string line;
+  while( getline( ifs, line ) ){
+    if( line.size() == 0 || line[0] == '#' )
+      continue;
+
+    istringstream iss( line );
+    ManifestEntry entry;
+    if( !( iss >> entry.name >> entry.size >> entry.mtime >> std::hex >> entry.hash >> std::dec >> entry.format >> entry.seconds ) )
+      continue;
+
+    manifest_[ entry.name ] = entry;
+  }
+
+  return true;
+}
+
+bool BatchConverter::SaveManifest()
+{
+  // a temporary file is renamed so that the manifest is not broken even if the program is stopped while writing
+  string temp = this->GetManifestName() + ".tmp";
+  ofstream ofs( temp.c_str() );
+  if( ofs.fail() ){
+    cerr << "Failed to write the manifest " << temp << endl;
+    return false;
+  }
+
+  ofs << "# name size mtime hash format seconds" << endl;
+  for( auto& it : manifest_ ){
+    const ManifestEntry& entry = it.second;
+    ofs << entry.name << " " << entry.size << " " << entry.mtime << " "
+	<< std::hex << entry.hash << std::dec << " " << entry.format << " " << entry.seconds << endl;
+  }
+  ofs.close();
+
+  return rename( temp.c_str(), this->GetManifestName().c_str() ) == 0;
+}
+
+vector < string > BatchConverter::GetJobs()
+{
+  vector < pair < Long64_t, string > > jobs;
+  void* dir = gSystem->OpenDirectory( dir_.c_str() );
+  if( dir == nullptr ){
+    cerr << "The directory \"" << dir_ << "\" is not found." << endl;
+    return vector < string >();
+  }
+
+  Long64_t now = (Long64_t)time( nullptr );
+  const char* entry_name;
+  while( ( entry_name = gSystem->GetDirEntry( dir ) ) != nullptr ){
+    string name = entry_name;
+    if( name.size() < 4 || name.substr( name.size() - 4 ) != ".dat" )
+      continue;
+
+    FileStat_t stat;
+    if( gSystem->GetPathInfo( ( dir_ + name ).c_str(), stat ) != 0 || stat.fIsDir )
+      continue;
+
+    if( now - stat.fMtime < min_age_ )
+      continue;
+
+    // nothing is changed if the size and the modification time are the same
+    auto it = manifest_.find( name );
+    string output = dir_ + name.substr( 0, name.find_last_of( "." ) ) + ".root";
+    if( force_ == false && it != manifest_.end()
+	&& it->second.size == stat.fSize && it->second.mtime == stat.fMtime
+	&& it->second.format == ( format_ == "" ? "-" : format_ )
+	&& gSystem->AccessPathName( output.c_str() ) == false ){
+      skipped_++;
+      continue;
+    }
+
+    jobs.push_back( pair < Long64_t, string >( stat.fSize, name ) );
+  }
+  gSystem->FreeDirectory( dir );
+
+  // larger files first so that the workers finish at a similar time
+  sort( jobs.begin(), jobs.end(), []( const pair < Long64_t, string >& a, const pair < Long64_t, string >& b ){ return a.first > b.first; } );
+
+  vector < string > names;
+  for( auto& job : jobs )
+    names.push_back( job.second );
+
+  return names;
+}
+
+bool BatchConverter::Convert( string fname, string output, Long64_t& nrecords, Long64_t& nhits )
+{
+  nrecords = nhits = 0;
+
+  RawRecordReader reader;
+  if( mode_ == "camac" || mode_ == "camac_clustering" )
+    reader.SetTrailerType( is_old_camac_format_ ? RawRecordReader::kCamacTrailerOld : RawRecordReader::kCamacTrailer );
+
+  if( reader.Open( fname ) == false )
+    return false;
+
+  // the same as MakeTree
+  TFile* tf = new TFile( output.c_str(), "RECREATE" );
+  if( tf->IsZombie() ){
+    cerr << "Failed to create " << output << endl;
+    delete tf;
+    return false;
+  }
+
+  FelixDecoder decoder( mode_, is_old_camac_format_ );
+  decoder.verbosity_ = verbosity_ >= DecodeStats::kRecord ? verbosity_ : DecodeStats::kQuiet;
+  EventIndex event_index;
+  HitCountCube count_cube;
+  if( decoder.SetUp( tf, format_, nullptr, &event_index, &count_cube ) == false ){
+    // the empty ROOT file is removed so that it's not taken as a converted file
+    tf->Close();
+    delete tf;
+    gSystem->Unlink( output.c_str() );
+    return false;
+  }
+
+  while( reader.Next() ){
+    decoder.Decode( reader.GetRecord(), nrecords, true, reader.GetRecordOffset() );
+    nrecords++;
+  }
+
+  if( reader.IsPartial() )
+    decoder.stats_.partial_buffers_++;
+
+  nhits = decoder.ievent_;
+  tf->cd();
+  decoder.Write();
+  tf->Close();
+  delete tf;
+
+  event_index.Write( GetEventIndexName( output ) );
+  return true;
+}
+
+void BatchConverter::Record( const ManifestEntry& entry, Long64_t nrecords, Long64_t nhits, bool is_success )
+{
+  std::lock_guard < std::mutex > lock( mutex_ );
+  if( is_success ){
+    manifest_[ entry.name ] = entry;
+    this->SaveManifest();
+  }
+
+  // date, file, bytes, records, hits, seconds, MB/s, status
+  ofstream ofs( this->GetLogName().c_str(), ios::app );
+  double throughput = entry.seconds > 0 ? entry.size / entry.seconds / 1e6 : 0;
+  ofs << TDatime().AsSQLString() << "\t" << entry.name << "\t" << entry.size << "\t" << nrecords << "\t" << nhits << "\t"
+      << entry.seconds << "\t" << throughput << "\t" << ( is_success ? "ok" : "failed" ) << endl;
+
+  if( verbosity_ >= DecodeStats::kSummary )
+    cout << ( is_success ? "Converted " : "Failed " ) << entry.name << ": " << nhits << " hits, "
+	 << entry.seconds << " s (" << throughput << " MB/s)" << endl;
+}
+
+int BatchConverter::Run()
+{
+  skipped_ = converted_ = failed_ = 0;
+  this->LoadManifest();
+  vector < string > jobs = this->GetJobs();
+  if( verbosity_ >= DecodeStats::kSummary )
+    cout << jobs.size() << " files to be checked, " << skipped_ << " files not changed in " << dir_ << endl;
+
+  if( jobs.size() == 0 )
+    return 0;
+
+  TDirectory* dir = gDirectory;
+  ROOT::EnableThreadSafety();
+  std::atomic < size_t > next_job( 0 );
+  std::atomic < int > converted( 0 ), unchanged( 0 ), failed( 0 );
+  vector < std::thread > workers;
+  int nworkers = std::min( (size_t)nworkers_, jobs.size() );
+  for( int worker=0; worker<nworkers; worker++ ){
+    workers.push_back( std::thread( [&]() {
+
+      size_t job;
+      while( ( job = next_job++ ) < jobs.size() ){
+
+	string fname = dir_ + jobs[job];
+	string output = fname.substr( 0, fname.find_last_of( "." ) ) + ".root";
+
+	ManifestEntry entry;
+	entry.name = jobs[job];
+	entry.format = format_ == "" ? "-" : format_;
+
+	FileStat_t stat;
+	gSystem->GetPathInfo( fname.c_str(), stat );
+	entry.size = stat.fSize;
+	entry.mtime = stat.fMtime;
+
+	auto start = std::chrono::steady_clock::now();
+	entry.hash = GetContentHash( fname );
+
+	// the file was touched or copied, but the contents are the same
+	ManifestEntry old;
+	bool is_known = false;
+	{
+	  std::lock_guard < std::mutex > lock( mutex_ );
+	  auto it = manifest_.find( entry.name );
+	  if( it != manifest_.end() ){
+	    old = it->second;
+	    is_known = true;
+	  }
+	}
+
+	if( force_ == false && is_known && old.hash == entry.hash && old.size == entry.size && old.format == entry.format
+	    && gSystem->AccessPathName( output.c_str() ) == false ){
+	  entry.seconds = old.seconds;
+	  std::lock_guard < std::mutex > lock( mutex_ );
+	  manifest_[ entry.name ] = entry;
+	  this->SaveManifest();
+	  unchanged++;
+	  continue;
+	}
+
+	Long64_t nrecords, nhits;
+	bool is_success = this->Convert( fname, output, nrecords, nhits );
+	entry.seconds = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+	this->Record( entry, nrecords, nhits, is_success );
+
+	if( is_success )
+	  converted++;
+	else
+	  failed++;
+      }
+    }) );
+  }
+
+  for( auto& worker : workers )
+    worker.join();
+
+  dir->cd();
+  converted_ = converted;
+  failed_ = failed;
+  skipped_ += unchanged;
+
+  if( verbosity_ >= DecodeStats::kSummary )
+    cout << converted_ << " converted, " << skipped_ << " skipped, " << failed_ << " failed. Log: " << this->GetLogName() << endl;
+
+  return failed_ > 0 && converted_ == 0 ? -1 : converted_;
+}
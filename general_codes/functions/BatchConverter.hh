@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include "FelixDecoder.hh"
+
+/*!
+  @struct ManifestEntry
+  @brief A converted .dat file in the manifest of BatchConverter
+*/
+struct ManifestEntry
+{
+  string name;          //!< file name without the directory
+  Long64_t size = 0;    //!< bytes
+  Long64_t mtime = 0;   //!< the last modification time (UNIX time)
+  ULong64_t hash = 0;   //!< hash of the contents, see GetContentHash
+  string format = "-";  //!< the format given to FelixDecoder::SetFormat, "-" for the usual tree
+  double seconds = 0;   //!< time for the conversion
+};
+
+//! 64-bit FNV-1a hash of the contents of the file. 0 is returned if the file can't be read.
+ULong64_t GetContentHash( string fname );
+
+/*!
+  @class BatchConverter
+  @brief All .dat files in a directory are converted to ROOT files (the same as MakeTree) by a pool of workers. Files converted before are skipped.
+  @details The converted files are listed in the manifest "<dir>/convert_manifest.txt" with their size, modification time, and hash of the contents.
+  A file is converted if
+    - it's not in the manifest,
+    - its contents changed (the size and the modification time are different, and so is the hash), or
+    - the ROOT file is not found or the format is different.
+  The hash is calculated only when the size or the modification time changed, so running it again costs only a stat() of each file.
+  The workers take the files one by one from the list (the largest first). Each worker decodes a file serially into its own ROOT file and the event index.
+  A line for each file (size, records, hits, time, and throughput) is appended to the log "<dir>/convert_log.txt".
+  The manifest is saved after each conversion, so the finished files are kept even if the program is stopped.
+
+  How to use:
+    BatchConverter converter( "data/campaign/", "calib", 4 );
+    converter.Run(); // the number of the converted files is returned
+*/
+class BatchConverter
+{
+public:
+  BatchConverter( string dir, string mode = "calib", int nworkers = 2, bool is_old_camac_format = false );
+
+  //! The format of the ROOT files, see FelixDecoder::SetFormat. false is returned for an unknown format.
+  bool SetFormat( string format );
+
+  //! All files are converted regardless of the manifest if it's true
+  void SetForce( bool force ){ force_ = force; };
+
+  //! Files modified within this number of seconds are skipped since they may be written by the DAQ
+  void SetMinimumAge( double seconds ){ min_age_ = seconds; };
+
+  //! .dat files to be converted are listed. It's called in Run.
+  vector < string > GetJobs();
+
+  //! New or changed files are converted. The number of the converted files is returned, -1 for an error.
+  int Run();
+
+  string GetManifestName(){ return dir_ + "convert_manifest.txt"; };
+  string GetLogName(){ return dir_ + "convert_log.txt"; };
+
+  int verbosity_ = DecodeStats::kSummary; //!< see DecodeStats::Verbosity
+
+  // statistics of the last Run
+  int skipped_ = 0;   //!< files not changed since the last conversion
+  int converted_ = 0;
+  int failed_ = 0;
+
+private:
+  string dir_;
+  string mode_;
+  int nworkers_;
+  bool is_old_camac_format_;
+  string format_ = "";
+  bool force_ = false;
+  double min_age_ = 0;
+
+  std::map < string, ManifestEntry > manifest_;
+  std::mutex mutex_; //!< for manifest_ and the log
+
+  bool LoadManifest();
+  bool SaveManifest();
+
+  //! The file is decoded into the ROOT file. The number of records and hits are returned via the arguments.
+  //! false is returned if the file can't be read, the ROOT file can't be created, or FelixDecoder::SetUp fails, and the file is counted in failed_.
+  bool Convert( string fname, string output, Long64_t& nrecords, Long64_t& nhits );
+
+  //! The result is added to the manifest and the log
+  void Record( const ManifestEntry& entry, Long64_t nrecords, Long64_t nhits, bool is_success );
+};
+
+#ifndef BATCH_CONVERTER_source
+#define BATCH_CONVERTER_source
+
+#include "BatchConverter.cc"
+#endif //  BATCH_CONVERTER_source
@@ -0,0 +1,337 @@
+#include "BcoEventBuilder.hh"
+
+void BcoFragment::Clear()
+{
+  stream = fem_id = bco_full = -1;
+  bco_unwrapped = -1;
+  adcs.clear();
+  ampls.clear();
+  chip_ids.clear();
+  fpga_ids.clear();
+  modules.clear();
+  chan_ids.clear();
+  bcos.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BcoHitStream
+/////////////////////////////////////////////////////////////////////////////////////////////
+BcoHitStream::BcoHitStream( int stream, std::string fname, std::string tree_name, int fem_id )
+{
+  stream_ = stream;
+  fname_ = fname;
+  selected_fem_id_ = fem_id;
+
+  tf_ = new TFile( fname.c_str(), "READ" );
+  if( tf_->IsZombie() ){
+    std::cerr << "Failed to open " << fname << std::endl;
+    return;
+  }
+
+  tree_ = (TTree*)tf_->Get( tree_name.c_str() );
+  if( tree_ == nullptr ){
+    std::cerr << tree_name << " is not found in " << fname << std::endl;
+    return;
+  }
+
+  tree_->SetBranchAddress( "adc", &adc_ );
+  tree_->SetBranchAddress( "ampl", &ampl_ );
+  tree_->SetBranchAddress( "chip_id", &chip_id_ );
+  tree_->SetBranchAddress( "fpga_id", &fpga_id_ );
+  tree_->SetBranchAddress( "module", &module_ );
+  tree_->SetBranchAddress( "chan_id", &chan_id_ );
+  tree_->SetBranchAddress( "fem_id", &fem_id_, &fem_id_branch_ );
+  tree_->SetBranchAddress( "bco", &bco_ );
+  tree_->SetBranchAddress( "bco_full", &bco_full_, &bco_full_branch_ );
+}
+
+BcoHitStream::~BcoHitStream()
+{
+  if( tf_ != nullptr ){
+    tf_->Close();
+    delete tf_;
+  }
+}
+
+bool BcoHitStream::Next( BcoFragment& fragment )
+{
+  fragment.Clear();
+  if( tree_ == nullptr )
+    return false;
+
+  Long64_t entries = tree_->GetEntries();
+  for( ; entry_ < entries; entry_++ ){
+    if( is_ranged_ ){
+      // the entries of the other FEMs are jumped over
+      while( range_ < ranges_.size() && entry_ >= ranges_[range_].second )
+	range_++;
+
+      if( range_ == ranges_.size() )
+	break;
+
+      if( entry_ < ranges_[range_].first )
+	entry_ = ranges_[range_].first;
+    }
+    else if( selected_fem_id_ >= 0 ){
+      // only fem_id is read for the hits of the other FEMs
+      fem_id_branch_->GetEntry( entry_ );
+      if( fem_id_ != selected_fem_id_ )
+	continue;
+    }
+
+    tree_->GetEntry( entry_ );
+
+    // hits before the first bco_full word in a record cannot be matched
+    if( bco_full_ < 0 ){
+      skipped_++;
+      continue;
+    }
+
+    if( fragment.stream < 0 ){
+      // the first hit of this fragment
+      if( last_bco_full_ >= 0 && bco_full_ < last_bco_full_ - 0x8000 )
+	wraps_++;
+
+      last_bco_full_ = bco_full_;
+      fragment.stream = stream_;
+      fragment.fem_id = fem_id_;
+      fragment.bco_full = bco_full_;
+      fragment.bco_unwrapped = bco_full_ + wraps_ * 0x10000;
+    }
+    else if( fem_id_ != fragment.fem_id || bco_full_ != fragment.bco_full ){
+      // this hit is the first one of the next fragment, it's read again next time
+      break;
+    }
+
+    fragment.adcs.push_back( adc_ );
+    fragment.ampls.push_back( ampl_ );
+    fragment.chip_ids.push_back( chip_id_ );
+    fragment.fpga_ids.push_back( fpga_id_ );
+    fragment.modules.push_back( module_ );
+    fragment.chan_ids.push_back( chan_id_ );
+    fragment.bcos.push_back( bco_ );
+  }
+
+  return fragment.stream >= 0;
+}
+
+std::map < int, std::vector < BcoHitStream::EntryRange > > BcoHitStream::SplitByFem()
+{
+  std::map < int, std::vector < EntryRange > > ranges;
+  if( tree_ == nullptr )
+    return ranges;
+
+  // consecutive entries of the same FEM are a range. FEMs without bco_full are not taken.
+  std::set < int > fem_ids; // with bco_full
+  Long64_t entries = tree_->GetEntries();
+  for( Long64_t i=0; i<entries; i++ ){
+    fem_id_branch_->GetEntry( i );
+    bco_full_branch_->GetEntry( i );
+
+    std::vector < EntryRange >& fem_ranges = ranges[ fem_id_ ];
+    if( fem_ranges.size() > 0 && fem_ranges.back().second == i )
+      fem_ranges.back().second = i + 1;
+    else
+      fem_ranges.push_back( EntryRange( i, i + 1 ) );
+
+    if( bco_full_ >= 0 )
+      fem_ids.insert( fem_id_ );
+  }
+
+  for( auto it = ranges.begin(); it != ranges.end(); ){
+    if( fem_ids.count( it->first ) == 0 )
+      it = ranges.erase( it );
+    else
+      ++it;
+  }
+
+  return ranges;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// BcoEventBuilder
+/////////////////////////////////////////////////////////////////////////////////////////////
+BcoEventBuilder::~BcoEventBuilder()
+{
+  for( auto& stream : streams_ )
+    delete stream;
+}
+
+bool BcoEventBuilder::AddFile( std::string fname, std::string tree_name )
+{
+  TDirectory* dir = gDirectory;
+  BcoHitStream* stream = new BcoHitStream( streams_.size(), fname, tree_name );
+  dir->cd();
+
+  if( stream->IsOpen() == false ){
+    delete stream;
+    return false;
+  }
+
+  // a stream for each FEM. The file is taken as one stream if it has no hits with bco_full.
+  std::map < int, std::vector < BcoHitStream::EntryRange > > ranges = stream->SplitByFem();
+  if( ranges.size() == 0 ){
+    streams_.push_back( stream );
+    return true;
+  }
+
+  delete stream;
+  for( auto& it : ranges ){
+    stream = new BcoHitStream( streams_.size(), fname, tree_name, it.first );
+    dir->cd();
+    if( stream->IsOpen() == false ){
+      delete stream;
+      return false;
+    }
+
+    stream->SetRanges( it.second );
+    streams_.push_back( stream );
+  }
+
+  return true;
+}
+
+Long64_t BcoEventBuilder::Build( std::string output )
+{
+  int nstreams = streams_.size();
+  events_ = complete_events_ = 0;
+  fragments_.assign( nstreams, 0 );
+  orphan_fragments_.assign( nstreams, 0 );
+  if( nstreams == 0 ){
+    std::cerr << "No file is given" << std::endl;
+    return 0;
+  }
+
+  TDirectory* dir = gDirectory;
+  TFile* tf = new TFile( output.c_str(), "RECREATE" );
+
+  Long64_t event = 0, bco_unwrapped = 0;
+  int bco_full = 0, nstreams_in_event = 0;
+  bool is_complete = false;
+  std::vector < int > streams, fem_ids, bco_fulls, adcs, ampls, chip_ids, fpga_ids, modules, chan_ids, bcos;
+
+  TTree* tree = new TTree( "event_tree", "events built by bco_full" );
+  tree->Branch( "event", &event, "event/L" );
+  tree->Branch( "bco_full", &bco_full, "bco_full/I" );
+  tree->Branch( "bco_unwrapped", &bco_unwrapped, "bco_unwrapped/L" );
+  tree->Branch( "nstreams", &nstreams_in_event, "nstreams/I" );
+  tree->Branch( "complete", &is_complete, "complete/O" );
+  tree->Branch( "stream", &streams );
+  tree->Branch( "fem_id", &fem_ids );
+  tree->Branch( "hit_bco_full", &bco_fulls );
+  tree->Branch( "adc", &adcs );
+  tree->Branch( "ampl", &ampls );
+  tree->Branch( "chip_id", &chip_ids );
+  tree->Branch( "fpga_id", &fpga_ids );
+  tree->Branch( "module", &modules );
+  tree->Branch( "chan_id", &chan_ids );
+  tree->Branch( "bco", &bcos );
+
+  // the first fragment of each stream
+  typedef std::pair < Long64_t, int > QueueItem; // (bco_unwrapped, stream), the smallest one on the top
+  std::priority_queue < QueueItem, std::vector < QueueItem >, std::greater < QueueItem > > queue;
+  std::vector < BcoFragment > pending( nstreams );
+  for( int i=0; i<nstreams; i++ ){
+    if( streams_[i]->Next( pending[i] ) ){
+      queue.push( QueueItem( pending[i].bco_unwrapped, i ) );
+      fragments_[i]++;
+    }
+  }
+
+  std::vector < int > contributions( nstreams );
+  while( queue.empty() == false ){
+
+    Long64_t first = queue.top().first;
+    streams.clear();
+    fem_ids.clear();
+    bco_fulls.clear();
+    adcs.clear();
+    ampls.clear();
+    chip_ids.clear();
+    fpga_ids.clear();
+    modules.clear();
+    chan_ids.clear();
+    bcos.clear();
+    contributions.assign( nstreams, 0 );
+
+    // fragments within the window are taken. The next fragment of the same stream can be in the window as well.
+    while( queue.empty() == false && queue.top().first - first <= window_ ){
+      int i = queue.top().second;
+      queue.pop();
+
+      BcoFragment& fragment = pending[i];
+      for( size_t j=0; j<fragment.adcs.size(); j++ ){
+	streams.push_back( i );
+	fem_ids.push_back( fragment.fem_id );
+	bco_fulls.push_back( fragment.bco_full );
+	adcs.push_back( fragment.adcs[j] );
+	ampls.push_back( fragment.ampls[j] );
+	chip_ids.push_back( fragment.chip_ids[j] );
+	fpga_ids.push_back( fragment.fpga_ids[j] );
+	modules.push_back( fragment.modules[j] );
+	chan_ids.push_back( fragment.chan_ids[j] );
+	bcos.push_back( fragment.bcos[j] );
+      }
+      contributions[i]++;
+
+      if( streams_[i]->Next( fragment ) ){
+	queue.push( QueueItem( fragment.bco_unwrapped, i ) );
+	fragments_[i]++;
+      }
+    }
+
+    nstreams_in_event = nstreams - std::count( contributions.begin(), contributions.end(), 0 );
+    is_complete = ( nstreams_in_event == nstreams );
+    if( is_complete )
+      complete_events_++;
+    else
+      for( int i=0; i<nstreams; i++ )
+	orphan_fragments_[i] += contributions[i];
+
+    event = events_++;
+    bco_unwrapped = first;
+    bco_full = first & 0xFFFF;
+    tree->Fill();
+  }
+
+  tree->Write();
+
+  // statistics
+  std::vector < Long64_t > skipped( nstreams );
+  std::vector < int > stream_fem_ids( nstreams );
+  for( int i=0; i<nstreams; i++ ){
+    skipped[i] = streams_[i]->skipped_;
+    stream_fem_ids[i] = streams_[i]->GetFemId();
+  }
+
+  TTree* tree_stats = new TTree( "event_builder_stats", "statistics of the event building" );
+  tree_stats->Branch( "nstreams", &nstreams, "nstreams/I" );
+  tree_stats->Branch( "window", &window_, "window/I" );
+  tree_stats->Branch( "fem_ids", &stream_fem_ids[0], "fem_ids[nstreams]/I" );
+  tree_stats->Branch( "events", &events_, "events/L" );
+  tree_stats->Branch( "complete_events", &complete_events_, "complete_events/L" );
+  tree_stats->Branch( "fragments", &fragments_[0], "fragments[nstreams]/L" );
+  tree_stats->Branch( "orphan_fragments", &orphan_fragments_[0], "orphan_fragments[nstreams]/L" );
+  tree_stats->Branch( "skipped_hits", &skipped[0], "skipped_hits[nstreams]/L" );
+  tree_stats->Fill();
+  tree_stats->Write();
+
+  tf->Close();
+  delete tf;
+  dir->cd();
+
+  return events_;
+}
+
+void BcoEventBuilder::Print( std::ostream& os )
+{
+  os << "+--- Event building (window: " << window_ << " BCO) ---------------" << std::endl;
+  os << "| Events          : " << events_ << " (complete " << complete_events_ << ", incomplete " << events_ - complete_events_ << ")" << std::endl;
+  for( size_t i=0; i<streams_.size(); i++ ){
+    os << "| Stream " << i << " " << streams_[i]->GetName() << ", FEM " << streams_[i]->GetFemId() << std::endl;
+    os << "|   fragments " << ( i < fragments_.size() ? fragments_[i] : 0 )
+       << ", orphans " << ( i < orphan_fragments_.size() ? orphan_fragments_[i] : 0 )
+       << ", hits without bco_full " << streams_[i]->skipped_ << std::endl;
+  }
+  os << "+-------------------------------------------------------" << std::endl;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+  @struct BcoFragment
+  @brief Consecutive hits with the same FEM_ID and bco_full in a stream (a decoded file)
+*/
+struct BcoFragment
+{
+  int stream = -1;
+  int fem_id = -1;
+  int bco_full = -1;
+  Long64_t bco_unwrapped = -1; //!< bco_full + 65536 * (the number of wrap-arounds)
+  std::vector < int > adcs, ampls, chip_ids, fpga_ids, modules, chan_ids, bcos;
+
+  void Clear();
+};
+
+/*!
+  @class BcoHitStream
+  @brief Hits of a FEM in "tree" of a ROOT file made by MakeTree are read and given as fragments one by one
+  @details The records of the FEMs in a file are interleaved, and the bco_full counters of the FEMs aren't in phase,
+  so a stream takes the hits of one FEM only, and bco_full is unwrapped for the FEM. All hits are taken if fem_id is -1.
+  The entries of the FEMs are found in one pass by SplitByFem, and the stream of a FEM reads only its ranges given by SetRanges,
+  so the file is read once for all FEMs. Without the ranges, fem_id of all entries is checked.
+*/
+class BcoHitStream
+{
+public:
+  BcoHitStream( int stream, std::string fname, std::string tree_name = "tree", int fem_id = -1 );
+  ~BcoHitStream();
+
+  bool IsOpen(){ return tree_ != nullptr; };
+
+  //! The next fragment is read. false is returned at the end.
+  bool Next( BcoFragment& fragment );
+
+  typedef std::pair < Long64_t, Long64_t > EntryRange; //!< [first, last + 1) of entries
+
+  /*!
+    @brief Entries of each FEM with hits with bco_full. Only fem_id and bco_full are read in one pass.
+    @retval Ranges of consecutive entries of the FEM (a record) for each FEM_ID, in increasing order of FEM_ID
+  */
+  std::map < int, std::vector < EntryRange > > SplitByFem();
+
+  //! Only the entries in the ranges are read, see SplitByFem
+  void SetRanges( const std::vector < EntryRange >& ranges ){ ranges_ = ranges; is_ranged_ = true; };
+
+  std::string GetName(){ return fname_; };
+  int GetFemId(){ return selected_fem_id_; };
+
+  Long64_t skipped_ = 0; //!< hits before the first bco_full word in a record, they are not used
+
+private:
+  int stream_;
+  std::string fname_;
+  int selected_fem_id_;
+  TFile* tf_ = nullptr;
+  TTree* tree_ = nullptr;
+  TBranch* fem_id_branch_ = nullptr;
+  TBranch* bco_full_branch_ = nullptr;
+  Long64_t entry_ = 0;
+  std::vector < EntryRange > ranges_;
+  size_t range_ = 0;
+  bool is_ranged_ = false;
+
+  // branches
+  int adc_, ampl_, chip_id_, fpga_id_, module_, chan_id_, fem_id_, bco_, bco_full_;
+
+  int last_bco_full_ = -1;
+  Long64_t wraps_ = 0;
+};
+
+/*!
+  @class BcoEventBuilder
+  @brief Hits in several decoded files (FELIX servers, FEMs) are merged into events by bco_full
+  @details A stream is made for each FEM of each file (BcoHitStream), since the FEMs in a file have their own bco_full counters.
+  The file is split by FEM in one pass, and each stream reads only the entries of its FEM.
+  The fragments of the streams are merged in the order of bco_full (k-way merge with a priority queue).
+  An event starts with the fragment with the smallest bco_full. The fragments whose bco_full is within the window from it are added to the event.
+  Only one fragment of each stream is in the memory, so the size of the files doesn't matter.
+  bco_full of each FEM must increase except the wrap-around at 65536, it's unwrapped stream by stream.
+
+  An event without fragments from all streams is incomplete, and its fragments are counted as orphans of the streams.
+  Events are filled to the TTree "event_tree" and the statistics are filled to "event_builder_stats".
+
+  How to use:
+    BcoEventBuilder builder;
+    builder.AddFile( "data/felix1.root" );
+    builder.AddFile( "data/felix2.root" );
+    builder.SetWindow( 1 );
+    builder.Build( "data/events.root" );
+*/
+class BcoEventBuilder
+{
+public:
+  BcoEventBuilder(){};
+  ~BcoEventBuilder();
+
+  //! A stream is added for each FEM in the file. false is returned if the file can't be read.
+  bool AddFile( std::string fname, std::string tree_name = "tree" );
+
+  //! Fragments within window BCOs from the first one are in the same event
+  void SetWindow( int window ){ window_ = window; };
+
+  //! Events are built and saved to the file. The number of the events is returned.
+  Long64_t Build( std::string output );
+
+  void Print( std::ostream& os = std::cout );
+
+  // statistics
+  Long64_t events_ = 0;
+  Long64_t complete_events_ = 0;
+  std::vector < Long64_t > fragments_;        //!< the number of fragments for each stream
+  std::vector < Long64_t > orphan_fragments_; //!< the number of fragments in incomplete events for each stream
+
+private:
+  int window_ = 0;
+  std::vector < BcoHitStream* > streams_;
+};
+
+#ifndef BCO_EVENT_BUILDER_source
+#define BCO_EVENT_BUILDER_source
+
+#include "BcoEventBuilder.cc"
+#endif //  BCO_EVENT_BUILDER_source
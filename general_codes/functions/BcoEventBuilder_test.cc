@@ -0,0 +1,88 @@
+#include "BcoEventBuilder.hh"
+
+/*!
+  @fn int BcoEventBuilder_test( string fname )
+  @brief Events are built from a file with two FEMs whose records are interleaved out of phase
+  @details Both FEMs record the same 4 triggers around the wrap-around of bco_full (65530, 65534, 2, 6),
+  but the records of FEM 2 are written 2 records later than FEM 1, so FEM 1 has wrapped while FEM 2 hasn't.
+  Each FEM has to be unwrapped by itself, and all 4 events have to be complete with one fragment of each FEM.
+  The file is split by FEM in one pass, and the records (3 entries each) of each FEM have to be found as ranges of entries.
+  Usage: root -l -b -q 'functions/BcoEventBuilder_test.cc+( "/tmp/BcoEventBuilder_test.root" )'
+  @retval The number of failed cases
+*/
+int BcoEventBuilder_test( string fname = "BcoEventBuilder_test.root" )
+{
+  int bco_fulls[4] = { 65530, 65534, 2, 6 };
+
+  // (fem_id, trigger) in the order of the file
+  vector < pair < int, int > > records = { { 1, 0 }, { 1, 1 }, { 1, 2 }, { 2, 0 }, { 1, 3 }, { 2, 1 }, { 2, 2 }, { 2, 3 } };
+
+  TDirectory* dir = gDirectory;
+  TFile* tf = new TFile( fname.c_str(), "RECREATE" );
+  int adc = 0, ampl = 0, chip_id = 0, fpga_id = 0, module = 0, chan_id = 0, fem_id = 0, bco = 0, bco_full = 0;
+  TTree* tree = new TTree( "tree", "hits of two FEMs" );
+  tree->Branch( "adc", &adc, "adc/I" );
+  tree->Branch( "ampl", &ampl, "ampl/I" );
+  tree->Branch( "chip_id", &chip_id, "chip_id/I" );
+  tree->Branch( "fpga_id", &fpga_id, "fpga_id/I" );
+  tree->Branch( "module", &module, "module/I" );
+  tree->Branch( "chan_id", &chan_id, "chan_id/I" );
+  tree->Branch( "fem_id", &fem_id, "fem_id/I" );
+  tree->Branch( "bco", &bco, "bco/I" );
+  tree->Branch( "bco_full", &bco_full, "bco_full/I" );
+  for( auto& record : records ){
+    fem_id = record.first;
+    module = fem_id;
+
+    // a hit before the first bco_full word and 2 hits after it
+    bco_full = -1;
+    tree->Fill();
+    bco_full = bco_fulls[ record.second ];
+    bco = bco_full & 0x7F;
+    for( chan_id=0; chan_id<2; chan_id++ )
+      tree->Fill();
+  }
+
+  tree->Write();
+  tf->Close();
+  delete tf;
+  dir->cd();
+
+  int failures = 0;
+  BcoHitStream stream( 0, fname );
+  map < int, vector < BcoHitStream::EntryRange > > ranges = stream.SplitByFem();
+  map < int, vector < BcoHitStream::EntryRange > > expected_ranges = {
+    { 1, { { 0, 9 }, { 12, 15 } } },
+    { 2, { { 9, 12 }, { 15, 24 } } }
+  };
+  dir->cd();
+
+  bool is_ok = ranges == expected_ranges;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " entries split by FEM: " << ranges.size() << " FEMs, "
+       << ( ranges.count( 1 ) ? ranges[1].size() : 0 ) << " + " << ( ranges.count( 2 ) ? ranges[2].size() : 0 ) << " ranges" << endl;
+
+  BcoEventBuilder builder;
+  builder.AddFile( fname );
+  builder.SetWindow( 0 );
+  Long64_t events = builder.Build( fname.substr( 0, fname.find_last_of( "." ) ) + "_events.root" );
+  builder.Print();
+
+  is_ok = builder.fragments_.size() == 2;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " a stream for each FEM: " << builder.fragments_.size() << " streams" << endl;
+
+  is_ok = events == 4 && builder.complete_events_ == 4;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " FEMs out of phase: " << builder.complete_events_ << "/" << events << " events complete, 4 expected" << endl;
+
+  remove( fname.c_str() );
+  remove( ( fname.substr( 0, fname.find_last_of( "." ) ) + "_events.root" ).c_str() );
+  return failures;
+}
@@ -0,0 +1,161 @@
+#include "CalibrationRecord.hh"
+
+std::vector < CalibrationRecordTree::Column > CalibrationRecordTree::GetColumns( CalibrationRecord& r )
+{
+  return {
+    { "source_id", 'I', &r.source_id },
+    { "module", 'I', &r.module },
+    { "chip_id", 'I', &r.chip_id },
+    { "chan_id", 'I', &r.chan_id },
+    { "is_noise", 'O', &r.is_noise },
+    { "is_unbonded", 'O', &r.is_unbonded },
+    { "is_entries_out", 'O', &r.is_entries_out },
+    { "chan_entry", 'I', &r.chan_entry },
+    { "ampl_chan_entry", 'I', &r.ampl_chan_entry },
+    { "entries_mean", 'D', &r.entries_mean },
+    { "entries_width", 'D', &r.entries_width },
+    { "ampl_entries_mean", 'D', &r.ampl_entries_mean },
+    { "ampl_entries_width", 'D', &r.ampl_entries_width },
+    { "Gaus_width", 'D', &r.Gaus_width },
+    { "Gaus_width02", 'D', &r.Gaus_width02 },
+    { "Gaus_width13", 'D', &r.Gaus_width13 },
+    { "TP_turnon", 'D', &r.TP_turnon },
+    { "TP_width", 'D', &r.TP_width },
+    { "TP_height", 'D', &r.TP_height },
+    { "slope_value", 'D', &r.slope_value },
+    { "slope_rchi2", 'D', &r.slope_rchi2 },
+    { "width_value", 'D', &r.width_value },
+    { "width_rchi2", 'D', &r.width_rchi2 },
+    { "adc0", 'D', &r.adc0 },
+    { "adc1", 'D', &r.adc1 },
+    { "adc2", 'D', &r.adc2 },
+    { "adc3", 'D', &r.adc3 },
+    { "adc4", 'D', &r.adc4 },
+    { "adc0N", 'D', &r.adc0N },
+    { "adc1N", 'D', &r.adc1N },
+    { "adc2N", 'D', &r.adc2N },
+    { "adc3N", 'D', &r.adc3N },
+    { "adc4N", 'D', &r.adc4N },
+    { "err_width0", 'D', &r.err_width0 },
+    { "err_width1", 'D', &r.err_width1 },
+    { "err_width2", 'D', &r.err_width2 },
+    { "err_width3", 'D', &r.err_width3 },
+    { "err_pvalue", 'D', &r.err_pvalue },
+    { "err_mean0", 'D', &r.err_mean0 },
+    { "err_mean1", 'D', &r.err_mean1 },
+    { "err_mean2", 'D', &r.err_mean2 },
+    { "err_mean3", 'D', &r.err_mean3 }
+  };
+}
+
+std::vector < std::string > CalibrationRecordTree::GetColumnNames()
+{
+  CalibrationRecord record;
+  std::vector < std::string > names;
+  for( auto& column : GetColumns( record ) )
+    names.push_back( column.name );
+
+  return names;
+}
+
+void CalibrationRecordTree::Book( TTree* tree )
+{
+  for( auto& column : GetColumns( record_ ) )
+    tree->Branch( column.name.c_str(), column.address, ( column.name + "/" + column.type ).c_str() );
+}
+
+void CalibrationRecordTree::Fill( TTree* tree )
+{
+  std::stable_sort( records_.begin(), records_.end(),
+		    []( const CalibrationRecord& a, const CalibrationRecord& b ){ return GetKey( a ) < GetKey( b ); } );
+
+  for( auto& record : records_ ){
+    record_ = record;
+    tree->Fill();
+  }
+
+  records_.clear();
+}
+
+int CalibrationRecordTree::SetBranchAddresses( TTree* tree, std::string columns )
+{
+  // "a,b,c" -> "a b c"
+  std::replace( columns.begin(), columns.end(), ',', ' ' );
+  std::istringstream iss( columns );
+  std::vector < std::string > names;
+  std::string name;
+  while( iss >> name )
+    names.push_back( name );
+
+  bool is_all = std::find( names.begin(), names.end(), "*" ) != names.end();
+  std::vector < std::string > all_names = GetColumnNames();
+  for( auto& name : names ){
+    if( name != "*" && std::find( all_names.begin(), all_names.end(), name ) == all_names.end() ){
+      std::cerr << "CalibrationRecordTree: " << name << " is not a column of " << kTreeName << std::endl;
+      return -1;
+    }
+  }
+
+  tree->SetBranchStatus( "*", 0 );
+  int num = 0;
+  for( auto& column : GetColumns( record_ ) ){
+    bool is_key = column.name == "source_id" || column.name == "module" || column.name == "chip_id" || column.name == "chan_id";
+    if( is_key == false && is_all == false && std::find( names.begin(), names.end(), column.name ) == names.end() )
+      continue;
+
+    if( tree->GetBranch( column.name.c_str() ) == nullptr ){
+      std::cerr << "CalibrationRecordTree: " << column.name << " is not found in " << tree->GetName() << std::endl;
+      return -1;
+    }
+
+    tree->SetBranchStatus( column.name.c_str(), 1 );
+    tree->SetBranchAddress( column.name.c_str(), column.address );
+    num++;
+  }
+
+  this->BuildIndex( tree );
+  return num;
+}
+
+void CalibrationRecordTree::BuildIndex( TTree* tree )
+{
+  // only the key branches are read. The branches are taken again when the file of a TChain changes.
+  const char* keys[4] = { "source_id", "module", "chip_id", "chan_id" };
+  TBranch* branches[4] = { nullptr, nullptr, nullptr, nullptr };
+  TTree* current = nullptr;
+  index_.clear();
+  index_.reserve( tree->GetEntries() );
+  for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+    Long64_t local = tree->LoadTree( i );
+    if( current != tree->GetTree() ){
+      current = tree->GetTree();
+      for( int j=0; j<4; j++ )
+	branches[j] = current->GetBranch( keys[j] );
+    }
+
+    for( int j=0; j<4; j++ )
+      branches[j]->GetEntry( local );
+
+    index_.push_back( std::make_pair( GetKey( record_ ), i ) );
+  }
+
+  std::sort( index_.begin(), index_.end() );
+  record_ = CalibrationRecord();
+}
+
+Long64_t CalibrationRecordTree::Find( int module, int chip_id, int chan_id, int source_id ) const
+{
+  // source_id is 0 or more, so the key with -1 is before all files of the channel
+  auto it = std::lower_bound( index_.begin(), index_.end(), std::make_pair( Key( module, chip_id, chan_id, source_id ), (Long64_t)-1 ) );
+  if( it == index_.end() )
+    return -1;
+
+  const Key& key = it->first;
+  if( std::get<0>( key ) != module || std::get<1>( key ) != chip_id || std::get<2>( key ) != chan_id )
+    return -1;
+
+  if( source_id >= 0 && std::get<3>( key ) != source_id )
+    return -1;
+
+  return it->second;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/*!
+  @struct CalibrationRecord
+  @brief All results of the calibration (Channel_classification/ladder_cali_BNL/template_v1/calibration_ana_code_multi.c) for a channel
+  @details The names are the same as the branches of the trees which were written before:
+  chan_gaus_width, chan_entry, ampl_channel_entries, chan_thre_position, chan_study, chan_adc_study, chan_err_width, and chan_err_mean.
+  Noise_check, Unbonded_check, and Entries_check are the flags, and Total_entries and ampl_total_entries are the entries_* columns,
+  which are the same for all channels of a file.
+*/
+struct CalibrationRecord
+{
+  // the key
+  Int_t source_id = -1;        //!< the index of the file in total_file.txt
+  Int_t module = -1;
+  Int_t chip_id = 0;           //!< 1-26
+  Int_t chan_id = 0;           //!< 0-127
+
+  // the flags
+  Bool_t is_noise = false;     //!< Gaus_width >= the noise cut or 0 (Noise_check)
+  Bool_t is_unbonded = false;  //!< 0 < Gaus_width < the noise cut (Unbonded_check)
+  Bool_t is_entries_out = false; //!< chan_entry is out of the entry cuts (Entries_check)
+
+  // the entries
+  Int_t chan_entry = 0;        //!< without the ampl cut
+  Int_t ampl_chan_entry = 0;   //!< after the ampl cut
+  Double_t entries_mean = 0;   //!< mean and std dev of chan_entry of all channels in the file
+  Double_t entries_width = 0;
+  Double_t ampl_entries_mean = 0;  //!< the same for ampl_chan_entry
+  Double_t ampl_entries_width = 0;
+
+  // the gaussian width of the ADC response
+  Double_t Gaus_width = 0;
+  Double_t Gaus_width02 = 0;   //!< ADC0 and ADC2
+  Double_t Gaus_width13 = 0;   //!< ADC1 and ADC3
+
+  // the S-curve of the threshold scan
+  Double_t TP_turnon = 0;
+  Double_t TP_width = 0;
+  Double_t TP_height = 0;
+
+  // the linearity and the width consistency
+  Double_t slope_value = 0;
+  Double_t slope_rchi2 = 0;
+  Double_t width_value = 0;
+  Double_t width_rchi2 = 0;
+
+  // the mean of the ampl of each ADC, by the fit and numeric
+  Double_t adc0 = 0, adc1 = 0, adc2 = 0, adc3 = 0, adc4 = 0;
+  Double_t adc0N = 0, adc1N = 0, adc2N = 0, adc3N = 0, adc4N = 0;
+
+  // the err fit of each ADC
+  Double_t err_width0 = 0, err_width1 = 0, err_width2 = 0, err_width3 = 0;
+  Double_t err_pvalue = 0;
+  Double_t err_mean0 = 0, err_mean1 = 0, err_mean2 = 0, err_mean3 = 0;
+};
+
+/*!
+  @class CalibrationRecordTree
+  @brief The calibration results are stored as one TTree "calibration_record" with an entry for each channel and a branch for each column
+  @details 13 trees (one for each study, and Noise_check and so on only for the flagged channels) were written to <name>_summary.root,
+  and cut_finder.c and ladder_summary.c read 6-8 of them with GetEntry in lockstep, assuming that all trees had the channels in the same order.
+  Now a channel is a row of one table, and a reader enables only the branches it needs, so the other columns aren't read from the file.
+  The entries are sorted by module, chip_id, chan_id, and source_id when they're written, and an index of these keys is made for reading,
+  so a channel can be found by the key. The index is made by reading the key branches only, and it works for a hadd of the files as well.
+
+  Writing:
+    CalibrationRecordTree records;
+    records.Book( tree );                        // branches are made
+    records.Add( record );                       // the records of the channels are kept
+    records.Fill( tree );                        // they are sorted and filled
+
+  Reading:
+    CalibrationRecordTree records;
+    records.SetBranchAddresses( tree, "Gaus_width,chan_entry,TP_turnon" ); // the keys and these columns, "*" for all
+    for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+      records.GetEntry( tree, i );
+      records.record_.Gaus_width ...
+    }
+    Long64_t entry = records.Find( module, chip_id, chan_id ); // -1 if it's not found
+*/
+class CalibrationRecordTree
+{
+public:
+  static constexpr const char* kTreeName = "calibration_record";
+
+  CalibrationRecord record_; //!< the entry read by GetEntry
+
+  CalibrationRecordTree(){};
+
+  //! Branches of all columns are made in the given tree
+  void Book( TTree* tree );
+
+  //! The record is kept until Fill
+  void Add( const CalibrationRecord& record ){ records_.push_back( record ); };
+
+  //! The kept records are sorted by the key and filled, and they are cleared
+  void Fill( TTree* tree );
+
+  /*!
+    @brief For reading, the key columns and the given columns are set to record_, and the other branches are disabled
+    @param columns Names separated by ",", "*" for all columns
+    @retval The number of the set columns, -1 if a column isn't in the tree
+  */
+  int SetBranchAddresses( TTree* tree, std::string columns = "*" );
+
+  //! The enabled columns of the entry are read to record_
+  Int_t GetEntry( TTree* tree, Long64_t entry ){ return tree->GetEntry( entry ); };
+
+  //! The entry of the channel, the first file ( smallest source_id ) if source_id is -1. -1 if it's not found.
+  Long64_t Find( int module, int chip_id, int chan_id, int source_id = -1 ) const;
+
+  //! Names of all columns in the order of the branches
+  static std::vector < std::string > GetColumnNames();
+
+private:
+  struct Column
+  {
+    std::string name;
+    char type; //!< I, D, or O of the leaf list
+    void* address;
+  };
+
+  typedef std::tuple < int, int, int, int > Key; //!< module, chip_id, chan_id, source_id
+
+  std::vector < CalibrationRecord > records_;
+  std::vector < std::pair < Key, Long64_t > > index_;
+
+  //! The columns bound to the record
+  static std::vector < Column > GetColumns( CalibrationRecord& record );
+
+  static Key GetKey( const CalibrationRecord& record )
+  {
+    return Key( record.module, record.chip_id, record.chan_id, record.source_id );
+  };
+
+  //! The index is made from the key branches
+  void BuildIndex( TTree* tree );
+};
+
+#ifndef CALIBRATION_RECORD_source
+#define CALIBRATION_RECORD_source
+
+#include "CalibrationRecord.cc"
+#endif //  CALIBRATION_RECORD_source
@@ -0,0 +1,157 @@
+#include "ChannelMask.hh"
+
+int ChannelMask::Load( std::string fname, int module, int ladder_id )
+{
+  if( module < 0 || kModule_num <= module ){
+    cerr << "ChannelMask::Load: module " << module << " is out of range" << endl;
+    return -1;
+  }
+
+  int counter = 0;
+  if( fname.substr( fname.find_last_of( "." ) + 1 ) == "root" ){
+    TFile* tf = TFile::Open( fname.c_str(), "READ" );
+    if( tf == nullptr || tf->IsZombie() ){
+      cerr << "ChannelMask::Load: " << fname << " cannot be opened" << endl;
+      return -1;
+    }
+
+    TTree* tree = (TTree*)tf->Get( "bad_channel_detail" );
+    if( tree == nullptr ){
+      cerr << "ChannelMask::Load: bad_channel_detail is not found in " << fname << endl;
+      tf->Close();
+      return -1;
+    }
+
+    int ladder = -1, chip_id = -1, chan_id = -1;
+    tree->SetBranchAddress( "ladder_id", &ladder );
+    tree->SetBranchAddress( "chip_id", &chip_id );
+    tree->SetBranchAddress( "chan_id", &chan_id );
+    for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+      tree->GetEntry( i );
+      if( ladder_id != -1 && ladder != ladder_id )
+	continue;
+
+      this->Mask( module, chip_id, chan_id );
+      counter++;
+    }
+
+    tf->Close();
+    return counter;
+  }
+
+  // bad_channel_detail.txt: ladder_id chip_id chan_id decode, lines ending with "\r"
+  ifstream ifs( fname );
+  if( ifs.fail() ){
+    cerr << "ChannelMask::Load: " << fname << " cannot be opened" << endl;
+    return -1;
+  }
+
+  string line;
+  while( getline( ifs, line ) ){
+    istringstream iss( line );
+    int ladder, chip_id, chan_id;
+    if( !( iss >> ladder >> chip_id >> chan_id ) )
+      continue; // the total number at the end
+
+    if( ladder_id != -1 && ladder != ladder_id )
+      continue;
+
+    this->Mask( module, chip_id, chan_id );
+    counter++;
+  }
+
+  return counter;
+}
+
+int ChannelMask::Load( std::string list )
+{
+  int counter = 0;
+  istringstream iss( list );
+  string item;
+  while( getline( iss, item, ',' ) ){
+    if( item == "" )
+      continue;
+
+    // module=file[:ladder_id]
+    size_t equal = item.find( "=" );
+    if( equal == string::npos ){
+      cerr << "ChannelMask::Load: \"" << item << "\" is not module=file[:ladder_id]" << endl;
+      return -1;
+    }
+
+    int module = stoi( item.substr( 0, equal ) );
+    string fname = item.substr( equal + 1 );
+    int ladder_id = -1;
+    size_t colon = fname.find_last_of( ":" );
+    if( colon != string::npos && fname.find_first_not_of( "0123456789", colon + 1 ) == string::npos && colon + 1 != fname.size() ){
+      ladder_id = stoi( fname.substr( colon + 1 ) );
+      fname = fname.substr( 0, colon );
+    }
+
+    int num = this->Load( fname, module, ladder_id );
+    if( num < 0 )
+      return -1;
+
+    counter += num;
+  }
+
+  return counter;
+}
+
+void ChannelMask::Mask( int module, int chip_id, int chan_id, bool status )
+{
+  if( module < 0 || kModule_num <= module || chip_id < 1 || kChip_num < chip_id || chan_id < 0 || kChan_num <= chan_id ){
+    cerr << "ChannelMask::Mask: module " << module << " chip " << chip_id << " chan " << chan_id << " is out of range" << endl;
+    return;
+  }
+
+  masks_[module][ ( chip_id - 1 ) * kChan_num + chan_id ] = status;
+}
+
+bool ChannelMask::IsEmpty() const
+{
+  for( int module=0; module<kModule_num; module++ )
+    if( masks_[module].any() )
+      return false;
+
+  return true;
+}
+
+int ChannelMask::GetMaskedNum( int module ) const
+{
+  if( module != -1 )
+    return ( 0 <= module && module < kModule_num ) ? masks_[module].count() : 0;
+
+  int counter = 0;
+  for( int i=0; i<kModule_num; i++ )
+    counter += masks_[i].count();
+
+  return counter;
+}
+
+void ChannelMask::Clear()
+{
+  for( int module=0; module<kModule_num; module++ )
+    masks_[module].reset();
+}
+
+void ChannelMask::Print( std::ostream& os ) const
+{
+  os << "+--- Channel mask --------------------------------------" << endl;
+  for( int module=0; module<kModule_num; module++ ){
+    if( masks_[module].none() )
+      continue;
+
+    os << "| module " << setw(2) << module << ": " << masks_[module].count() << " channels, chip:channels";
+    for( int chip=1; chip<=kChip_num; chip++ ){
+      int num = 0;
+      for( int chan=0; chan<kChan_num; chan++ )
+	num += masks_[module][ ( chip - 1 ) * kChan_num + chan ];
+
+      if( num != 0 )
+	os << " " << chip << ":" << num;
+    }
+    os << endl;
+  }
+  os << "+-------------------------------------------------------" << endl;
+}
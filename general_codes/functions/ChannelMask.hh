@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bitset>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/*!
+  @class ChannelMask
+  @brief Bad (hot or dead) channels are masked when the data is decoded or clustered
+  @details A mask is a bitset of 26 chips x 128 channels for each module. Hits in masked channels are not filled to the trees by MakeTree (FelixDecoder),
+  and they are ignored by INTTClusterer, so the following analyses don't need cuts on the channels.
+
+  Masked channels are taken from the output of the channel classification (Channel_classification/ladder_cali_BNL/template_v1/ladder_summary.c):
+    - bad_channel_summary.root: the TTree "bad_channel_detail" with the branches ladder_id, chip_id, and chan_id
+    - bad_channel_detail.txt  : lines of "ladder_id chip_id chan_id decode"
+  ladder_id is 0 or 1 in the classification (two ladders are calibrated at once). A module is given for each ladder_id.
+  Channels can be masked by hand by Mask() as well.
+
+  How to use:
+    ChannelMask mask;
+    mask.Load( "ladder_files/B1L101/bad_channel_summary.root", 5, 0 ); // ladder 0 in the file is module 5
+    mask.Load( "5=a/bad_channel_summary.root:0,6=a/bad_channel_summary.root:1" ); // the same in one string, used by MakeTree
+    mask.Mask( 5, 10, 64 );
+    if( mask.IsMasked( module, chip_id, chan_id ) ) ...
+*/
+class ChannelMask
+{
+public:
+  static const int kModule_num = 16;
+  static const int kChip_num = 26;
+  static const int kChan_num = 128;
+
+  ChannelMask(){};
+
+  /*!
+    @brief Bad channels of the ladder in the classification output are masked for the module
+    @param fname bad_channel_summary.root or bad_channel_detail.txt
+    @param module The module ID which the ladder is connected to
+    @param ladder_id ladder_id in the file, -1 for all
+    @retval The number of masked channels in the file, -1 in the case of an error
+  */
+  int Load( std::string fname, int module, int ladder_id = -1 );
+
+  /*!
+    @brief Masks are loaded from a list of "module=file[:ladder_id]" separated by ","
+    @retval The number of masked channels, -1 in the case of an error
+  */
+  int Load( std::string list );
+
+  void Mask( int module, int chip_id, int chan_id, bool status = true );
+
+  //! true if the channel is masked. chip_id is 1-26, chan_id is 0-127. Channels out of the ranges are not masked.
+  bool IsMasked( int module, int chip_id, int chan_id ) const
+  {
+    if( module < 0 || kModule_num <= module || chip_id < 1 || kChip_num < chip_id || chan_id < 0 || kChan_num <= chan_id )
+      return false;
+
+    return masks_[module][ ( chip_id - 1 ) * kChan_num + chan_id ];
+  };
+
+  //! true if no channel is masked
+  bool IsEmpty() const;
+
+  //! The number of masked channels, for all modules if module is -1
+  int GetMaskedNum( int module = -1 ) const;
+
+  void Clear();
+  void Print( std::ostream& os = std::cout ) const;
+
+private:
+  std::bitset < kChip_num * kChan_num > masks_[kModule_num];
+};
+
+#ifndef CHANNEL_MASK_source
+#define CHANNEL_MASK_source
+
+#include "ChannelMask.cc"
+#endif //  CHANNEL_MASK_source
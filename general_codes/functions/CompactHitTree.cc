@@ -0,0 +1,209 @@
+#include "CompactHitTree.hh"
+
+bool CompactFormat::Parse( std::string format )
+{
+  // "compact:zstd:5:32000:-30000000" -> "compact zstd 5 32000 -30000000"
+  std::replace( format.begin(), format.end(), ':', ' ' );
+  std::istringstream iss( format );
+
+  std::string name;
+  if( !( iss >> name ) || name != "compact" )
+    return false;
+
+  std::string temp_algorithm;
+  if( iss >> temp_algorithm ){
+    algorithm = temp_algorithm;
+    iss >> level >> basket_size >> auto_flush;
+  }
+
+  if( this->GetCompressionSettings() < 0 ){
+    std::cerr << "Unknown compression algorithm \"" << algorithm << "\". zlib, lzma, lz4, and zstd are available." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int CompactFormat::GetCompressionSettings() const
+{
+  // the same numbers as ROOT::RCompressionSetting::EAlgorithm
+  int id = -1;
+  if( algorithm == "zlib" )
+    id = 1;
+  else if( algorithm == "lzma" )
+    id = 2;
+  else if( algorithm == "lz4" )
+    id = 4;
+  else if( algorithm == "zstd" )
+    id = 5;
+  else
+    return -1;
+
+  return id * 100 + level;
+}
+
+std::string CompactFormat::GetName() const
+{
+  return "compact:" + algorithm + ":" + std::to_string( level ) + ":" + std::to_string( basket_size ) + ":" + std::to_string( auto_flush );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// CompactHitTree
+/////////////////////////////////////////////////////////////////////////////////////////////
+void CompactHitTree::Resize( size_t size )
+{
+  if( size <= adcs_.size() )
+    return;
+
+  adcs_.resize( size );
+  ampls_.resize( size );
+  chip_ids_.resize( size );
+  fpga_ids_.resize( size );
+  chan_ids_.resize( size );
+  bcos_.resize( size );
+  modules_.resize( size );
+}
+
+void CompactHitTree::Bind( TTree* tree )
+{
+  // addresses of the arrays change when the vectors are resized
+  tree->SetBranchAddress( "adc", &adcs_[0] );
+  tree->SetBranchAddress( "ampl", &ampls_[0] );
+  tree->SetBranchAddress( "chip_id", &chip_ids_[0] );
+  tree->SetBranchAddress( "fpga_id", &fpga_ids_[0] );
+  tree->SetBranchAddress( "chan_id", &chan_ids_[0] );
+  tree->SetBranchAddress( "bco", &bcos_[0] );
+  tree->SetBranchAddress( "module", &modules_[0] );
+  bound_ = &adcs_[0];
+}
+
+void CompactHitTree::Book( TTree* tree, const CompactFormat& format )
+{
+  this->Resize( 256 );
+  tree->Branch( "nhits", &nhits_, "nhits/i" );
+  tree->Branch( "has_bco_full", &has_bco_full_, "has_bco_full/O" );
+  tree->Branch( "dbco_full", &dbco_full_, "dbco_full/S" );
+  tree->Branch( "fem_id", &fem_id_, "fem_id/B" );
+  tree->Branch( "adc", &adcs_[0], "adc[nhits]/b" );
+  tree->Branch( "ampl", &ampls_[0], "ampl[nhits]/b" );
+  tree->Branch( "chip_id", &chip_ids_[0], "chip_id[nhits]/b" );
+  tree->Branch( "fpga_id", &fpga_ids_[0], "fpga_id[nhits]/b" );
+  tree->Branch( "chan_id", &chan_ids_[0], "chan_id[nhits]/b" );
+  tree->Branch( "bco", &bcos_[0], "bco[nhits]/b" );
+  tree->Branch( "module", &modules_[0], "module[nhits]/B" );
+  bound_ = &adcs_[0];
+
+  tree->SetBasketSize( "*", format.basket_size );
+  tree->SetAutoFlush( format.auto_flush );
+}
+
+void CompactHitTree::AddHit( TTree* tree, int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id, int fem_id, int bco, int bco_full )
+{
+  if( nhits_ > 0 && ( fem_id != fem_id_ || bco_full != bco_full_ ) )
+    this->Flush( tree );
+
+  if( nhits_ == 0 ){
+    fem_id_ = fem_id;
+    bco_full_ = bco_full;
+  }
+
+  if( nhits_ == adcs_.size() )
+    this->Resize( 2 * adcs_.size() );
+
+  adcs_[nhits_] = adc;
+  ampls_[nhits_] = ampl;
+  chip_ids_[nhits_] = chip_id;
+  fpga_ids_[nhits_] = fpga_id;
+  chan_ids_[nhits_] = chan_id;
+  bcos_[nhits_] = bco;
+  modules_[nhits_] = module;
+  nhits_++;
+}
+
+void CompactHitTree::Flush( TTree* tree )
+{
+  if( nhits_ == 0 )
+    return;
+
+  // bco_full is coded as the difference from the previous one
+  has_bco_full_ = ( bco_full_ >= 0 );
+  dbco_full_ = 0;
+  if( has_bco_full_ ){
+    dbco_full_ = (Short_t)( ( bco_full_ - last_bco_full_ ) & 0xFFFF );
+    last_bco_full_ = bco_full_;
+  }
+
+  if( bound_ != &adcs_[0] )
+    this->Bind( tree );
+
+  tree->Fill();
+  event_ += nhits_;
+  nhits_ = 0;
+}
+
+void CompactHitTree::SetBranchAddresses( TTree* tree )
+{
+  this->Resize( std::max( 256, (int)tree->GetMaximum( "nhits" ) ) );
+
+  tree->SetBranchAddress( "nhits", &nhits_ );
+  tree->SetBranchAddress( "has_bco_full", &has_bco_full_ );
+  tree->SetBranchAddress( "dbco_full", &dbco_full_ );
+  tree->SetBranchAddress( "fem_id", &fem_id_ );
+  this->Bind( tree );
+
+  last_bco_full_ = 0;
+  event_ = 0;
+  nhits_ = 0;
+}
+
+Int_t CompactHitTree::GetEntry( TTree* tree, Long64_t entry )
+{
+  // event_ is the serial number of the first hit
+  event_ += nhits_;
+
+  Int_t bytes = tree->GetEntry( entry );
+  if( has_bco_full_ ){
+    bco_full_ = ( last_bco_full_ + dbco_full_ ) & 0xFFFF;
+    last_bco_full_ = bco_full_;
+  }
+  else{
+    bco_full_ = -1;
+  }
+
+  return bytes;
+}
+
+void CompactHitTree::CopyTo( TTree* tree, CompactHitTree& output )
+{
+  output.Flush( tree );
+  output.Resize( nhits_ );
+  for( UInt_t i=0; i<nhits_; i++ ){
+    output.adcs_[i] = adcs_[i];
+    output.ampls_[i] = ampls_[i];
+    output.chip_ids_[i] = chip_ids_[i];
+    output.fpga_ids_[i] = fpga_ids_[i];
+    output.chan_ids_[i] = chan_ids_[i];
+    output.bcos_[i] = bcos_[i];
+    output.modules_[i] = modules_[i];
+  }
+
+  output.nhits_ = nhits_;
+  output.fem_id_ = fem_id_;
+  output.bco_full_ = bco_full_;
+  output.Flush( tree );
+}
+
+void CompactHitTree::Attach( TTree* tree, Int_t last_bco_full )
+{
+  // the arrays are resized by CopyTo and AddHit, so the entries aren't read to get the maximum of nhits
+  this->Resize( 256 );
+  tree->SetBranchAddress( "nhits", &nhits_ );
+  tree->SetBranchAddress( "has_bco_full", &has_bco_full_ );
+  tree->SetBranchAddress( "dbco_full", &dbco_full_ );
+  tree->SetBranchAddress( "fem_id", &fem_id_ );
+  this->Bind( tree );
+
+  last_bco_full_ = last_bco_full;
+  event_ = 0;
+  nhits_ = 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*!
+  @struct CompactFormat
+  @brief Settings of the compact hit format: compression algorithm and level, basket size, and AutoFlush
+  @details It's given as a string "compact[:algorithm[:level[:basket_size[:auto_flush]]]]", for example,
+    "compact"                   : ZSTD level 5 with the default basket size and AutoFlush
+    "compact:lz4:4"             : LZ4 level 4
+    "compact:lzma:8:256000:-50000000" : LZMA level 8, 256 kB baskets, flushed every 50 MB
+  Algorithms: zlib, lzma, lz4, zstd
+*/
+struct CompactFormat
+{
+  std::string algorithm = "zstd";
+  int level = 5;
+  int basket_size = 32000;            //!< bytes, TTree::SetBasketSize
+  Long64_t auto_flush = -30000000;    //!< TTree::SetAutoFlush, negative for bytes and positive for entries
+
+  //! false is returned for a string not starting with "compact" or an unknown algorithm
+  bool Parse( std::string format );
+
+  //! algorithm * 100 + level for TFile::SetCompressionSettings, -1 for an unknown algorithm
+  int GetCompressionSettings() const;
+
+  std::string GetName() const;
+};
+
+/*!
+  @class CompactHitTree
+  @brief Hits are stored as packed columns of events with narrow types, instead of a 32-bit int branch for each hit
+  @details An entry is an "event", consecutive hits with the same FEM_ID and bco_full.
+  Branches of the TTree "tree_compact":
+    nhits/i               the number of hits
+    has_bco_full/O        false if the hits come before the bco_full word in a record (bco_full = -1)
+    dbco_full/S           bco_full - bco_full of the previous entry with bco_full, modulo 65536
+    fem_id/B              -1 before the FEM_ID word
+    adc, ampl, chip_id, fpga_id, chan_id, bco [nhits]/b
+    module[nhits]/B       -1 for an unknown FEM_ID
+  The serial number of hits (branch "event" of "tree") is the sum of nhits of the entries before, so it's not stored.
+  The raw word (branch "command") isn't stored either.
+
+  Writing:
+    CompactHitTree compact;
+    compact.Book( tree );       // branches are made
+    compact.AddHit( tree, ... ); // an entry is filled when FEM_ID or bco_full changes
+    compact.Flush( tree );      // at the end of a record
+
+  Reading:
+    CompactHitTree compact;
+    compact.SetBranchAddresses( tree );
+    for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+      compact.GetEntry( tree, i ); // bco_full_ is decoded
+      for( int j=0; j<compact.nhits_; j++ ) compact.chan_ids_[j] ...
+    }
+
+  Appending to a tree written before:
+    CompactHitTree compact;
+    compact.Attach( tree, last_bco_full ); // GetLastBcoFull() of the writer of the tree
+    compact_from.CopyTo( tree, compact );   // for each entry read by compact_from
+*/
+class CompactHitTree
+{
+public:
+  UInt_t nhits_ = 0;
+  Int_t bco_full_ = -1; //!< decoded bco_full of this entry
+  Char_t fem_id_ = -1;
+  std::vector < UChar_t > adcs_, ampls_, chip_ids_, fpga_ids_, chan_ids_, bcos_;
+  std::vector < Char_t > modules_;
+  Long64_t event_ = 0; //!< serial number of the first hit in the entry read by GetEntry
+
+  CompactHitTree(){};
+
+  //! Branches are made in the given tree
+  void Book( TTree* tree, const CompactFormat& format = CompactFormat() );
+
+  //! A hit is added. The hits kept so far are filled as an entry if FEM_ID or bco_full is different.
+  void AddHit( TTree* tree, int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id, int fem_id, int bco, int bco_full );
+
+  //! The hits kept so far are filled as an entry
+  void Flush( TTree* tree );
+
+  //! For reading, the branches of the tree are set to this object
+  void SetBranchAddresses( TTree* tree );
+
+  //! The entry is read and bco_full is decoded. Entries must be read from the beginning in order.
+  Int_t GetEntry( TTree* tree, Long64_t entry );
+
+  //! The current entry (read by GetEntry) is filled to another tree booked by another CompactHitTree
+  void CopyTo( TTree* tree, CompactHitTree& output );
+
+  //! For appending, the branches of the tree are set to this object, and bco_full is coded as the difference from last_bco_full
+  void Attach( TTree* tree, Int_t last_bco_full );
+
+  //! bco_full of the last filled (or read) entry with bco_full, the base of the delta coding of the next entry
+  Int_t GetLastBcoFull() const { return last_bco_full_; };
+
+private:
+  Short_t dbco_full_ = 0;
+  Bool_t has_bco_full_ = false;
+  Int_t last_bco_full_ = 0; //!< bco_full of the previous entry with bco_full, for the delta coding
+  const void* bound_ = nullptr; //!< the address of the vectors given to the tree
+
+  void Resize( size_t size );
+  void Bind( TTree* tree );
+};
+
+#ifndef COMPACT_HIT_TREE_source
+#define COMPACT_HIT_TREE_source
+
+#include "CompactHitTree.cc"
+#endif //  COMPACT_HIT_TREE_source
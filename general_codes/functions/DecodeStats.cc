@@ -0,0 +1,144 @@
+#include "DecodeStats.hh"
+
+void DecodeStats::AddBuffer( int bufid )
+{
+  if( bufid == 100 )
+    buffers_[ kConfiguration ]++;
+  else if( bufid == 101 )
+    buffers_[ kTimestamp ]++;
+  else if( bufid == 102 )
+    buffers_[ kData ]++;
+  else
+    buffers_[ kUnknownBuffer ]++;
+}
+
+void DecodeStats::AddHit( int fem, int chip )
+{
+  hits_++;
+  if( fem < 0 || fem >= kNFems || chip < 0 || chip >= kNChips ){
+    unknown_words_++;
+    return;
+  }
+
+  hits_fem_chip_[fem][chip]++;
+}
+
+void DecodeStats::AddBco( int bco, int modulo, bool count )
+{
+  if( count && last_bco_ >= 0 ){
+    int gap = ( ( bco - last_bco_ ) % modulo + modulo ) % modulo;
+
+    int bin = 0;
+    while( gap > 0 && bin < kNBcoGapBins - 1 ){
+      gap >>= 1;
+      bin++;
+    }
+
+    bco_gaps_[bin]++;
+  }
+
+  last_bco_ = bco;
+}
+
+void DecodeStats::Add( const DecodeStats& stats )
+{
+  for( int i=0; i<kNBufferTypes; i++ )
+    buffers_[i] += stats.buffers_[i];
+
+  bad_checksums_ += stats.bad_checksums_;
+  partial_buffers_ += stats.partial_buffers_;
+  words_ += stats.words_;
+  hits_ += stats.hits_;
+  unknown_words_ += stats.unknown_words_;
+  masked_hits_ += stats.masked_hits_;
+
+  for( int fem=0; fem<kNFems; fem++ )
+    for( int chip=0; chip<kNChips; chip++ )
+      hits_fem_chip_[fem][chip] += stats.hits_fem_chip_[fem][chip];
+
+  for( int i=0; i<kNBcoGapBins; i++ )
+    bco_gaps_[i] += stats.bco_gaps_[i];
+}
+
+void DecodeStats::Write( std::string name )
+{
+  TTree* tree = new TTree( name.c_str(), "statistics of the decoding" );
+  tree->Branch( "buffers", buffers_, Form( "buffers[%d]/L", kNBufferTypes ) );
+  tree->Branch( "bad_checksum", &bad_checksums_, "bad_checksum/L" );
+  tree->Branch( "partial_buffer", &partial_buffers_, "partial_buffer/L" );
+  tree->Branch( "words", &words_, "words/L" );
+  tree->Branch( "hits", &hits_, "hits/L" );
+  tree->Branch( "unknown_words", &unknown_words_, "unknown_words/L" );
+  tree->Branch( "masked_hits", &masked_hits_, "masked_hits/L" );
+  tree->Branch( "hits_fem_chip", hits_fem_chip_, Form( "hits_fem_chip[%d][%d]/L", kNFems, kNChips ) );
+  tree->Branch( "bco_gap", bco_gaps_, Form( "bco_gap[%d]/L", kNBcoGapBins ) );
+  tree->Fill();
+  tree->Write();
+}
+
+bool DecodeStats::Read( TDirectory* dir, std::string name )
+{
+  TTree* tree = (TTree*)dir->Get( name.c_str() );
+  if( tree == nullptr || tree->GetEntries() == 0 )
+    return false;
+
+  tree->SetBranchAddress( "buffers", buffers_ );
+  tree->SetBranchAddress( "bad_checksum", &bad_checksums_ );
+  tree->SetBranchAddress( "partial_buffer", &partial_buffers_ );
+  tree->SetBranchAddress( "words", &words_ );
+  tree->SetBranchAddress( "hits", &hits_ );
+  tree->SetBranchAddress( "unknown_words", &unknown_words_ );
+  if( tree->GetBranch( "masked_hits" ) != nullptr ) // not in files made before the channel mask
+    tree->SetBranchAddress( "masked_hits", &masked_hits_ );
+  tree->SetBranchAddress( "hits_fem_chip", hits_fem_chip_ );
+  tree->SetBranchAddress( "bco_gap", bco_gaps_ );
+  tree->GetEntry( 0 );
+  tree->ResetBranchAddresses();
+  return true;
+}
+
+void DecodeStats::Print( std::ostream& os ) const
+{
+  os << "+--- Decode statistics ---------------------------------" << std::endl;
+  os << "| Records           : " << buffers_[ kConfiguration ] + buffers_[ kTimestamp ] + buffers_[ kData ] + buffers_[ kUnknownBuffer ]
+     << " (configuration " << buffers_[ kConfiguration ]
+     << ", time stamp " << buffers_[ kTimestamp ]
+     << ", data " << buffers_[ kData ]
+     << ", unknown " << buffers_[ kUnknownBuffer ] << ")" << std::endl;
+  os << "| Bad checksum      : " << bad_checksums_ << std::endl;
+  os << "| Partial records   : " << partial_buffers_ << std::endl;
+  os << "| Data words        : " << words_ << std::endl;
+  os << "| Hits              : " << hits_ << std::endl;
+  os << "| Unknown words     : " << unknown_words_ << std::endl;
+  os << "| Masked hits       : " << masked_hits_ << std::endl;
+
+  // only FEMs with hits are shown
+  for( int fem=0; fem<kNFems; fem++ ){
+    Long64_t sum = 0;
+    for( int chip=0; chip<kNChips; chip++ )
+      sum += hits_fem_chip_[fem][chip];
+
+    if( sum == 0 )
+      continue;
+
+    os << "| FEM " << std::setw(2) << fem << " hits " << sum << ", chip:hits";
+    for( int chip=0; chip<kNChips; chip++ )
+      if( hits_fem_chip_[fem][chip] != 0 )
+	os << " " << chip << ":" << hits_fem_chip_[fem][chip];
+    os << std::endl;
+  }
+
+  os << "| BCO gap           :";
+  for( int bin=0; bin<kNBcoGapBins; bin++ ){
+    if( bco_gaps_[bin] == 0 )
+      continue;
+
+    if( bin == 0 )
+      os << " [0]:";
+    else
+      os << " [" << (1 << (bin-1)) << "," << (1 << bin) << "):";
+    os << bco_gaps_[bin];
+  }
+  os << std::endl;
+  os << "+-------------------------------------------------------" << std::endl;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+/*!
+  @class DecodeStats
+  @brief Statistics of decoding a .dat file. They are counted instead of printing a line for each hit or record.
+  @details Counters and histograms of
+    - the number of records for each buffer id (configuration, time stamp, data, unknown),
+    - records with a bad checksum,
+    - partially-written records at the end of the file,
+    - hits for each FEM (or module) and chip,
+    - gaps between consecutive BCO values,
+    - unknown words (words which cannot be decoded as a hit),
+    - hits in masked channels, which are not filled (see ChannelMask).
+  They are written to the current directory as the TTree "decode_stats" with one entry (Write), and shown as a text report (Print).
+  DecodeStats of files or threads can be summed by Add.
+
+  The verbosity is given to FelixDecoder (MakeTree) and FphxRecordDecoder (fphx_raw2root) to select the console outputs:
+    kQuiet   : nothing during the decoding, no report
+    kSummary : the report at the end, and the configuration records (default)
+    kRecord  : a line for each record in addition
+    kHit     : a line for each hit in addition, as MakeTree did before
+*/
+class DecodeStats
+{
+public:
+  enum Verbosity { kQuiet = 0, kSummary = 1, kRecord = 2, kHit = 3 };
+  enum BufferType { kConfiguration = 0, kTimestamp, kData, kUnknownBuffer, kNBufferTypes };
+
+  static const int kNFems = 16;     //!< FEM id is 4 bits
+  static const int kNChips = 64;    //!< raw chip id is 6 bits
+  static const int kNBcoGapBins = 18; //!< bin 0: gap 0, bin k: 2^(k-1) <= gap < 2^k
+
+  Long64_t buffers_[kNBufferTypes] = { 0 };
+  Long64_t bad_checksums_ = 0;
+  Long64_t partial_buffers_ = 0;
+  Long64_t words_ = 0;          //!< data words in data records
+  Long64_t hits_ = 0;
+  Long64_t unknown_words_ = 0;
+  Long64_t masked_hits_ = 0;
+  Long64_t hits_fem_chip_[kNFems][kNChips] = { { 0 } };
+  Long64_t bco_gaps_[kNBcoGapBins] = { 0 };
+
+  DecodeStats(){};
+
+  //! A record with the buffer id is counted. 100: configuration, 101: time stamp, 102: data
+  void AddBuffer( int bufid );
+
+  //! A filled hit of the FEM (module) and the chip is counted, hits in masked channels are not. Out of range values are counted as unknown words.
+  void AddHit( int fem, int chip );
+
+  /*!
+    @brief A BCO value is given. The gap from the previous value is counted.
+    @param bco The BCO value
+    @param modulo The range of the BCO counter, the gap is taken modulo this value
+    @param count If false, the value is only kept as the previous value
+  */
+  void AddBco( int bco, int modulo, bool count = true );
+
+  //! The previous BCO value is forgotten, e.g. at the beginning of a new buffer in which BCO starts from 0
+  void ResetBco(){ last_bco_ = -1; };
+
+  //! Counters and histograms are summed
+  void Add( const DecodeStats& stats );
+
+  //! The TTree "decode_stats" with one entry is written to the current directory
+  void Write( std::string name = "decode_stats" );
+
+  //! The statistics are read from the TTree written by Write. false is returned if it's not found.
+  bool Read( TDirectory* dir, std::string name = "decode_stats" );
+
+  //! A text report is shown
+  void Print( std::ostream& os = std::cout ) const;
+
+private:
+  int last_bco_ = -1;
+};
+
+#ifndef DECODE_STATS_source
+#define DECODE_STATS_source
+
+#include "DecodeStats.cc"
+#endif //  DECODE_STATS_source
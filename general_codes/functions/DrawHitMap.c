@@ -15,6 +15,7 @@ root[n] .x DrawHitMap.c( tree )
 
 */
 
+#include "HitMapLookup.hh"
 
 /*!
 @fn void void DrawHitMap(Tree* tree, string expression, string cut, string option, int bin_ch)
@@ -25,6 +26,7 @@ root[n] .x DrawHitMap.c( tree )
 @param bin_ch A number of bin for channels. It's up to 257 because Y-axis up to 257 is meaningful.
 
 @details Hit map (chip vs channel)
+The hits are filled using the table of HitMapLookup instead of the expression for TTree::Draw.
 */
 
 
@@ -111,13 +113,8 @@ int DrawHitMap(TTree* tree, string cut, string option, int bin_ch) {
 		+ ">> " + hist_name.str();
 	*/
 
-	string expression = string("int(chip_id / 14) * 256") // it's offsets for y-axis.
-	  + "+ pow(-1, int(chip_id / 14)) * chan_id"        // Y value increases(decreases) as chan_id decreases(increases) for chips1-13(14-26)
-	  + ": chip_id - (int(chip_id / 14)) * 13 -1"               // In addition to above, offset is needed. 
-	  + ">> " + hist_name.str();
-
-	cout << expression << endl;
-	tree->Draw(expression.c_str(), cut.c_str(), "goff");
+	// x = chip_id - int(chip_id / 14) * 13 - 1 is in the table of HitMapLookup::kChipAscending, see HitMapLookup::GetExpression()
+	HitMapLookup::Get( HitMapLookup::kChipAscending ).FillFromTree( tree, hitmap, cut );
 	hitmap->Draw( option.c_str() );
 
 	// setting for JPS2021 spring /////////////////////////////////////////
@@ -410,13 +410,8 @@ void DrawPlots(string root_file, int usemod, string mode ) {
   //                        The second term is the depending term on the channel ID. Sign is + for chip 0-13 and - for chip 14-27.
 
 
-  string expression = string("int(chip_id / 14) * 256") // it's offsets for y-axis.
-    + "+ pow(-1, int(chip_id / 14)) * chan_id"        // Y value increases(decreases) as chan_id decreases(increases) for chips1-13(14-26)
-    + ": -chip_id"                                   // Basically, x value increases as chip_id decreases (chip13 at x=0, chip12 at x=-1, ...)
-    + "+ (1 + int(chip_id / 14)) * 13"               // In addition to above, offset is needed. 
-    + ">> hitmap";
-	
-  tree->Draw(expression.c_str(), cut_base.str().c_str(), "goff");
+  // The coordinates above are in the table of HitMapLookup::kChipDescending, so the expression isn't evaluated for each entry
+  HitMapLookup::Get( HitMapLookup::kChipDescending ).FillFromTree( tree, hitmap, cut_base.str() );
   hitmap->Draw("colz");
 
   hitmap->GetXaxis()->SetNdivisions(15);
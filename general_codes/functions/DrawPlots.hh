@@ -1,5 +1,7 @@
 #pragma once
 
+#include "HitMapLookup.hh"
+
 // Review plots are made using a TTree in the given ROOT file
 void DrawPlots(string root_file, int usemod, string mode);
 
@@ -18,8 +18,11 @@
   For example, a histogram of amplitude vs ADC vs chips is made and projected on amplitude vs ADC dimension with selection of a chip.
   Old methods are remained as they are for the moment.
 
+  Now the histograms with chip_id are filled by LadderQAHistograms in one loop over the tree, and TTree::Draw in DrawPlots_* is skipped.
+  Use DrawPlotsMultipleLadders( root_file, modules, mode, cut, nthreads ) to draw all plots of all modules with one loop.
+
 */
-void DrawPlotsMultipleLadders(string root_file, int usemod, string mode, string plot_type, string cut ) {
+void DrawPlotsMultipleLadders(string root_file, int usemod, string mode, string plot_type, string cut, int nthreads ) {
 
   // general setting for ROOT
   gStyle->SetPalette(1);
@@ -63,36 +66,101 @@ void DrawPlotsMultipleLadders(string root_file, int usemod, string mode, string
   string output_base = root_file.substr(0, root_file.find_last_of(".root") - 4)
     + "__module" + ss.str() ;
 
+  // all histograms are filled in one loop over the tree instead of TTree::Draw for each plot, cut_base is applied in it
+  LadderQAHistograms qa( { usemod } );
+  qa.Fill( root_file, cut, nthreads );
+  LadderQAHistogramSet* hists = qa.GetSet( usemod );
+
   if( plot_type == "all"  ) // for debugging
     {
-      DrawPlots_AmplADC( output_base, tree, cut_base.str(), false );
-      DrawPlots_ChAmpl( output_base, tree, cut_base.str(), false );
-      DrawPlots_Ch( output_base, tree, cut_base.str(), false, mode );
-      DrawPlots_ADC( output_base, tree, cut_base.str(), false, mode );
+      DrawPlots_AmplADC( output_base, tree, cut_base.str(), false, hists->ampl_adc_chip );
+      DrawPlots_ChAmpl( output_base, tree, cut_base.str(), false, hists->ampl_ch_chip );
+      DrawPlots_Ch( output_base, tree, cut_base.str(), false, mode, hists->ch_chip );
+      DrawPlots_ADC( output_base, tree, cut_base.str(), false, mode, hists->adc_chip );
+      DrawPlots_Hitmap( output_base, tree, cut_base.str(), false, hists->hitmap );
       return;
     }
 
   if( mode == "calib" ){ // plots for calibration data
     if( plot_type == "ampl_adc" )
-      DrawPlots_AmplADC( output_base, tree, cut_base.str(), false );
+      DrawPlots_AmplADC( output_base, tree, cut_base.str(), false, hists->ampl_adc_chip );
     else if( plot_type == "ch_ampl" )
-      DrawPlots_ChAmpl( output_base, tree, cut_base.str(), false );
+      DrawPlots_ChAmpl( output_base, tree, cut_base.str(), false, hists->ampl_ch_chip );
     
   }
 
   // plots for all data
   if( plot_type == "ch" ) // channel dists
-    DrawPlots_Ch( output_base, tree, cut_base.str(), false, mode );
+    DrawPlots_Ch( output_base, tree, cut_base.str(), false, mode, hists->ch_chip );
   else if( plot_type == "adc" ) // ADC dists
-    DrawPlots_ADC( output_base, tree, cut_base.str(), false, mode );
+    DrawPlots_ADC( output_base, tree, cut_base.str(), false, mode, hists->adc_chip );
+  else if( plot_type == "hitmap" ) // chip vs channel
+    DrawPlots_Hitmap( output_base, tree, cut_base.str(), false, hists->hitmap );
 
   cout << root_file << ", module" << usemod << ", " << mode << ", " << plot_type << " done." << endl;
   //tf->Close();
   return;
 }
 
+/*!
+  @fn void DrawPlotsMultipleLadders( string root_file, vector < int > modules, string mode, string cut, int nthreads )
+  @brief All plots of all modules are drawn with one loop over the tree
+  @param root_file A path to a ROOT file made by MakeTree
+  @param modules IDs of the modules to be drawn
+  @param mode "calib" or "external". Amplitude vs ADC and Amplitude vs Channel are drawn only for "calib".
+  @param cut An additional cut
+  @param nthreads The number of threads to fill the histograms
+  @details The tree was read 4 times for each module by TTree::Draw (once for each plot type). Here LadderQAHistograms reads it once for all modules,
+  and the histograms are given to DrawPlots_*. The plots are the same as the ones made by DrawPlotsMultipleLadders( root_file, module, mode, plot_type ).
+*/
+void DrawPlotsMultipleLadders(string root_file, vector < int > modules, string mode, string cut, int nthreads ) {
+
+  gStyle->SetPalette(1);
+  gStyle->SetOptFit(0);
+  gStyle->SetOptStat(0);
+  gStyle->SetFrameBorderMode(0);
+  gStyle->SetCanvasColor(0);
+  gStyle->SetCanvasBorderMode(0);
+  gStyle->SetPadColor(0);
+  gStyle->SetPadBorderMode(0);
+  gErrorIgnoreLevel = kWarning;
+
+  LadderQAHistograms qa( modules );
+  if( qa.Fill( root_file, cut, nthreads ) == false ){
+    cerr << " Error: tree in " << root_file << " cannot be read." << endl;
+    cerr << " Program stopped" << endl;
+    return;
+  }
+
+  cout << root_file << ": " << qa.GetEntries() << " entries, " << qa.GetFilledNum() << " hits filled in "
+       << qa.GetTime() << " s with " << nthreads << " thread(s)" << endl;
+
+  for( auto& usemod : modules ){
+    LadderQAHistogramSet* hists = qa.GetSet( usemod );
+    if( hists == nullptr )
+      continue;
+
+    string output_base = root_file.substr(0, root_file.find_last_of(".root") - 4)
+      + "__module" + to_string( usemod );
+
+    // the tree and the cut aren't used since the histograms are given
+    if( mode == "calib" ){
+      DrawPlots_AmplADC( output_base, nullptr, "", false, hists->ampl_adc_chip );
+      DrawPlots_ChAmpl( output_base, nullptr, "", false, hists->ampl_ch_chip );
+    }
+
+    DrawPlots_Ch( output_base, nullptr, "", false, mode, hists->ch_chip );
+    DrawPlots_ADC( output_base, nullptr, "", false, mode, hists->adc_chip );
+    DrawPlots_Hitmap( output_base, nullptr, "", false, hists->hitmap );
+
+    cout << root_file << ", module" << usemod << ", " << mode << " done." << endl;
+  }
+
+  return;
+}
+
 
-void DrawPlots_AmplADC( string output_base, TTree* tree, string cut, bool reverse_chip_order )
+TCanvas* DrawPlots_AmplADC( string output_base, TTree* tree, string cut, bool reverse_chip_order, TH3D* hist_ampl_adc_chip )
 {
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -107,15 +175,17 @@ void DrawPlots_AmplADC( string output_base, TTree* tree, string cut, bool revers
   //     and then make histograms for each chip by projecting on the axis of chip                 //
   //////////////////////////////////////////////////////////////////////////////////////////////////
 
-  // hist of amplitude vs ADC vs chip
-  TH3D* hist_ampl_adc_chip = new TH3D("ampl_adc_chip", "Amplitude vs ADC vs Chip ID;Amplitude;ADC;Chip ID",
-				      70, 0, 70, 8, 0, 8, 26, 0, 26);
+  // hist of amplitude vs ADC vs chip, it's filled here unless it's given
+  if( hist_ampl_adc_chip == nullptr ){
+    hist_ampl_adc_chip = new TH3D("ampl_adc_chip", "Amplitude vs ADC vs Chip ID;Amplitude;ADC;Chip ID",
+				  70, 0, 70, 8, 0, 8, 26, 0, 26);
 
-  // expression for Draw
-  string expression_ampl_adc_chip = string("chip_id:adc:ampl>>") + hist_ampl_adc_chip->GetName();
+    // expression for Draw
+    string expression_ampl_adc_chip = string("chip_id:adc:ampl>>") + hist_ampl_adc_chip->GetName();
 
-  // draw the distribution and fill the hist with the result
-  tree->Draw(expression_ampl_adc_chip.c_str(), cut.c_str(), "goff");
+    // draw the distribution and fill the hist with the result
+    tree->Draw(expression_ampl_adc_chip.c_str(), cut.c_str(), "goff");
+  }
 
   // 2D hists to contain distribution of amplitude vs ADC for each chip
   TH2D* hist_ampl_adc[26];
@@ -170,10 +240,10 @@ void DrawPlots_AmplADC( string output_base, TTree* tree, string cut, bool revers
   output = GetOutputName( output_base, "ampl_adc", ".root" );
   c->Print(output.c_str());
 
-  return 0;
+  return c;
 }
 
-void DrawPlots_ChAmpl( string output_base, TTree* tree, string cut, bool reverse_chip_order ){
+TCanvas* DrawPlots_ChAmpl( string output_base, TTree* tree, string cut, bool reverse_chip_order, TH3D* hist_ampl_ch_chip ){
   
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Amplitude vs Channel for each chip, only "calib" mode make sence                             //
@@ -183,11 +253,13 @@ void DrawPlots_ChAmpl( string output_base, TTree* tree, string cut, bool reverse
   c->Divide(13, 2);
 
   // 3D hist ( amplitude vs channel vs chip )  --> 2D hist of a chip ( amplitude vs channel) by making a profile on z-axis
-  TH3D* hist_ampl_ch_chip = new TH3D("ampl_ch_chip", "Amplitude vs Channel vs Chip;Amplitude;Channel;Chip",
-				     127, 0, 127, 128, 0, 128, 26, 0, 26); // channel bins are reduced by a factor of 4
+  if( hist_ampl_ch_chip == nullptr ){
+    hist_ampl_ch_chip = new TH3D("ampl_ch_chip", "Amplitude vs Channel vs Chip;Amplitude;Channel;Chip",
+				 127, 0, 127, 128, 0, 128, 26, 0, 26); // channel bins are reduced by a factor of 4
 		
-  string expression_ampl_ch_chip = string("chip_id:chan_id:ampl>>") + hist_ampl_ch_chip->GetName();
-  tree->Draw(expression_ampl_ch_chip.c_str(), cut.c_str(), "goff");
+    string expression_ampl_ch_chip = string("chip_id:chan_id:ampl>>") + hist_ampl_ch_chip->GetName();
+    tree->Draw(expression_ampl_ch_chip.c_str(), cut.c_str(), "goff");
+  }
 
   for (int i = 0; i < 26; i++) { // loop over all chips
     c->cd(i + 1);
@@ -267,10 +339,10 @@ void DrawPlots_ChAmpl( string output_base, TTree* tree, string cut, bool reverse
   output = GetOutputName( output_base, "ch_ampl", ".root" );
   c->Print(output.c_str());
 
-  return 0;
+  return c;
 }
   
-void DrawPlots_Ch( string output_base, TTree* tree, string cut, bool reverse_chip_order, string mode ){
+TCanvas* DrawPlots_Ch( string output_base, TTree* tree, string cut, bool reverse_chip_order, string mode, TH2D* hist_ch_chip ){
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Channel distribution for each chip, any mode is OK                                           //
@@ -278,10 +350,12 @@ void DrawPlots_Ch( string output_base, TTree* tree, string cut, bool reverse_chi
 
   string canvas_name = string("ch");
   TCanvas *c = new TCanvas( canvas_name.c_str(), canvas_name.c_str(), 0, 560, 1625, 250);
-  TH2D* hist_ch_chip = new TH2D("ch_chip", "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26);
+  if( hist_ch_chip == nullptr ){
+    hist_ch_chip = new TH2D("ch_chip", "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26);
 
-  string expression_ch_chip = string("chip_id:chan_id>>") + hist_ch_chip->GetName();
-  tree->Draw(expression_ch_chip.c_str(), cut.c_str(), "goff");
+    string expression_ch_chip = string("chip_id:chan_id>>") + hist_ch_chip->GetName();
+    tree->Draw(expression_ch_chip.c_str(), cut.c_str(), "goff");
+  }
 
   c->Divide(13, 2);
   vector < int > bin_contents_ch;
@@ -348,10 +422,10 @@ void DrawPlots_Ch( string output_base, TTree* tree, string cut, bool reverse_chi
   output = GetOutputName( output_base, "ch", ".root" );
   c->Print(output.c_str());
 
-  return;
+  return c;
 }
 
-void DrawPlots_ADC( string output_base, TTree* tree, string cut, bool reverse_chip_order, string mode ){
+TCanvas* DrawPlots_ADC( string output_base, TTree* tree, string cut, bool reverse_chip_order, string mode, TH2D* hist_adc_chip ){
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // ADC distribution for each chip, any mode is OK                                           //
@@ -359,10 +433,12 @@ void DrawPlots_ADC( string output_base, TTree* tree, string cut, bool reverse_ch
 
   string canvas_name = string("adc");
   TCanvas *c = new TCanvas( canvas_name.c_str(), canvas_name.c_str(), 0, 700, 1625, 250);
-  TH2D* hist_adc_chip = new TH2D("adc_chip", "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26);
+  if( hist_adc_chip == nullptr ){
+    hist_adc_chip = new TH2D("adc_chip", "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26);
 
-  string expression_adc_chip = string("chip_id:adc>>") + hist_adc_chip->GetName();
-  tree->Draw(expression_adc_chip.c_str(), cut.c_str(), "goff");
+    string expression_adc_chip = string("chip_id:adc>>") + hist_adc_chip->GetName();
+    tree->Draw(expression_adc_chip.c_str(), cut.c_str(), "goff");
+  }
 
   c->Divide(13, 2);
   vector < int > bin_contents_adc;
@@ -431,18 +507,17 @@ void DrawPlots_ADC( string output_base, TTree* tree, string cut, bool reverse_ch
   output = GetOutputName( output_base, "adc", ".root" );
   c->Print(output.c_str());
 
-  return;
+  return c;
 }
 
-/*
-void DrawPlots_Hitmap( string output_base, TTree* tree, string cut, bool reverse_chip_order ){
+TCanvas* DrawPlots_Hitmap( string output_base, TTree* tree, string cut, bool reverse_chip_order, TH2D* hitmap ){
 
-  
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // Hit map ( chip vs channel ), any mode is OK                                                  //
   //////////////////////////////////////////////////////////////////////////////////////////////////
-  string canvas_name_c4 = string("hit_map_module") + ss.str().c_str();
-  TCanvas *c4 = new TCanvas( canvas_name_c4.c_str(), canvas_name_c4.c_str(), 0, 750, 1625, 250);
+  // the chips are placed as the ladder (HitMapLookup::kChipDescending), so reverse_chip_order isn't used
+  string canvas_name = string("hit_map");
+  TCanvas *c = new TCanvas( canvas_name.c_str(), canvas_name.c_str(), 0, 750, 1625, 250);
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
   //                                                                                              //
@@ -466,33 +541,36 @@ void DrawPlots_Hitmap( string output_base, TTree* tree, string cut, bool reverse
   //                       Schematic figure of what will be drawn                                 //
   //////////////////////////////////////////////////////////////////////////////////////////////////
 
-  TH2D* hitmap = new TH2D("hitmap", "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257);
-
-  // Super long expression to draw a hit map in one execution:
-  //   int(chip_id / 14) * 256+ pow(-1, int(chip_id / 14)) * chan_id: -chip_id+ (1 + int(chip_id / 14)) * 13"
-  // here
-  //    int(chip_id / 14) : = 0 (chip=0, 1, ..., 13) or = 1 (chip=14, ..., 27)
-  //                x-axis: -chip_id+ (1 + int(chip_id / 14)) * 13  
-  //                         X value should start from 13 (for chip1) and value decreases as chip number increases basically.
-  //                         For chips #14 or later, another offset of 13 (26 in total) is needed.
-  //                         The first term -chip_id is the depending term on chip ID.
-  //                         The second term is an offset to draw hist from right to left.
-  //
-  //                y-axis: int(chip_id / 14) * 256+ pow(-1, int(chip_id / 14)) * chan_id
-  //                        Y value is bit complicated...
-  //                        For chip from 1 to 13, a channel ID is simply the same as Y coordinate (ch_{i} = y_{i}).
-  //                        For chip from 14 to 26, relation between a channel ID ch_{i}  and Y coordinate y_{i} is ch_{i} = 256 - y_{i} (i=0, 1, ...).
-  //                        The first term is an offset, 0 for chip 0-13 and 256 for chip 14-27.
-  //                        The second term is the depending term on the channel ID. Sign is + for chip 0-13 and - for chip 14-27.
-
-
-  string expression = string("int(chip_id / 14) * 256") // it's offsets for y-axis.
-    + "+ pow(-1, int(chip_id / 14)) * chan_id"        // Y value increases(decreases) as chan_id decreases(increases) for chips1-13(14-26)
-    + ": -chip_id"                                   // Basically, x value increases as chip_id decreases (chip13 at x=0, chip12 at x=-1, ...)
-    + "+ (1 + int(chip_id / 14)) * 13"               // In addition to above, offset is needed. 
-    + ">> hitmap";
-	
-  tree->Draw(expression.c_str(), cut_base.str().c_str(), "goff");
+  // the same histogram as LadderQAHistogramSet::hitmap, it's filled here unless it's given
+  if( hitmap == nullptr ){
+    hitmap = new TH2D("hitmap", "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257);
+
+    // Super long expression to draw a hit map in one execution:
+    //   int(chip_id / 14) * 256+ pow(-1, int(chip_id / 14)) * chan_id: -chip_id+ (1 + int(chip_id / 14)) * 13"
+    // here
+    //    int(chip_id / 14) : = 0 (chip=0, 1, ..., 13) or = 1 (chip=14, ..., 27)
+    //                x-axis: -chip_id+ (1 + int(chip_id / 14)) * 13  
+    //                         X value should start from 13 (for chip1) and value decreases as chip number increases basically.
+    //                         For chips #14 or later, another offset of 13 (26 in total) is needed.
+    //                         The first term -chip_id is the depending term on chip ID.
+    //                         The second term is an offset to draw hist from right to left.
+    //
+    //                y-axis: int(chip_id / 14) * 256+ pow(-1, int(chip_id / 14)) * chan_id
+    //                        Y value is bit complicated...
+    //                        For chip from 1 to 13, a channel ID is simply the same as Y coordinate (ch_{i} = y_{i}).
+    //                        For chip from 14 to 26, relation between a channel ID ch_{i}  and Y coordinate y_{i} is ch_{i} = 256 - y_{i} (i=0, 1, ...).
+    //                        The first term is an offset, 0 for chip 0-13 and 256 for chip 14-27.
+    //                        The second term is the depending term on the channel ID. Sign is + for chip 0-13 and - for chip 14-27.
+
+    string expression = string("int(chip_id / 14) * 256") // it's offsets for y-axis.
+      + "+ pow(-1, int(chip_id / 14)) * chan_id"        // Y value increases(decreases) as chan_id decreases(increases) for chips1-13(14-26)
+      + ": -chip_id"                                   // Basically, x value increases as chip_id decreases (chip13 at x=0, chip12 at x=-1, ...)
+      + "+ (1 + int(chip_id / 14)) * 13"               // In addition to above, offset is needed.
+      + ">> " + hitmap->GetName();
+
+    tree->Draw(expression.c_str(), cut.c_str(), "goff");
+  }
+
   hitmap->Draw("colz");
 
   hitmap->GetXaxis()->SetNdivisions(15);
@@ -534,10 +612,11 @@ void DrawPlots_Hitmap( string output_base, TTree* tree, string cut, bool reverse
     tex->DrawLatex(x, y, Form("Chip%d", i + 1));
   }
 
-  string output_hitmap = root_file.substr(0, root_file.find_last_of(".root") - 4)
-    + "_hitmap_module" + ss.str().c_str() + ".pdf";
-  c4->Print(output_hitmap.c_str());
+  string output = GetOutputName( output_base, "hitmap", ".pdf" );
+  c->Print(output.c_str());
 
-  return;
+  output = GetOutputName( output_base, "hitmap", ".root" );
+  c->Print(output.c_str());
+
+  return c;
 }
-*/
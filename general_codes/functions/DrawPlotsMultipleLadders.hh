@@ -1,13 +1,19 @@
 #pragma once
 
+#include "LadderQAHistograms.hh"
+
 // Review plots are made using a TTree in the given ROOT file
-void DrawPlotsMultipleLadders(string root_file, int usemod, string mode, string plot_type = "", string cut = "" );
+void DrawPlotsMultipleLadders(string root_file, int usemod, string mode, string plot_type = "", string cut = "", int nthreads = 1 );
+
+// All review plots of all modules are made with only one loop over the TTree (see LadderQAHistograms)
+void DrawPlotsMultipleLadders(string root_file, vector < int > modules, string mode, string cut = "", int nthreads = 1 );
 
-void DrawPlots_AmplADC( string root_file, TTree* tree, string cut, bool reverse_chip_order );
-void DrawPlots_ChAmpl( string root_file, TTree* tree, string cut, bool reverse_chip_order );
-void DrawPlots_Ch( string root_file, TTree* tree, string cut, bool reverse_chip_order, string mode );
-void DrawPlots_ADC( string root_file, TTree* tree, string cut, bool reverse_chip_order, string mode );
-void DrawPlots_Hitmap( string root_file, TTree* tree, string cut, bool reverse_chip_order );
+// If a histogram filled by LadderQAHistograms is given, TTree::Draw is skipped. The canvas is returned.
+TCanvas* DrawPlots_AmplADC( string root_file, TTree* tree, string cut, bool reverse_chip_order, TH3D* hist_ampl_adc_chip = nullptr );
+TCanvas* DrawPlots_ChAmpl( string root_file, TTree* tree, string cut, bool reverse_chip_order, TH3D* hist_ampl_ch_chip = nullptr );
+TCanvas* DrawPlots_Ch( string root_file, TTree* tree, string cut, bool reverse_chip_order, string mode, TH2D* hist_ch_chip = nullptr );
+TCanvas* DrawPlots_ADC( string root_file, TTree* tree, string cut, bool reverse_chip_order, string mode, TH2D* hist_adc_chip = nullptr );
+TCanvas* DrawPlots_Hitmap( string root_file, TTree* tree, string cut, bool reverse_chip_order, TH2D* hitmap = nullptr );
 
 int GetChipNum( int i, bool reverse_chip_order )
 {
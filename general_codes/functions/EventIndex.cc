@@ -0,0 +1,161 @@
+#include "EventIndex.hh"
+
+void EventIndex::Add( Long64_t raw_offset, Long64_t event, Long64_t entry, int fem_id, int event_fem, int bco_full )
+{
+  if( entries_.size() != 0 ){
+    EventIndexEntry& last = entries_.back();
+    // hits are in consecutive entries, or in the same entry in the compact format
+    if( last.raw_offset == raw_offset && last.fem_id == fem_id && last.event_fem == event_fem && last.bco_full == bco_full
+	&& ( last.entry + last.nhits == entry || last.entry == entry ) ){
+      last.nhits++;
+      return;
+    }
+  }
+
+  EventIndexEntry e;
+  e.raw_offset = raw_offset;
+  e.event = event;
+  e.entry = entry;
+  e.nhits = 1;
+  e.fem_id = fem_id;
+  e.event_fem = event_fem;
+  e.bco_full = bco_full;
+  entries_.push_back( e );
+
+  order_event_fem_.clear();
+  order_bco_full_.clear();
+}
+
+void EventIndex::Append( const EventIndex& index, Long64_t event_offset, Long64_t entry_offset )
+{
+  for( auto e : index.entries_ ){
+    e.event += event_offset;
+    e.entry += entry_offset;
+    entries_.push_back( e );
+  }
+
+  order_event_fem_.clear();
+  order_bco_full_.clear();
+}
+
+void EventIndex::Truncate( Long64_t event )
+{
+  entries_.erase( std::remove_if( entries_.begin(), entries_.end(), [event]( const EventIndexEntry& e ){ return e.event >= event; } ),
+		  entries_.end() );
+  order_event_fem_.clear();
+  order_bco_full_.clear();
+}
+
+void EventIndex::Clear()
+{
+  entries_.clear();
+  order_event_fem_.clear();
+  order_bco_full_.clear();
+}
+
+bool EventIndex::Write( std::string fname )
+{
+  std::ofstream ofs( fname.c_str(), std::ofstream::binary );
+  if( ofs.fail() ){
+    std::cerr << "Failed to write the event index " << fname << std::endl;
+    return false;
+  }
+
+  UInt_t entry_size = sizeof( EventIndexEntry );
+  Long64_t size = entries_.size();
+  ofs.write( "INTTIDX1", 8 );
+  ofs.write( (char*)&entry_size, sizeof(entry_size) );
+  ofs.write( (char*)&size, sizeof(size) );
+  if( size > 0 )
+    ofs.write( (char*)&entries_[0], size * entry_size );
+
+  return !ofs.fail();
+}
+
+bool EventIndex::Read( std::string fname )
+{
+  this->Clear();
+
+  std::ifstream ifs( fname.c_str(), std::ifstream::binary );
+  if( ifs.fail() ){
+    std::cerr << "Failed to open the event index " << fname << std::endl;
+    return false;
+  }
+
+  char magic[8];
+  UInt_t entry_size = 0;
+  Long64_t size = 0;
+  ifs.read( magic, 8 );
+  ifs.read( (char*)&entry_size, sizeof(entry_size) );
+  ifs.read( (char*)&size, sizeof(size) );
+  if( ifs.fail() || std::string( magic, 8 ) != "INTTIDX1" || entry_size != sizeof( EventIndexEntry ) || size < 0 ){
+    std::cerr << fname << " is not an event index" << std::endl;
+    return false;
+  }
+
+  entries_.resize( size );
+  if( size > 0 )
+    ifs.read( (char*)&entries_[0], size * entry_size );
+
+  if( ifs.fail() ){
+    std::cerr << fname << " is broken" << std::endl;
+    entries_.clear();
+    return false;
+  }
+
+  return true;
+}
+
+std::vector < EventIndexEntry > EventIndex::FindEvent( Long64_t first, Long64_t last )
+{
+  // entries are in the order of the serial number of hits
+  auto begin = std::upper_bound( entries_.begin(), entries_.end(), first,
+				 []( Long64_t value, const EventIndexEntry& e ){ return value < e.event; } );
+  if( begin != entries_.begin() )
+    --begin;
+
+  std::vector < EventIndexEntry > found;
+  for( auto it = begin; it != entries_.end() && it->event <= last; ++it )
+    if( first < it->event + it->nhits )
+      found.push_back( *it );
+
+  return found;
+}
+
+std::vector < EventIndexEntry > EventIndex::FindByKey( std::vector < size_t >& order, Int_t EventIndexEntry::* key, int first, int last, int fem_id )
+{
+  if( order.size() != entries_.size() ){
+    order.resize( entries_.size() );
+    for( size_t i=0; i<order.size(); i++ )
+      order[i] = i;
+
+    // stable to keep the order of the records for the same key
+    std::stable_sort( order.begin(), order.end(),
+		      [&]( size_t a, size_t b ){ return entries_[a].*key < entries_[b].*key; } );
+  }
+
+  auto begin = std::lower_bound( order.begin(), order.end(), first,
+				 [&]( size_t i, int value ){ return entries_[i].*key < value; } );
+
+  std::vector < EventIndexEntry > found;
+  for( auto it = begin; it != order.end() && entries_[*it].*key <= last; ++it )
+    if( fem_id < 0 || entries_[*it].fem_id == fem_id )
+      found.push_back( entries_[*it] );
+
+  return found;
+}
+
+std::vector < EventIndexEntry > EventIndex::FindEventFem( int first, int last, int fem_id )
+{
+  return this->FindByKey( order_event_fem_, &EventIndexEntry::event_fem, first, last, fem_id );
+}
+
+std::vector < EventIndexEntry > EventIndex::FindBcoFull( int first, int last, int fem_id )
+{
+  return this->FindByKey( order_bco_full_, &EventIndexEntry::bco_full, first, last, fem_id );
+}
+
+std::string GetEventIndexName( std::string root_file )
+{
+  return root_file.substr( 0, root_file.find_last_of( "." ) ) + ".idx";
+}
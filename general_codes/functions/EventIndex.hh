@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*!
+  @struct EventIndexEntry
+  @brief Consecutive hits with the same FEM_ID, FEM event counter, and bco_full in a record
+*/
+struct EventIndexEntry
+{
+  Long64_t raw_offset; //!< byte offset of the record in the .dat file
+  Long64_t event;      //!< serial number of the first hit (branch "event")
+  Long64_t entry;      //!< TTree entry of the first hit, or the entry of the hits in the compact format (tree_compact)
+  Int_t nhits;         //!< the number of hits, they are entry, entry+1, ..., entry+nhits-1 in tree
+  Int_t fem_id;
+  Int_t event_fem;     //!< FEM event counter
+  Int_t bco_full;
+};
+
+/*!
+  @class EventIndex
+  @brief Index of a decoded run to jump to an event in the .dat file and in the TTree without reading all of them
+  @details It's written in a binary file "<name>.idx" next to the ROOT file "<name>.root" by MakeTree (see GetEventIndexName).
+  The format is
+    char[8]  "INTTIDX1"
+    UInt_t   size of an entry in bytes (40)
+    Long64_t the number of entries
+    EventIndexEntry[the number of entries]
+  in the byte order of the machine.
+
+  How to use:
+    EventIndex index;
+    index.Read( GetEventIndexName( "data/run.root" ) );
+    for( auto& e : index.FindBcoFull( 1000, 1010 ) )  // or FindEvent, FindEventFem
+      for( Long64_t i=e.entry; i<e.entry + e.nhits; i++ )
+        tree->GetEntry( i );                         // or RawRecordReader::Seek( e.raw_offset ) for raw words
+*/
+class EventIndex
+{
+public:
+  EventIndex(){};
+
+  //! A hit is added. It's merged to the last entry if the keys are the same.
+  void Add( Long64_t raw_offset, Long64_t event, Long64_t entry, int fem_id, int event_fem, int bco_full );
+
+  //! Entries of another index are appended. event and entry are shifted by the given values.
+  void Append( const EventIndex& index, Long64_t event_offset, Long64_t entry_offset );
+
+  //! Entries of the hits whose serial number is event or more are removed
+  void Truncate( Long64_t event );
+
+  bool Write( std::string fname );
+  bool Read( std::string fname );
+
+  void Clear();
+  size_t GetSize(){ return entries_.size(); };
+  const std::vector < EventIndexEntry >& GetEntries(){ return entries_; };
+
+  //! Entries with hits whose serial number is in [first, last]
+  std::vector < EventIndexEntry > FindEvent( Long64_t first, Long64_t last );
+
+  //! Entries with the FEM event counter in [first, last]. All FEMs for fem_id = -1.
+  std::vector < EventIndexEntry > FindEventFem( int first, int last, int fem_id = -1 );
+
+  //! Entries with bco_full in [first, last]. All FEMs for fem_id = -1.
+  std::vector < EventIndexEntry > FindBcoFull( int first, int last, int fem_id = -1 );
+
+private:
+  std::vector < EventIndexEntry > entries_;
+
+  // positions in entries_ sorted by the keys, made at the first search
+  std::vector < size_t > order_event_fem_, order_bco_full_;
+
+  std::vector < EventIndexEntry > FindByKey( std::vector < size_t >& order, Int_t EventIndexEntry::* key, int first, int last, int fem_id );
+};
+
+//! "<name>.root" -> "<name>.idx"
+std::string GetEventIndexName( std::string root_file );
+
+#ifndef EVENT_INDEX_source
+#define EVENT_INDEX_source
+
+#include "EventIndex.cc"
+#endif //  EVENT_INDEX_source
@@ -0,0 +1,708 @@
+#include "FelixDecoder.hh"
+
+FelixDecoder::FelixDecoder( string mode, bool is_old_camac_format )
+{
+  mode_ = mode;
+  is_old_camac_format_ = is_old_camac_format;
+}
+
+bool FelixDecoder::SetFormat( string format )
+{
+  is_compact_ = false;
+  if( format == "" )
+    return true;
+
+  is_compact_ = compact_format_.Parse( format );
+  return is_compact_;
+}
+
+void FelixDecoder::MakeTrees()
+{
+  if( is_compact_ ){
+    tree_ = new TTree("tree_compact", "chip info in the compact format");
+    compact_.Book( tree_, compact_format_ );
+  }
+  else{
+    // made branches for each column
+    tree_ = new TTree("tree", "chip info");
+    tree_->Branch("adc", &adc_, "adc/I");
+    tree_->Branch("ampl", &ampl_, "ampl/I");
+    tree_->Branch("chip_id", &chip_id_, "chip_id/I");
+    tree_->Branch("fpga_id", &fpga_id_, "fpga_id/I");
+    tree_->Branch("module", &module_, "module/I");
+    tree_->Branch("chan_id", &chan_id_, "chan_id/I");
+    tree_->Branch("fem_id", &fem_id_, "fem_id/I");
+    tree_->Branch("bco", &bco_, "bco/I");
+    tree_->Branch("bco_full", &bco_full_, "bco_full/I");
+    tree_->Branch("event", &ievent_, "event/I");
+    tree_->Branch("command", &command_, "command/i" );
+  }
+
+  //--------------------------------------------------------------------------------------------------
+  tree_camac_ = new TTree( "tree_camac", "CAMAC data" );
+  tree_camac_->Branch("camac_adc", &camac_adcs_);
+  tree_camac_->Branch("camac_tdc", &camac_tdcs_);
+  tree_camac_->Branch("INTT_event", &is_INTT_, "is_INTT/O");
+
+  //--------------------------------------------------------------------------------------------------
+  tree_both_ = new TTree( "tree_both", "CAMAC-wise TTree for CAMAC events and INTT events" );
+  tree_both_->Branch("camac_adc", &camac_adcs_);
+  tree_both_->Branch("camac_tdc", &camac_tdcs_);
+  tree_both_->Branch("INTT_event", &is_INTT_, "is_INTT/O");
+
+  if( this->IsCamacMode() ){
+
+    if( mode_ == "camac_clustering" )
+      {
+	tree_both_->Branch("nhit_in_cluster", &nhits_in_cluster_ );
+      }
+
+    tree_both_->Branch("adc", &adcs_ );
+    tree_both_->Branch("adc_vol", &adc_voltages_);
+    tree_both_->Branch("ampl", &ampls_ );
+    tree_both_->Branch("chip_id", &chip_ids_ );
+    tree_both_->Branch("fpga_id", &fpga_ids_ );
+    tree_both_->Branch("module", &modules_ );
+    tree_both_->Branch("chan_id", &chan_ids_ );
+    tree_both_->Branch("fem_id", &fem_ids_ );
+    tree_both_->Branch("bco", &bcos_ );
+    tree_both_->Branch("bco_full", &bco_fulls_ );
+    tree_both_->Branch("single_bco_event", &is_single_bco_event_, "single_bco_event/O" );
+    tree_both_->Branch("event", &events_ );
+  }
+}
+
+bool FelixDecoder::SetUp( TFile* tf, string format, const ChannelMask* mask, EventIndex* event_index, HitCountCube* count_cube )
+{
+  if( this->SetFormat( format ) == false ){
+    cerr << "Format \"" << format << "\" is not supported." << endl;
+    return false;
+  }
+
+  if( is_compact_ )
+    tf->SetCompressionSettings( compact_format_.GetCompressionSettings() );
+
+  tf->cd();
+  this->MakeTrees();
+  mask_ = mask;
+  event_index_ = event_index;
+  count_cube_ = count_cube;
+  return true;
+}
+
+void FelixDecoder::ClearRecord()
+{
+  // init variables for branches
+  command_ = 0;
+  adc_ = ampl_ = chip_id_ = fpga_id_ = module_ = chan_id_ = bco_ = bco_full_ = -1;
+  is_INTT_ = true;
+  is_single_bco_event_ = false;
+
+  // erase elements in vectors
+  camac_adcs_.clear();
+  camac_tdcs_.clear();
+  bcos_.clear();
+  adcs_.clear();
+  adc_voltages_.clear();
+  ampls_.clear();
+  chip_ids_.clear();
+  fpga_ids_.clear();
+  modules_.clear();
+  fem_ids_.clear();
+  chan_ids_.clear();
+  bco_fulls_.clear();
+  events_.clear();
+  nhits_in_cluster_.clear();
+}
+
+bool FelixDecoder::HasFemId( const UInt_t* data )
+{
+  int buflen = data[0];
+  if( data[1] != 102 )
+    return false;
+
+  for( int index = 2; index < buflen; index++ )
+    if( (data[index] & 0xFFFF) != 1 && (data[index] & 0xFFFF) != 2 && (data[index] & 0xfff) == 0 )
+      return true;
+
+  return false;
+}
+
+void FelixDecoder::Decode( const UInt_t* data, Long64_t bufcnt, bool fill, Long64_t offset )
+{
+  this->ClearRecord();
+
+  int index = 0; // position in this record
+  int buflen = data[index];
+  int bufid = data[index + 1];
+  int cnt = buflen - 1;
+  int start = index + 2;
+
+  if( fill )
+    stats_.AddBuffer( bufid );
+
+  if (bufid == 101) {
+    // This record is a time stamp
+    // Format of timestamp record is
+    //   data[0] = word count, excluding this word and checksum
+    //   data[1] = 0xFFFFFFFF
+    //   data[2] = 0xFFFFFFFF
+    //   data[3] = time in clock ticks for cpu
+    //   data[4] = CLOCKS_PER_SEC taken from the system value
+    //   data[5] = checksum for buffer
+    //std::cout << "Buffer " << bufcnt << ": Timestamp" << std::endl;
+    return;
+  }
+  else if (bufid == 100) {
+    if( fill == false || verbosity_ < DecodeStats::kSummary )
+      return;
+
+    // This buffer is a configuration record
+    std::cout << "Buffer " << bufcnt << ": Configuration " << std::endl;
+
+    index += 2;
+    int runno = data[index++];
+
+    // print the run number
+    std::cout << "    Run " << runno << std::endl;
+
+    unsigned short* p = (unsigned short*)&data[index];
+
+    int n = 0;
+    for (n = 0; n < 9; ) {
+      unsigned short chipid = p[n++];
+      unsigned short masks[8];
+
+      for (int m = 0; m < 8; m++, n++)
+	masks[m] = p[n];
+
+      std::cout << "    Chip " << chipid << std::endl;
+      std::cout << "      enable masks ";
+
+      for (int m = 0; m < 8; m++)
+	std::cout << "0x" << std::hex << masks[m] << " ";
+
+      std::cout << std::dec << std::endl;
+    }
+
+    unsigned short* p2 = &p[n];
+    for (n = 0; n < 16; n++) {
+      std::cout << "      Reg " << n << ": " << (int)p2[n] << std::endl;
+    }
+    return;
+  } // end of if( bufid == 100 )
+  else if (bufid != 102) {
+    // unknown buffer id, nothing to do
+    return;
+  }
+
+  // Format of record is
+  //   data[0] = # of data words
+  //   data[1..n] = data words
+  //   data[n+1] = checksum for buffer
+  if (fill && verbosity_ >= DecodeStats::kRecord)
+    std::cout << "Buffer " << bufcnt << ": Data record, "
+	      << "nwords = " << cnt << " checksum = "
+	      << "0x" << std::hex << data[index + cnt + 1] << std::dec << std::endl;
+
+  // the checksum includes buflen and the buffer id in addition to the data words, the same as fphx_raw2root.C
+  int checksum = buflen ^ bufid;
+
+  int index_camac = start + cnt;
+
+  if( fill && mode_ != "calib" && mode_ != "external" )
+    {
+      int camac_ADC_num = data[index_camac];
+      // only for some data (taken at the beginning of the implementation)
+      if( is_old_camac_format_ )
+	{
+
+	  int camac_data_num = data[index_camac];
+	  if (camac_data_num % 2 != 0) {
+	    cerr << "A number of camac data \"" << camac_data_num << "\" is odd. It's not expected (for the moment)" << endl;
+	    cerr << "Consider modfy this macro or use even number of channels (normaly #ADC = #TDC)" << endl;
+	  }
+
+	  for (int i=0; i < camac_data_num / 2; i++)
+	    {
+	      index_camac++;
+	      camac_adcs_.push_back(data[index_camac]);
+	    }
+
+	  for (int i = 0; i < camac_data_num / 2; i++)
+	    {
+	      index_camac++;
+	      camac_tdcs_.push_back(data[index_camac]);
+	    }
+
+	}
+      else
+	{
+	  for (int i=0; i < camac_ADC_num; i++)
+	    {
+	      index_camac++;
+	      camac_adcs_.push_back(data[index_camac]);
+	    }
+
+	  index_camac++;
+	  int camac_TDC_num = data[index_camac];
+	  for (int i = 0; i < camac_TDC_num; i++)
+	    {
+	      index_camac++;
+	      camac_tdcs_.push_back(data[index_camac]);
+	    }
+	}
+    }
+
+  // loop over data in this event group until the next event group shows up
+  // A partially-written buffer never comes here, RawRecordReader stops before it.
+  for (index += 2; index < start + cnt - 1; index++)
+    {
+      // ^= means XOR
+      checksum ^= data[index];
+
+      command_ = data[index];
+      int rawchip = -1;
+
+      // Check whether this word holds an event#, a full 16-bit BCO# or hit data:
+      if ((data[index] & 0xFFFF) == 1) {
+	event_fem_ = (data[index] & 0xFFFF0000) >> 16;
+	continue;
+      }
+      else if ((data[index] & 0xFFFF) == 2) {
+	bco_full_ = (data[index] & 0xFFFF0000) >> 16;
+	stats_.AddBco( bco_full_, 0x10000, fill );
+	continue;
+      }
+      else {
+	//check if this is a FEM_ID (bottom 12 bits = 0) or a data word:
+	if ((data[index] & 0xfff) == 0) {
+	  fem_id_ = (data[index] & 0xf000) >> 12;
+	  continue;
+	}
+	else {
+	  rawchip = (data[index] >> 3) & 0x3F;
+
+	  if (rawchip < 27)
+	    chip_id_ = rawchip;
+	  else
+	    chip_id_ = rawchip - 26;
+
+	  fpga_id_ = 0;
+
+	  if (fem_id_ == 1) {
+	    if (rawchip < 27)
+	      module_ = 1;
+	    else
+	      module_ = 2;
+	  }
+	  else if (fem_id_ == 2) {
+	    if (rawchip < 27)
+	      module_ = 3;
+	    else
+	      module_ = 4;
+	  }
+	  else if (fem_id_ == 4) {
+	    if (rawchip < 27)
+	      module_ = 7;
+	    else
+	      module_ = 8;
+	  }
+	  else if (fem_id_ == 8) {
+	    if (rawchip < 27)
+	      module_ = 5;
+	    else
+	      module_ = 6;
+	  }
+
+	  // assign data to each variable to fill TTree
+	  ampl_ = (data[index] >> 24) & 0x7F;
+	  bco_ = (data[index] >> 16) & 0x7F;
+	  chan_id_ = (data[index] >> 9) & 0x7F; //((data[index] & 0x200) >>3) | ((data[index] & 0xFC00)>>10); //data[index]>>9) & 0x7F; //
+	  adc_ = (data[index] & 0x07);
+
+	  if( fill )
+	    nhits_[chan_id_][ampl_]++;
+	}
+      }
+
+      if( fill ){
+	int noise;
+
+	if (ampl_ != 0)
+	  noise = 1;
+	else if (chip_id_ == 0 || chip_id_ > 26)
+	  noise = 1;
+	else if (chan_id_ == 0 || chan_id_ > 126)
+	  noise = 1;
+	else if (fem_id_ != 4 || module_ != 7)
+	  noise = 1;
+	else
+	  noise = 0;
+
+	if (noise != 0)
+	  inoise_++;
+	else if (noise == 0)
+	  ihealthy_++;
+      }
+
+      if (event_fem_ != old_event_fem_) {
+
+	if (old_event_fem_ >= 0) {
+
+	  for (int ichip = 0; ichip < 8; ichip++) {
+	    if (chiphit_[ichip] != 0)
+	      nchip_event_++;
+	  }
+
+	} // end of if( old_event_fem >= 0 )
+
+	nhit_event_ = 1;
+	nchip_event_ = 0;
+
+	for (int ichip = 0; ichip < 8; ichip++) {
+	  chiphit_[ichip] = 0;
+	}
+
+	if ((chip_id_ < 9) && (chip_id_ != 0)) {
+	  chiphit_[chip_id_ - 1]++;
+	}
+
+	old_event_fem_ = event_fem_;
+	old_bco_ = bco_;
+	old_bco_full_ = bco_full_;
+      } // end of if( event_fem != old_event_fem )
+      else {
+	nhit_event_++;
+	if ((chip_id_ < 9) && (chip_id_ != 0))
+	  chiphit_[chip_id_ - 1]++;
+      }
+
+      if( fill == false )
+	continue;
+
+      // hits in bad channels don't reach the trees
+      if( mask_ != nullptr && mask_->IsMasked( module_, chip_id_, chan_id_ ) ){
+	stats_.masked_hits_++;
+	continue;
+      }
+
+      // only the filled hits are counted, the masked ones are in masked_hits_
+      stats_.AddHit( fem_id_, rawchip );
+      if( count_cube_ != nullptr )
+	count_cube_->Fill( module_, chip_id_, chan_id_, ampl_, adc_ );
+
+      bcos_      .push_back( bco_      );
+      adcs_      .push_back( adc_      );
+      ampls_     .push_back( ampl_     );
+      chip_ids_  .push_back( chip_id_  );
+      fpga_ids_  .push_back( fpga_id_  );
+      modules_   .push_back( module_   );
+      fem_ids_   .push_back( fem_id_   );
+      chan_ids_  .push_back( chan_id_  );
+      bco_fulls_ .push_back( bco_full_ );
+      events_    .push_back( ievent_   );
+
+      if( verbosity_ >= DecodeStats::kHit )
+	cout << ievent_ << "\t" << adc_ << endl;
+
+      if( is_compact_ )
+	compact_.AddHit( tree_, adc_, ampl_, chip_id_, fpga_id_, module_, chan_id_, fem_id_, bco_, bco_full_ );
+      else
+	tree_->Fill();
+
+      // the hit is in the entry to be filled in the compact format
+      if( event_index_ != nullptr )
+	event_index_->Add( offset, ievent_, is_compact_ ? tree_->GetEntries() : tree_->GetEntries() - 1, fem_id_, event_fem_, bco_full_ );
+
+      //Note:  we seem to get some odd chip_ids out of the new DAQ VHDL code
+      //after the event gets larger than some value.  Need to understand this:
+
+      ievent_++;
+    }  //for loop on 	for (index += 2; index < start + cnt - 1; index++)
+
+  if( fill == false )
+    return;
+
+  if( is_compact_ )
+    compact_.Flush( tree_ );
+
+  stats_.words_ += cnt - 1;
+  if( (UInt_t)checksum != data[index] ){
+    stats_.bad_checksums_++;
+    if( verbosity_ >= DecodeStats::kRecord )
+      std::cout << "WARNING: bad checksum = "
+		<< std::hex << checksum << std::dec << std::endl;
+  }
+
+  // If there are only CAMAC data but no INTT data, fill CAMAC data to the tree
+  // -1 is filled to the branches for INTT events in this case.
+  if (cnt == 1) {
+    is_INTT_ = false;
+  } else {
+    is_INTT_ = true;
+  }
+
+  // make flag whether is event consists of a single bco or not
+  if( bcos_.size() != 0 ) // skip here if no INTT event is
+    {
+      int bco_min = *min_element( bcos_.begin(), bcos_.end() );
+      int bco_max = *max_element( bcos_.begin(), bcos_.end() );
+
+      if( bco_max - bco_min < 2 )
+	is_single_bco_event_ = true;
+      else
+	is_single_bco_event_ = false;
+    }
+
+  tree_both_->Fill();
+
+  // fill TTree for only CAMAC data if CAMAC data exits
+  if( mode_ != "calib" && mode_ != "external" )
+    tree_camac_->Fill();
+}
+
+void FelixDecoder::Append( TFile* tf, int event_offset )
+{
+  if( is_compact_ ){
+    // the event number is not stored, but bco_full is coded again since it's the difference from the previous entry
+    TTree* tree = (TTree*)tf->Get( "tree_compact" );
+    if( tree == nullptr )
+      return;
+
+    CompactHitTree compact;
+    compact.SetBranchAddresses( tree );
+    for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+      compact.GetEntry( tree, i );
+      compact.CopyTo( tree_, compact_ );
+    }
+    tree->ResetBranchAddresses();
+  }
+  else{
+    TTree* tree = (TTree*)tf->Get( "tree" );
+    if( tree == nullptr )
+      return;
+
+    tree->SetBranchAddress("adc", &adc_);
+    tree->SetBranchAddress("ampl", &ampl_);
+    tree->SetBranchAddress("chip_id", &chip_id_);
+    tree->SetBranchAddress("fpga_id", &fpga_id_);
+    tree->SetBranchAddress("module", &module_);
+    tree->SetBranchAddress("chan_id", &chan_id_);
+    tree->SetBranchAddress("fem_id", &fem_id_);
+    tree->SetBranchAddress("bco", &bco_);
+    tree->SetBranchAddress("bco_full", &bco_full_);
+    tree->SetBranchAddress("event", &ievent_);
+    tree->SetBranchAddress("command", &command_);
+
+    for( Long64_t i=0; i<tree->GetEntries(); i++ )
+      {
+	tree->GetEntry( i );
+	ievent_ += event_offset;
+	tree_->Fill();
+      }
+    tree->ResetBranchAddresses();
+  }
+
+  if( this->IsCamacMode() == false )
+    return;
+
+  // ROOT needs pointers to the vectors for reading
+  vector < int >* camac_adcs = &camac_adcs_;
+  vector < int >* camac_tdcs = &camac_tdcs_;
+
+  TTree* tree_camac = (TTree*)tf->Get( "tree_camac" );
+  tree_camac->SetBranchAddress("camac_adc", &camac_adcs);
+  tree_camac->SetBranchAddress("camac_tdc", &camac_tdcs);
+  tree_camac->SetBranchAddress("INTT_event", &is_INTT_);
+  for( Long64_t i=0; i<tree_camac->GetEntries(); i++ )
+    {
+      tree_camac->GetEntry( i );
+      tree_camac_->Fill();
+    }
+  tree_camac->ResetBranchAddresses();
+
+  vector < int >* adcs = &adcs_, *ampls = &ampls_, *chip_ids = &chip_ids_, *fpga_ids = &fpga_ids_, *modules = &modules_;
+  vector < int >* chan_ids = &chan_ids_, *fem_ids = &fem_ids_, *bcos = &bcos_, *bco_fulls = &bco_fulls_, *events = &events_;
+  vector < int >* nhits_in_cluster = &nhits_in_cluster_;
+  vector < float >* adc_voltages = &adc_voltages_;
+
+  TTree* tree_both = (TTree*)tf->Get( "tree_both" );
+  tree_both->SetBranchAddress("camac_adc", &camac_adcs);
+  tree_both->SetBranchAddress("camac_tdc", &camac_tdcs);
+  tree_both->SetBranchAddress("INTT_event", &is_INTT_);
+  if( mode_ == "camac_clustering" )
+    tree_both->SetBranchAddress("nhit_in_cluster", &nhits_in_cluster );
+
+  tree_both->SetBranchAddress("adc", &adcs );
+  tree_both->SetBranchAddress("adc_vol", &adc_voltages );
+  tree_both->SetBranchAddress("ampl", &ampls );
+  tree_both->SetBranchAddress("chip_id", &chip_ids );
+  tree_both->SetBranchAddress("fpga_id", &fpga_ids );
+  tree_both->SetBranchAddress("module", &modules );
+  tree_both->SetBranchAddress("chan_id", &chan_ids );
+  tree_both->SetBranchAddress("fem_id", &fem_ids );
+  tree_both->SetBranchAddress("bco", &bcos );
+  tree_both->SetBranchAddress("bco_full", &bco_fulls );
+  tree_both->SetBranchAddress("single_bco_event", &is_single_bco_event_ );
+  tree_both->SetBranchAddress("event", &events );
+
+  for( Long64_t i=0; i<tree_both->GetEntries(); i++ )
+    {
+      tree_both->GetEntry( i );
+      for( auto& event : events_ )
+	event += event_offset;
+
+      tree_both_->Fill();
+    }
+  tree_both->ResetBranchAddresses();
+}
+
+void FelixDecoder::Write()
+{
+  tree_->Write();
+  stats_.Write();
+  if( count_cube_ != nullptr )
+    count_cube_->Write();
+
+  if( this->IsCamacMode() ){
+    tree_camac_->Write();
+    tree_both_->Write();
+  }
+}
+
+bool DecodeFelixInParallel( string fname, FelixDecoder& output, int nthreads )
+{
+  int trailer_type = RawRecordReader::kNoTrailer;
+  if( output.IsCamacMode() )
+    trailer_type = output.is_old_camac_format_ ? RawRecordReader::kCamacTrailerOld : RawRecordReader::kCamacTrailer;
+
+  // 1st phase: make a list of records by reading only the headers
+  vector < RawRecordEntry > index;
+  Long64_t size = BuildRawRecordIndex( fname, trailer_type, index );
+  cout << "Records: " << index.size() << " (" << size << " bytes)" << endl;
+  if( index.size() == 0 )
+    return false;
+
+  // 2nd phase: each thread decodes a range of the records into its own file
+  TDirectory* output_dir = gDirectory;
+  auto ranges = SplitRawRecordIndex( index, nthreads );
+  vector < string > part_names( ranges.size() );
+  vector < int > part_hits( ranges.size(), 0 );
+  vector < int > part_noise( ranges.size(), 0 ), part_healthy( ranges.size(), 0 );
+  vector < DecodeStats > part_stats( ranges.size() );
+  vector < EventIndex > part_indexes( ranges.size() );
+  std::mutex cube_mutex; // the count cube of output is shared by the threads
+
+  // The parts are written next to the output file, or to the temporary directory if the output isn't a file.
+  // The names are unique, so runs at the same time don't clash.
+  TFile* output_file = output_dir->GetFile();
+  string part_dir = output_file != nullptr ? gSystem->GetDirName( output_file->GetName() ).Data() : gSystem->TempDirectory();
+  for( int part=0; part<ranges.size(); part++ ){
+    TString part_name = Form( "felix_part%d_", part );
+    FILE* fp = gSystem->TempFileName( part_name, part_dir.c_str() );
+    if( fp == nullptr ){
+      cerr << "Failed to make a temporary file in " << part_dir << endl;
+      for( int i=0; i<part; i++ )
+	gSystem->Unlink( part_names[i].c_str() );
+
+      return false;
+    }
+
+    fclose( fp );
+    part_names[part] = part_name.Data();
+  }
+
+  ROOT::EnableThreadSafety();
+  vector < std::thread > threads;
+  for( int part=0; part<ranges.size(); part++ ){
+
+    threads.push_back( std::thread( [&, part]() {
+
+      size_t first = ranges[part].first;
+      size_t last = ranges[part].second;
+
+      TFile* tf = new TFile( part_names[part].c_str(), "RECREATE" );
+      FelixDecoder decoder( output.mode_, output.is_old_camac_format_ );
+      HitCountCube cube;
+      decoder.verbosity_ = output.verbosity_;
+      decoder.is_compact_ = output.is_compact_;
+      decoder.compact_format_ = output.compact_format_;
+      decoder.mask_ = output.mask_; // it's only read
+      if( output.event_index_ != nullptr )
+	decoder.event_index_ = &part_indexes[part];
+      if( output.count_cube_ != nullptr )
+	decoder.count_cube_ = &cube;
+      decoder.MakeTrees();
+
+      RawRecordReader reader;
+      reader.SetTrailerType( (RawRecordReader::TrailerType)trailer_type );
+      reader.Open( fname );
+
+      // FEM_ID is carried over records. The records before this range are read back until a FEM_ID is found, then replayed without filling.
+      size_t warm_up = first;
+      while( warm_up > 0 ){
+	warm_up--;
+	reader.Seek( index[warm_up].offset );
+	if( reader.Next() && decoder.HasFemId( reader.GetRecord() ) )
+	  break;
+      }
+
+      reader.Seek( index[warm_up].offset );
+      for( size_t irecord = warm_up; irecord < first && reader.Next(); irecord++ )
+	decoder.Decode( reader.GetRecord(), irecord, false );
+
+      // decode records in this range
+      for( size_t irecord = first; irecord < last && reader.Next(); irecord++ )
+	decoder.Decode( reader.GetRecord(), irecord, true, index[irecord].offset );
+
+      part_hits[part] = decoder.ievent_;
+      part_noise[part] = decoder.inoise_;
+      part_healthy[part] = decoder.ihealthy_;
+      part_stats[part] = decoder.stats_;
+      decoder.count_cube_ = nullptr; // it's merged in the memory, not written to the temporary file
+
+      // The cube is merged as soon as the range is done and it's freed at the end of the thread, so the cubes of finished ranges aren't kept.
+      if( output.count_cube_ != nullptr ){
+	std::lock_guard < std::mutex > lock( cube_mutex );
+	output.count_cube_->Add( cube );
+      }
+
+      tf->cd();
+      decoder.Write();
+      tf->Close();
+      delete tf;
+    }) );
+  }
+
+  for( auto& thread : threads )
+    thread.join();
+
+  // merge the trees in the order of the records
+  int event_offset = 0;
+  for( int part=0; part<ranges.size(); part++ ){
+
+    TFile* tf = new TFile( part_names[part].c_str(), "READ" );
+    if( output.event_index_ != nullptr )
+      output.event_index_->Append( part_indexes[part], event_offset, output.tree_->GetEntries() );
+
+    output.Append( tf, event_offset );
+    tf->Close();
+    delete tf;
+    gSystem->Unlink( part_names[part].c_str() );
+
+    event_offset += part_hits[part];
+    output.inoise_ += part_noise[part];
+    output.ihealthy_ += part_healthy[part];
+    output.stats_.Add( part_stats[part] );
+  }
+
+  // the scan stops at a partially-written record at the end of the file
+  RawRecordReader reader;
+  if( reader.Open( fname ) && reader.GetFileSize() > size )
+    output.stats_.partial_buffers_++;
+
+  output.ievent_ = event_offset;
+  output_dir->cd();
+  return true;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include "RawRecordReader.hh"
+#include "RawRecordIndex.hh"
+#include "DecodeStats.hh"
+#include "EventIndex.hh"
+#include "CompactHitTree.hh"
+#include "ChannelMask.hh"
+#include "HitCountCube.hh"
+
+/*!
+  @class FelixDecoder
+  @brief A record in a .dat file is decoded and filled to TTrees, tree, tree_camac, and tree_both.
+  @details It was the loop over records in MakeTree (check_chip_prototypeMaximum7.c). It was moved to this class to decode records in parallel.
+  Variables for branches are public members as INTTHit does.
+
+  How to use:
+    FelixDecoder decoder( "calib", false );
+    decoder.MakeTrees(); // trees are made in the current directory
+    while( reader.Next() )
+      decoder.Decode( reader.GetRecord(), reader.GetRecordCount() - 1 );
+    decoder.Write();
+*/
+class FelixDecoder
+{
+public:
+  string mode_ = "calib";
+  bool is_old_camac_format_ = false;
+
+  // variables for branches of tree
+  UInt_t command_ = 0;
+  int adc_ = -1, ampl_ = -1, chip_id_ = -1, fpga_id_ = -1, module_ = -1, chan_id_ = -1, fem_id_ = -1, bco_ = -1, bco_full_ = -1;
+  int ievent_ = 0; //!< serial number of hits
+
+  // variables for branches of tree_both and tree_camac
+  vector < int > adcs_, ampls_, chip_ids_, fpga_ids_, modules_, chan_ids_, fem_ids_, bcos_, bco_fulls_, events_, nhits_in_cluster_;
+  vector < float > adc_voltages_;
+  vector < int > camac_adcs_, camac_tdcs_;
+  bool is_INTT_ = true, is_single_bco_event_ = false;
+
+  TTree* tree_ = nullptr;
+  TTree* tree_camac_ = nullptr;
+  TTree* tree_both_ = nullptr;
+
+  // counters
+  int inoise_ = 0, ihealthy_ = 0;
+  int nhits_[128][128] = { { 0 } }; // the number of hits for each channel and amplitude, not used, why?
+  DecodeStats stats_;
+
+  int verbosity_ = DecodeStats::kSummary; //!< console outputs, see DecodeStats::Verbosity
+  EventIndex* event_index_ = nullptr;      //!< hits are added to it if it's given
+  const ChannelMask* mask_ = nullptr;      //!< hits in the masked channels are not filled if it's given
+  HitCountCube* count_cube_ = nullptr;     //!< filled hits are counted in it and it's written by Write if it's given
+
+  // the compact format, hits are filled to tree_compact instead of tree (see CompactHitTree)
+  bool is_compact_ = false;
+  CompactFormat compact_format_;
+  CompactHitTree compact_;
+
+  FelixDecoder( string mode = "calib", bool is_old_camac_format = false );
+
+  bool IsCamacMode(){ return mode_ == "camac" || mode_ == "camac_clustering"; };
+
+  /*!
+    @brief The output format of hits is set, it has to be done before MakeTrees.
+    @param format "" for tree with a branch for each variable, "compact..." for tree_compact (see CompactFormat)
+  */
+  bool SetFormat( string format );
+
+  //! tree (or tree_compact), tree_camac, and tree_both are made in the current directory. tree_ points to tree_compact in the compact format.
+  void MakeTrees();
+
+  /*!
+    @brief The decoder is set up for the ROOT file in the same way for MakeTree, BatchConverter, and FelixFollower
+    @details The format is set (the compression of the compact format is set to tf), the trees are made in tf,
+    and the mask, the event index, and the count cube are used if they're given.
+    @retval false if the format isn't supported
+  */
+  bool SetUp( TFile* tf, string format = "", const ChannelMask* mask = nullptr, EventIndex* event_index = nullptr, HitCountCube* count_cube = nullptr );
+
+  /*!
+    @brief A record is decoded.
+    @param data Words of the record, data[0] is buflen
+    @param bufcnt Serial number of the record in the file
+    @param fill If false, only the state carried over records (fem_id, event_fem) is updated. Nothing is filled.
+    @param offset Byte offset of the record in the file, it's used for the event index
+  */
+  void Decode( const UInt_t* data, Long64_t bufcnt, bool fill = true, Long64_t offset = -1 );
+
+  //! true if a FEM_ID word is in the record, it means that the record doesn't depend on the records before
+  bool HasFemId( const UInt_t* data );
+
+  //! Entries in the trees in the given file, made by another FelixDecoder, are appended. The event numbers are shifted by event_offset.
+  void Append( TFile* tf, int event_offset );
+
+  //! The trees, the statistics (decode_stats), and the count cube (count_cube) are written to the current directory
+  void Write();
+
+private:
+  // state carried over hits and records
+  int event_fem_ = -999, old_event_fem_ = -999;
+  int nhit_event_ = 0, nchip_event_ = 0;
+  int chiphit_[8] = { 0 };
+  int old_bco_ = -1, old_bco_full_ = -1;
+
+  void ClearRecord();
+};
+
+/*!
+  @fn bool DecodeFelixInParallel( string fname, FelixDecoder& output, int nthreads )
+  @brief Records in the file are decoded by nthreads threads and merged into the trees of output in the order of the records.
+  @details It's done in two phases:
+    1. Only the record headers are read to make a list of the records (BuildRawRecordIndex).
+    2. The list is divided into nthreads ranges with a similar size. Each thread decodes a range into its own trees in a temporary ROOT file.
+  The trees are merged into output in the order of the ranges. The serial number of hits (event) is shifted so that it's the same as the serial decoding.
+  The temporary files are made next to the file of the current directory (the output) with unique names, and they are removed at the end.
+  If output has the event index or the count cube, the ones of the ranges are merged into them as well.
+  Each thread counts hits in its own HitCountCube, which has a dense block of 512 kB for each (module, chip_id) with hits (26 MB for 2 modules),
+  and it's added to the cube of output when the range is done. So up to nthreads + 1 cubes are in the memory at the same time.
+*/
+bool DecodeFelixInParallel( string fname, FelixDecoder& output, int nthreads );
+
+#ifndef FELIX_DECODER_source
+#define FELIX_DECODER_source
+
+#include "FelixDecoder.cc"
+#endif //  FELIX_DECODER_source
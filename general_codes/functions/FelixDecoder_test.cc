@@ -0,0 +1,63 @@
+#include "FelixDecoder.hh"
+#include "RawDataGenerator.hh"
+
+/*!
+  @fn int FelixDecoder_test( string fname )
+  @brief Checksums of records are checked by FelixDecoder in the same way as fphx_raw2root.C
+  @details The checksum is XOR of buflen, the buffer id, and the data words. A record written by hand with the checksum calculated
+  by hand has to be good, and the same record with a wrong checksum has to be bad.
+  Then the records of RawDataGenerator with corrupt records have to give as many bad checksums as the corrupt records.
+  Usage: root -l -b -q 'functions/FelixDecoder_test.cc+( "/tmp/FelixDecoder_test.dat" )'
+  @retval The number of failed cases
+*/
+int FelixDecoder_test( string fname = "FelixDecoder_test.dat" )
+{
+  int failures = 0;
+
+  // buflen, buffer id, 2 event_fem words, checksum. 4 ^ 102 ^ 0x00050001 ^ 0x00060001 = 0x00030062
+  UInt_t record[5] = { 4, 102, 0x00050001, 0x00060001, 0x00030062 };
+  for( UInt_t checksum : { 0x00030062u, 0x00030000u } ){
+    record[4] = checksum;
+    FelixDecoder decoder( "calib" );
+    decoder.verbosity_ = DecodeStats::kQuiet;
+    decoder.MakeTrees();
+    decoder.Decode( record, 0 );
+
+    Long64_t expected = checksum == 0x00030062u ? 0 : 1;
+    bool is_ok = decoder.stats_.bad_checksums_ == expected;
+    if( is_ok == false )
+      failures++;
+
+    cout << ( is_ok ? "OK  " : "FAIL" ) << " a record with the checksum 0x" << hex << checksum << dec << ": "
+	 << decoder.stats_.bad_checksums_ << " bad checksums, " << expected << " expected" << endl;
+
+    delete decoder.tree_;
+    delete decoder.tree_camac_;
+    delete decoder.tree_both_;
+  }
+
+  RawDataGenerator generator( 1 );
+  generator.corrupt_fraction_ = 0.1;
+  generator.Generate( fname, 1000000 );
+
+  FelixDecoder decoder( "calib" );
+  decoder.verbosity_ = DecodeStats::kQuiet;
+  decoder.MakeTrees();
+  RawRecordReader reader;
+  reader.Open( fname );
+  for( Long64_t irecord=0; reader.Next(); irecord++ )
+    decoder.Decode( reader.GetRecord(), irecord );
+
+  bool is_ok = generator.corrupt_records_ > 0 && decoder.stats_.bad_checksums_ == generator.corrupt_records_;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " RawDataGenerator: " << decoder.stats_.bad_checksums_ << " bad checksums, "
+       << generator.corrupt_records_ << " corrupt records" << endl;
+
+  delete decoder.tree_;
+  delete decoder.tree_camac_;
+  delete decoder.tree_both_;
+  remove( fname.c_str() );
+  return failures;
+}
@@ -0,0 +1,337 @@
+#include "FelixFollower.hh"
+
+FelixFollower::FelixFollower( string fname, string mode, bool is_old_camac_format, bool per_chunk )
+{
+  fname_ = fname;
+  mode_ = mode;
+  is_old_camac_format_ = is_old_camac_format;
+  per_chunk_ = per_chunk;
+
+  // the same name as MakeTree, for example, nwu_fphx_20200101_000000_0.dat -> nwu_fphx_20200101_000000_0.root
+  output_ = fname_.substr( 0, fname_.find_last_of( "." ) ) + ".root";
+}
+
+bool FelixFollower::SetFormat( string format )
+{
+  // only for the check
+  FelixDecoder decoder( mode_ );
+  if( decoder.SetFormat( format ) == false )
+    return false;
+
+  format_ = format;
+  return true;
+}
+
+bool FelixFollower::SetMask( string mask )
+{
+  is_masked_ = false;
+  if( mask == "" )
+    return true;
+
+  if( mask_.Load( mask ) < 0 )
+    return false;
+
+  if( verbosity_ >= DecodeStats::kSummary )
+    mask_.Print();
+
+  is_masked_ = true;
+  return true;
+}
+
+string FelixFollower::GetChunkName( int chunk )
+{
+  return output_.substr( 0, output_.find_last_of( "." ) ) + Form( "_chunk%04d.root", chunk );
+}
+
+string FelixFollower::GetCheckpointName()
+{
+  // AccessPathName returns false if the file exists
+  if( per_chunk_ == false )
+    return gSystem->AccessPathName( output_.c_str() ) ? "" : output_;
+
+  // a chunk file is made by renaming a complete file, so the last one has the latest checkpoint
+  int chunk = 0;
+  while( gSystem->AccessPathName( this->GetChunkName( chunk ).c_str() ) == false )
+    chunk++;
+
+  return chunk > 0 ? this->GetChunkName( chunk - 1 ) : "";
+}
+
+bool FelixFollower::LoadCheckpoint()
+{
+  offset_ = records_ = entries_ = 0;
+  ievent_ = inoise_ = ihealthy_ = chunk_ = last_bco_full_ = 0;
+  fem_id_ = -1;
+
+  string name = this->GetCheckpointName();
+  if( name == "" )
+    return false;
+
+  TDirectory* dir = gDirectory;
+  TFile* tf = new TFile( name.c_str(), "READ" );
+  TTree* tree = tf->IsZombie() ? nullptr : (TTree*)tf->Get( "follower_checkpoint" );
+  bool is_loaded = tree != nullptr && tree->GetEntries() > 0;
+  if( is_loaded ){
+    tree->SetBranchAddress( "offset", &offset_ );
+    tree->SetBranchAddress( "records", &records_ );
+    tree->SetBranchAddress( "entries", &entries_ );
+    tree->SetBranchAddress( "event", &ievent_ );
+    tree->SetBranchAddress( "fem_id", &fem_id_ );
+    tree->SetBranchAddress( "inoise", &inoise_ );
+    tree->SetBranchAddress( "ihealthy", &ihealthy_ );
+    tree->SetBranchAddress( "chunk", &chunk_ );
+    if( tree->GetBranch( "last_bco_full" ) != nullptr )
+      tree->SetBranchAddress( "last_bco_full", &last_bco_full_ );
+
+    tree->GetEntry( 0 );
+    tree->ResetBranchAddresses();
+  }
+  else if( verbosity_ >= DecodeStats::kSummary ){
+    cout << "No checkpoint in " << name << ". Start from the beginning." << endl;
+  }
+
+  tf->Close();
+  delete tf;
+  dir->cd();
+  return is_loaded;
+}
+
+void FelixFollower::WriteCheckpoint()
+{
+  TTree* tree = new TTree( "follower_checkpoint", "state of FelixFollower" );
+  tree->Branch( "offset", &offset_, "offset/L" );
+  tree->Branch( "records", &records_, "records/L" );
+  tree->Branch( "entries", &entries_, "entries/L" );
+  tree->Branch( "event", &ievent_, "event/I" );
+  tree->Branch( "fem_id", &fem_id_, "fem_id/I" );
+  tree->Branch( "inoise", &inoise_, "inoise/I" );
+  tree->Branch( "ihealthy", &ihealthy_, "ihealthy/I" );
+  tree->Branch( "chunk", &chunk_, "chunk/I" );
+  tree->Branch( "last_bco_full", &last_bco_full_, "last_bco_full/I" );
+  tree->Fill();
+  tree->Write();
+}
+
+void FelixFollower::Reset()
+{
+  this->LoadCheckpoint();
+  if( per_chunk_ ){
+    for( int chunk=0; chunk<chunk_; chunk++ ){
+      gSystem->Unlink( this->GetChunkName( chunk ).c_str() );
+      gSystem->Unlink( GetEventIndexName( this->GetChunkName( chunk ) ).c_str() );
+    }
+  }
+  else if( offset_ > 0 ){
+    gSystem->Unlink( output_.c_str() );
+    gSystem->Unlink( GetEventIndexName( output_ ).c_str() );
+  }
+
+  this->LoadCheckpoint();
+}
+
+bool FelixFollower::AppendToOutput( TFile* tf_from )
+{
+  TFile* tf = new TFile( output_.c_str(), "UPDATE" );
+  if( tf->IsZombie() ){
+    cerr << "Failed to open " << output_ << endl;
+    delete tf;
+    return false;
+  }
+
+  tf->cd();
+  string names[4] = { "tree", "tree_compact", "tree_camac", "tree_both" };
+  for( auto& name : names ){
+    TTree* tree_from = (TTree*)tf_from->Get( name.c_str() );
+    if( tree_from == nullptr )
+      continue;
+
+    TTree* tree = (TTree*)tf->Get( name.c_str() );
+    if( tree == nullptr ){
+      cerr << name << " is not found in " << output_ << endl;
+      continue;
+    }
+
+    if( name == "tree_compact" ){
+      // bco_full in tf_from is coded from 0, it's coded again from the last entry of the output
+      CompactHitTree compact_from, compact;
+      compact_from.SetBranchAddresses( tree_from );
+      compact.Attach( tree, last_bco_full_ );
+      for( Long64_t i=0; i<tree_from->GetEntries(); i++ ){
+	compact_from.GetEntry( tree_from, i );
+	compact_from.CopyTo( tree, compact );
+      }
+
+      last_bco_full_ = compact.GetLastBcoFull();
+      tree_from->ResetBranchAddresses();
+      tree->ResetBranchAddresses();
+    }
+    else{
+      tree->CopyEntries( tree_from );
+    }
+
+    tree->Write( "", TObject::kOverwrite );
+  }
+
+  // the statistics are summed
+  DecodeStats stats, stats_from;
+  stats.Read( tf );
+  stats_from.Read( tf_from );
+  stats.Add( stats_from );
+  tf->cd();
+  tf->Delete( "decode_stats;*" );
+  stats.Write();
+
+  // so are the count cubes
+  HitCountCube count_cube, count_cube_from;
+  if( count_cube_from.Read( tf_from ) ){
+    count_cube.Read( tf );
+    count_cube.Add( count_cube_from );
+    tf->cd();
+    tf->Delete( "count_cube;*" );
+    count_cube.Write();
+  }
+
+  // the checkpoint is written in the same update as the entries
+  tf->cd();
+  tf->Delete( "follower_checkpoint;*" );
+  this->WriteCheckpoint();
+
+  tf->Close();
+  delete tf;
+  return true;
+}
+
+Long64_t FelixFollower::Poll()
+{
+  this->LoadCheckpoint();
+
+  RawRecordReader reader;
+  if( mode_ == "camac" || mode_ == "camac_clustering" )
+    reader.SetTrailerType( is_old_camac_format_ ? RawRecordReader::kCamacTrailerOld : RawRecordReader::kCamacTrailer );
+
+  if( reader.Open( fname_ ) == false )
+    return -1;
+
+  Long64_t size = reader.GetFileSize();
+  if( size < offset_ ){
+    cerr << fname_ << " is smaller than the checkpoint (" << size << " < " << offset_ << " bytes). Start from the beginning." << endl;
+    this->Reset();
+  }
+
+  if( size == offset_ || reader.Seek( offset_ ) == false )
+    return 0;
+
+  // The records are decoded into a temporary file. It's renamed to the output at the first poll or to a chunk, otherwise it's appended to the output.
+  bool is_append = per_chunk_ == false && offset_ > 0;
+  string poll_output = per_chunk_ ? this->GetChunkName( chunk_ ) : output_;
+  string temp = output_.substr( 0, output_.find_last_of( "." ) ) + "_follow_temp.root";
+
+  TDirectory* dir = gDirectory;
+  TFile* tf = new TFile( temp.c_str(), "RECREATE" );
+  FelixDecoder decoder( mode_, is_old_camac_format_ );
+  decoder.verbosity_ = verbosity_;
+  EventIndex event_index;
+  HitCountCube count_cube;
+  decoder.SetUp( tf, format_, is_masked_ ? &mask_ : nullptr, &event_index, &count_cube );
+
+  // the state carried over records
+  decoder.ievent_ = ievent_;
+  decoder.fem_id_ = fem_id_;
+
+  Long64_t nrecords = 0;
+  while( reader.Next() ){
+    decoder.Decode( reader.GetRecord(), records_ + nrecords, true, reader.GetRecordOffset() );
+    nrecords++;
+  }
+
+  if( nrecords == 0 ){
+    tf->Close();
+    delete tf;
+    gSystem->Unlink( temp.c_str() );
+    dir->cd();
+    return 0;
+  }
+
+  // the new state. A partially-written record is left for the next poll. After Next() fails, the record offset points to the head of it.
+  int first_event = ievent_;
+  Long64_t first_entry = entries_;
+  offset_ = reader.GetRecordOffset();
+  records_ += nrecords;
+  entries_ += decoder.tree_->GetEntries();
+  ievent_ = decoder.ievent_;
+  fem_id_ = decoder.fem_id_;
+  inoise_ += decoder.inoise_;
+  ihealthy_ += decoder.ihealthy_;
+  if( per_chunk_ )
+    chunk_++;
+
+  // the output is the temporary file itself, otherwise it's updated by AppendToOutput
+  if( is_append == false )
+    last_bco_full_ = decoder.compact_.GetLastBcoFull();
+
+  tf->cd();
+  decoder.Write();
+  if( is_append == false )
+    this->WriteCheckpoint();
+
+  tf->Close();
+  delete tf;
+
+  // The event index is written before the ROOT file. If it's stopped in between, the entries after the checkpoint are replaced in the next poll.
+  if( is_append ){
+    // the TTree entries in the temporary file start from 0, they follow the entries in the output
+    EventIndex event_index_all;
+    event_index_all.Read( GetEventIndexName( output_ ) );
+    event_index_all.Truncate( first_event );
+    event_index_all.Append( event_index, 0, first_entry );
+    event_index_all.Write( GetEventIndexName( output_ ) );
+
+    TFile* tf_temp = new TFile( temp.c_str(), "READ" );
+    bool is_appended = this->AppendToOutput( tf_temp );
+    tf_temp->Close();
+    delete tf_temp;
+    gSystem->Unlink( temp.c_str() );
+
+    if( is_appended == false ){
+      dir->cd();
+      return -1;
+    }
+  }
+  else{
+    event_index.Write( GetEventIndexName( poll_output ) );
+    if( rename( temp.c_str(), poll_output.c_str() ) != 0 ){
+      cerr << "Failed to rename " << temp << " to " << poll_output << endl;
+      dir->cd();
+      return -1;
+    }
+  }
+
+  if( verbosity_ >= DecodeStats::kSummary )
+    cout << "Poll: " << nrecords << " records, " << offset_ << " / " << size << " bytes -> " << poll_output << endl;
+
+  if( verbosity_ >= DecodeStats::kRecord )
+    decoder.stats_.Print();
+
+  dir->cd();
+  return nrecords;
+}
+
+Long64_t FelixFollower::Follow( double interval, double timeout )
+{
+  Long64_t total = 0;
+  double idle = 0;
+  while( timeout < 0 || idle < timeout ){
+
+    Long64_t nrecords = this->Poll();
+    if( nrecords < 0 )
+      break;
+
+    total += nrecords;
+    idle = nrecords > 0 ? 0 : idle + interval;
+
+    gSystem->Sleep( (UInt_t)( interval * 1000 ) );
+    gSystem->ProcessEvents(); // to be stopped by ctrl-c
+  }
+
+  return total;
+}
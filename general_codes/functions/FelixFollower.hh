@@ -0,0 +1,97 @@
+#pragma once
+
+#include "FelixDecoder.hh"
+
+/*!
+  @class FelixFollower
+  @brief A .dat file which is still written by the DAQ is decoded incrementally. Only the records appended since the last poll are decoded.
+  @details The byte offset after the last complete record and the state carried over records (serial number of hits, FEM_ID, counters) are kept
+  as the TTree "follower_checkpoint" in the ROOT file, together with the decoded hits. A partially-written record at the end is left for the next poll.
+  The decoded records are
+    - appended to the trees in the ROOT file made by MakeTree (default), or
+    - saved into a new ROOT file "<name>_chunk0000.root", "<name>_chunk0001.root", ... for each poll (per_chunk = true).
+  Records of a poll are decoded into a temporary file. It's renamed to the output (the first poll or a chunk), or its entries, the statistics,
+  the count cube, and the checkpoint are written to the output in one update, so the output and the checkpoint don't go out of step.
+  If the program is stopped during a poll, the records of the poll are decoded again in the next poll.
+  The event index (see EventIndex) of each ROOT file is updated in the same way. It's written before the ROOT file, and the entries after the checkpoint are
+  replaced in the next poll.
+  The format, the channel mask, and the count cube are the same as MakeTree (see FelixDecoder::SetUp).
+
+  How to use:
+    FelixFollower follower( "data/calib_packv1_220927_1700.dat", "calib" );
+    follower.SetMask( "5=ladder_files/B1L101/bad_channel_summary.root:0" ); // optional
+    follower.Poll();  // decodes new records once
+    follower.Follow( 5, 600 ); // polls every 5 s until the file doesn't grow for 600 s
+*/
+class FelixFollower
+{
+public:
+  FelixFollower( string fname, string mode = "calib", bool is_old_camac_format = false, bool per_chunk = false );
+
+  //! The format of the ROOT files, see FelixDecoder::SetFormat. false is returned for an unknown format.
+  bool SetFormat( string format );
+
+  //! Hits in the channels masked by ChannelMask::Load( mask ) are not filled. false is returned if it can't be loaded.
+  bool SetMask( string mask );
+
+  //! New records are decoded and saved. The number of the decoded records is returned, -1 for an error.
+  Long64_t Poll();
+
+  /*!
+    @brief Poll() is called every interval seconds until the file doesn't grow for timeout seconds. The number of the decoded records is returned.
+    @param timeout If it's negative, it never stops.
+  */
+  Long64_t Follow( double interval = 5, double timeout = 600 );
+
+  //! The checkpoint and the output files are removed, the next poll starts from the beginning of the file
+  void Reset();
+
+  string GetOutputName(){ return output_; };
+
+  //! The ROOT file with the checkpoint, the output or the last chunk. "" if nothing is decoded yet.
+  string GetCheckpointName();
+  Long64_t GetOffset(){ return offset_; };
+  Long64_t GetRecords(){ return records_; };
+  int GetChunk(){ return chunk_; };
+
+  int verbosity_ = DecodeStats::kSummary; //!< see DecodeStats::Verbosity
+
+private:
+  string fname_;
+  string mode_;
+  bool is_old_camac_format_;
+  bool per_chunk_;
+  string format_ = "";
+  ChannelMask mask_;
+  bool is_masked_ = false;
+
+  string output_;     //!< ROOT file made in the same way as MakeTree
+
+  // state saved in the checkpoint
+  Long64_t offset_ = 0;  //!< byte offset after the last decoded record
+  Long64_t records_ = 0; //!< number of the decoded records
+  Long64_t entries_ = 0; //!< number of the entries of tree (or tree_compact) in the output
+  int ievent_ = 0, fem_id_ = -1, inoise_ = 0, ihealthy_ = 0;
+  int chunk_ = 0;        //!< number of the chunk files
+  int last_bco_full_ = 0; //!< the base of the delta coding of bco_full in tree_compact of the output (see CompactHitTree)
+
+  //! The state is read from the file given by GetCheckpointName. false is returned if it's not found, and the state starts from the beginning.
+  bool LoadCheckpoint();
+
+  //! The state is written as the TTree "follower_checkpoint" to the current directory
+  void WriteCheckpoint();
+
+  string GetChunkName( int chunk );
+
+  /*!
+    @brief The trees, decode_stats, and count_cube in tf_from are appended to those in the file of output_, and the checkpoint is written with them
+    @details The entries of tree_compact are coded again by CompactHitTree::CopyTo, since bco_full is the difference from the previous entry.
+  */
+  bool AppendToOutput( TFile* tf_from );
+};
+
+#ifndef FELIX_FOLLOWER_source
+#define FELIX_FOLLOWER_source
+
+#include "FelixFollower.cc"
+#endif //  FELIX_FOLLOWER_source
@@ -0,0 +1,98 @@
+#include "FelixFollower.hh"
+#include "RawDataGenerator.hh"
+
+//! bco_full of all entries of tree_compact in the ROOT file
+vector < int > FelixFollower_test_ReadBcoFulls( string root_file )
+{
+  vector < int > bco_fulls;
+  TDirectory* dir = gDirectory;
+  TFile* tf = new TFile( root_file.c_str(), "READ" );
+  TTree* tree = (TTree*)tf->Get( "tree_compact" );
+  if( tree != nullptr ){
+    CompactHitTree compact;
+    compact.SetBranchAddresses( tree );
+    for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+      compact.GetEntry( tree, i );
+      bco_fulls.push_back( compact.bco_full_ );
+    }
+  }
+
+  tf->Close();
+  delete tf;
+  dir->cd();
+  return bco_fulls;
+}
+
+//! The first bytes of the file are copied, like a file which is still written by the DAQ
+void FelixFollower_test_CopyHead( string from, string to, Long64_t bytes )
+{
+  ifstream ifs( from.c_str(), ios::binary );
+  vector < char > buffer( bytes );
+  ifs.read( &buffer[0], bytes );
+
+  ofstream ofs( to.c_str(), ios::binary | ios::trunc );
+  ofs.write( &buffer[0], ifs.gcount() );
+}
+
+/*!
+  @fn int FelixFollower_test( string fname )
+  @brief bco_full of the compact format is decoded correctly from an output made by two polls
+  @details bco_full of tree_compact is the difference from the previous entry. The file is followed by two polls,
+  the first one with the first half of the file (cut in the middle of a record) and the second one with the rest,
+  and bco_full of all entries has to be the same as the file decoded by one poll.
+  Usage: root -l -b -q 'functions/FelixFollower_test.cc+( "/tmp/FelixFollower_test.dat" )'
+  @retval The number of failed cases
+*/
+int FelixFollower_test( string fname = "FelixFollower_test.dat" )
+{
+  string base = fname.substr( 0, fname.find_last_of( "." ) );
+  string full = base + "_full.dat";
+  RawDataGenerator generator( 1 );
+  Long64_t bytes = generator.Generate( full, 2000000 );
+
+  // decoded by one poll
+  FelixFollower reference( full, "calib" );
+  reference.verbosity_ = DecodeStats::kQuiet;
+  reference.SetFormat( "compact" );
+  reference.Reset();
+  reference.Poll();
+  vector < int > expected = FelixFollower_test_ReadBcoFulls( reference.GetOutputName() );
+
+  // decoded by two polls
+  FelixFollower follower( fname, "calib" );
+  follower.verbosity_ = DecodeStats::kQuiet;
+  follower.SetFormat( "compact" );
+  follower.Reset();
+  FelixFollower_test_CopyHead( full, fname, bytes / 2 + 3 );
+  follower.Poll();
+  Long64_t first_records = follower.GetRecords();
+  FelixFollower_test_CopyHead( full, fname, bytes );
+  follower.Poll();
+  vector < int > bco_fulls = FelixFollower_test_ReadBcoFulls( follower.GetOutputName() );
+
+  int failures = 0;
+  bool is_ok = 0 < first_records && first_records < follower.GetRecords() && follower.GetRecords() == reference.GetRecords();
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " two polls: " << first_records << " + " << follower.GetRecords() - first_records
+       << " records, " << reference.GetRecords() << " by one poll" << endl;
+
+  int mismatches = 0;
+  for( size_t i=0; i<bco_fulls.size() && i<expected.size(); i++ )
+    if( bco_fulls[i] != expected[i] )
+      mismatches++;
+
+  is_ok = expected.size() > 0 && bco_fulls.size() == expected.size() && mismatches == 0;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " bco_full of tree_compact: " << bco_fulls.size() << "/" << expected.size() << " entries, "
+       << mismatches << " different" << endl;
+
+  reference.Reset();
+  follower.Reset();
+  remove( full.c_str() );
+  remove( fname.c_str() );
+  return failures;
+}
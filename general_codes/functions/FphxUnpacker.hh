@@ -0,0 +1,294 @@
+#pragma once
+
+#include <vector>
+
+/*!
+  @file FphxUnpacker.hh
+  @brief Hit words of the FPHX data are unpacked for each revision of the hit format (fphxrev in fphx_raw2root.C)
+  @details The unpacker for the revision is selected once per file by GetFphxUnpacker, so no "if( fphxrev == ... )" is evaluated for each word.
+  Words are unpacked kFphxBlock words at once into arrays of each field (FphxHitBlock), then the hits to be kept are copied to FphxHitColumns.
+  Bit extraction in a block has no branch so that compilers can vectorize it.
+
+  How to use:
+    FphxUnpackFunction unpack = GetFphxUnpacker( fphxrev ); // nullptr for an unknown revision
+    FphxHitColumns hits;
+    unsigned int nhits = unpack( words, nwords, hits );
+    for( unsigned int i=0; i<nhits; i++ ) hits.chan[i] ...
+
+  A benchmark is in FphxUnpacker_benchmark.cc.
+*/
+
+//! Number of words unpacked at once
+const int kFphxBlock = 16;
+
+//! Fields of kFphxBlock words
+struct FphxHitBlock
+{
+  unsigned int word[kFphxBlock];
+  unsigned short chan[kFphxBlock];
+  unsigned short amp[kFphxBlock];
+  unsigned short adc[kFphxBlock];
+  unsigned short bco[kFphxBlock];
+  unsigned short fpga[kFphxBlock];
+  unsigned short module[kFphxBlock];
+  unsigned short side[kFphxBlock];
+  unsigned short chip[kFphxBlock];
+  unsigned char keep[kFphxBlock]; //!< 0 if the word is not a hit
+};
+
+//! Unpacked hits of a buffer, a vector for each field
+struct FphxHitColumns
+{
+  std::vector < unsigned int > word;
+  std::vector < unsigned short > chan, amp, adc, bco, fpga, module, side, chip;
+
+  void Reserve( unsigned int n )
+  {
+    if( word.size() >= n )
+      return;
+
+    word.resize( n );
+    chan.resize( n );
+    amp.resize( n );
+    adc.resize( n );
+    bco.resize( n );
+    fpga.resize( n );
+    module.resize( n );
+    side.resize( n );
+    chip.resize( n );
+  }
+};
+
+/*!
+  @struct FphxFormat
+  @brief Bit layout of a hit word. It's specialized for each revision.
+  @details Unpack( words, index, block ) fills block with the fields of words[0..kFphxBlock-1]. index is the position of words[0] in the buffer.
+*/
+template < int REV > struct FphxFormat;
+
+//! 0 = first FPHX1 format from first Xilinx board (repacked in the fpga output)
+template <> struct FphxFormat < 0 >
+{
+  static inline void Unpack( const unsigned int* words, unsigned int /*index*/, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+
+      // This is copied straight out of ReadDigChan-IntClk-DigRef.c,
+      // but I do not know why this is necessary.  Should be redundant, though.
+      b.keep[k]   = ( w & 0x00000001 ) != 0;
+      b.word[k]   = 0; // word is not filled for this revision
+      b.bco[k]    = ( w & 0x3F000000 ) >> 24;
+      b.adc[k]    = ( w & 0x00380000 ) >> 19;
+      b.chan[k]   = ( w & 0x0003F800 ) >> 11;
+      b.amp[k]    = ( w & 0x000007FE ) >> 1;
+      b.side[k]   = 0;
+      b.fpga[k]   = 0;
+      b.chip[k]   = 0;
+      b.module[k] = 0;
+    }
+  }
+};
+
+//! 3 = 8/13/2009 Test beam ROC format (FPHX1) and second file format (updated daq code midway thru day)
+template <> struct FphxFormat < 3 >
+{
+  static inline void Unpack( const unsigned int* words, unsigned int index, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+
+      // There is a bug in the version of read_DAQ that was used for the testbeam.  The wordcount
+      // was incremented for each new data word, and then used to index into the output array when
+      // storing the hit.  The order should have been the opposite.  As a result, the first word
+      // in the buffer is bogus, and the last hit (for the buffer) was lost.
+      b.keep[k] = ( index + k ) != 0;
+
+      b.word[k] = w;
+      b.adc[k]  = ( w & 0xe0000000 ) >> 29;
+      b.bco[k]  = ( w & 0x1f800000 ) >> 23;
+      b.amp[k]  = ( w & 0x007e0000 ) >> 17;
+      b.chan[k] = ( w & 0x0000fe00 ) >> 9;
+      b.fpga[k] = ( w & 0x00000080 ) >> 7;
+      unsigned short roc_chip_id = ( w & 0x0000007c ) >> 2;
+
+      // Unpack the chip id.  The top 4 chips on each side were read out, and a single FPGA read two modules.
+      // The FPGA numbered the chips from 1 to 16, which means one module was chips 1-8 and the other was 9-16.
+      // So this chip is not the physical id, but a logical one that starts with 1 from the top, regardless of which side.
+      unsigned short mod_chip_id = ( roc_chip_id < 9 ) ? roc_chip_id : roc_chip_id - 8;
+
+      // Note the order of FPGA 1's modules.  This was because of how the cabling was done in the testbeam.
+      b.module[k] = ( b.fpga[k] == 0 ) ? ( roc_chip_id < 9 ? 0 : 1 ) : ( roc_chip_id < 9 ? 3 : 2 );
+      b.side[k]   = mod_chip_id < 5 ? 0 : 1;
+      b.chip[k]   = mod_chip_id < 5 ? mod_chip_id : mod_chip_id - 4;
+    }
+  }
+};
+
+//! 4 = V1 of the chip, read out by the Spartan3 with no rearranging of bits on output
+template <> struct FphxFormat < 4 >
+{
+  static inline void Unpack( const unsigned int* words, unsigned int index, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+      b.keep[k]   = ( index + k ) != 0; // A bug in read_DAQ -- see rev 3 comments
+      b.word[k]   = w;
+      b.amp[k]    = ( w & 0x000007fe ) >> 1;
+      b.bco[k]    = ( w & 0x0001f800 ) >> 11;
+      b.chan[k]   = ( w & 0x00fe0000 ) >> 17;
+      b.adc[k]    = ( w & 0x0e000000 ) >> 25;
+      b.side[k]   = 0;
+      b.fpga[k]   = 0;
+      b.chip[k]   = 0;
+      b.module[k] = 0;
+    }
+  }
+};
+
+//! 5 = V2 of the chip, read out by the Spartan3 with no rearranging of bits on output
+template <> struct FphxFormat < 5 >
+{
+  static inline void Unpack( const unsigned int* words, unsigned int index, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+      b.keep[k]   = ( index + k ) != 0; // A bug in read_DAQ -- see rev 3 comments
+      b.word[k]   = w;
+      b.amp[k]    = ( w & 0x000007fe ) >> 1;  // 10 bits of amplitude
+      b.bco[k]    = ( w & 0x0003f800 ) >> 11; // 7 bits of BCO
+      b.chan[k]   = ( w & 0x01fc0000 ) >> 18; // 7 bits of channel number
+      b.adc[k]    = ( w & 0x1c000000 ) >> 26; // 3 bits of ADC (skip over the word mark)
+      b.side[k]   = 0;
+      b.fpga[k]   = 0;
+      b.chip[k]   = 0;
+      b.module[k] = 0;
+    }
+  }
+};
+
+/*!
+  6 = V2 of the chip, read out by the ROC with no rearranging of bits on output (single-chip board)
+  7 = the same as 6, except read out via the small interface HDI (Rev1)
+
+  ROCv1 output (FPHX-2) format
+  ----------------------------
+  DDxB BBBB BAAA AAA1 CCCC CCBC FIII IID0
+  adc = DDD, bco = BBBBBB, ampl = AAAAAA, channel = CCCC CCCC, chip id = IIIII
+
+  In the version 7, all chips are read out by FPGA0, except two lines (chips 6 & 7,
+  which are chips 1 and 2 from side 1).  We compensate for this split readout.
+*/
+template < int REV > struct FphxFormatROCv1
+{
+  static inline void Unpack( const unsigned int* words, unsigned int /*index*/, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+      b.keep[k] = 1;
+      b.word[k] = w;
+      b.adc[k]  = ((w>>30) & 0x03) | ((w<<1) & 0x04);
+      b.bco[k]  = ((w>>23) & 0x3F) | ((w>>3) & 0x40);
+      b.amp[k]  =  (w>>17) & 0x3F;
+      b.chan[k] = ((w>>10) & 0x3F) | ((w>>2) & 0x40);
+
+      unsigned short fpga_id = (w>>7) & 0x01;
+      unsigned short chip_id = (w>>2) & 0x1F;
+      bool remap = ( REV == 7 ) && ( chip_id > 5 ); // Remap the chip and fpga ids
+      b.fpga[k]   = remap ? 1 : fpga_id;
+      b.chip[k]   = remap ? chip_id - 5 : chip_id;
+      b.side[k]   = 0;
+      b.module[k] = 0;
+    }
+  }
+};
+
+template <> struct FphxFormat < 6 > : FphxFormatROCv1 < 6 > {};
+template <> struct FphxFormat < 7 > : FphxFormatROCv1 < 7 > {};
+
+//! 8 = V1 of the chip, read out by the ROC with no rearranging of bits on output (13-chip kapton HDI from UNM), ROCv1 output (FPHX-1) format
+template <> struct FphxFormat < 8 >
+{
+  static inline void Unpack( const unsigned int* words, unsigned int /*index*/, FphxHitBlock& b )
+  {
+    for( int k=0; k<kFphxBlock; k++ ){
+      unsigned int w = words[k];
+      b.keep[k]   = 1;
+      b.word[k]   = w;
+      b.adc[k]    = ( w & 0xe0000000 ) >> 29;
+      b.bco[k]    = ( w & 0x1f800000 ) >> 23;
+      b.amp[k]    = ( w & 0x007e0000 ) >> 17;
+      b.chan[k]   = ( w & 0x0000fe00 ) >> 9;
+      b.fpga[k]   = ( w & 0x00000080 ) >> 7;
+      b.chip[k]   = ( w & 0x0000007c ) >> 2;
+      b.side[k]   = 0; // TODO
+      b.module[k] = 0;
+    }
+  }
+};
+
+/*!
+  @fn template < int REV > unsigned int FphxUnpack( const unsigned int* words, unsigned int nwords, FphxHitColumns& hits )
+  @brief Hit words in a buffer are unpacked into hits. The number of hits is returned.
+*/
+template < int REV >
+unsigned int FphxUnpack( const unsigned int* words, unsigned int nwords, FphxHitColumns& hits )
+{
+  // kFphxBlock words are written at once, so some room is needed at the end
+  hits.Reserve( nwords + kFphxBlock );
+
+  FphxHitBlock b;
+  unsigned int nhits = 0;
+  for( unsigned int i=0; i<nwords; i+=kFphxBlock ){
+
+    const unsigned int* block_words = &words[i];
+    unsigned int nblock = kFphxBlock;
+
+    // the last block is filled with zeros, and they are not kept
+    unsigned int tail[kFphxBlock] = { 0 };
+    if( nwords - i < (unsigned int)kFphxBlock ){
+      nblock = nwords - i;
+      for( unsigned int k=0; k<nblock; k++ )
+	tail[k] = words[i+k];
+      block_words = tail;
+    }
+
+    FphxFormat < REV >::Unpack( block_words, i, b );
+
+    // hits are written at the position nhits in any case, and nhits is moved only for the kept hits
+    for( unsigned int k=0; k<nblock; k++ ){
+      hits.word  [nhits] = b.word  [k];
+      hits.chan  [nhits] = b.chan  [k];
+      hits.amp   [nhits] = b.amp   [k];
+      hits.adc   [nhits] = b.adc   [k];
+      hits.bco   [nhits] = b.bco   [k];
+      hits.fpga  [nhits] = b.fpga  [k];
+      hits.module[nhits] = b.module[k];
+      hits.side  [nhits] = b.side  [k];
+      hits.chip  [nhits] = b.chip  [k];
+      nhits += b.keep[k];
+    }
+  }
+
+  return nhits;
+}
+
+typedef unsigned int (*FphxUnpackFunction)( const unsigned int* words, unsigned int nwords, FphxHitColumns& hits );
+
+/*!
+  @fn FphxUnpackFunction GetFphxUnpacker( int fphxrev )
+  @brief The unpacker for the revision is returned. nullptr is returned for an unknown revision.
+*/
+inline FphxUnpackFunction GetFphxUnpacker( int fphxrev )
+{
+  switch( fphxrev ){
+  case 0: return FphxUnpack < 0 >;
+  case 3: return FphxUnpack < 3 >;
+  case 4: return FphxUnpack < 4 >;
+  case 5: return FphxUnpack < 5 >;
+  case 6: return FphxUnpack < 6 >;
+  case 7: return FphxUnpack < 7 >;
+  case 8: return FphxUnpack < 8 >;
+  default: return nullptr;
+  }
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include "FphxUnpacker.hh"
+
+/*!
+  @fn int FphxUnpacker_benchmark( unsigned int nwords, int nrepeat, unsigned int buffer_words )
+  @brief Words per second of the unpacker for each revision of the hit format are shown.
+  @param nwords The number of random words to be unpacked
+  @param nrepeat The words are unpacked nrepeat times
+  @param buffer_words The words are given to the unpacker by this number of words as a data record of a .dat file
+  @details Usage: root -l -b -q 'functions/FphxUnpacker_benchmark.cc+O'
+*/
+int FphxUnpacker_benchmark( unsigned int nwords = 1 << 24, int nrepeat = 5, unsigned int buffer_words = 1000 )
+{
+  // the same words for all revisions
+  std::vector < unsigned int > words( nwords );
+  std::mt19937 engine( 20211201 );
+  for( auto& word : words )
+    word = engine();
+
+  int revisions[] = { 0, 3, 4, 5, 6, 7, 8 };
+  FphxHitColumns hits;
+
+  std::cout << std::setw(8) << "fphxrev"
+	    << std::setw(16) << "hits"
+	    << std::setw(16) << "Mwords/s"
+	    << std::setw(16) << "checksum" << std::endl;
+
+  for( auto rev : revisions ){
+    FphxUnpackFunction unpack = GetFphxUnpacker( rev );
+
+    unsigned long long nhits = 0, checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for( int repeat=0; repeat<nrepeat; repeat++ ){
+      for( unsigned int i=0; i<nwords; i+=buffer_words ){
+	unsigned int n = unpack( &words[i], std::min( buffer_words, nwords - i ), hits );
+	nhits += n;
+
+	// the results are used so that the unpacking is not optimized away
+	if( n > 0 )
+	  checksum += hits.chan[n-1] + hits.amp[n-1] + hits.chip[n-1];
+      }
+    }
+    double seconds = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+
+    std::cout << std::setw(8) << rev
+	      << std::setw(16) << nhits / nrepeat
+	      << std::setw(16) << std::fixed << std::setprecision(1) << (double)nwords * nrepeat / seconds / 1e6
+	      << std::setw(16) << checksum << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,296 @@
+#include "HitCountCube.hh"
+
+void HitCountCube::Add( const HitCountCube& cube )
+{
+  for( int module=0; module<kNModules; module++ ){
+    for( int chip=0; chip<kNChips; chip++ ){
+      const vector < UInt_t >& source = cube.blocks_[module][chip];
+      if( source.size() == 0 )
+	continue;
+
+      vector < UInt_t >& block = blocks_[module][chip];
+      if( block.size() == 0 ){
+	block = source;
+	continue;
+      }
+
+      for( int i=0; i<kBlockSize; i++ )
+	block[i] += source[i];
+    }
+  }
+
+  outside_ += cube.outside_;
+}
+
+bool HitCountCube::Add( std::string root_file, std::string name )
+{
+  HitCountCube cube;
+  if( cube.Read( root_file, name ) == false )
+    return false;
+
+  this->Add( cube );
+  return true;
+}
+
+bool HitCountCube::Read( std::string root_file, std::string name )
+{
+  TFile* tf = TFile::Open( root_file.c_str(), "READ" );
+  if( tf == nullptr || tf->IsZombie() ){
+    cerr << "HitCountCube::Read: " << root_file << " cannot be opened" << endl;
+    return false;
+  }
+
+  bool is_found = this->Read( tf, name );
+  tf->Close();
+  delete tf;
+  return is_found;
+}
+
+bool HitCountCube::Read( TDirectory* dir, std::string name )
+{
+  TTree* tree = (TTree*)dir->Get( name.c_str() );
+  if( tree == nullptr )
+    return false;
+
+  this->Clear();
+  int module = -1, chip_id = -1;
+  vector < UInt_t > counts( kBlockSize, 0 );
+  tree->SetBranchAddress( "module", &module );
+  tree->SetBranchAddress( "chip_id", &chip_id );
+  tree->SetBranchAddress( "counts", counts.data() );
+  tree->SetBranchAddress( "outside", &outside_ );
+  for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+    tree->GetEntry( i );
+    if( module < 0 || kNModules <= module || chip_id < 0 || kNChips <= chip_id )
+      continue;
+
+    blocks_[module][chip_id] = counts;
+  }
+
+  tree->ResetBranchAddresses();
+  return true;
+}
+
+void HitCountCube::Write( std::string name )
+{
+  int module = -1, chip_id = -1;
+  vector < UInt_t > counts( kBlockSize, 0 ); // the address of the branch doesn't change
+  TTree* tree = new TTree( name.c_str(), "the number of hits for each module, chip, channel, amplitude, and ADC" );
+  tree->Branch( "module", &module, "module/I" );
+  tree->Branch( "chip_id", &chip_id, "chip_id/I" );
+  tree->Branch( "counts", counts.data(), Form( "counts[%d]/i", kBlockSize ) ); // [chan_id][ampl][adc]
+  tree->Branch( "outside", &outside_, "outside/L" );
+
+  for( module=0; module<kNModules; module++ ){
+    for( chip_id=0; chip_id<kNChips; chip_id++ ){
+      if( blocks_[module][chip_id].size() == 0 )
+	continue;
+
+      counts = blocks_[module][chip_id];
+      tree->Fill();
+    }
+  }
+
+  tree->Write();
+  tree->ResetBranchAddresses();
+}
+
+void HitCountCube::Clear()
+{
+  for( int module=0; module<kNModules; module++ )
+    for( int chip=0; chip<kNChips; chip++ )
+      vector < UInt_t >().swap( blocks_[module][chip] );
+
+  outside_ = 0;
+}
+
+bool HitCountCube::HasModule( int module ) const
+{
+  for( int chip=0; chip<kNChips; chip++ )
+    if( this->HasChip( module, chip ) )
+      return true;
+
+  return false;
+}
+
+bool HitCountCube::HasChip( int module, int chip_id ) const
+{
+  if( module < 0 || kNModules <= module || chip_id < 0 || kNChips <= chip_id )
+    return false;
+
+  return blocks_[module][chip_id].size() != 0;
+}
+
+UInt_t HitCountCube::GetCount( int module, int chip_id, int chan_id, int ampl, int adc ) const
+{
+  if( this->HasChip( module, chip_id ) == false
+      || chan_id < 0 || kNChans <= chan_id || ampl < 0 || kNAmpls <= ampl || adc < 0 || kNAdcs <= adc )
+    return 0;
+
+  return blocks_[module][chip_id][ ( chan_id * kNAmpls + ampl ) * kNAdcs + adc ];
+}
+
+Long64_t HitCountCube::GetTotal( int module, int chip_id ) const
+{
+  Long64_t total = 0;
+  for( int mod=0; mod<kNModules; mod++ ){
+    if( module != -1 && mod != module )
+      continue;
+
+    for( int chip=0; chip<kNChips; chip++ ){
+      if( ( chip_id != -1 && chip != chip_id ) || this->HasChip( mod, chip ) == false )
+	continue;
+
+      for( auto& count : blocks_[mod][chip] )
+	total += count;
+    }
+  }
+
+  return total;
+}
+
+TH2D* HitCountCube::MakeHitmap( int module, int max_ampl )
+{
+  TH2D* hist = new TH2D( Form( "cube_hitmap_module%d", module ), "Hit map;chip_id;chan_id", kNChips, 0, kNChips, kNChans, 0, kNChans );
+  Long64_t total = 0;
+  for( int chip=0; chip<kNChips; chip++ ){
+    if( this->HasChip( module, chip ) == false )
+      continue;
+
+    const vector < UInt_t >& block = blocks_[module][chip];
+    for( int chan=0; chan<kNChans; chan++ ){
+      Long64_t sum = 0;
+      for( int i=chan * kNAmpls * kNAdcs; i<( chan * kNAmpls + std::min( max_ampl, kNAmpls ) ) * kNAdcs; i++ )
+	sum += block[i];
+
+      if( sum != 0 )
+	hist->SetBinContent( chip + 1, chan + 1, sum );
+
+      total += sum;
+    }
+  }
+
+  hist->SetEntries( total );
+  return hist;
+}
+
+TH2D* HitCountCube::MakeAmplChan( int module, int chip_id, int max_ampl )
+{
+  TH2D* hist = new TH2D( Form( "cube_ampl_chan_module%d_chip%d", module, chip_id ), Form( "chip_id==%d;Amplitude;Channel", chip_id ),
+			 kNAmpls, 0, kNAmpls, kNChans, 0, kNChans );
+  if( this->HasChip( module, chip_id ) == false )
+    return hist;
+
+  const vector < UInt_t >& block = blocks_[module][chip_id];
+  Long64_t total = 0;
+  for( int chan=0; chan<kNChans; chan++ ){
+    for( int ampl=0; ampl<std::min( max_ampl, kNAmpls ); ampl++ ){
+      Long64_t sum = 0;
+      for( int adc=0; adc<kNAdcs; adc++ )
+	sum += block[ ( chan * kNAmpls + ampl ) * kNAdcs + adc ];
+
+      if( sum != 0 )
+	hist->SetBinContent( ampl + 1, chan + 1, sum );
+
+      total += sum;
+    }
+  }
+
+  hist->SetEntries( total );
+  return hist;
+}
+
+TH2D* HitCountCube::MakeAmplADC( int module, int chip_id, int max_ampl )
+{
+  TH2D* hist = new TH2D( Form( "cube_ampl_adc_module%d_chip%d", module, chip_id ), Form( "chip_id==%d;Amplitude;ADC", chip_id ),
+			 kNAmpls, 0, kNAmpls, kNAdcs, 0, kNAdcs );
+  if( this->HasChip( module, chip_id ) == false )
+    return hist;
+
+  const vector < UInt_t >& block = blocks_[module][chip_id];
+  Long64_t sums[kNAmpls][kNAdcs] = { { 0 } };
+  for( int chan=0; chan<kNChans; chan++ )
+    for( int ampl=0; ampl<std::min( max_ampl, kNAmpls ); ampl++ )
+      for( int adc=0; adc<kNAdcs; adc++ )
+	sums[ampl][adc] += block[ ( chan * kNAmpls + ampl ) * kNAdcs + adc ];
+
+  Long64_t total = 0;
+  for( int ampl=0; ampl<kNAmpls; ampl++ ){
+    for( int adc=0; adc<kNAdcs; adc++ ){
+      if( sums[ampl][adc] != 0 )
+	hist->SetBinContent( ampl + 1, adc + 1, sums[ampl][adc] );
+
+      total += sums[ampl][adc];
+    }
+  }
+
+  hist->SetEntries( total );
+  return hist;
+}
+
+TH1D* HitCountCube::MakeADC( int module, int chip_id, int max_ampl )
+{
+  string name = chip_id == -1 ? Form( "cube_adc_module%d", module ) : Form( "cube_adc_module%d_chip%d", module, chip_id );
+  TH1D* hist = new TH1D( name.c_str(), ";ADC;Entries", kNAdcs, 0, kNAdcs );
+
+  Long64_t sums[kNAdcs] = { 0 };
+  for( int chip=0; chip<kNChips; chip++ ){
+    if( ( chip_id != -1 && chip != chip_id ) || this->HasChip( module, chip ) == false )
+      continue;
+
+    const vector < UInt_t >& block = blocks_[module][chip];
+    for( int chan=0; chan<kNChans; chan++ )
+      for( int ampl=0; ampl<std::min( max_ampl, kNAmpls ); ampl++ )
+	for( int adc=0; adc<kNAdcs; adc++ )
+	  sums[adc] += block[ ( chan * kNAmpls + ampl ) * kNAdcs + adc ];
+  }
+
+  Long64_t total = 0;
+  for( int adc=0; adc<kNAdcs; adc++ ){
+    hist->SetBinContent( adc + 1, sums[adc] );
+    total += sums[adc];
+  }
+
+  hist->SetEntries( total );
+  return hist;
+}
+
+TH1D* HitCountCube::MakeChipTotals( int module, int max_ampl )
+{
+  TH1D* hist = new TH1D( Form( "cube_chip_totals_module%d", module ), ";chip_id;Entries", kNChips, 0, kNChips );
+  Long64_t total = 0;
+  for( int chip=0; chip<kNChips; chip++ ){
+    if( this->HasChip( module, chip ) == false )
+      continue;
+
+    const vector < UInt_t >& block = blocks_[module][chip];
+    Long64_t sum = 0;
+    for( int chan=0; chan<kNChans; chan++ )
+      for( int i=chan * kNAmpls * kNAdcs; i<( chan * kNAmpls + std::min( max_ampl, kNAmpls ) ) * kNAdcs; i++ )
+	sum += block[i];
+
+    hist->SetBinContent( chip + 1, sum );
+    total += sum;
+  }
+
+  hist->SetEntries( total );
+  return hist;
+}
+
+void HitCountCube::Print( std::ostream& os ) const
+{
+  os << "+--- Hit count cube ------------------------------------" << endl;
+  for( int module=0; module<kNModules; module++ ){
+    if( this->HasModule( module ) == false )
+      continue;
+
+    os << "| module " << setw(2) << module << ": " << setw(10) << this->GetTotal( module ) << " hits, chip:hits";
+    for( int chip=0; chip<kNChips; chip++ )
+      if( this->HasChip( module, chip ) )
+	os << " " << chip << ":" << this->GetTotal( module, chip );
+
+    os << endl;
+  }
+  os << "| outside of the cube: " << outside_ << " hits" << endl;
+  os << "+-------------------------------------------------------" << endl;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*!
+  @class HitCountCube
+  @brief The number of hits for each module, chip, channel, amplitude, and ADC of a run
+  @details QA macros (DrawPlots.cc, DrawHitMap.c, show_status.cc, ...) read all hits in the tree to count the same things again and again.
+  The decoder (FelixDecoder) counts them once while decoding, and writes them to the ROOT file as the TTree "count_cube".
+  Plots are made from the counts without reading the hits.
+
+  The counts are dense arrays of UInt_t for each (module, chip_id) with 128 channels x 128 amplitudes x 8 ADC values (512 kB).
+  An array is allocated at the first hit of the chip, and only allocated arrays are written (an entry for each).
+  Most of the counts are zero, so they are compressed well by ROOT.
+  Hits out of the ranges (module 0-15, chip_id 0-26) are not in the cube. They are counted by GetOutsideNum.
+  Cubes of threads, files, or runs are summed by Add.
+
+  How to use:
+    HitCountCube cube;
+    cube.Read( "data/calib_packv1_220927_1700.root" );
+    cube.Add( "data/calib_packv1_220927_1800.root" ); // another run
+    TH2D* hitmap = cube.MakeHitmap( 1 );
+    TH1D* adc = cube.MakeADC( 1, 10 );
+*/
+class HitCountCube
+{
+public:
+  static const int kNModules = 16;
+  static const int kNChips = 27;  //!< chip_id 0-26, 0 is not used by the detector
+  static const int kNChans = 128;
+  static const int kNAmpls = 128;
+  static const int kNAdcs = 8;
+  static const int kBlockSize = kNChans * kNAmpls * kNAdcs;
+
+  HitCountCube(){};
+
+  //! A hit is counted
+  void Fill( int module, int chip_id, int chan_id, int ampl, int adc )
+  {
+    if( module < 0 || kNModules <= module || chip_id < 0 || kNChips <= chip_id ){
+      outside_++;
+      return;
+    }
+
+    vector < UInt_t >& block = blocks_[module][chip_id];
+    if( block.size() == 0 )
+      block.assign( kBlockSize, 0 );
+
+    block[ ( ( chan_id & 0x7F ) * kNAmpls + ( ampl & 0x7F ) ) * kNAdcs + ( adc & 0x07 ) ]++;
+  };
+
+  //! Counts of another cube are added
+  void Add( const HitCountCube& cube );
+
+  //! The cube in the ROOT file is added. false is returned if it's not found.
+  bool Add( std::string root_file, std::string name = "count_cube" );
+
+  //! The cube in the ROOT file is read. false is returned if it's not found.
+  bool Read( std::string root_file, std::string name = "count_cube" );
+  bool Read( TDirectory* dir, std::string name = "count_cube" );
+
+  //! The TTree with an entry for each allocated (module, chip_id) is written to the current directory
+  void Write( std::string name = "count_cube" );
+
+  void Clear();
+
+  //! true if a hit of the module (and the chip) was counted
+  bool HasModule( int module ) const;
+  bool HasChip( int module, int chip_id ) const;
+
+  //! The number of hits with the values
+  UInt_t GetCount( int module, int chip_id, int chan_id, int ampl, int adc ) const;
+
+  //! The number of hits in the module (all modules for -1) and the chip (all chips for -1)
+  Long64_t GetTotal( int module = -1, int chip_id = -1 ) const;
+
+  //! The number of hits which are not in the cube
+  Long64_t GetOutsideNum() const { return outside_; };
+
+  // Projections. The histograms are made with the names including the module and the chip. Hits with ampl < max_ampl are used.
+  TH2D* MakeHitmap( int module, int max_ampl = kNAmpls );             //!< channel vs chip_id
+  TH2D* MakeAmplChan( int module, int chip_id, int max_ampl = kNAmpls );  //!< channel vs amplitude
+  TH2D* MakeAmplADC( int module, int chip_id, int max_ampl = kNAmpls );   //!< ADC vs amplitude
+  TH1D* MakeADC( int module, int chip_id = -1, int max_ampl = kNAmpls );  //!< ADC of the chip, all chips for -1
+  TH1D* MakeChipTotals( int module, int max_ampl = kNAmpls );         //!< the number of hits for each chip_id
+
+  void Print( std::ostream& os = std::cout ) const;
+
+private:
+  vector < UInt_t > blocks_[kNModules][kNChips];
+  Long64_t outside_ = 0;
+};
+
+#ifndef HIT_COUNT_CUBE_source
+#define HIT_COUNT_CUBE_source
+
+#include "HitCountCube.cc"
+#endif //  HIT_COUNT_CUBE_source
@@ -0,0 +1,95 @@
+#include "HitMapLookup.hh"
+
+HitMapLookup::HitMapLookup( Layout layout )
+{
+  layout_ = layout;
+  for( int chip=0; chip<kNChips; chip++ ){
+    int side = chip / 14; // int(chip_id / 14) in the expressions
+    for( int chan=0; chan<kNChans; chan++ ){
+      int x = layout_ == kChipAscending ? chip - side * 13 - 1 : -chip + ( 1 + side ) * 13;
+      int y = side * 256 + ( side % 2 == 0 ? chan : -chan ); // pow(-1, side) * chan
+
+      positions_[chip][chan][0] = x;
+      positions_[chip][chan][1] = y;
+    }
+  }
+}
+
+const HitMapLookup& HitMapLookup::Get( Layout layout )
+{
+  // made at the first call, it's thread-safe in C++11
+  static const HitMapLookup tables[kNLayouts] = { HitMapLookup( kChipAscending ), HitMapLookup( kChipDescending ) };
+  return tables[ layout == kChipDescending ? kChipDescending : kChipAscending ];
+}
+
+Long64_t HitMapLookup::FillFromTree( TTree* tree, TH2* hist, std::string cut ) const
+{
+  TBranch* branches[2] = { tree->GetBranch( "chip_id" ), tree->GetBranch( "chan_id" ) };
+  if( branches[0] == nullptr || branches[1] == nullptr )
+    return 0;
+
+  // the tree belongs to the caller, so the statuses and addresses of the branches are restored at the end
+  std::vector < std::pair < std::string, bool > > statuses;
+  auto branch_list = tree->GetListOfBranches();
+  for( int i=0; i<branch_list->GetEntries(); i++ ){
+    std::string name = branch_list->At( i )->GetName();
+    statuses.push_back( std::make_pair( name, tree->GetBranchStatus( name.c_str() ) ) );
+  }
+
+  void* addresses[2] = { branches[0]->GetAddress(), branches[1]->GetAddress() };
+
+  int chip_id = -1, chan_id = -1;
+  TTreeFormula* formula = nullptr;
+  if( cut == "" ){
+    // only the branches in use are read
+    tree->SetBranchStatus( "*", 0 );
+    tree->SetBranchStatus( "chip_id", 1 );
+    tree->SetBranchStatus( "chan_id", 1 );
+  }
+  else{
+    formula = new TTreeFormula( "hitmap_cut", cut.c_str(), tree );
+  }
+
+  tree->SetBranchAddress( "chip_id", &chip_id );
+  tree->SetBranchAddress( "chan_id", &chan_id );
+
+  Long64_t filled = 0;
+  for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+    tree->GetEntry( i );
+    if( formula != nullptr ){
+      tree->LoadTree( i );
+      if( formula->EvalInstance() == 0 )
+	continue;
+    }
+
+    int x, y;
+    if( this->GetPosition( chip_id, chan_id, x, y ) == false )
+      continue;
+
+    hist->Fill( x, y );
+    filled++;
+  }
+
+  delete formula;
+  for( auto& status : statuses )
+    tree->SetBranchStatus( status.first.c_str(), status.second );
+
+  const char* names[2] = { "chip_id", "chan_id" };
+  for( int i=0; i<2; i++ ){
+    if( addresses[i] != nullptr )
+      tree->SetBranchAddress( names[i], addresses[i] );
+    else
+      tree->ResetBranchAddress( tree->GetBranch( names[i] ) );
+  }
+
+  return filled;
+}
+
+std::string HitMapLookup::GetExpression() const
+{
+  std::string y = "int(chip_id / 14) * 256 + pow(-1, int(chip_id / 14)) * chan_id";
+  if( layout_ == kChipAscending )
+    return y + " : chip_id - (int(chip_id / 14)) * 13 -1";
+
+  return y + " : -chip_id + (1 + int(chip_id / 14)) * 13";
+}
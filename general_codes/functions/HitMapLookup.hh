@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+  @class HitMapLookup
+  @brief (chip_id, chan_id) -> (x, y) of the hit map in a table made once, to fill hit maps without TTree::Draw expressions
+  @details The hit maps were drawn by TTree::Draw with expressions like
+    "int(chip_id / 14) * 256 + pow(-1, int(chip_id / 14)) * chan_id : chip_id - int(chip_id / 14) * 13 - 1"
+  which were evaluated by the formula interpreter for every entry.
+  Here the coordinates are calculated for all chip_id (0-63) and chan_id (0-127) when the table is made, and a hit is filled by looking it up.
+  The coordinates are exactly the same as the ones of the expressions. The layout doesn't depend on the module, so the table is shared by all modules.
+
+  Two layouts are used in this directory:
+    - kChipAscending  : chip 1 at x=0 (DrawHitMap)
+    - kChipDescending : chip 1 at x=12 (DrawPlots_Hitmap, LadderQAHistograms)
+  In both layouts, chips 1-13 are at y = chan_id and chips 14-26 are at y = 256 - chan_id.
+
+  How to use:
+    const HitMapLookup& lookup = HitMapLookup::Get( HitMapLookup::kChipAscending );
+    TH2D* hitmap = new TH2D( "hitmap", "Hit map", 13, 0, 13, 257, 0, 257 );
+    lookup.FillFromTree( tree, hitmap, "module==1" ); // or lookup.Fill( hitmap, chip_id, chan_id ) for each hit
+*/
+class HitMapLookup
+{
+public:
+  enum Layout { kChipAscending = 0, kChipDescending, kNLayouts };
+  static const int kNChips = 64;
+  static const int kNChans = 128;
+
+  HitMapLookup( Layout layout = kChipAscending );
+
+  //! The table shared by all hit-map producers
+  static const HitMapLookup& Get( Layout layout );
+
+  //! false if chip_id or chan_id is out of the table
+  bool GetPosition( int chip_id, int chan_id, int& x, int& y ) const
+  {
+    if( chip_id < 0 || kNChips <= chip_id || chan_id < 0 || kNChans <= chan_id )
+      return false;
+
+    const Short_t* position = positions_[chip_id][chan_id];
+    x = position[0];
+    y = position[1];
+    return true;
+  };
+
+  //! A hit is filled to the hit map. Hits out of the table are ignored.
+  void Fill( TH2* hist, int chip_id, int chan_id, double weight = 1 ) const
+  {
+    int x, y;
+    if( this->GetPosition( chip_id, chan_id, x, y ) )
+      hist->Fill( x, y, weight );
+  };
+
+  /*!
+    @brief Hits in the tree are filled to the hit map by reading chip_id and chan_id directly
+    @details The branch statuses and the addresses of chip_id and chan_id are changed during the loop, and they are restored at the end.
+    @param tree The TTree made by MakeTree
+    @param hist The hit map
+    @param cut A cut in the TTree::Draw syntax, "" for nothing
+    @retval The number of filled hits
+  */
+  Long64_t FillFromTree( TTree* tree, TH2* hist, std::string cut = "" ) const;
+
+  //! The expression for TTree::Draw ("y:x") giving the same coordinates, for comparisons
+  std::string GetExpression() const;
+
+  Layout GetLayout() const { return layout_; };
+
+private:
+  Layout layout_;
+  Short_t positions_[kNChips][kNChans][2];
+};
+
+#ifndef HIT_MAP_LOOKUP_source
+#define HIT_MAP_LOOKUP_source
+
+#include "HitMapLookup.cc"
+#endif //  HIT_MAP_LOOKUP_source
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <TTree.h>
+#include <TTreeFormula.h>
+#include <TH2D.h>
+#include "HitMapLookup.hh"
+
+using std::string;
+
+/*!
+  @fn int HitMapLookup_benchmark( Long64_t nhits, string cut )
+  @brief Hit maps are filled by TTree::Draw with the expression and by HitMapLookup, and the time and the difference are shown.
+  @param nhits The number of random hits in the tree (in the memory)
+  @param cut A cut given to both, for example "module==1"
+  @details Usage: root -l -b -q 'functions/HitMapLookup_benchmark.cc+O( 10000000 )'
+  The hits have module 0-3, chip_id 1-26, and chan_id 0-127. The bin contents of the hit maps should be the same.
+*/
+int HitMapLookup_benchmark( Long64_t nhits = 10000000, string cut = "" )
+{
+  TH1::AddDirectory( false );
+
+  // the tree in the memory with the branches used by the hit maps
+  TTree* tree = new TTree( "tree", "random hits" );
+  tree->SetDirectory( nullptr );
+  int module, chip_id, chan_id;
+  tree->Branch( "module", &module, "module/I" );
+  tree->Branch( "chip_id", &chip_id, "chip_id/I" );
+  tree->Branch( "chan_id", &chan_id, "chan_id/I" );
+
+  std::mt19937 engine( 20221016 );
+  for( Long64_t i=0; i<nhits; i++ ){
+    module = engine() % 4;
+    chip_id = engine() % 26 + 1;
+    chan_id = engine() % 128;
+    tree->Fill();
+  }
+
+  std::cout << std::setw(18) << "layout"
+	    << std::setw(12) << "method"
+	    << std::setw(12) << "seconds"
+	    << std::setw(12) << "Mhits/s"
+	    << std::setw(12) << "entries" << std::endl;
+
+  for( auto layout : { HitMapLookup::kChipAscending, HitMapLookup::kChipDescending } ){
+    const HitMapLookup& lookup = HitMapLookup::Get( layout );
+    string layout_name = layout == HitMapLookup::kChipAscending ? "kChipAscending" : "kChipDescending";
+
+    // x and y ranges of DrawHitMap and DrawPlots_Hitmap
+    TH2D* hist_draw = new TH2D( ( "draw_" + layout_name ).c_str(), "TTree::Draw", 13, 0, 13, 257, 0, 257 );
+    TH2D* hist_lookup = new TH2D( ( "lookup_" + layout_name ).c_str(), "HitMapLookup", 13, 0, 13, 257, 0, 257 );
+
+    auto start = std::chrono::steady_clock::now();
+    tree->Draw( ( lookup.GetExpression() + ">>" + hist_draw->GetName() ).c_str(), cut.c_str(), "goff" );
+    double seconds_draw = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+
+    start = std::chrono::steady_clock::now();
+    lookup.FillFromTree( tree, hist_lookup, cut );
+    double seconds_lookup = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+
+    // the lookup has to give the same hit map
+    int different_bins = 0;
+    for( int x=0; x<=hist_draw->GetNbinsX() + 1; x++ )
+      for( int y=0; y<=hist_draw->GetNbinsY() + 1; y++ )
+	if( hist_draw->GetBinContent( x, y ) != hist_lookup->GetBinContent( x, y ) )
+	  different_bins++;
+
+    std::cout << std::setw(18) << layout_name
+	      << std::setw(12) << "Draw"
+	      << std::setw(12) << std::fixed << std::setprecision(3) << seconds_draw
+	      << std::setw(12) << std::setprecision(1) << nhits / seconds_draw / 1e6
+	      << std::setw(12) << std::setprecision(0) << hist_draw->GetEntries() << std::endl;
+    std::cout << std::setw(18) << layout_name
+	      << std::setw(12) << "lookup"
+	      << std::setw(12) << std::fixed << std::setprecision(3) << seconds_lookup
+	      << std::setw(12) << std::setprecision(1) << nhits / seconds_lookup / 1e6
+	      << std::setw(12) << std::setprecision(0) << hist_lookup->GetEntries() << std::endl;
+    std::cout << std::setw(18) << layout_name
+	      << "  " << different_bins << " different bins, x" << std::setprecision(1) << seconds_draw / seconds_lookup << " faster" << std::endl;
+
+    delete hist_draw;
+    delete hist_lookup;
+  }
+
+  delete tree;
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include "INTTClusterProperty.hh"
+
+INTTClusterProperty::INTTClusterProperty()
+{
+  const Double_t kStrip_width = 0.078; // mm
+  const Double_t kLower_section_initial = -9.961;
+  const Double_t kUpper_section_initial = 0.055;
+
+  positions_.resize( 13 * 256 );
+  for( int slot=1; slot<=13; slot++ )
+    for( int channel=0; channel<256; channel++ )
+      this->SetStripPosition( slot, channel,
+			      channel < 128 ? kLower_section_initial + kStrip_width * channel : kUpper_section_initial + kStrip_width * ( channel - 128 ) );
+
+  this->Clear();
+}
+
+void INTTClusterProperty::Clear()
+{
+  slots_.clear();
+  slot_channels_.clear();
+  adcs_.clear();
+  charges_of_hits_.clear();
+
+  sizes_.clear();
+  cluster_slots_.clear();
+  charges_.clear();
+  centroids_.clear();
+  mean_channels_.clear();
+  member_begin_.assign( 1, 0 );
+  members_.clear();
+}
+
+int INTTClusterProperty::AddSlot( int slot, int slot_channel, int adc, Double_t charge )
+{
+  // a hit out of the slots is kept to have the same index as INTTClusterer, but it's not clustered by Run()
+  if( slot < 1 || 13 < slot || slot_channel < 0 || 255 < slot_channel )
+    slot = slot_channel = 0;
+
+  slots_.push_back( slot );
+  slot_channels_.push_back( slot_channel );
+  adcs_.push_back( adc );
+  charges_of_hits_.push_back( charge );
+  return slots_.size() - 1;
+}
+
+void INTTClusterProperty::CloseCluster()
+{
+  int begin = member_begin_.back();
+  int end = members_.size();
+
+  Double_t charge = 0, weighted_position = 0, channel_sum = 0;
+  for( int k=begin; k<end; k++ ){
+    int i = members_[k];
+    charge += charges_of_hits_[i];
+    weighted_position += charges_of_hits_[i] * this->GetStripPosition( slots_[i], slot_channels_[i] );
+    channel_sum += slot_channels_[i];
+  }
+
+  int size = end - begin;
+  sizes_.push_back( size );
+  cluster_slots_.push_back( slots_[ members_[begin] ] );
+  charges_.push_back( charge );
+  centroids_.push_back( charge != 0 ? weighted_position / charge : 0.0 );
+  mean_channels_.push_back( channel_sum / size );
+  member_begin_.push_back( end );
+}
+
+int INTTClusterProperty::Run()
+{
+  int nhits = slots_.size();
+  sorted_.clear();
+  for( int i=0; i<nhits; i++ )
+    if( slots_[i] != 0 )
+      sorted_.push_back( std::pair < int, int >( slots_[i] * 256 + slot_channels_[i], i ) );
+
+  std::sort( sorted_.begin(), sorted_.end() );
+
+  for( int k=0; k<(int)sorted_.size(); k++ ){
+    int key = sorted_[k].first;
+    if( k != 0 ){
+      int previous = sorted_[k-1].first;
+      if( key == previous && is_duplicate_removed_ )
+	continue;
+
+      // the slot is in the key, so the next slot doesn't continue the cluster
+      bool is_neighbor = key == previous + 1 && key % 256 != 0;
+      if( is_neighbor == false )
+	this->CloseCluster();
+    }
+
+    members_.push_back( sorted_[k].second );
+  }
+
+  if( member_begin_.back() != (int)members_.size() )
+    this->CloseCluster();
+
+  return sizes_.size();
+}
+
+int INTTClusterProperty::RunAsOneCluster()
+{
+  for( int i=0; i<(int)slots_.size(); i++ )
+    members_.push_back( i );
+
+  if( members_.size() != 0 )
+    this->CloseCluster();
+
+  return sizes_.size();
+}
+
+int INTTClusterProperty::Calculate( INTTClusterer& clusterer )
+{
+  for( int c=0; c<clusterer.GetClusterNum(); c++ ){
+    for( int j=0; j<clusterer.GetSize( c ); j++ )
+      members_.push_back( clusterer.GetMember( c, j ) );
+
+    this->CloseCluster();
+  }
+
+  return sizes_.size();
+}
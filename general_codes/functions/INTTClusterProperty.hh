@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "INTTClusterer.hh"
+
+/*!
+  @class INTTClusterProperty
+  @brief Size, charge, and position in mm of all clusters in an event are calculated in one pass
+  @details The same calculation was done in INTTHit, shibata/readtree.C (process_hits), and Testbeam_G4_code/tracking_single.C (data_all_edep_weight).
+  They use this class now.
+
+  Coordinates: A slot (1-13) is a pair of chips facing each other, and a slot channel (0-255) is a channel in the slot, as the test beam analyses do:
+    - chip 1-13 : slot = chip     , slot channel = 255 - chan
+    - chip 14-26: slot = chip - 13, slot channel = chan
+  The position of a strip in mm is taken from a table for the slot channels. The default table is for the 78 um strips:
+    - slot channel 0-127  : -9.961 + 0.078 * slot channel
+    - slot channel 128-255:  0.055 + 0.078 * ( slot channel - 128 )
+  It can be changed by SetStripPosition.
+
+  Clusters are made in Run(): the hits are sorted by (slot, slot channel) once, and hits in consecutive slot channels make a cluster.
+  Clusters of INTTClusterer (for example in check_chip_prototypeMaximam6.c) can be given to Calculate() instead, and the hits of INTTHit are one cluster (RunAsOneCluster).
+
+  For each cluster:
+    - size: the number of hits
+    - charge: sum of the charges given to Add (the DAC voltage, or a weight for each ADC)
+    - centroid: the charge-weighted position in mm
+    - mean channel: the mean slot channel without weights
+  The results are kept in arrays, so all of them can be looped over quickly. The memory is reused for the next event.
+
+  How to use:
+    INTTClusterProperty property;
+    property.Clear();
+    property.Add( chip_id, chan_id, adc, adc_voltage ); // for each hit, or AddSlot( slot, slot_channel, adc, charge )
+    int nclusters = property.Run();
+    for( int i=0; i<nclusters; i++ )
+      property.GetSize( i ), property.GetCharge( i ), property.GetCentroid( i ), property.GetMeanChannel( i ), property.GetSlot( i ) ...
+*/
+class INTTClusterProperty
+{
+public:
+  INTTClusterProperty();
+
+  //! A slot (1-13) for chip_id (1-26)
+  static int ToSlot( int chip_id ){ return chip_id <= 13 ? chip_id : chip_id - 13; };
+
+  //! A slot channel (0-255) for chip_id (1-26) and chan_id (0-127)
+  static int ToSlotChannel( int chip_id, int chan_id ){ return chip_id <= 13 ? 255 - chan_id : chan_id; };
+
+  //! Position of the strip in mm
+  Double_t GetStripPosition( int slot, int slot_channel ){ return slot != 0 ? positions_[ ( slot - 1 ) * 256 + slot_channel ] : 0.0; };
+  void SetStripPosition( int slot, int slot_channel, Double_t position ){ positions_[ ( slot - 1 ) * 256 + slot_channel ] = position; };
+
+  //! If true, only the first hit in a slot channel is used in Run(). If false, hits in the same slot channel are in different clusters.
+  void SetDuplicateRemoved( bool flag ){ is_duplicate_removed_ = flag; };
+
+  //! Hits and clusters of the previous event are removed
+  void Clear();
+
+  //! A hit is added. Its index (from 0) is returned. A hit out of the slots is not clustered by Run(), and its position is 0.
+  int Add( int chip_id, int chan_id, int adc, Double_t charge ){ return this->AddSlot( ToSlot( chip_id ), ToSlotChannel( chip_id, chan_id ), adc, charge ); };
+  int AddSlot( int slot, int slot_channel, int adc, Double_t charge );
+
+  //! Hits are clustered and the properties are calculated. The number of the clusters is returned.
+  int Run();
+
+  //! All hits are treated as one cluster, for example the hits kept in INTTHit. 1 is returned (0 if no hit).
+  int RunAsOneCluster();
+
+  //! The properties of the clusters made by INTTClusterer are calculated. The hits should be given in the same order. The number of the clusters is returned.
+  int Calculate( INTTClusterer& clusterer );
+
+  int GetHitNum(){ return slots_.size(); };
+  int GetClusterNum(){ return sizes_.size(); };
+  int GetSize( int cluster ){ return sizes_[cluster]; };
+  int GetSlot( int cluster ){ return cluster_slots_[cluster]; };
+  Double_t GetCharge( int cluster ){ return charges_[cluster]; };
+  Double_t GetCentroid( int cluster ){ return centroids_[cluster]; };        //!< in mm
+  Double_t GetMeanChannel( int cluster ){ return mean_channels_[cluster]; }; //!< in slot channel
+  int GetMember( int cluster, int i ){ return members_[ member_begin_[cluster] + i ]; }; //!< index of the i-th hit in the slot channel order
+  int GetADC( int index ){ return adcs_[index]; };
+
+private:
+  std::vector < Double_t > positions_; //!< [slot-1][slot channel]
+  bool is_duplicate_removed_ = false;
+
+  // hits
+  std::vector < int > slots_;
+  std::vector < int > slot_channels_;
+  std::vector < int > adcs_;
+  std::vector < Double_t > charges_of_hits_;
+
+  // work space
+  std::vector < std::pair < int, int > > sorted_; //!< (slot * 256 + slot channel, index of the hit)
+
+  // results
+  std::vector < int > sizes_;
+  std::vector < int > cluster_slots_;
+  std::vector < Double_t > charges_;
+  std::vector < Double_t > centroids_;
+  std::vector < Double_t > mean_channels_;
+  std::vector < int > member_begin_;
+  std::vector < int > members_;
+
+  //! A cluster of the hits members_[ member_begin_.back() ... ] is closed
+  void CloseCluster();
+};
+
+#ifndef INTT_CLUSTER_PROPERTY_source
+#define INTT_CLUSTER_PROPERTY_source
+
+#include "INTTClusterProperty.cc"
+#endif //  INTT_CLUSTER_PROPERTY_source
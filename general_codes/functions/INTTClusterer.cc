@@ -0,0 +1,256 @@
+#include "INTTClusterer.hh"
+
+void INTTClusterer::Clear()
+{
+  hits_.clear();
+  ignored_.clear();
+  cluster_of_.clear();
+  heads_.clear();
+  member_begin_.assign( 1, 0 );
+  members_.clear();
+  adc_voltages_.clear();
+}
+
+int INTTClusterer::Add( int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id,
+			int fem_id, int bco, int bco_full, int event, Double_t adc_voltage )
+{
+  INTTClusterHit hit = { adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event, adc_voltage };
+  hits_.push_back( hit );
+  ignored_.push_back( false );
+  return hits_.size() - 1;
+}
+
+bool INTTClusterer::IsIgnored( int index )
+{
+  // the same as INTTHit::IsIgnored
+  const INTTClusterHit& hit = hits_[index];
+  if( ignored_[index] || 27 < hit.chip_id || 128 < hit.chan_id || hit.ampl != 0 || hit.module == -1 )
+    return true;
+
+  return mask_ != nullptr && mask_->IsMasked( hit.module, hit.chip_id, hit.chan_id );
+}
+
+ULong64_t INTTClusterer::GetKey( const INTTClusterHit& hit )
+{
+  // fem_id | fpga_id | module | bco | chip_id | chan_id, 8 bits for each (16 bits for bco)
+  return ( (ULong64_t)( hit.fem_id & 0xFF ) << 48 )
+    | ( (ULong64_t)( hit.fpga_id & 0xFF ) << 40 )
+    | ( (ULong64_t)( hit.module & 0xFF ) << 32 )
+    | ( (ULong64_t)( hit.bco & 0xFFFF ) << 16 )
+    | ( (ULong64_t)( hit.chip_id & 0xFF ) << 8 )
+    | (ULong64_t)( hit.chan_id & 0xFF );
+}
+
+int INTTClusterer::Find( int position )
+{
+  // path halving
+  while( parent_[position] != position ){
+    parent_[position] = parent_[ parent_[position] ];
+    position = parent_[position];
+  }
+  return position;
+}
+
+void INTTClusterer::Unite( int a, int b )
+{
+  a = this->Find( a );
+  b = this->Find( b );
+  if( a != b )
+    parent_[ std::max( a, b ) ] = std::min( a, b );
+}
+
+int INTTClusterer::Run()
+{
+  int nhits = hits_.size();
+  sorted_.clear();
+  for( int i=0; i<nhits; i++ )
+    if( this->IsIgnored( i ) == false )
+      sorted_.push_back( std::pair < ULong64_t, int >( GetKey( hits_[i] ), i ) );
+
+  std::sort( sorted_.begin(), sorted_.end() );
+
+  int nsorted = sorted_.size();
+  parent_.resize( nsorted );
+  for( int k=0; k<nsorted; k++ )
+    parent_[k] = k;
+
+  // hits in other BCOs are looked for in the BCO window, the groups are made for (fem_id, fpga_id, module)
+  if( bco_window_ > 0 ){
+    for( int begin=0; begin<nsorted; ){
+      int end = begin;
+      while( end < nsorted && ( sorted_[end].first >> 32 ) == ( sorted_[begin].first >> 32 ) )
+	end++;
+
+      this->UniteInWindow( begin, end );
+      begin = end;
+    }
+  }
+  else{
+    // sweep over groups of the same (fem_id, fpga_id, module, bco)
+    for( int begin=0; begin<nsorted; ){
+      int end = begin;
+      while( end < nsorted && ( sorted_[end].first >> 16 ) == ( sorted_[begin].first >> 16 ) )
+	end++;
+
+      // positions of the candidates: (chip, chan-1), (chip-1, chan), (chip-13, 128)
+      int pointers[3] = { begin, begin, begin };
+      for( int k=begin; k<end; k++ ){
+	ULong64_t key = sorted_[k].first;
+	int chip = ( key >> 8 ) & 0xFF;
+	int chan = key & 0xFF;
+
+	ULong64_t targets[3];
+	bool is_valid[3] = { chan > 0, chip > 0, chip >= 13 && chan == 128 };
+	targets[0] = key - 1;
+	targets[1] = key - ( 1 << 8 );
+	targets[2] = key - ( 13 << 8 );
+
+	for( int t=0; t<3; t++ ){
+	  if( is_valid[t] == false )
+	    continue;
+
+	  int& p = pointers[t];
+	  while( p < k && sorted_[p].first < targets[t] )
+	    p++;
+
+	  // hits in the same channel are not neighbors of each other, but all of them are neighbors of this hit
+	  for( int q=p; q<k && sorted_[q].first == targets[t]; q++ )
+	    this->Unite( k, q );
+	}
+      }
+
+      begin = end;
+    }
+  }
+
+  // the first hit in the input order represents a cluster
+  position_.assign( nhits, -1 );
+  head_of_root_.assign( nsorted, nhits );
+  cluster_of_root_.assign( nsorted, -1 );
+  for( int k=0; k<nsorted; k++ ){
+    position_[ sorted_[k].second ] = k;
+    int root = this->Find( k );
+    head_of_root_[root] = std::min( head_of_root_[root], sorted_[k].second );
+  }
+
+  heads_.clear();
+  cluster_of_.assign( nhits, -1 );
+  for( int i=0; i<nhits; i++ ){
+    if( position_[i] < 0 )
+      continue;
+
+    int root = this->Find( position_[i] );
+    if( head_of_root_[root] == i ){
+      cluster_of_root_[root] = heads_.size();
+      heads_.push_back( i );
+    }
+
+    cluster_of_[i] = cluster_of_root_[root];
+  }
+
+  // members of each cluster in the input order
+  int nclusters = heads_.size();
+  member_begin_.assign( nclusters + 1, 0 );
+  for( int i=0; i<nhits; i++ )
+    if( cluster_of_[i] >= 0 )
+      member_begin_[ cluster_of_[i] + 1 ]++;
+
+  for( int c=0; c<nclusters; c++ )
+    member_begin_[c+1] += member_begin_[c];
+
+  members_.resize( nsorted );
+  adc_voltages_.assign( nclusters, 0.0 );
+  filled_.assign( nclusters, 0 );
+  for( int i=0; i<nhits; i++ ){
+    int c = cluster_of_[i];
+    if( c < 0 )
+      continue;
+
+    members_[ member_begin_[c] + filled_[c]++ ] = i;
+    adc_voltages_[c] += hits_[i].adc_voltage;
+  }
+
+  return nclusters;
+}
+
+void INTTClusterer::UniteInWindow( int begin, int end )
+{
+  // buckets for bco, a bucket is a range in sorted_ sorted by (chip_id, chan_id)
+  for( int b=0; b<128; b++ )
+    bucket_begin_[b] = bucket_end_[b] = begin;
+
+  for( int k=begin; k<end; ){
+    int j = k;
+    while( j < end && ( sorted_[j].first >> 16 ) == ( sorted_[k].first >> 16 ) )
+      j++;
+
+    int bucket = ( sorted_[k].first >> 16 ) & 0x7F;
+    bucket_begin_[bucket] = k;
+    bucket_end_[bucket] = j;
+    k = j;
+  }
+
+  int window = std::min( bco_window_, 63 ); // a pair shouldn't be in the window in both directions
+  ULong64_t group = sorted_[begin].first >> 32 << 32;
+  auto compare = []( const std::pair < ULong64_t, int >& a, ULong64_t b ){ return a.first < b; };
+  for( int k=begin; k<end; k++ ){
+    ULong64_t key = sorted_[k].first;
+    int bco = ( key >> 16 ) & 0x7F;
+    int chip = ( key >> 8 ) & 0xFF;
+    int chan = key & 0xFF;
+
+    for( int d=0; d<=window; d++ ){
+      int bucket = ( bco - d ) & 0x7F;
+      if( bucket_begin_[bucket] == bucket_end_[bucket] )
+	continue;
+
+      // (chip, chan) of the neighbors. In the same BCO, only the ones before this hit as the sweep without the window.
+      // In other BCOs, neighbors in both directions and the same channel.
+      int targets[7][2] = { { chip, chan - 1 }, { chip - 1, chan }, { chip - 13, 128 },
+			    { chip, chan + 1 }, { chip + 1, chan }, { chip + 13, 128 }, { chip, chan } };
+      bool is_valid[7] = { chan > 0, chip > 0, chip >= 13 && chan == 128,
+			   d > 0, d > 0, d > 0 && chan == 128, d > 0 };
+
+      ULong64_t bucket_key = group | ( (ULong64_t)( ( sorted_[ bucket_begin_[bucket] ].first >> 16 ) & 0xFFFF ) << 16 );
+      for( int t=0; t<7; t++ ){
+	if( is_valid[t] == false )
+	  continue;
+
+	ULong64_t target = bucket_key | ( (ULong64_t)targets[t][0] << 8 ) | (ULong64_t)targets[t][1];
+	auto first = std::lower_bound( sorted_.begin() + bucket_begin_[bucket], sorted_.begin() + bucket_end_[bucket], target, compare );
+	for( auto it = first; it != sorted_.begin() + bucket_end_[bucket] && it->first == target; it++ )
+	  this->Unite( k, it - sorted_.begin() );
+      }
+    }
+  }
+}
+
+void INTTClusterer::ScanBcoWindow( int max_window )
+{
+  if( (int)window_clusters_.size() < max_window + 1 )
+    window_clusters_.resize( max_window + 1, 0 );
+
+  int window = bco_window_;
+  for( int w=0; w<=max_window; w++ ){
+    bco_window_ = w;
+    window_clusters_[w] += this->Run();
+  }
+
+  bco_window_ = window;
+  this->Run();
+  scanned_events_++;
+}
+
+void INTTClusterer::PrintBcoWindowScan( std::ostream& os )
+{
+  os << "+--- Clusters for each BCO window ----------------------" << std::endl;
+  os << "| " << std::setw(8) << "window" << std::setw(14) << "clusters" << std::setw(14) << "per event" << std::setw(14) << "/ window 0" << std::endl;
+  for( int w=0; w<(int)window_clusters_.size(); w++ )
+    os << "| " << std::setw(8) << ( "+-" + std::to_string( w ) )
+       << std::setw(14) << window_clusters_[w]
+       << std::setw(14) << ( scanned_events_ != 0 ? (double)window_clusters_[w] / scanned_events_ : 0.0 )
+       << std::setw(14) << ( window_clusters_[0] != 0 ? (double)window_clusters_[w] / window_clusters_[0] : 0.0 )
+       << std::endl;
+  os << "| " << scanned_events_ << " events" << std::endl;
+  os << "+-------------------------------------------------------" << std::endl;
+}
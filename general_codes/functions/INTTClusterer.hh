@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ChannelMask.hh"
+
+//! A hit given to INTTClusterer
+struct INTTClusterHit
+{
+  int adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event;
+  Double_t adc_voltage;
+};
+
+/*!
+  @class INTTClusterer
+  @brief Hits in an event are clustered by sorting them once, instead of calling INTTHit::Clustering for every pair of hits
+  @details Two hits are neighbors in the same way as INTTHit::IsCluster:
+    - the same FEM_ID, FPGA_ID, module, and BCO, and
+    - neighboring channels on the same chip, the same channel on neighboring chips, or channel 128 on the chips facing each other (chip +-13).
+  Hits ignored by INTTHit::IsIgnored (chip_id > 27, chan_id > 128, ampl != 0, module == -1), hits given to SetIgnored,
+  and hits in the channels masked by ChannelMask (SetMask) are neither clustered nor output.
+  It's the same as the pairwise clustering, where these hits get the clustering status -2 (INTTHit::Init or SetIgnored) and aren't output.
+
+  The hits are sorted by (fem_id, fpga_id, module, bco, chip_id, chan_id). In a group with the same (fem_id, fpga_id, module, bco),
+  the neighbors (chip, chan-1), (chip-1, chan), and (chip-13, 128) of a hit come before it, so they are found by pointers which move only forward.
+  Neighbors are merged by union-find. It costs O(n log n) for the sort and O(n) for the rest, while the pairwise clustering costs O(n^2).
+  Different from the pairwise clustering, the result doesn't depend on the order of the hits. For example, channels 5, 7, and 6 make a cluster.
+  The memory is reused for the next event.
+
+  A cluster is represented by its first hit in the input order, as the pairwise clustering keeps the hit which took the others.
+  Clusters are given in the order of the representative hits.
+
+  BCO window (SetBcoWindow): charge can be split over neighboring BCOs. With a window N > 0, hits within +-N BCO (modulo 128, bco has 7 bits)
+  are clustered if they are in neighboring channels as above or in the same channel. The hits in a group of the same (fem_id, fpga_id, module)
+  are put into 128 buckets by bco, and each hit looks into its own bucket and the N buckets before it. A bucket is sorted by (chip_id, chan_id),
+  so the neighbors are found by binary search, and the cost stays linear in the number of hits for a fixed N. N should be less than 64.
+  The number of clusters for each window is counted by ScanBcoWindow to choose N (PrintBcoWindowScan).
+
+  How to use:
+    INTTClusterer clusterer;
+    clusterer.Clear();
+    clusterer.Add( adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event, adc_voltage ); // for each hit
+    int nclusters = clusterer.Run();
+    for( int i=0; i<nclusters; i++ ){
+      const INTTClusterHit& hit = clusterer.GetHit( clusterer.GetHead( i ) );
+      clusterer.GetSize( i ), clusterer.GetADCVoltage( i ), clusterer.GetMember( i, j ) ...
+    }
+*/
+class INTTClusterer
+{
+public:
+  INTTClusterer(){};
+
+  //! Hits of the previous event are removed
+  void Clear();
+
+  //! A hit is added. Its index (from 0) is returned.
+  int Add( int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id,
+	   int fem_id, int bco, int bco_full, int event, Double_t adc_voltage = -1.0 );
+
+  //! The hit is not clustered as INTTHit::SetIgnored
+  void SetIgnored( int index ){ ignored_[index] = true; };
+
+  //! Hits in the masked channels are ignored. nullptr for no mask.
+  void SetMask( const ChannelMask* mask ){ mask_ = mask; };
+
+  //! Hits within +-window BCO are clustered, 0 (default) for the same BCO only
+  void SetBcoWindow( int window ){ bco_window_ = window; };
+  int GetBcoWindow(){ return bco_window_; };
+
+  //! Hits are clustered. The number of the clusters is returned.
+  int Run();
+
+  int GetHitNum(){ return hits_.size(); };
+  const INTTClusterHit& GetHit( int index ){ return hits_[index]; };
+  bool IsIgnored( int index );
+
+  //! The cluster of the hit, -1 for an ignored hit
+  int GetCluster( int index ){ return cluster_of_[index]; };
+
+  int GetClusterNum(){ return heads_.size(); };
+  int GetHead( int cluster ){ return heads_[cluster]; };                          //!< index of the representative hit
+  int GetSize( int cluster ){ return member_begin_[cluster+1] - member_begin_[cluster]; };
+  int GetMember( int cluster, int i ){ return members_[ member_begin_[cluster] + i ]; }; //!< index of the i-th hit in the input order
+  Double_t GetADCVoltage( int cluster ){ return adc_voltages_[cluster]; };         //!< sum of the ADC voltages
+
+  //! The hits are clustered with the windows from 0 to max_window, and the numbers of the clusters are added to the diagnostics. The result of the current window is kept.
+  void ScanBcoWindow( int max_window );
+
+  //! The numbers of the clusters for each window summed over the events given to ScanBcoWindow
+  void PrintBcoWindowScan( std::ostream& os = std::cout );
+
+private:
+  const ChannelMask* mask_ = nullptr;
+  int bco_window_ = 0;
+  std::vector < INTTClusterHit > hits_;
+  std::vector < bool > ignored_;
+
+  // work space
+  std::vector < std::pair < ULong64_t, int > > sorted_; //!< (key, index of the hit)
+  std::vector < int > parent_;                         //!< union-find on the positions in sorted_
+  std::vector < int > head_of_root_;
+  std::vector < int > cluster_of_root_;
+  std::vector < int > position_;                       //!< position in sorted_ of each hit
+  std::vector < int > filled_;                         //!< the number of members filled for each cluster
+  int bucket_begin_[128], bucket_end_[128];            //!< range of each bco in sorted_ for the BCO window
+
+  // diagnostics of the BCO window
+  Long64_t scanned_events_ = 0;
+  std::vector < Long64_t > window_clusters_;            //!< the number of clusters for each window
+
+  // results
+  std::vector < int > cluster_of_;
+  std::vector < int > heads_;
+  std::vector < int > member_begin_;
+  std::vector < int > members_;
+  std::vector < Double_t > adc_voltages_;
+
+  static ULong64_t GetKey( const INTTClusterHit& hit );
+  int Find( int position );
+  void Unite( int a, int b );
+  void UniteInWindow( int begin, int end ); //!< a group of the same (fem_id, fpga_id, module) with the BCO window
+};
+
+#ifndef INTT_CLUSTERER_source
+#define INTT_CLUSTERER_source
+
+#include "INTTClusterer.cc"
+#endif //  INTT_CLUSTERER_source
@@ -130,9 +130,13 @@ void INTTHit::SetAllDAC( int values[8] )
   for( int i=0; i<8; i++ )
     this->SetDAC( i, values[i] );
 
-  //  adc_voltage_ = 210.0 + this->dac_values_[this->adc_] * 4;//
-  adc_voltage_ = 200.0 + this->dac_values_[this->adc_] * 4;//
-  
+  adc_voltage_ = INTTHit::GetADCVoltage( this->adc_, this->dac_values_ );
+}
+
+Double_t INTTHit::GetADCVoltage( int adc, int dac[8] )
+{
+  //  return 210.0 + dac[adc] * 4;//
+  return 200.0 + dac[adc] * 4;//
 }
 
 void INTTHit::Clustering( INTTHit* another )
@@ -140,6 +144,7 @@ void INTTHit::Clustering( INTTHit* another )
   if( this->IsCluster(another) == false )
     return;
   
+  this->cluster_geometry_.push_back( pair < int, int >( another->chip_id_, another->chan_id_ ) );
   this->cluster_channels_.push_back( another->chan_id_ );
   this->cluster_adc_voltages_.push_back( another->adc_voltage_ );
 
@@ -157,10 +162,26 @@ INTTHit* INTTHit::MakeCluster( INTTHit* another )
   cluster->adc_ = -1;
   cluster->adc_voltage_ += another->adc_voltage_;
   cluster->cluster_geometry_.push_back( pair < int, int >( another->chip_id_, another->chan_id_ ) );
+  cluster->cluster_channels_.push_back( another->chan_id_ );
+  cluster->cluster_adc_voltages_.push_back( another->adc_voltage_ );
   
   return cluster;
 }
 
+Double_t INTTHit::GetClusterPosition()
+{
+  // it's static to reuse the memory
+  static INTTClusterProperty property;
+  property.Clear();
+  for( int i=0; i<cluster_geometry_.size(); i++ )
+    property.Add( cluster_geometry_[i].first, cluster_geometry_[i].second, adc_, cluster_adc_voltages_[i] );
+
+  if( property.RunAsOneCluster() == 0 )
+    return 0.0;
+
+  return property.GetCentroid( 0 );
+}
+
 void INTTHit::SetClusteringStatus( int status )
 {
   // skipp if it's noise in any case
@@ -281,6 +302,13 @@ void INTTHit::Print()
        << setw(width_line - 2 - width_item - width_val - 1 ) << " "
        << "|"
        << endl;
+
+  cout << "| "
+       << setw(width_item) << "Cluster position (mm): "
+       << setw(width_val) << Form( "%.2f", this->GetClusterPosition() )
+       << setw(width_line - 2 - width_item - width_val - 1 ) << " "
+       << "|"
+       << endl;
   
   cout << "+" << string(width_line - 2,  '-' ) << "+" << endl;
 
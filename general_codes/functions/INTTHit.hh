@@ -1,5 +1,7 @@
 #pragma once
 
+#include "INTTClusterProperty.hh"
+
 class INTTHit
 {
 public:
@@ -56,6 +58,9 @@ public:
   INTTHit* MakeCluster( INTTHit* another );
 
   Double_t GetClusterADCVoltage(){ return accumulate( cluster_adc_voltages_.begin(), cluster_adc_voltages_.end(), 0.0); };;
+
+  //! The ADC voltage weighted position of the cluster in mm, see INTTClusterProperty for the geometry
+  Double_t GetClusterPosition();
   int GetClusteringStatus(){ return clustering_status_; };
   //double GetCluster
   
@@ -63,6 +68,9 @@ public:
   void SetDAC( int id, int value );
   void SetAllDAC( int values[8] );
   void SetIgnored( bool status );
+
+  //! ADC voltage of the ADC value with the DAC config, the same as SetAllDAC
+  static Double_t GetADCVoltage( int adc, int dac[8] );
   
   void Print();
   void PrintInOneLine();
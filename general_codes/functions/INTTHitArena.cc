@@ -0,0 +1,150 @@
+#include "INTTHitArena.hh"
+
+int INTTHitArena::Add( int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id,
+		       int fem_id, int bco, int bco_full, int event )
+{
+  if( hits_.size() == hits_.capacity() )
+    allocations_++;
+
+  INTTHitData hit;
+  hit.event = event;
+  hit.bco_full = bco_full & 0xFFFF;
+  hit.adc = adc;
+  hit.ampl = ampl;
+  hit.chip_id = chip_id;
+  hit.chan_id = chan_id;
+  hit.bco = bco;
+  hit.fpga_id = fpga_id;
+  hit.module = module;
+  hit.fem_id = fem_id;
+  hit.dac_config = 0;
+  hit.flags = bco_full >= 0 ? INTTHitData::kHasBcoFull : 0;
+
+  hits_.push_back( hit );
+  return hits_.size() - 1;
+}
+
+int INTTHitArena::Add( INTTHit& hit )
+{
+  int index = this->Add( hit.adc_, hit.ampl_, hit.chip_id_, hit.fpga_id_, hit.module_, hit.chan_id_,
+			 hit.fem_id_, hit.bco_, hit.bco_full_, hit.event_ );
+  this->SetAllDAC( index, hit.dac_values_ );
+  this->SetIgnored( index, hit.forced_ignored_ );
+  return index;
+}
+
+void INTTHitArena::SetAllDAC( int index, int values[8] )
+{
+  std::array < int, 8 > config;
+  for( int i=0; i<8; i++ )
+    config[i] = values[i];
+
+  // the same config is shared by the hits
+  size_t id = std::find( dac_configs_.begin(), dac_configs_.end(), config ) - dac_configs_.begin();
+  if( id == dac_configs_.size() ){
+    if( dac_configs_.size() == 255 ){
+      cerr << "INTTHitArena::SetAllDAC: more than 255 DAC configs are not supported" << endl;
+      return;
+    }
+
+    dac_configs_.push_back( config );
+  }
+
+  hits_[index].dac_config = id + 1;
+}
+
+Double_t INTTHitArena::GetADCVoltage( int index )
+{
+  const INTTHitData& hit = hits_[index];
+  if( hit.dac_config == 0 )
+    return -1.0;
+
+  return INTTHit::GetADCVoltage( hit.adc, &dac_configs_[ hit.dac_config - 1 ][0] );
+}
+
+INTTHit INTTHitArena::MakeINTTHit( int index )
+{
+  const INTTHitData& hit = hits_[index];
+  if( hit.dac_config == 0 ){
+    INTTHit output( hit.adc, hit.ampl, hit.chip_id, hit.fpga_id, hit.module, hit.chan_id,
+		    hit.fem_id, hit.bco, hit.GetBcoFull(), hit.event );
+    if( hit.IsIgnored() )
+      output.SetIgnored( true );
+
+    return output;
+  }
+
+  INTTHit output( hit.adc, hit.ampl, hit.chip_id, hit.fpga_id, hit.module, hit.chan_id,
+		  hit.fem_id, hit.bco, hit.GetBcoFull(), hit.event, &dac_configs_[ hit.dac_config - 1 ][0] );
+  if( hit.IsIgnored() )
+    output.SetIgnored( true );
+
+  return output;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// INTTClusterTable
+/////////////////////////////////////////////////////////////////////////////////////////////
+void INTTClusterTable::Clear( int nhits )
+{
+  begin_.assign( 1, 0 );
+  members_.clear();
+  cluster_of_.assign( nhits, -1 );
+  ignored_.assign( nhits, false );
+}
+
+int INTTClusterTable::AddCluster( const int* members, int size )
+{
+  int cluster = begin_.size() - 1;
+  for( int i=0; i<size; i++ ){
+    members_.push_back( members[i] );
+    cluster_of_[ members[i] ] = cluster;
+  }
+
+  begin_.push_back( members_.size() );
+  return cluster;
+}
+
+void INTTClusterTable::Fill( INTTClusterer& clusterer )
+{
+  this->Clear( clusterer.GetHitNum() );
+  for( int i=0; i<clusterer.GetHitNum(); i++ )
+    ignored_[i] = clusterer.IsIgnored( i );
+
+  for( int c=0; c<clusterer.GetClusterNum(); c++ ){
+    for( int i=0; i<clusterer.GetSize( c ); i++ ){
+      int member = clusterer.GetMember( c, i );
+      members_.push_back( member );
+      cluster_of_[member] = c;
+    }
+
+    begin_.push_back( members_.size() );
+  }
+}
+
+int INTTClusterTable::GetClusteringStatus( INTTHitArena& arena, int index )
+{
+  // the hits ignored by the clusterer (ampl != 0, masked, ...) are -2 as INTTHit::Init gives, and they are not in the output
+  if( arena[index].IsIgnored() || ignored_[index] )
+    return -2;
+
+  int cluster = cluster_of_[index];
+  if( cluster < 0 || this->GetSize( cluster ) == 1 )
+    return 0;
+
+  return this->GetMember( cluster, 0 ) == index ? 1 : -1;
+}
+
+INTTHit INTTClusterTable::MakeINTTHit( INTTHitArena& arena, int cluster )
+{
+  INTTHit output = arena.MakeINTTHit( this->GetMember( cluster, 0 ) );
+  for( int i=1; i<this->GetSize( cluster ); i++ ){
+    int member = this->GetMember( cluster, i );
+    output.cluster_geometry_.push_back( pair < int, int >( arena[member].chip_id, arena[member].chan_id ) );
+    output.cluster_channels_.push_back( arena[member].chan_id );
+    output.cluster_adc_voltages_.push_back( arena.GetADCVoltage( member ) );
+    output.SetClusteringStatus( 1 );
+  }
+
+  return output;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "INTTHit.hh"
+#include "INTTClusterer.hh"
+
+/*!
+  @struct INTTHitData
+  @brief A hit in 16 bytes, without strings and vectors. It's a POD, so an array of it is allocated at once.
+  @details bco_full has 16 bits, so -1 (no bco_full word yet) is kept as a flag. dac_config is the index of the DAC config in INTTHitArena.
+*/
+struct INTTHitData
+{
+  Int_t event;
+  UShort_t bco_full;
+  UChar_t adc, ampl, chip_id, chan_id, bco;
+  Char_t fpga_id, module, fem_id;
+  UChar_t dac_config;
+  UChar_t flags; //!< see Flag
+
+  enum Flag { kHasBcoFull = 1, kIgnored = 2 };
+
+  int GetBcoFull() const { return ( flags & kHasBcoFull ) ? bco_full : -1; };
+  bool IsIgnored() const { return flags & kIgnored; };
+};
+
+static_assert( sizeof( INTTHitData ) == 16, "INTTHitData should be 16 bytes" );
+
+/*!
+  @class INTTHitArena
+  @brief Hits of an event are kept in an array of INTTHitData, the memory is reused for the following events
+  @details Clear() removes the hits but keeps the memory, so no allocation is done once the array is large enough for the largest event.
+  The DAC configs are kept in a table (usually a few configs for a run), and each hit has the index.
+  INTTHit can be made from a hit (MakeINTTHit) to use Print and the other functions.
+
+  How to use:
+    INTTHitArena arena;
+    int dac[8] = { 15, 23, 60, 98, 135, 173, 210, 248 };
+    arena.Clear(); // for each event
+    int index = arena.Add( adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event );
+    arena.SetAllDAC( index, dac );
+    arena.GetADCVoltage( index );
+    arena.MakeINTTHit( index ).Print();
+*/
+class INTTHitArena
+{
+public:
+  INTTHitArena( size_t capacity = 1024 ){ hits_.reserve( capacity ); allocations_ = capacity > 0; };
+
+  //! The hits are removed, but the memory and the DAC configs are kept
+  void Clear(){ hits_.clear(); };
+
+  //! A hit is added. Its index is returned.
+  int Add( int adc, int ampl, int chip_id, int fpga_id, int module, int chan_id,
+	   int fem_id, int bco, int bco_full, int event );
+
+  //! The values of INTTHit are copied, the DAC config too
+  int Add( INTTHit& hit );
+
+  INTTHitData& operator[]( int index ){ return hits_[index]; };
+  int GetHitNum(){ return hits_.size(); };
+
+  //! The same as INTTHit::SetAllDAC
+  void SetAllDAC( int index, int values[8] );
+
+  //! The same as INTTHit::adc_voltage_, -1 if no DAC config is given
+  Double_t GetADCVoltage( int index );
+
+  //! The same as INTTHit::SetIgnored
+  void SetIgnored( int index, bool status ){ hits_[index].flags = status ? ( hits_[index].flags | INTTHitData::kIgnored ) : ( hits_[index].flags & ~INTTHitData::kIgnored ); };
+
+  //! INTTHit with the same values is made, for Print and so on
+  INTTHit MakeINTTHit( int index );
+
+  //! The number of times the array of the hits was allocated
+  Long64_t GetAllocations(){ return allocations_; };
+
+  //! Bytes of the memory in use (the array and the DAC configs)
+  size_t GetBytes(){ return hits_.capacity() * sizeof( INTTHitData ) + dac_configs_.capacity() * sizeof( std::array < int, 8 > ); };
+
+private:
+  std::vector < INTTHitData > hits_;
+  std::vector < std::array < int, 8 > > dac_configs_; //!< index 0 means no config
+  Long64_t allocations_ = 0;
+};
+
+/*!
+  @class INTTClusterTable
+  @brief Cluster membership of the hits in INTTHitArena, kept separately from the hits
+  @details The members of the cluster i are members_[ begin_[i] ] ... members_[ begin_[i+1]-1 ], the first one is the representative hit.
+  GetClusteringStatus gives the same status as INTTHit::GetClusteringStatus.
+
+  How to use:
+    INTTClusterTable table;
+    table.Clear( arena.GetHitNum() );
+    int members[] = { 3, 5, 6 };
+    table.AddCluster( members, 3 );
+    table.GetClusteringStatus( arena, 5 ); // -1
+    table.Fill( clusterer ); // or the result of INTTClusterer (the hits are given in the same order)
+*/
+class INTTClusterTable
+{
+public:
+  //! The table is emptied for nhits hits. The memory is kept.
+  void Clear( int nhits );
+
+  //! A cluster of the hits is added, the first one represents the cluster. Its index is returned.
+  int AddCluster( const int* members, int size );
+
+  //! The clusters made by INTTClusterer are copied, and the hits ignored by it are kept. The hits should be given to the clusterer in the same order as the arena.
+  void Fill( INTTClusterer& clusterer );
+
+  int GetClusterNum(){ return begin_.size() - 1; };
+  int GetSize( int cluster ){ return begin_[cluster+1] - begin_[cluster]; };
+  int GetMember( int cluster, int i ){ return members_[ begin_[cluster] + i ]; };
+  int GetCluster( int index ){ return cluster_of_[index]; }; //!< -1 if the hit is not in a cluster
+
+  //! 1: the representative hit of a cluster with other hits, 0: just a hit, -1: a hit taken by another hit, -2: ignored by the arena or the clusterer
+  int GetClusteringStatus( INTTHitArena& arena, int index );
+
+  //! INTTHit of the cluster as INTTHit::Clustering makes, for Print and so on
+  INTTHit MakeINTTHit( INTTHitArena& arena, int cluster );
+
+private:
+  std::vector < int > begin_ = { 0 };
+  std::vector < int > members_;
+  std::vector < int > cluster_of_;
+  std::vector < bool > ignored_; //!< ignored by INTTClusterer (Fill)
+};
+
+#ifndef INTT_HIT_ARENA_source
+#define INTT_HIT_ARENA_source
+
+#include "INTTHitArena.cc"
+#endif //  INTT_HIT_ARENA_source
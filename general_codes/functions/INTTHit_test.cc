@@ -1,4 +1,103 @@
+#include <chrono>
 #include "INTTHit.hh"
+#include "INTTHitArena.hh"
+
+//! Heap allocations owned by the hit (strings longer than SSO, vectors with elements), and their bytes
+int GetHeapAllocations( INTTHit* hit, size_t& bytes )
+{
+  int allocations = 0;
+  const char* begin = (const char*)hit;
+  const char* end = begin + sizeof( INTTHit );
+  for( const string* color : { &hit->color_red_, &hit->color_cyan_, &hit->color_cancel_ } ){
+    if( color->data() < begin || end <= color->data() ){
+      allocations++;
+      bytes += color->capacity() + 1;
+    }
+  }
+
+  if( hit->cluster_geometry_.capacity() > 0 ){
+    allocations++;
+    bytes += hit->cluster_geometry_.capacity() * sizeof( pair < int, int > );
+  }
+
+  if( hit->cluster_channels_.capacity() > 0 ){
+    allocations++;
+    bytes += hit->cluster_channels_.capacity() * sizeof( int );
+  }
+
+  if( hit->cluster_adc_voltages_.capacity() > 0 ){
+    allocations++;
+    bytes += hit->cluster_adc_voltages_.capacity() * sizeof( Double_t );
+  }
+
+  return allocations;
+}
+
+//! Sizes and allocations of INTTHit and INTTHitArena for the same hits
+void INTTHit_benchmark( int nevents = 1000, int nhits_per_event = 200 )
+{
+  int DACs[8] = { 15, 23, 60, 98, 135, 173, 210, 248 };
+  cout << "sizeof( INTTHit )     : " << sizeof( INTTHit ) << " bytes" << endl;
+  cout << "sizeof( INTTHitData ) : " << sizeof( INTTHitData ) << " bytes" << endl;
+
+  INTTHit* sample = new INTTHit( 1, 0, 3, 1, 1, 5, 1, 1, 100, 1, DACs );
+  size_t heap_bytes = 0;
+  int heap_allocations = GetHeapAllocations( sample, heap_bytes );
+  cout << "INTTHit per hit: " << 1 + heap_allocations << " allocations (new + " << heap_allocations << " in the members), "
+       << sizeof( INTTHit ) + heap_bytes << " bytes" << endl;
+  delete sample;
+
+  // the same hits for both
+  TRandom3 rand( 1 );
+  vector < int > values;
+  for( int i=0; i<nhits_per_event; i++ ){
+    values.push_back( rand.Integer( 8 ) );   // adc
+    values.push_back( rand.Integer( 26 ) );  // chip
+    values.push_back( rand.Integer( 128 ) ); // chan
+    values.push_back( rand.Integer( 128 ) ); // bco
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Long64_t allocations_hit = 0;
+  Double_t sum_hit = 0;
+  for( int event=0; event<nevents; event++ ){
+    vector < INTTHit* > hits;
+    for( int i=0; i<nhits_per_event; i++ ){
+      hits.push_back( new INTTHit( values[4*i], 0, values[4*i+1], 0, 1, values[4*i+2], 1, values[4*i+3], 100, event, DACs ) );
+      size_t bytes = 0;
+      allocations_hit += 1 + GetHeapAllocations( hits.back(), bytes );
+    }
+
+    for( auto& hit : hits ){
+      sum_hit += hit->adc_voltage_;
+      delete hit;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double time_hit = std::chrono::duration < double, std::milli >( end - start ).count();
+
+  start = std::chrono::steady_clock::now();
+  INTTHitArena arena;
+  Double_t sum_arena = 0;
+  for( int event=0; event<nevents; event++ ){
+    arena.Clear();
+    for( int i=0; i<nhits_per_event; i++ ){
+      int index = arena.Add( values[4*i], 0, values[4*i+1], 0, 1, values[4*i+2], 1, values[4*i+3], 100, event );
+      arena.SetAllDAC( index, DACs );
+    }
+
+    for( int i=0; i<arena.GetHitNum(); i++ )
+      sum_arena += arena.GetADCVoltage( i );
+  }
+  end = std::chrono::steady_clock::now();
+  double time_arena = std::chrono::duration < double, std::milli >( end - start ).count();
+
+  int width = 14;
+  cout << setw(width) << "" << setw(width) << "allocations" << setw(width) << "time (ms)" << setw(width) << "sum of V" << endl;
+  cout << setw(width) << "INTTHit" << setw(width) << allocations_hit << setw(width) << time_hit << setw(width) << sum_hit << endl;
+  cout << setw(width) << "INTTHitArena" << setw(width) << arena.GetAllocations() << setw(width) << time_arena << setw(width) << sum_arena << endl;
+  cout << "for " << nevents << " events x " << nhits_per_event << " hits, the arena uses " << arena.GetBytes() << " bytes" << endl;
+}
 
 int INTTHit_test()
 {
@@ -66,8 +165,73 @@ int INTTHit_test()
   for( const auto& hit : hits )
     if( hit->GetClusteringStatus() != -1 )
       hit->Print();
-  
-  return 0;
+
+  // the same hits in the arena, clustered by INTTClusterer, should be printed in the same way
+  INTTHitArena arena;
+  INTTClusterer clusterer;
+  clusterer.Clear();
+  for( int i=0; i<hits.size(); i++ ){
+    int index = arena.Add( *hits[i] );
+    clusterer.Add( hits[i]->adc_, hits[i]->ampl_, hits[i]->chip_id_, hits[i]->fpga_id_, hits[i]->module_, hits[i]->chan_id_,
+		   hits[i]->fem_id_, hits[i]->bco_, hits[i]->bco_full_, hits[i]->event_, arena.GetADCVoltage( index ) );
+  }
+  clusterer.Run();
+
+  INTTClusterTable table;
+  table.Fill( clusterer );
+  cout << "Hits in the arena finally: ";
+  for( int i=0; i<arena.GetHitNum(); i++ )
+    if( table.GetClusteringStatus( arena, i ) != -1 )
+      cout << i << " ";
+  cout << endl;
+
+  for( int c=0; c<table.GetClusterNum(); c++ )
+    table.MakeINTTHit( arena, c ).Print();
+
+  // hits ignored by INTTHit (ampl != 0, chip_id > 27, module == -1, and SetIgnored) should have the same status in the table
+  vector < INTTHit* > ignored_hits;
+  //                                  adc,ampl,chip,fpga,modl,chan, fem, bco,bcof, eve
+  ignored_hits.push_back( new INTTHit(   1,   0,   3,   0,   6,   5,   8,  52, 100,   1, DACs ) ); // 0
+  ignored_hits.push_back( new INTTHit(   1,   1,   3,   0,   6,   6,   8,  52, 100,   1, DACs ) ); // 1, ampl != 0
+  ignored_hits.push_back( new INTTHit(   1,   0,   3,   0,   6,   7,   8,  52, 100,   1, DACs ) ); // 2, SetIgnored
+  ignored_hits.push_back( new INTTHit(   1,   0,  30,   0,   6,   8,   8,  52, 100,   1, DACs ) ); // 3, chip_id > 27
+  ignored_hits.push_back( new INTTHit(   1,   0,   3,   0,  -1,   9,   8,  52, 100,   1, DACs ) ); // 4, module == -1
+  ignored_hits.push_back( new INTTHit(   1,   0,   3,   0,   6,   4,   8,  52, 100,   1, DACs ) ); // 5
+  ignored_hits[2]->SetIgnored( true );
+
+  INTTHitArena ignored_arena;
+  clusterer.Clear();
+  for( int i=0; i<ignored_hits.size(); i++ ){
+    int index = ignored_arena.Add( *ignored_hits[i] );
+    ignored_arena.SetIgnored( index, false ); // only the clusterer knows them
+    clusterer.Add( ignored_hits[i]->adc_, ignored_hits[i]->ampl_, ignored_hits[i]->chip_id_, ignored_hits[i]->fpga_id_,
+		   ignored_hits[i]->module_, ignored_hits[i]->chan_id_, ignored_hits[i]->fem_id_, ignored_hits[i]->bco_,
+		   ignored_hits[i]->bco_full_, ignored_hits[i]->event_, ignored_arena.GetADCVoltage( index ) );
+  }
+  clusterer.SetIgnored( 2 );
+
+  for( int i=0; i<ignored_hits.size(); i++ )
+    for( int j=i+1; j<ignored_hits.size(); j++ )
+      ignored_hits[i]->Clustering( ignored_hits[j] );
+
+  clusterer.Run();
+  table.Fill( clusterer );
+
+  int failures = 0;
+  for( int i=0; i<ignored_hits.size(); i++ ){
+    bool is_ok = table.GetClusteringStatus( ignored_arena, i ) == ignored_hits[i]->GetClusteringStatus();
+    if( is_ok == false )
+      failures++;
+
+    cout << ( is_ok ? "OK  " : "FAIL" ) << " status of hit " << i << ": " << table.GetClusteringStatus( ignored_arena, i )
+	 << " in the table, " << ignored_hits[i]->GetClusteringStatus() << " by INTTHit" << endl;
+  }
+
+  for( auto& hit : ignored_hits )
+    delete hit;
+
+  INTTHit_benchmark();
+  return failures;
 }
 
     
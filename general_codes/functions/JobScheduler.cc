@@ -0,0 +1,182 @@
+#include "JobScheduler.hh"
+
+JobScheduler::JobScheduler( int max_running )
+{
+  max_running_ = max_running;
+  if( max_running_ <= 0 )
+    max_running_ = std::max( 1u, std::thread::hardware_concurrency() );
+
+  start_ = std::chrono::steady_clock::now();
+}
+
+JobScheduler::~JobScheduler()
+{
+  this->WaitAll();
+
+  {
+    std::lock_guard < std::mutex > lock( mutex_ );
+    is_stopped_ = true;
+  }
+  cv_job_.notify_all();
+
+  for( auto& worker : workers_ )
+    worker.join();
+}
+
+std::shared_future < bool > JobScheduler::Submit( string name, std::function < bool() > job )
+{
+  std::shared_future < bool > result;
+  {
+    std::lock_guard < std::mutex > lock( mutex_ );
+
+    JobRecord record;
+    record.name = name;
+    records_.push_back( record );
+
+    Task task;
+    task.index = records_.size() - 1;
+    task.job = job;
+    result = task.promise.get_future().share();
+    queue_.push_back( std::move( task ) );
+    unfinished_++;
+
+    // threads are started when they are needed
+    if( (int)workers_.size() < max_running_ && (int)workers_.size() < unfinished_ )
+      workers_.push_back( std::thread( &JobScheduler::Work, this ) );
+  }
+
+  cv_job_.notify_one();
+  return result;
+}
+
+bool JobScheduler::Run( string name, std::function < bool() > job )
+{
+  int index = 0;
+  {
+    std::lock_guard < std::mutex > lock( mutex_ );
+    JobRecord record;
+    record.name = name;
+    records_.push_back( record );
+    index = records_.size() - 1;
+  }
+
+  return this->Execute( index, job );
+}
+
+bool JobScheduler::WaitAll()
+{
+  std::unique_lock < std::mutex > lock( mutex_ );
+  cv_finished_.wait( lock, [this]() { return unfinished_ == 0; } );
+
+  for( auto& record : records_ )
+    if( record.status == JobRecord::kFailed )
+      return false;
+
+  return true;
+}
+
+int JobScheduler::GetJobNum()
+{
+  std::lock_guard < std::mutex > lock( mutex_ );
+  return records_.size();
+}
+
+int JobScheduler::GetFailedNum()
+{
+  std::lock_guard < std::mutex > lock( mutex_ );
+  int counter = 0;
+  for( auto& record : records_ )
+    if( record.status == JobRecord::kFailed )
+      counter++;
+
+  return counter;
+}
+
+JobRecord JobScheduler::GetRecord( int index )
+{
+  std::lock_guard < std::mutex > lock( mutex_ );
+  if( index < 0 || (int)records_.size() <= index )
+    return JobRecord();
+
+  return records_[index];
+}
+
+void JobScheduler::Print( std::ostream& os )
+{
+  std::lock_guard < std::mutex > lock( mutex_ );
+  const char* status_names[] = { "queued", "running", "done", "FAILED" };
+
+  double elapsed = std::chrono::duration < double >( std::chrono::steady_clock::now() - start_ ).count();
+  double total = 0;
+  for( auto& record : records_ )
+    total += record.seconds;
+
+  os << "+--- Jobs ----------------------------------------------" << endl;
+  for( auto& record : records_ ){
+    os << "| " << setw(7) << status_names[ record.status ] << " "
+       << setw(8) << fixed << setprecision(2) << record.seconds << " s  "
+       << record.name;
+    if( record.message != "" )
+      os << ": " << record.message;
+
+    os << endl;
+  }
+  os << "| " << records_.size() << " jobs, " << max_running_ << " thread(s), "
+     << setprecision(2) << total << " s in total, " << elapsed << " s elapsed" << endl;
+  os << "+-------------------------------------------------------" << endl;
+  os.unsetf( std::ios::fixed );
+}
+
+bool JobScheduler::Execute( int index, std::function < bool() >& job )
+{
+  {
+    std::lock_guard < std::mutex > lock( mutex_ );
+    records_[index].status = JobRecord::kRunning;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool is_success = false;
+  string message = "";
+  try{
+    is_success = job();
+    if( is_success == false )
+      message = "returned false";
+  }
+  catch( std::exception& error ){
+    message = error.what();
+  }
+  catch( ... ){
+    message = "unknown exception";
+  }
+
+  std::lock_guard < std::mutex > lock( mutex_ );
+  records_[index].seconds = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+  records_[index].status = is_success ? JobRecord::kDone : JobRecord::kFailed;
+  records_[index].message = message;
+  return is_success;
+}
+
+void JobScheduler::Work()
+{
+  while( true ){
+    Task task;
+    {
+      std::unique_lock < std::mutex > lock( mutex_ );
+      cv_job_.wait( lock, [this]() { return is_stopped_ || queue_.empty() == false; } );
+      if( queue_.empty() )
+	return; // stopped
+
+      task = std::move( queue_.front() );
+      queue_.pop_front();
+    }
+
+    bool is_success = this->Execute( task.index, task.job );
+    task.promise.set_value( is_success );
+
+    {
+      std::lock_guard < std::mutex > lock( mutex_ );
+      unfinished_--;
+    }
+    cv_finished_.notify_all();
+  }
+}
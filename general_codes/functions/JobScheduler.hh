@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/*!
+  @struct JobRecord
+  @brief The status, time, and error of a job in JobScheduler
+*/
+struct JobRecord
+{
+  enum Status { kQueued, kRunning, kDone, kFailed };
+
+  string name;
+  Status status = kQueued;
+  double seconds = 0;    //!< time to run the job
+  string message = "";   //!< the reason of the failure
+};
+
+/*!
+  @class JobScheduler
+  @brief Jobs are run in this process by a limited number of threads, instead of ROOT processes in the background
+  @details check_felix started "root -q -b -l '...' &" for each module and plot type, and it waited for them by counting lines of "ps aux".
+  It didn't work when other people ran ROOT on the same machine, and all processes ran at once.
+  Here a job is a function. It's queued by Submit, and at most max_running jobs run at the same time.
+  A job fails if it returns false or throws an exception. The time and the result of each job are kept and shown by Print.
+  Submit returns a future, so one can wait for a job by get(). WaitAll waits for all jobs.
+
+  ROOT objects used by jobs running at the same time must be independent (e.g. each job opens the file by itself),
+  and ROOT::EnableThreadSafety() is needed. Jobs drawing something should be given to Run, which runs the job in this thread with the same bookkeeping.
+
+  How to use:
+    JobScheduler scheduler( 4 );
+    auto result = scheduler.Submit( "module 0", [&](){ return FillSomething( 0 ); } );
+    ...
+    scheduler.WaitAll();
+    scheduler.Print();
+*/
+class JobScheduler
+{
+public:
+  //! max_running is the number of threads. The number of cores is used if it's 0 or negative.
+  JobScheduler( int max_running = 0 );
+
+  //! All jobs are waited for
+  ~JobScheduler();
+
+  //! The job is queued, and true is given to the future if it succeeded
+  std::shared_future < bool > Submit( string name, std::function < bool() > job );
+
+  //! The job is run in this thread with the same bookkeeping as submitted jobs
+  bool Run( string name, std::function < bool() > job );
+
+  //! All jobs submitted are waited for. false is returned if any of them failed.
+  bool WaitAll();
+
+  int GetMaxRunning(){ return max_running_; };
+  int GetJobNum();
+  int GetFailedNum();
+
+  //! A copy of the record of the job. Jobs are numbered in order of Submit and Run.
+  JobRecord GetRecord( int index );
+
+  //! The time, the status, and the errors of all jobs
+  void Print( std::ostream& os = std::cout );
+
+private:
+  struct Task
+  {
+    int index;
+    std::function < bool() > job;
+    std::promise < bool > promise;
+  };
+
+  int max_running_;
+  vector < std::thread > workers_;
+  std::deque < Task > queue_;
+  vector < JobRecord > records_;
+  int unfinished_ = 0;
+  bool is_stopped_ = false;
+  std::chrono::steady_clock::time_point start_;
+
+  std::mutex mutex_;                    //!< for all members above
+  std::condition_variable cv_job_;      //!< a job is queued or the scheduler is stopped
+  std::condition_variable cv_finished_; //!< a job is finished
+
+  //! The job is run and the record is updated
+  bool Execute( int index, std::function < bool() >& job );
+
+  //! Loop of a worker thread
+  void Work();
+};
+
+#ifndef JOB_SCHEDULER_source
+#define JOB_SCHEDULER_source
+
+#include "JobScheduler.cc"
+#endif //  JOB_SCHEDULER_source
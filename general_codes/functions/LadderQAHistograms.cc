@@ -0,0 +1,263 @@
+#include "LadderQAHistograms.hh"
+
+void LadderQAHistogramSet::Book( int module_id, string suffix )
+{
+  module = module_id;
+  string tag = "_module" + to_string( module ) + suffix;
+
+  ampl_adc_chip = new TH3D( ( "ampl_adc_chip" + tag ).c_str(), "Amplitude vs ADC vs Chip ID;Amplitude;ADC;Chip ID",
+			    70, 0, 70, 8, 0, 8, 26, 0, 26 );
+  ampl_ch_chip = new TH3D( ( "ampl_ch_chip" + tag ).c_str(), "Amplitude vs Channel vs Chip;Amplitude;Channel;Chip",
+			   127, 0, 127, 128, 0, 128, 26, 0, 26 );
+  ch_chip = new TH2D( ( "ch_chip" + tag ).c_str(), "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26 );
+  adc_chip = new TH2D( ( "adc_chip" + tag ).c_str(), "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26 );
+  hitmap = new TH2D( ( "hitmap" + tag ).c_str(), "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257 );
+
+  // they aren't owned by the file of a thread
+  ampl_adc_chip->SetDirectory( nullptr );
+  ampl_ch_chip->SetDirectory( nullptr );
+  ch_chip->SetDirectory( nullptr );
+  adc_chip->SetDirectory( nullptr );
+  hitmap->SetDirectory( nullptr );
+}
+
+void LadderQAHistogramSet::Add( const LadderQAHistogramSet& another )
+{
+  ampl_adc_chip->Add( another.ampl_adc_chip );
+  ampl_ch_chip->Add( another.ampl_ch_chip );
+  ch_chip->Add( another.ch_chip );
+  adc_chip->Add( another.adc_chip );
+  hitmap->Add( another.hitmap );
+}
+
+void LadderQAHistogramSet::Delete()
+{
+  delete ampl_adc_chip;
+  delete ampl_ch_chip;
+  delete ch_chip;
+  delete adc_chip;
+  delete hitmap;
+  ampl_adc_chip = ampl_ch_chip = nullptr;
+  ch_chip = adc_chip = hitmap = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// LadderQAHistograms
+/////////////////////////////////////////////////////////////////////////////////////////////
+LadderQAHistograms::LadderQAHistograms( vector < int > modules )
+{
+  modules_ = modules;
+  for( int i=0; i<16; i++ )
+    index_of_module_[i] = -1;
+
+  for( auto& module : modules_ ){
+    if( module < 0 || 16 <= module ){
+      cerr << "LadderQAHistograms: module " << module << " is out of range, skipped" << endl;
+      continue;
+    }
+
+    index_of_module_[module] = sets_.size();
+    sets_.push_back( LadderQAHistogramSet() );
+    sets_.back().Book( module );
+  }
+}
+
+LadderQAHistograms::~LadderQAHistograms()
+{
+  for( auto& set : sets_ )
+    set.Delete();
+}
+
+LadderQAHistogramSet* LadderQAHistograms::GetSet( int module )
+{
+  if( module < 0 || 16 <= module || index_of_module_[module] < 0 )
+    return nullptr;
+
+  return &sets_[ index_of_module_[module] ];
+}
+
+Long64_t LadderQAHistograms::FillRange( string root_file, string cut, Long64_t first, Long64_t last, vector < LadderQAHistogramSet >& sets )
+{
+  TFile* tf = new TFile( root_file.c_str(), "READ" );
+  TTree* tree = (TTree*)tf->Get( "tree" );
+  if( tree == nullptr ){
+    tf->Close();
+    delete tf;
+    return -1;
+  }
+
+  // only the branches in use are read
+  int adc, ampl, chip_id, module, chan_id;
+  tree->SetBranchStatus( "*", 0 );
+  for( auto name : { "adc", "ampl", "chip_id", "module", "chan_id" } )
+    tree->SetBranchStatus( name, 1 );
+
+  tree->SetBranchAddress( "adc", &adc );
+  tree->SetBranchAddress( "ampl", &ampl );
+  tree->SetBranchAddress( "chip_id", &chip_id );
+  tree->SetBranchAddress( "module", &module );
+  tree->SetBranchAddress( "chan_id", &chan_id );
+
+  TTreeFormula* formula = nullptr;
+  if( cut != "" ){
+    tree->SetBranchStatus( "*", 1 ); // branches in the cut are needed too
+    formula = new TTreeFormula( "qa_cut", cut.c_str(), tree );
+  }
+
+  const HitMapLookup& hitmap_lookup = HitMapLookup::Get( HitMapLookup::kChipDescending );
+  Long64_t filled = 0;
+  for( Long64_t i=first; i<last; i++ ){
+    tree->GetEntry( i );
+
+    // the same as cut_base in DrawPlotsMultipleLadders
+    if( ampl >= 70 || chan_id >= 128 || chip_id >= 27 )
+      continue;
+
+    if( module < 0 || 16 <= module || index_of_module_[module] < 0 )
+      continue;
+
+    if( formula != nullptr ){
+      tree->LoadTree( i );
+      if( formula->EvalInstance() == 0 )
+	continue;
+    }
+
+    LadderQAHistogramSet& set = sets[ index_of_module_[module] ];
+    set.ampl_adc_chip->Fill( ampl, adc, chip_id );
+    set.ampl_ch_chip->Fill( ampl, chan_id, chip_id );
+    set.ch_chip->Fill( chan_id, chip_id );
+    set.adc_chip->Fill( adc, chip_id );
+
+    // the same coordinates as DrawPlots_Hitmap
+    hitmap_lookup.Fill( set.hitmap, chip_id, chan_id );
+    filled++;
+  }
+
+  delete formula;
+  tf->Close();
+  delete tf;
+  return filled;
+}
+
+bool LadderQAHistograms::Fill( string root_file, string cut, int nthreads, JobScheduler* scheduler )
+{
+  auto start = std::chrono::steady_clock::now();
+
+  TFile* tf = new TFile( root_file.c_str(), "READ" );
+  TTree* tree = (TTree*)tf->Get( "tree" );
+  bool has_tree = tree != nullptr;
+  entries_ = has_tree ? tree->GetEntries() : 0;
+
+  // the hits don't need to be read if they were counted by the decoder, so the tree isn't needed (e.g. tree_compact only)
+  HitCountCube cube;
+  if( cut == "" && cube.Read( tf ) ){
+    tf->Close();
+    delete tf;
+
+    this->Fill( cube );
+    seconds_ = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+    return true;
+  }
+
+  tf->Close();
+  delete tf;
+  if( has_tree == false ){
+    cerr << "LadderQAHistograms::Fill: tree is not found in " << root_file << endl;
+    return false;
+  }
+
+  if( nthreads < 1 )
+    nthreads = 1;
+
+  // each thread fills its own sets, they are added in the order of the ranges at the end
+  vector < vector < LadderQAHistogramSet > > thread_sets( nthreads );
+  vector < Long64_t > thread_filled( nthreads, -1 ); // -1 remains if a job failed
+  for( int part=1; part<nthreads; part++ )
+    for( auto& module : modules_ )
+      if( this->GetSet( module ) != nullptr ){
+	thread_sets[part].push_back( LadderQAHistogramSet() );
+	thread_sets[part].back().Book( module, "_thread" + to_string( part ) );
+      }
+
+  if( nthreads == 1 && scheduler == nullptr ){
+    thread_filled[0] = this->FillRange( root_file, cut, 0, entries_, sets_ );
+  }
+  else{
+    ROOT::EnableThreadSafety();
+    JobScheduler own_scheduler( nthreads );
+    if( scheduler == nullptr )
+      scheduler = &own_scheduler;
+
+    vector < std::shared_future < bool > > results;
+    for( int part=0; part<nthreads; part++ ){
+      Long64_t first = entries_ * part / nthreads;
+      Long64_t last = entries_ * ( part + 1 ) / nthreads;
+      string name = "fill " + root_file + " [" + to_string( first ) + ", " + to_string( last ) + ")";
+      results.push_back( scheduler->Submit( name, [&, part, first, last]() {
+	thread_filled[part] = this->FillRange( root_file, cut, first, last, part == 0 ? sets_ : thread_sets[part] );
+	return thread_filled[part] >= 0;
+      }) );
+    }
+
+    // only the jobs of this filling are waited for since the scheduler may have others
+    for( auto& result : results )
+      result.wait();
+  }
+
+  filled_ = 0;
+  bool is_ok = true;
+  for( int part=0; part<nthreads; part++ ){
+    if( thread_filled[part] < 0 )
+      is_ok = false;
+    else
+      filled_ += thread_filled[part];
+
+    for( int i=0; i<(int)thread_sets[part].size(); i++ ){
+      sets_[i].Add( thread_sets[part][i] );
+      thread_sets[part][i].Delete();
+    }
+  }
+
+  seconds_ = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+  return is_ok;
+}
+
+void LadderQAHistograms::Fill( const HitCountCube& cube )
+{
+  const HitMapLookup& hitmap_lookup = HitMapLookup::Get( HitMapLookup::kChipDescending );
+  int x, y;
+  filled_ = 0;
+  for( auto& set : sets_ ){
+    Long64_t total = 0;
+    for( int chip=0; chip<HitCountCube::kNChips; chip++ ){
+      if( cube.HasChip( set.module, chip ) == false )
+	continue;
+
+      for( int chan=0; chan<HitCountCube::kNChans; chan++ ){
+	for( int ampl=0; ampl<70; ampl++ ){ // ampl<70 as FillRange
+	  for( int adc=0; adc<HitCountCube::kNAdcs; adc++ ){
+	    UInt_t count = cube.GetCount( set.module, chip, chan, ampl, adc );
+	    if( count == 0 )
+	      continue;
+
+	    // bin contents are added instead of Fill with the weight, which makes the errors different from the ones of hits
+	    set.ampl_adc_chip->AddBinContent( set.ampl_adc_chip->FindBin( ampl, adc, chip ), count );
+	    set.ampl_ch_chip->AddBinContent( set.ampl_ch_chip->FindBin( ampl, chan, chip ), count );
+	    set.ch_chip->AddBinContent( set.ch_chip->FindBin( chan, chip ), count );
+	    set.adc_chip->AddBinContent( set.adc_chip->FindBin( adc, chip ), count );
+	    hitmap_lookup.GetPosition( chip, chan, x, y );
+	    set.hitmap->AddBinContent( set.hitmap->FindBin( x, y ), count );
+	    total += count;
+	  }
+	}
+      }
+    }
+
+    set.ampl_adc_chip->SetEntries( total );
+    set.ampl_ch_chip->SetEntries( total );
+    set.ch_chip->SetEntries( total );
+    set.adc_chip->SetEntries( total );
+    set.hitmap->SetEntries( total );
+    filled_ += total;
+  }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "JobScheduler.hh"
+#include "HitCountCube.hh"
+#include "HitMapLookup.hh"
+
+//! Histograms of a module filled by LadderQAHistograms. Their binning is the same as the ones of DrawPlots_* in DrawPlotsMultipleLadders.cc.
+struct LadderQAHistogramSet
+{
+  int module = -1;
+  TH3D* ampl_adc_chip = nullptr; //!< amplitude : ADC : chip_id
+  TH3D* ampl_ch_chip = nullptr;  //!< amplitude : chan_id : chip_id
+  TH2D* ch_chip = nullptr;       //!< chan_id : chip_id
+  TH2D* adc_chip = nullptr;      //!< ADC : chip_id
+  TH2D* hitmap = nullptr;        //!< the hit map, see DrawPlots_Hitmap and HitMapLookup::kChipDescending
+
+  //! The histograms are made without the directory. suffix is added to the names.
+  void Book( int module_id, string suffix = "" );
+
+  //! Contents of another set are added
+  void Add( const LadderQAHistogramSet& another );
+
+  void Delete();
+};
+
+/*!
+  @class LadderQAHistograms
+  @brief Histograms of all plot types in DrawPlotsMultipleLadders are filled for all modules in one loop over the TTree
+  @details DrawPlots_AmplADC, DrawPlots_ChAmpl, DrawPlots_Ch, and DrawPlots_ADC used TTree::Draw for each plot type and each module,
+  so the whole tree was read several times. Here the branches are read directly once, and a hit is filled to all histograms of its module.
+  The cuts of DrawPlotsMultipleLadders (ampl<70, chan_id<128, chip_id<27) are applied. An additional cut is evaluated by TTreeFormula.
+
+  With nthreads > 1, the entries are divided into nthreads ranges, and they are filled as jobs of JobScheduler.
+  Each job opens the file by itself and fills its own set of histograms. The sets are added at the end, so the results are the same as the serial filling.
+
+  How to use:
+    LadderQAHistograms qa( { 0, 1, 2 } );
+    qa.Fill( "data/calib_packv1_220927_1700.root", "", 4 );
+    qa.GetSet( 1 )->ampl_adc_chip->Project3D( "YX" ) ...
+*/
+class LadderQAHistograms
+{
+public:
+  LadderQAHistograms( vector < int > modules );
+  ~LadderQAHistograms();
+
+  /*!
+    @brief "tree" in the file is read once and the histograms are filled
+    @details If cut is "" and the file has count_cube, the histograms are filled with it (see Fill( const HitCountCube& )), and tree isn't needed.
+    @param root_file A ROOT file made by MakeTree
+    @param cut An additional cut in the TTree::Draw syntax, "" for nothing
+    @param nthreads The number of ranges of entries filled in parallel
+    @param scheduler The ranges are run by it if it's given, otherwise by a scheduler with nthreads threads
+    @retval false if neither count_cube nor the tree can be read
+  */
+  bool Fill( string root_file, string cut = "", int nthreads = 1, JobScheduler* scheduler = nullptr );
+
+  //! The histograms are filled with the counts in the cube. The same cuts as Fill are applied.
+  void Fill( const HitCountCube& cube );
+
+  //! The histograms of the module, nullptr if the module isn't given to the constructor
+  LadderQAHistogramSet* GetSet( int module );
+
+  Long64_t GetEntries(){ return entries_; };   //!< entries read
+  Long64_t GetFilledNum(){ return filled_; };  //!< hits passing the cuts
+  double GetTime(){ return seconds_; };        //!< seconds for Fill
+
+private:
+  vector < int > modules_;
+  vector < LadderQAHistogramSet > sets_;
+  int index_of_module_[16];
+
+  Long64_t entries_ = 0;
+  Long64_t filled_ = 0;
+  double seconds_ = 0;
+
+  //! Entries in [first, last) are filled to sets. The number of filled hits is returned, -1 in the case of an error.
+  Long64_t FillRange( string root_file, string cut, Long64_t first, Long64_t last, vector < LadderQAHistogramSet >& sets );
+};
+
+#ifndef LADDER_QA_HISTOGRAMS_source
+#define LADDER_QA_HISTOGRAMS_source
+
+#include "LadderQAHistograms.cc"
+#endif //  LADDER_QA_HISTOGRAMS_source
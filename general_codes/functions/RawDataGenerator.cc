@@ -0,0 +1,334 @@
+#include "RawDataGenerator.hh"
+
+ULong64_t RawDataGenerator::Next()
+{
+  // SplitMix64, the integers are the same on any platform
+  ULong64_t z = ( state_ += 0x9e3779b97f4a7c15ULL );
+  z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+  return z ^ ( z >> 31 );
+}
+
+double RawDataGenerator::Uniform()
+{
+  // 53 bits for the mantissa
+  return ( this->Next() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+UInt_t RawDataGenerator::Integer( UInt_t n )
+{
+  return n == 0 ? 0 : (UInt_t)( this->Uniform() * n );
+}
+
+UInt_t RawDataGenerator::Poisson( double mean )
+{
+  if( mean <= 0 )
+    return 0;
+
+  // Gaussian approximation for a large mean (Box-Muller)
+  if( mean > 30 ){
+    double u1 = 1.0 - this->Uniform(), u2 = this->Uniform();
+    double value = mean + sqrt( mean ) * sqrt( -2.0 * log( u1 ) ) * cos( 2.0 * M_PI * u2 );
+    return value > 0 ? (UInt_t)( value + 0.5 ) : 0;
+  }
+
+  // Knuth's method
+  double limit = exp( -mean ), product = this->Uniform();
+  UInt_t n = 0;
+  while( product > limit ){
+    product *= this->Uniform();
+    n++;
+  }
+  return n;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// hits
+/////////////////////////////////////////////////////////////////////////////////////////////
+RawDataGenerator::Hit RawDataGenerator::MakeRandomHit( int fpga )
+{
+  Hit hit;
+  hit.chan = this->Integer( 128 );
+  if( fphxrev_ < 0 ){
+    // FELIX: raw chip id 1-26 for a module and 27-52 for the other
+    hit.fpga = fpga;
+    hit.module = this->Integer( 2 );
+    hit.chip = 1 + this->Integer( std::min( chips_, 26 ) );
+  }
+  else if( fphxrev_ == 3 ){
+    // 2 FPGAs with 16 chips, see FphxFormat < 3 >
+    hit.fpga = this->Integer( 2 );
+    hit.module = 0;
+    hit.chip = 1 + this->Integer( 16 );
+  }
+  else if( fphxrev_ >= 6 ){
+    // 5 bits of the chip id
+    hit.fpga = this->Integer( 2 );
+    hit.module = 0;
+    hit.chip = 1 + this->Integer( std::min( chips_, 31 ) );
+  }
+  else{
+    // no chip id in the word
+    hit.fpga = hit.module = 0;
+    hit.chip = 1;
+  }
+
+  return hit;
+}
+
+UInt_t RawDataGenerator::MakeHitWord( const Hit& hit, int bco, int ampl, int adc )
+{
+  UInt_t chan = hit.chan & 0x7F;
+  UInt_t chip = hit.chip & 0x1F;
+  UInt_t fpga = hit.fpga & 0x1;
+  adc &= 0x7;
+
+  // the inverse of FelixDecoder::Decode and FphxFormat < REV >::Unpack
+  switch( fphxrev_ ){
+  case 0:
+    return ( ( bco & 0x3F ) << 24 ) | ( adc << 19 ) | ( chan << 11 ) | ( ( ampl & 0x3FF ) << 1 ) | 0x1;
+  case 3:
+  case 8:
+    return ( adc << 29 ) | ( ( bco & 0x3F ) << 23 ) | ( ( ampl & 0x3F ) << 17 ) | ( chan << 9 ) | ( fpga << 7 ) | ( chip << 2 );
+  case 4:
+    return ( adc << 25 ) | ( chan << 17 ) | ( ( bco & 0x3F ) << 11 ) | ( ( ampl & 0x3FF ) << 1 );
+  case 5:
+    return ( adc << 26 ) | ( chan << 18 ) | ( ( bco & 0x7F ) << 11 ) | ( ( ampl & 0x3FF ) << 1 );
+  case 6:
+  case 7:
+    // DDxB BBBB BAAA AAA1 CCCC CCBC FIII IID0
+    return ( ( adc & 0x3 ) << 30 ) | ( ( adc & 0x4 ) >> 1 )
+      | ( ( bco & 0x3F ) << 23 ) | ( ( bco & 0x40 ) << 3 )
+      | ( ( ampl & 0x3F ) << 17 ) | ( 1 << 16 )
+      | ( ( chan & 0x3F ) << 10 ) | ( ( chan & 0x40 ) << 2 )
+      | ( fpga << 7 ) | ( chip << 2 );
+  default:
+    // FELIX
+    UInt_t rawchip = hit.chip + 26 * hit.module;
+    return ( ( ampl & 0x7F ) << 24 ) | ( ( bco & 0x7F ) << 16 ) | ( chan << 9 ) | ( rawchip << 3 ) | adc;
+  }
+}
+
+void RawDataGenerator::AddEvent( int fpga, int bco_full )
+{
+  // FELIX: the FEM event counter and bco_full words come first
+  if( fphxrev_ < 0 ){
+    record_.push_back( ( ( event_fem_[fpga] & 0xFFFF ) << 16 ) | 1 );
+    record_.push_back( ( ( bco_full & 0xFFFF ) << 16 ) | 2 );
+    event_fem_[fpga]++;
+  }
+
+  int nfpgas = ( fphxrev_ < 0 || fphxrev_ == 3 || fphxrev_ >= 6 ) ? 2 : 1; // modules for FELIX
+  int nchips = fphxrev_ < 0 ? std::min( chips_, 26 ) : ( fphxrev_ == 3 ? 16 : ( fphxrev_ >= 6 ? std::min( chips_, 31 ) : 1 ) );
+  UInt_t nhits = this->Poisson( occupancy_ * nfpgas * nchips * 128 );
+
+  std::vector < Hit > hits;
+  for( UInt_t i=0; i<nhits; i++ )
+    hits.push_back( this->MakeRandomHit( fpga ) );
+
+  for( auto& noisy : noisy_ ){
+    if( ( fphxrev_ < 0 && noisy.fpga != fpga ) || this->Uniform() >= noisy_rate_ )
+      continue;
+
+    hits.push_back( noisy );
+    noisy_hits_++;
+  }
+
+  for( auto& hit : hits ){
+    // the hits come within a few BCOs from the trigger
+    int bco = bco_full + this->Integer( 3 );
+    int ampl = this->Integer( max_ampl_ + 1 );
+
+    // ADC follows the amplitude roughly
+    int adc = ampl * 8 / ( max_ampl_ + 1 ) + (int)this->Integer( 3 ) - 1;
+    adc = std::max( 0, std::min( 7, adc ) );
+
+    record_.push_back( this->MakeHitWord( hit, bco, ampl, adc ) );
+  }
+
+  hits_ += hits.size();
+  events_++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// records
+/////////////////////////////////////////////////////////////////////////////////////////////
+void RawDataGenerator::MakeConfigRecord()
+{
+  record_.assign( 2, 0 );
+  record_[1] = 100;
+  record_.push_back( run_ );
+
+  // a chip id, 8 enable masks, and 16 registers (shorts for FELIX, bytes for FPHX)
+  // FPHX: 26 words are used for a chip, see FphxRecordDecoder::Decode
+  size_t begin = record_.size();
+  record_.resize( begin + ( fphxrev_ < 0 ? 13 : 26 ), 0 );
+  unsigned short* p = (unsigned short*)&record_[begin];
+  p[0] = 1;
+  for( int m=1; m<9; m++ )
+    p[m] = 0xFFFF;
+
+  this->Close( record_, false );
+}
+
+void RawDataGenerator::MakeTimestampRecord()
+{
+  // the time in clock ticks and CLOCKS_PER_SEC
+  record_.assign( 2, 0 );
+  record_[1] = 101;
+  record_.push_back( (UInt_t)( data_records_ * 1000 ) );
+  record_.push_back( 1000000 );
+  this->Close( record_, false );
+}
+
+void RawDataGenerator::MakeDataRecord()
+{
+  record_.assign( 2, 0 );
+  record_[1] = 102;
+
+  int fem = -1;
+  int nfems = fem_ids_.size();
+  if( fphxrev_ < 0 ){
+    fem = data_records_ % nfems;
+    record_.push_back( ( fem_ids_[fem] & 0xF ) << 12 );
+  }
+  else if( fphxrev_ >= 3 && fphxrev_ <= 5 ){
+    // read_DAQ of those days lost the first word, see FphxFormat < 3 >
+    record_.push_back( 0 );
+  }
+
+  // the FEMs record the same triggers one after another
+  if( fem <= 0 ){
+    triggers_.resize( events_per_record_ );
+    for( auto& trigger : triggers_ ){
+      bco_full_ = ( bco_full_ + 1 + this->Integer( max_bco_gap_ ) ) & 0xFFFF;
+      trigger = bco_full_;
+    }
+  }
+
+  for( auto& trigger : triggers_ )
+    this->AddEvent( fem, trigger );
+
+  data_records_++;
+  this->Close( record_, true );
+}
+
+void RawDataGenerator::Close( std::vector < UInt_t >& record, bool is_data )
+{
+  // buflen doesn't count itself but the buffer id, so it's the size before the checksum
+  record[0] = record.size();
+
+  // XOR of all words including buflen and the buffer id for both layouts, as fphx_raw2root.C and FelixDecoder check it
+  UInt_t checksum = 0;
+  for( size_t i=0; i<record.size(); i++ )
+    checksum ^= record[i];
+  record.push_back( checksum );
+
+  // a bit of a data word or the checksum is flipped
+  if( is_data && corrupt_fraction_ > 0 && this->Uniform() < corrupt_fraction_ ){
+    size_t index = 2 + this->Integer( record.size() - 2 );
+    record[index] ^= 1u << this->Integer( 32 );
+    corrupt_records_++;
+  }
+
+  // CAMAC words follow the data records
+  if( fphxrev_ < 0 && camac_channels_ > 0 && is_data ){
+    int n = camac_channels_;
+    if( is_old_camac_format_ ){
+      record.push_back( 2 * n );
+      for( int i=0; i<n; i++ )
+	record.push_back( this->Integer( 2048 ) );
+      for( int i=0; i<n; i++ )
+	record.push_back( this->Integer( 4096 ) );
+    }
+    else{
+      record.push_back( n );
+      for( int i=0; i<n; i++ )
+	record.push_back( this->Integer( 2048 ) );
+      record.push_back( n );
+      for( int i=0; i<n; i++ )
+	record.push_back( this->Integer( 4096 ) );
+    }
+  }
+
+  buffer_.insert( buffer_.end(), record.begin(), record.end() );
+  records_++;
+}
+
+void RawDataGenerator::Flush()
+{
+  ofs_.write( (const char*)&buffer_[0], buffer_.size() * sizeof(UInt_t) );
+  bytes_ += buffer_.size() * sizeof(UInt_t);
+  buffer_.clear();
+}
+
+Long64_t RawDataGenerator::Generate( std::string fname, Long64_t bytes )
+{
+  if( fphxrev_ != -1 && fphxrev_ != 0 && ( fphxrev_ < 3 || 8 < fphxrev_ ) ){
+    std::cerr << "fphxrev " << fphxrev_ << " is not supported. -1 (FELIX), 0, and 3-8 are available." << std::endl;
+    return -1;
+  }
+
+  if( fphxrev_ < 0 && fem_ids_.size() == 0 ){
+    std::cerr << "No FEM is given" << std::endl;
+    return -1;
+  }
+
+  ofs_.open( fname.c_str(), std::ios::binary | std::ios::trunc );
+  if( ofs_.fail() ){
+    std::cerr << fname << " cannot be opened" << std::endl;
+    return -1;
+  }
+
+  // everything starts again from the seed
+  state_ = seed_;
+  bytes_ = records_ = data_records_ = events_ = hits_ = noisy_hits_ = corrupt_records_ = 0;
+  event_fem_.assign( fem_ids_.size(), 0 );
+  bco_full_ = 0;
+  buffer_.clear();
+
+  noisy_.clear();
+  for( int i=0; i<noisy_channels_; i++ )
+    noisy_.push_back( this->MakeRandomHit( fphxrev_ < 0 ? this->Integer( fem_ids_.size() ) : 0 ) );
+
+  this->MakeConfigRecord();
+  while( bytes_ + (Long64_t)( buffer_.size() * sizeof(UInt_t) ) < bytes ){
+    this->MakeDataRecord();
+    if( timestamp_interval_ > 0 && data_records_ % timestamp_interval_ == 0 )
+      this->MakeTimestampRecord();
+
+    // only here, so the records made by MakeDataRecord are still in the buffer for truncate_last_
+    if( buffer_.size() >= ( 1 << 20 ) )
+      this->Flush();
+  }
+
+  // half of a record is added, it's not counted in the statistics
+  if( truncate_last_ ){
+    Long64_t records = records_, data_records = data_records_, events = events_;
+    Long64_t hits = hits_, noisy_hits = noisy_hits_, corrupt_records = corrupt_records_;
+    this->MakeDataRecord();
+    // record_ is the whole record including the checksum and the CAMAC words, and it's at the end of the buffer
+    buffer_.resize( buffer_.size() - record_.size() + record_.size() / 2 );
+
+    records_ = records;
+    data_records_ = data_records;
+    events_ = events;
+    hits_ = hits;
+    noisy_hits_ = noisy_hits;
+    corrupt_records_ = corrupt_records;
+  }
+
+  this->Flush();
+  ofs_.close();
+  return bytes_;
+}
+
+void RawDataGenerator::Print( std::ostream& os )
+{
+  os << "Synthetic data (" << ( fphxrev_ < 0 ? std::string( "FELIX" ) : "fphxrev " + std::to_string( fphxrev_ ) ) << ", seed " << seed_ << ")" << std::endl;
+  os << "  bytes           : " << bytes_ << std::endl;
+  os << "  records         : " << records_ << " (data: " << data_records_ << ")" << std::endl;
+  os << "  events          : " << events_ << std::endl;
+  os << "  hits            : " << hits_ << " (noisy channels: " << noisy_hits_ << ")" << std::endl;
+  os << "  corrupt records : " << corrupt_records_ << std::endl;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*!
+  @class RawDataGenerator
+  @brief Synthetic .dat files are written for tests and benchmarks of the decoders without the detector
+  @details The records are the same as the DAQ writes:
+    record[0]             = buflen, the number of the following words except the checksum
+    record[1]             = buffer id, 100: configuration, 101: time stamp, 102: data
+    record[2..buflen-1]   = data words
+    record[buflen]        = checksum
+  The layout of the data words is selected by fphxrev_:
+    -1 (default) : FELIX words for MakeTree (FelixDecoder). A data record has the FEM_ID word, then the event_fem word, the bco_full word, and
+                   the hit words for each event. The CAMAC words follow the checksum of a data record if camac_channels_ > 0.
+    0, 3 - 8     : FPHX hit words of the revision for fphx_raw2root.C.
+  The checksum is XOR of buflen, the buffer id, and the data words in both layouts.
+                   For the revisions 3, 4, and 5, the first word of a data record is a dummy since read_DAQ of those days lost it.
+
+  Each event has hits of occupancy_ * (the number of channels) on average (Poisson) at random channels, and the noisy channels fire with
+  the probability noisy_rate_ in addition. corrupt_fraction_ of the data records have a flipped bit after the checksum is calculated.
+  If truncate_last_ is true, the last record is cut in the middle like a file which is still written.
+
+  The same seed gives the same file with the same build. The random numbers are made by SplitMix64 of this class, not by <random>,
+  but the Poisson numbers use exp, log, and cos of libm, so files made on different platforms can differ.
+  The file is written record by record through a buffer, so the size can be tens of GB.
+
+  How to use:
+    RawDataGenerator generator( 1234 ); // seed
+    generator.occupancy_ = 0.01;
+    generator.camac_channels_ = 4;
+    generator.Generate( "data/synthetic_felix.dat", 1000000000 ); // 1 GB
+    generator.Print();
+*/
+class RawDataGenerator
+{
+public:
+  RawDataGenerator( ULong64_t seed = 1 ){ this->SetSeed( seed ); };
+
+  //! The random numbers start again from the seed
+  void SetSeed( ULong64_t seed ){ seed_ = state_ = seed; };
+
+  // settings
+  int fphxrev_ = -1;                      //!< -1: FELIX layout, 0 and 3-8: the revision of FPHX hit words (see FphxUnpacker.hh)
+  std::vector < int > fem_ids_ = { 1, 2, 4, 8 }; //!< FEMs of the FELIX layout. A data record has events of one FEM, the FEMs take turns.
+  int chips_ = 26;                        //!< chips of a module, 2 modules for each FEM (FELIX) or FPGA (FPHX)
+  int events_per_record_ = 16;
+  double occupancy_ = 0.005;              //!< the mean fraction of the channels with a hit in an event
+  int noisy_channels_ = 0;                //!< the number of noisy channels, chosen randomly
+  double noisy_rate_ = 0.5;               //!< the probability that a noisy channel fires in an event
+  int max_bco_gap_ = 4;                   //!< bco_full increases by 1 to this value between events
+  int max_ampl_ = 63;                     //!< amplitude (calibration DAC) of the hits is from 0 to this value
+  int camac_channels_ = 0;                //!< the number of CAMAC ADC and TDC words after each data record (FELIX layout only)
+  bool is_old_camac_format_ = false;      //!< the total number of the CAMAC words is given at once as the data of Nov/2020
+  double corrupt_fraction_ = 0;           //!< the fraction of data records with a bad checksum
+  int timestamp_interval_ = 1000;         //!< a time stamp record is written every this number of data records, 0 for none
+  bool truncate_last_ = false;            //!< the last record is written partially
+  UInt_t run_ = 1;                        //!< run number in the configuration record
+
+  /*!
+    @brief A file of about bytes bytes is written (the configuration record, then data and time stamp records)
+    @retval the number of bytes written, -1 if the file cannot be opened or fphxrev_ is unknown
+  */
+  Long64_t Generate( std::string fname, Long64_t bytes );
+
+  void Print( std::ostream& os = std::cout );
+
+  // statistics of the last Generate
+  Long64_t bytes_ = 0;
+  Long64_t records_ = 0;      //!< all records
+  Long64_t data_records_ = 0;
+  Long64_t events_ = 0;
+  Long64_t hits_ = 0;         //!< hit words including the noisy channels (not including the dummy words of the FPHX revisions 3-5)
+  Long64_t noisy_hits_ = 0;
+  Long64_t corrupt_records_ = 0;
+
+private:
+  ULong64_t seed_;
+  ULong64_t state_;
+
+  // random numbers
+  ULong64_t Next();                       //!< SplitMix64
+  double Uniform();                       //!< [0, 1)
+  UInt_t Integer( UInt_t n );             //!< 0 to n-1
+  UInt_t Poisson( double mean );
+
+  struct Hit
+  {
+    int fpga;   //!< index of the FEM for the FELIX layout, FPGA for FPHX
+    int module; //!< 0 or 1 in the FEM (FPGA)
+    int chip;   //!< from 1
+    int chan;
+  };
+  std::vector < Hit > noisy_;
+
+  std::vector < UInt_t > record_;         //!< the record being made
+  std::vector < UInt_t > buffer_;         //!< records to be written
+  std::ofstream ofs_;
+
+  UInt_t MakeHitWord( const Hit& hit, int bco, int ampl, int adc );
+  Hit MakeRandomHit( int fpga );
+  void AddEvent( int fpga, int bco_full );
+  void MakeConfigRecord();
+  void MakeTimestampRecord();
+  void MakeDataRecord();
+  void Close( std::vector < UInt_t >& record, bool is_data ); //!< buflen, checksum, corruption, and CAMAC words are added, then it's buffered
+  void Flush();
+
+  // states of the FELIX layout
+  std::vector < int > event_fem_;  //!< FEM event counter of each FEM
+  std::vector < int > triggers_;   //!< bco_full of the events in the current data records
+  int bco_full_ = 0;
+};
+
+#ifndef RAW_DATA_GENERATOR_source
+#define RAW_DATA_GENERATOR_source
+
+#include "RawDataGenerator.cc"
+#endif //  RAW_DATA_GENERATOR_source
@@ -0,0 +1,43 @@
+#include "RawDataGenerator.hh"
+#include "RawRecordReader.hh"
+
+/*!
+  @fn int RawDataGenerator_test( string fname )
+  @brief Files with a truncated last record are made at sizes around the buffer of the generator (4 MB), and they are read back
+  @details The last record is made after the buffer is flushed at these sizes. All complete records have to be read,
+  and the last one has to be partial.
+  Usage: root -l -b -q 'functions/RawDataGenerator_test.cc+( "/tmp/RawDataGenerator_test.dat" )'
+  @retval The number of failed cases
+*/
+int RawDataGenerator_test( string fname = "RawDataGenerator_test.dat" )
+{
+  int failures = 0;
+  for( Long64_t bytes : { 1000LL, 4190713LL, 4194304LL, 4198400LL, 8388608LL } ){
+    for( int camac_channels : { 0, 4 } ){
+      RawDataGenerator generator( 1 );
+      generator.truncate_last_ = true;
+      generator.camac_channels_ = camac_channels;
+      Long64_t written = generator.Generate( fname, bytes );
+
+      RawRecordReader reader;
+      if( camac_channels > 0 )
+	reader.SetTrailerType( RawRecordReader::kCamacTrailer );
+
+      reader.Open( fname );
+      Long64_t records = 0;
+      while( reader.Next() )
+	records++;
+
+      bool is_ok = written >= bytes && records == generator.records_ && reader.IsPartial();
+      if( is_ok == false )
+	failures++;
+
+      cout << ( is_ok ? "OK  " : "FAIL" ) << " " << bytes << " bytes, " << camac_channels << " CAMAC channels: "
+	   << written << " bytes written, " << records << "/" << generator.records_ << " records read, "
+	   << ( reader.IsPartial() ? "" : "not " ) << "partial" << endl;
+    }
+  }
+
+  remove( fname.c_str() );
+  return failures;
+}
@@ -0,0 +1,100 @@
+#include "RawRecordIndex.hh"
+
+Long64_t BuildRawRecordIndex( std::string fname, int trailer_type, std::vector < RawRecordEntry >& index, Long64_t max_records )
+{
+  index.clear();
+
+  std::ifstream ifs( fname.c_str(), std::ifstream::binary );
+  if( !ifs.is_open() ){
+    std::cerr << "Failed to open input file " << fname << std::endl;
+    return 0;
+  }
+
+  ifs.seekg( 0, std::ifstream::end );
+  Long64_t size = (Long64_t)ifs.tellg();
+
+  // a word at the given byte offset is read, false is returned if it's beyond the end of file
+  auto read_word = [&]( Long64_t offset, UInt_t& word ) {
+    if( size < offset + (Long64_t)sizeof(UInt_t) )
+      return false;
+
+    ifs.clear();
+    ifs.seekg( offset, std::ifstream::beg );
+    ifs.read( (char*)&word, sizeof(UInt_t) );
+    return !ifs.fail();
+  };
+
+  Long64_t offset = 0;
+  while( max_records < 0 || (Long64_t)index.size() < max_records ){
+
+    UInt_t buflen = 0, bufid = 0;
+    if( read_word( offset, buflen ) == false || read_word( offset + sizeof(UInt_t), bufid ) == false )
+      break;
+
+    if( buflen == 0 ){
+      std::cerr << "Broken record (buflen = 0) at byte " << offset << " of " << fname << std::endl;
+      break;
+    }
+
+    Long64_t words = (Long64_t)buflen + 1;
+    // the CAMAC words follow only the data records
+    if( trailer_type != RawRecordReader::kNoTrailer && bufid == 102 ){
+
+      UInt_t num = 0;
+      if( read_word( offset + words * sizeof(UInt_t), num ) == false )
+	break;
+      words += 1 + num;
+
+      if( trailer_type == RawRecordReader::kCamacTrailer ){
+	if( read_word( offset + words * sizeof(UInt_t), num ) == false )
+	  break;
+	words += 1 + num;
+      }
+    }
+
+    // the last record may be written partially
+    if( size < offset + words * (Long64_t)sizeof(UInt_t) )
+      break;
+
+    RawRecordEntry entry;
+    entry.offset = offset;
+    entry.words = words;
+    entry.bufid = bufid;
+    index.push_back( entry );
+
+    offset += words * sizeof(UInt_t);
+  }
+
+  return offset;
+}
+
+std::vector < std::pair < size_t, size_t > > SplitRawRecordIndex( const std::vector < RawRecordEntry >& index, int nparts )
+{
+  std::vector < std::pair < size_t, size_t > > ranges;
+  if( nparts < 1 )
+    nparts = 1;
+
+  Long64_t total = 0;
+  for( const auto& entry : index )
+    total += entry.words;
+
+  size_t first = 0;
+  Long64_t sum = 0;
+  for( int part = 1; part <= nparts; part++ ){
+
+    // the boundary is put where the accumulated size reaches part/nparts of the total
+    Long64_t goal = total * part / nparts;
+    size_t last = first;
+    while( last < index.size() && ( sum < goal || part == nparts ) ){
+      sum += index[last].words;
+      last++;
+    }
+
+    if( last != first )
+      ranges.push_back( std::pair < size_t, size_t >( first, last ) );
+
+    first = last;
+  }
+
+  return ranges;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "RawRecordReader.hh"
+
+/*!
+  @struct RawRecordEntry
+  @brief Position of a record in a .dat file
+*/
+struct RawRecordEntry
+{
+  Long64_t offset;  //!< byte offset of the record head (buflen)
+  UInt_t words;     //!< number of words including buflen and CAMAC words
+  UInt_t bufid;     //!< buffer id, 100: configuration, 101: time stamp, 102: data
+};
+
+/*!
+  @fn Long64_t BuildRawRecordIndex( std::string fname, int trailer_type, std::vector < RawRecordEntry >& index, Long64_t max_records )
+  @brief Only the record headers (buflen and buffer id) in the file are read to make a list of the records.
+  @param trailer_type RawRecordReader::TrailerType of the data
+  @param max_records The scan stops at this number of records. -1 means all.
+  @retval The number of bytes covered by the complete records. A record which isn't written completely is not listed.
+  @details The data words are skipped by seeking, so it is much faster than decoding.
+           The list is used to give records to threads (see DecodeFelixInParallel) and to make the sidecar index.
+*/
+Long64_t BuildRawRecordIndex( std::string fname, int trailer_type, std::vector < RawRecordEntry >& index, Long64_t max_records = -1 );
+
+/*!
+  @fn std::vector < std::pair < size_t, size_t > > SplitRawRecordIndex( const std::vector < RawRecordEntry >& index, int nparts )
+  @brief The list of records is divided into nparts ranges with a similar size in bytes. [first, last) of the records are returned.
+*/
+std::vector < std::pair < size_t, size_t > > SplitRawRecordIndex( const std::vector < RawRecordEntry >& index, int nparts );
+
+#ifndef RAW_RECORD_INDEX_source
+#define RAW_RECORD_INDEX_source
+
+#include "RawRecordIndex.cc"
+#endif //  RAW_RECORD_INDEX_source
@@ -0,0 +1,159 @@
+#include "RawRecordReader.hh"
+
+RawRecordReader::RawRecordReader( size_t chunk_bytes )
+{
+  chunk_words_ = chunk_bytes / sizeof(UInt_t);
+  if( chunk_words_ < 1024 )
+    chunk_words_ = 1024;
+
+  buffer_.resize( chunk_words_ );
+}
+
+RawRecordReader::~RawRecordReader()
+{
+  this->Close();
+}
+
+bool RawRecordReader::Open( std::string fname )
+{
+  this->Close();
+
+  fname_ = fname;
+  ifs_.open( fname_.c_str(), std::ifstream::binary );
+  if( !ifs_.is_open() ){
+    std::cerr << "Failed to open input file " << fname_ << std::endl;
+    return false;
+  }
+
+  return this->Seek( 0 );
+}
+
+void RawRecordReader::Close()
+{
+  if( ifs_.is_open() )
+    ifs_.close();
+}
+
+bool RawRecordReader::Seek( Long64_t offset )
+{
+  if( !ifs_.is_open() || offset < 0 )
+    return false;
+
+  head_ = filled_ = 0;
+  buffer_offset_ = offset;
+  record_offset_ = offset;
+  record_words_ = 0;
+  is_partial_ = is_broken_ = false;
+  return true;
+}
+
+Long64_t RawRecordReader::GetFileSize()
+{
+  if( !ifs_.is_open() )
+    return 0;
+
+  // the file may be still written by the DAQ, so the size is taken every time
+  ifs_.clear();
+  ifs_.seekg( 0, std::ifstream::end );
+  Long64_t size = (Long64_t)ifs_.tellg();
+  return size < 0 ? 0 : size;
+}
+
+/*!
+  @brief It's made sure that the given number of words from the current record are in the buffer.
+  @retval false if the file doesn't have enough words
+*/
+bool RawRecordReader::Load( size_t words )
+{
+  if( head_ + words <= filled_ )
+    return true;
+
+  // words before the current record are not needed anymore, move the rest to the front of the buffer
+  if( head_ != 0 ){
+    std::copy( buffer_.begin() + head_, buffer_.begin() + filled_, buffer_.begin() );
+    filled_ -= head_;
+    buffer_offset_ += (Long64_t)head_ * sizeof(UInt_t);
+    head_ = 0;
+  }
+
+  // a record can be longer than the chunk
+  if( buffer_.size() < words )
+    buffer_.resize( words );
+
+  // eof bit should be cleared to read a file which is still growing
+  ifs_.clear();
+  ifs_.seekg( buffer_offset_ + (Long64_t)filled_ * sizeof(UInt_t), std::ifstream::beg );
+  ifs_.read( (char*)&buffer_[filled_], (buffer_.size() - filled_) * sizeof(UInt_t) );
+
+  // a fraction of a word at the end of file is read again next time
+  filled_ += ifs_.gcount() / sizeof(UInt_t);
+
+  return head_ + words <= filled_;
+}
+
+bool RawRecordReader::Next()
+{
+  if( !ifs_.is_open() || is_broken_ )
+    return false;
+
+  // go to the next record
+  head_ += record_words_;
+  record_offset_ += (Long64_t)record_words_ * sizeof(UInt_t);
+  record_words_ = 0;
+  is_partial_ = false;
+
+  if( this->Load( 1 ) == false ){
+    is_partial_ = ( this->GetFileSize() > record_offset_ );
+    return false;
+  }
+
+  UInt_t buflen = buffer_[head_];
+  if( buflen == 0 || max_record_words_ < buflen ){
+    std::cerr << "Broken record (buflen = " << buflen << ") at byte " << record_offset_ << " of " << fname_ << std::endl;
+    is_broken_ = true;
+    return false;
+  }
+
+  size_t words = (size_t)buflen + 1;
+  // the CAMAC words follow only the data records, as MakeTree read them
+  if( trailer_type_ != kNoTrailer && this->Load( 2 ) == false ){
+    is_partial_ = true;
+    return false;
+  }
+
+  if( trailer_type_ != kNoTrailer && buffer_[head_+1] == 102 ){
+
+    // the first number of CAMAC words
+    if( this->Load( words + 1 ) == false ){
+      is_partial_ = true;
+      return false;
+    }
+    words += 1 + buffer_[head_ + words];
+
+    // the number of TDC words
+    if( trailer_type_ == kCamacTrailer ){
+      if( this->Load( words + 1 ) == false ){
+	is_partial_ = true;
+	return false;
+      }
+      words += 1 + buffer_[head_ + words];
+    }
+
+    if( max_record_words_ < words ){
+      std::cerr << "Broken CAMAC words at byte " << record_offset_ << " of " << fname_ << std::endl;
+      is_broken_ = true;
+      return false;
+    }
+  }
+
+  // Safety belt against a partially-written buffer (it will have the full length field, but the whole buffer hasn't been written yet).
+  // It can happen if we are reading a file that is actively being written.
+  if( this->Load( words ) == false ){
+    is_partial_ = true;
+    return false;
+  }
+
+  record_words_ = words;
+  record_count_++;
+  return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*!
+  @class RawRecordReader
+  @brief Records in a .dat file are read one by one using a buffer with a fixed size.
+  @details A record in the .dat file is
+    record[0]           = buflen, a number of words in this record not including record[0]
+    record[1]           = buffer id (100: configuration, 101: time stamp, 102: data)
+    record[2..buflen-1] = data words
+    record[buflen]      = checksum
+  In the data taking with the CAMAC DAQ, CAMAC words follow each data record (buffer id 102, see TrailerType).
+  They are treated as a part of the record. The configuration and time stamp records have no CAMAC words.
+
+  Only the current record (and some records after it) are in the memory, so a file larger than the memory can be processed.
+  Offsets are given in bytes as Long64_t, files larger than 2 GB are OK.
+  The chunked read is used rather than mmap to keep it working on Windows as well.
+
+  How to use:
+    RawRecordReader reader;
+    reader.Open( "data.dat" );
+    while( reader.Next() ){
+      const UInt_t* data = reader.GetRecord(); // data[0] is buflen
+      ...
+    }
+*/
+class RawRecordReader
+{
+public:
+  //! Layout of the words after a record
+  enum TrailerType {
+    kNoTrailer = 0,     //!< nothing, for the calib and external modes
+    kCamacTrailer,      //!< #ADC, ADC..., #TDC, TDC..., for the camac modes
+    kCamacTrailerOld    //!< #(ADC+TDC), ADC..., TDC..., for data taken in Nov/2020
+  };
+
+  RawRecordReader( size_t chunk_bytes = 16 * 1024 * 1024 );
+  ~RawRecordReader();
+
+  bool Open( std::string fname );
+  void Close();
+
+  //! The next complete record is loaded. false is returned at the end of file, for a partially written record, or for a broken record.
+  bool Next();
+
+  //! The reader is moved to the given byte offset, which has to be the head of a record.
+  bool Seek( Long64_t offset );
+
+  const UInt_t* GetRecord(){ return &buffer_[head_]; };
+  UInt_t GetRecordWords(){ return record_words_; };
+  UInt_t GetBufLen(){ return buffer_[head_]; };
+  UInt_t GetBufId(){ return buffer_[head_+1]; };
+
+  Long64_t GetRecordOffset(){ return record_offset_; }; //!< byte offset of the current record
+  Long64_t GetOffset(){ return record_offset_ + (Long64_t)record_words_ * sizeof(UInt_t); }; //!< byte offset of the next record
+  Long64_t GetFileSize();
+  Long64_t GetRecordCount(){ return record_count_; };
+
+  bool IsPartial(){ return is_partial_; };  //!< true if the last record is not written completely yet
+  bool IsBroken(){ return is_broken_; };    //!< true if a record with an unphysical length was found
+
+  void SetTrailerType( TrailerType type ){ trailer_type_ = type; };
+  void SetMaxRecordWords( UInt_t words ){ max_record_words_ = words; };
+
+private:
+  std::ifstream ifs_;
+  std::string fname_ = "";
+
+  std::vector < UInt_t > buffer_;
+  size_t chunk_words_ = 0;
+  size_t head_ = 0;           //!< index of the current record in buffer_
+  size_t filled_ = 0;         //!< number of valid words in buffer_
+  Long64_t buffer_offset_ = 0; //!< byte offset of buffer_[0] in the file
+
+  Long64_t record_offset_ = 0;
+  UInt_t record_words_ = 0;
+  Long64_t record_count_ = 0;
+
+  TrailerType trailer_type_ = kNoTrailer;
+  UInt_t max_record_words_ = 64 * 1024 * 1024; //!< a record longer than it is treated as broken
+
+  bool is_partial_ = false;
+  bool is_broken_ = false;
+
+  bool Load( size_t words );
+};
+
+#ifndef RAW_RECORD_READER_source
+#define RAW_RECORD_READER_source
+
+#include "RawRecordReader.cc"
+#endif //  RAW_RECORD_READER_source
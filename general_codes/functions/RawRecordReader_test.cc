@@ -0,0 +1,101 @@
+#include "RawRecordReader.hh"
+#include "RawRecordIndex.hh"
+#include "RawDataGenerator.hh"
+
+//! A record is added to the words. The checksum isn't checked by the reader, so it's 0.
+void RawRecordReader_test_AddRecord( vector < UInt_t >& words, UInt_t bufid, int ndata )
+{
+  words.push_back( ndata + 2 ); // buflen, the words after it
+  words.push_back( bufid );
+  for( int i=0; i<ndata; i++ )
+    words.push_back( i );
+  words.push_back( 0 );         // checksum
+}
+
+/*!
+  @fn int RawRecordReader_test( string fname )
+  @brief Records of the camac modes are read by RawRecordReader and BuildRawRecordIndex
+  @details The CAMAC words follow only the data records (buffer id 102).
+  A file with a configuration record, data records, and a time stamp record is read in the camac mode,
+  and the records have to be found at the same offsets as they're written.
+  Then a file of RawDataGenerator with CAMAC words and time stamps is read as well.
+  Usage: root -l -b -q 'functions/RawRecordReader_test.cc+( "/tmp/RawRecordReader_test.dat" )'
+  @retval The number of failed cases
+*/
+int RawRecordReader_test( string fname = "RawRecordReader_test.dat" )
+{
+  int failures = 0;
+  for( auto type : { RawRecordReader::kCamacTrailer, RawRecordReader::kCamacTrailerOld } ){
+    vector < UInt_t > words;
+    vector < Long64_t > offsets;
+    vector < UInt_t > bufids = { 100, 102, 101, 102, 102 };
+    for( auto bufid : bufids ){
+      offsets.push_back( words.size() * sizeof(UInt_t) );
+      RawRecordReader_test_AddRecord( words, bufid, bufid == 100 ? 14 : 5 );
+      if( bufid != 102 )
+	continue;
+
+      // 3 ADC and 3 TDC words
+      if( type == RawRecordReader::kCamacTrailer ){
+	words.insert( words.end(), { 3, 100, 101, 102 } );
+	words.insert( words.end(), { 3, 200, 201, 202 } );
+      }
+      else{
+	words.insert( words.end(), { 6, 100, 101, 102, 200, 201, 202 } );
+      }
+    }
+
+    ofstream ofs( fname.c_str(), ios::binary | ios::trunc );
+    ofs.write( (const char*)&words[0], words.size() * sizeof(UInt_t) );
+    ofs.close();
+
+    RawRecordReader reader;
+    reader.SetTrailerType( type );
+    reader.Open( fname );
+    size_t read = 0;
+    bool is_ok = true;
+    while( reader.Next() ){
+      if( read >= bufids.size() || reader.GetRecordOffset() != offsets[read] || reader.GetBufId() != bufids[read] )
+	is_ok = false;
+
+      read++;
+    }
+
+    vector < RawRecordEntry > index;
+    Long64_t end = BuildRawRecordIndex( fname, type, index );
+    is_ok = is_ok && read == bufids.size() && reader.IsPartial() == false && reader.IsBroken() == false;
+    is_ok = is_ok && index.size() == bufids.size() && end == (Long64_t)( words.size() * sizeof(UInt_t) );
+    for( size_t i=0; i<index.size() && i<offsets.size(); i++ )
+      if( index[i].offset != offsets[i] || index[i].bufid != bufids[i] )
+	is_ok = false;
+
+    if( is_ok == false )
+      failures++;
+
+    cout << ( is_ok ? "OK  " : "FAIL" ) << " " << ( type == RawRecordReader::kCamacTrailer ? "camac" : "camac (old format)" )
+	 << " with config and time stamp records: " << read << "/" << bufids.size() << " records read, "
+	 << index.size() << " in the index" << endl;
+  }
+
+  // time stamps every 10 data records
+  RawDataGenerator generator( 1 );
+  generator.camac_channels_ = 4;
+  generator.timestamp_interval_ = 10;
+  generator.Generate( fname, 1000000 );
+
+  RawRecordReader reader;
+  reader.SetTrailerType( RawRecordReader::kCamacTrailer );
+  reader.Open( fname );
+  Long64_t records = 0;
+  while( reader.Next() )
+    records++;
+
+  bool is_ok = records == generator.records_ && reader.IsPartial() == false && reader.IsBroken() == false;
+  if( is_ok == false )
+    failures++;
+
+  cout << ( is_ok ? "OK  " : "FAIL" ) << " RawDataGenerator with CAMAC words: " << records << "/" << generator.records_ << " records read" << endl;
+
+  remove( fname.c_str() );
+  return failures;
+}
@@ -0,0 +1,314 @@
+#include <TH1.h>
+#include <TF1.h>
+
+#include "SCurveFitter.hh"
+
+SCurveFitter::SCurveFitter()
+{
+  this->ClearLimits();
+}
+
+void SCurveFitter::SetLimits( int par, double min, double max )
+{
+  if( par < 0 || kNPars <= par )
+    return;
+
+  min_[par] = min;
+  max_[par] = max;
+}
+
+void SCurveFitter::ClearLimits()
+{
+  for( int i=0; i<kNPars; i++ ){
+    min_[i] = 0;
+    max_[i] = 0;
+  }
+}
+
+double SCurveFitter::Clamp( int par, double value ) const
+{
+  if( this->IsLimited( par ) == false )
+    return value;
+
+  return value < min_[par] ? min_[par] : ( max_[par] < value ? max_[par] : value );
+}
+
+double SCurveFitter::Crossing( const double* x, const double* y, int n, double level ) const
+{
+  for( int i=0; i<n; i++ ){
+    if( y[i] < level )
+      continue;
+
+    if( i == 0 || y[i] == y[i-1] )
+      return x[i];
+
+    return x[i-1] + ( level - y[i-1] ) / ( y[i] - y[i-1] ) * ( x[i] - x[i-1] );
+  }
+
+  return x[n-1];
+}
+
+bool SCurveFitter::Seed( const double* x, const double* y, int n, double* par ) const
+{
+  double maximum = 0;
+  for( int i=0; i<n; i++ )
+    if( maximum < y[i] )
+      maximum = y[i];
+
+  if( n == 0 || maximum <= 0 )
+    return false;
+
+  // the width if the edge is in a bin
+  double min_width = n < 2 ? 0.5 : 0.5 * ( x[1] - x[0] );
+
+  // the maximum is higher than the plateau because of the fluctuation,
+  // so the height is the mean of the bins well above the turn on given by the maximum
+  double height = maximum;
+  for( int step=0; step<2; step++ ){
+    double turn_on = this->Crossing( x, y, n, 0.5 * height );
+    double width = 0.5 * ( this->Crossing( x, y, n, 0.84 * height ) - this->Crossing( x, y, n, 0.16 * height ) );
+    par[kTurnOn] = turn_on;
+    par[kWidth] = width < min_width ? min_width : width;
+    par[kHeight] = height;
+    if( step == 1 )
+      break;
+
+    double sum = 0;
+    int num = 0;
+    for( int i=0; i<n; i++ ){
+      if( x[i] < turn_on + 2 * par[kWidth] )
+	continue;
+
+      sum += y[i];
+      num++;
+    }
+
+    if( num == 0 || sum <= 0 )
+      break;
+
+    height = sum / num;
+  }
+
+  // kErf: the curve goes through the offset at the turn on, and the plateau is offset + height
+  if( model_ == kErf ){
+    if( 0 < offset_ && offset_ < par[kHeight] )
+      par[kTurnOn] = this->Crossing( x, y, n, offset_ );
+
+    par[kHeight] = par[kHeight] > offset_ ? par[kHeight] - offset_ : 0.5 * par[kHeight];
+  }
+
+  for( int i=0; i<kNPars; i++ )
+    par[i] = this->Clamp( i, par[i] );
+
+  return true;
+}
+
+double SCurveFitter::Chi2( const double* x, const double* y, const double* weight, int n, const double* par,
+			   double alpha[kNPars][kNPars], double beta[kNPars] ) const
+{
+  if( alpha != nullptr ){
+    for( int j=0; j<kNPars; j++ ){
+      beta[j] = 0;
+      for( int k=0; k<kNPars; k++ )
+	alpha[j][k] = 0;
+    }
+  }
+
+  // 1 / sqrt(2 pi)
+  const double inv_sqrt_2pi = 0.5 * M_2_SQRTPI / M_SQRT2;
+  double chi2 = 0;
+  for( int i=0; i<n; i++ ){
+    if( weight[i] <= 0 )
+      continue;
+
+    double z = ( x[i] - par[kTurnOn] ) / par[kWidth];
+    double step = 0.5 * ( 1.0 + std::erf( z / M_SQRT2 ) );
+
+    // kErf is offset + height * ( 2 * step - 1 )
+    double scale = model_ == kErf ? 2.0 : 1.0;
+    double shape = model_ == kErf ? 2.0 * step - 1.0 : step;
+    double residual = y[i] - ( model_ == kErf ? offset_ : 0.0 ) - par[kHeight] * shape;
+    chi2 += weight[i] * residual * residual;
+    if( alpha == nullptr )
+      continue;
+
+    // d/d turn_on, d/d width, and d/d height of the S-curve
+    double gaus = scale * par[kHeight] * inv_sqrt_2pi * std::exp( -0.5 * z * z ) / par[kWidth];
+    double derivative[kNPars] = { -gaus, -gaus * z, shape };
+    for( int j=0; j<kNPars; j++ ){
+      beta[j] += weight[i] * residual * derivative[j];
+      for( int k=0; k<=j; k++ )
+	alpha[j][k] += weight[i] * derivative[j] * derivative[k];
+    }
+  }
+
+  if( alpha != nullptr )
+    for( int j=0; j<kNPars; j++ )
+      for( int k=j+1; k<kNPars; k++ )
+	alpha[j][k] = alpha[k][j];
+
+  return chi2;
+}
+
+// The inverse of the 3x3 matrix by the cofactors. false is returned if it's singular.
+static bool SCurveFitter_Invert( const double m[3][3], double inverse[3][3] )
+{
+  double c[3][3];
+  c[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  c[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  c[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  double det = m[0][0] * c[0][0] + m[0][1] * c[0][1] + m[0][2] * c[0][2];
+  if( det == 0 || std::isfinite( det ) == false )
+    return false;
+
+  c[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+  c[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+  c[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+  c[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+  c[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+  c[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  for( int j=0; j<3; j++ )
+    for( int k=0; k<3; k++ )
+      inverse[j][k] = c[k][j] / det;
+
+  return true;
+}
+
+SCurveResult SCurveFitter::Fit( const double* x, const double* y, const double* ey, int n, const double* seed )
+{
+  SCurveResult result;
+  if( (int)weight_.size() < n )
+    weight_.resize( n );
+
+  // empty bins are skipped as TH1::Fit does
+  int used = 0;
+  for( int i=0; i<n; i++ ){
+    double error = ey == nullptr ? std::sqrt( y[i] > 0 ? y[i] : 0 ) : ey[i];
+    weight_[i] = error > 0 ? 1.0 / ( error * error ) : 0;
+    if( weight_[i] > 0 )
+      used++;
+  }
+
+  double par[kNPars];
+  if( seed != nullptr ){
+    for( int i=0; i<kNPars; i++ )
+      par[i] = this->Clamp( i, seed[i] );
+  }
+  else if( this->Seed( x, y, n, par ) == false ){
+    return result;
+  }
+
+  for( int i=0; i<kNPars; i++ )
+    result.seed[i] = result.par[i] = par[i];
+
+  if( used == 0 )
+    return result;
+
+  result.is_empty = false;
+  result.ndf = used - kNPars;
+
+  // Levenberg-Marquardt, the diagonal of J^T W J is scaled by 1 + lambda
+  double alpha[kNPars][kNPars], beta[kNPars];
+  double chi2 = this->Chi2( x, y, weight_.data(), n, par, alpha, beta );
+  double lambda = 1e-3;
+  int iteration = 0;
+  for( ; iteration<max_iterations_ && result.ndf >= 0; iteration++ ){
+    double scaled[kNPars][kNPars], inverse[kNPars][kNPars];
+    for( int j=0; j<kNPars; j++ )
+      for( int k=0; k<kNPars; k++ )
+	scaled[j][k] = alpha[j][k] * ( j == k ? 1 + lambda : 1 );
+
+    if( SCurveFitter_Invert( scaled, inverse ) == false ){
+      lambda *= 10;
+      if( lambda > 1e10 )
+	break;
+
+      continue;
+    }
+
+    double trial[kNPars];
+    for( int j=0; j<kNPars; j++ ){
+      double step = 0;
+      for( int k=0; k<kNPars; k++ )
+	step += inverse[j][k] * beta[k];
+
+      trial[j] = this->Clamp( j, par[j] + step );
+    }
+
+    // the width has to stay positive even without the limits, and it's not halved at once,
+    // otherwise the edge can fall between two bin centers where the derivatives are 0
+    if( trial[kWidth] < 0.5 * par[kWidth] )
+      trial[kWidth] = this->Clamp( kWidth, 0.5 * par[kWidth] );
+
+    double trial_chi2 = this->Chi2( x, y, weight_.data(), n, trial );
+    if( std::isfinite( trial_chi2 ) == false || chi2 < trial_chi2 ){
+      lambda *= 10;
+      if( lambda > 1e10 ){
+	// no step makes the chi2 smaller, it's at the minimum
+	result.is_converged = true;
+	break;
+      }
+
+      continue;
+    }
+
+    double change = chi2 - trial_chi2;
+    for( int j=0; j<kNPars; j++ )
+      par[j] = trial[j];
+
+    chi2 = this->Chi2( x, y, weight_.data(), n, par, alpha, beta );
+    lambda = lambda * 0.1 < 1e-7 ? 1e-7 : lambda * 0.1;
+    // chi2 + 1 for the steps of perfect curves, where the chi2 goes to 0 as the width goes to 0
+    if( change <= tolerance_ * ( chi2 + 1 ) ){
+      result.is_converged = true;
+      iteration++;
+      break;
+    }
+  }
+
+  double covariance[kNPars][kNPars];
+  bool is_invertible = SCurveFitter_Invert( alpha, covariance );
+  for( int j=0; j<kNPars; j++ ){
+    result.par[j] = par[j];
+    result.err[j] = is_invertible && covariance[j][j] > 0 ? std::sqrt( covariance[j][j] ) : 0;
+  }
+
+  result.chi2 = chi2;
+  result.iterations = iteration;
+  return result;
+}
+
+SCurveResult SCurveFitter::Fit( const TH1* hist, const double* seed )
+{
+  int n = hist->GetNbinsX();
+  x_.resize( n );
+  y_.resize( n );
+  ey_.resize( n );
+  for( int i=0; i<n; i++ ){
+    x_[i] = hist->GetBinCenter( i + 1 );
+    y_[i] = hist->GetBinContent( i + 1 );
+    ey_[i] = hist->GetBinError( i + 1 );
+  }
+
+  return this->Fit( x_.data(), y_.data(), ey_.data(), n, seed );
+}
+
+std::vector < SCurveResult > SCurveFitter::FitAll( const double* x, const double* counts, const double* errors, int nbins, int nchannels )
+{
+  std::vector < SCurveResult > results( nchannels );
+  for( int i=0; i<nchannels; i++ )
+    results[i] = this->Fit( x, counts + (size_t)i * nbins, errors == nullptr ? nullptr : errors + (size_t)i * nbins, nbins );
+
+  return results;
+}
+
+void SCurveFitter::SetResult( TF1* function, const SCurveResult& result )
+{
+  for( int i=0; i<kNPars; i++ ){
+    function->SetParameter( i, result.par[i] );
+    function->SetParError( i, result.err[i] );
+  }
+
+  function->SetChisquare( result.chi2 );
+  function->SetNDF( result.ndf );
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+class TH1;
+class TF1;
+
+/*!
+  @struct SCurveResult
+  @brief Parameters, errors, and the quality of a fit of SCurveFitter
+*/
+struct SCurveResult
+{
+  double par[3] = { 0, 0, 0 };   //!< turn_on, width, height (the same order as the TF1 of GetFormula)
+  double err[3] = { 0, 0, 0 };
+  double seed[3] = { 0, 0, 0 };  //!< the initial values
+  double chi2 = 0;
+  int ndf = 0;
+  int iterations = 0;
+  bool is_converged = false;
+  bool is_empty = true;          //!< no bins with counts, nothing is fitted
+
+  double GetTurnOn() const { return par[0]; };
+  double GetWidth() const { return par[1]; };
+  double GetHeight() const { return par[2]; };
+};
+
+/*!
+  @class SCurveFitter
+  @brief A fitter only for the S-curve height * 0.5 * ( 1 + erf( ( x - turn_on ) / width / sqrt(2) ) ) of the threshold scan
+  @details The S-curves of all channels were fitted by TF1 with an interpreted formula and Minuit starting from the same values.
+  It took most of the time of the calibration, and the fit sometimes went to a wrong minimum when the turn on was far from the start.
+  Here the initial values are taken from the curve: the height from the plateau,
+  the turn on from the 50% crossing, and the width from the 16% and 84% crossings ( (x84 - x16) / 2 for a gaussian edge ).
+  Then the chi2 is minimized by Levenberg-Marquardt with the analytic derivatives of the 3 parameters.
+  All arrays are on the stack or in buffers of the fitter, and nothing is allocated for each fit.
+
+  The old macros (morita/calib/erf3.C) fitted "[0]*TMath::Erf((x-[1])/[2])+10", which goes from 10 - [0] to 10 + [0].
+  It's fitted with SetModel( kErf, 10 ): height * erf( ( x - turn_on ) / width / sqrt(2) ) + offset with the fixed offset,
+  where height is [0], turn_on is [1], and width * sqrt(2) is [2] of the old formula.
+
+  The chi2 is the same as the one of TH1::Fit: bins with zero error (empty bins) are skipped,
+  the errors of the bins are used, and the function is evaluated at the bin center.
+  Limits of the parameters are kept by clamping the step, like SetParLimits.
+  The errors are from the covariance matrix at the minimum. They can be different from Minuit's ones when a parameter is at its limit.
+
+  A fitter has buffers, so it should be used by one thread. See SCurveFitter_benchmark.cc for the time and the comparison with TF1.
+
+  How to use:
+    SCurveFitter fitter;
+    fitter.SetLimits( SCurveFitter::kHeight, 9.9, 12 );
+    SCurveResult result = fitter.Fit( hist );
+    fitter.SetResult( tf1, result ); // tf1 = new TF1( "ef", SCurveFitter::GetFormula().c_str(), 0, 70 ) to draw it
+
+    // all channels at once, counts[ channel * nbins + bin ]
+    vector < SCurveResult > results = fitter.FitAll( x, counts, nullptr, nbins, nchannels );
+*/
+class SCurveFitter
+{
+public:
+  enum Parameter { kTurnOn = 0, kWidth, kHeight, kNPars };
+  enum Model { kSCurve = 0, kErf };
+
+  SCurveFitter();
+
+  //! The parameter is kept in [min, max]. Use min >= max to remove the limits.
+  void SetLimits( int par, double min, double max );
+  void ClearLimits();
+
+  //! The fit stops when the chi2 changes less than tolerance * ( chi2 + 1 ) or after max_iterations
+  void SetMaxIterations( int max_iterations ){ max_iterations_ = max_iterations; };
+  void SetTolerance( double tolerance ){ tolerance_ = tolerance; };
+
+  /*!
+    @brief The curve to be fitted
+    @param model kSCurve (default): height * 0.5 * ( 1 + erf( ( x - turn_on ) / width / sqrt(2) ) ), from 0 to height.
+    kErf: height * erf( ( x - turn_on ) / width / sqrt(2) ) + offset, from offset - height to offset + height.
+    @param offset The fixed offset of kErf
+  */
+  void SetModel( int model, double offset = 0 ){ model_ = model; offset_ = offset; };
+
+  //! The S-curve at x
+  static double Eval( double x, const double* par )
+  {
+    return par[kHeight] * 0.5 * ( 1.0 + std::erf( ( x - par[kTurnOn] ) / par[kWidth] / M_SQRT2 ) );
+  };
+
+  //! The formula of TF1 with the same parameters
+  static std::string GetFormula( int model = kSCurve, double offset = 0 )
+  {
+    if( model == kErf )
+      return "[2] * TMath::Erf((x - [0]) / [1] / TMath::Sqrt2()) + " + std::to_string( offset );
+
+    return "[2] * 0.5* (1.0 + TMath::Erf((x - [0]) / [1] / TMath::Sqrt2()))";
+  };
+
+  /*!
+    @brief The initial values from the curve
+    @param x The bin centers (ascending)
+    @param y The contents
+    @param n The number of bins
+    @param par The turn on, width, and height are set. They are in the limits.
+    @retval false if there are no counts
+  */
+  bool Seed( const double* x, const double* y, int n, double* par ) const;
+
+  /*!
+    @brief The S-curve is fitted
+    @param ey The errors of y. sqrt(y) is used if it's nullptr.
+    @param seed The initial values. They are taken by Seed if it's nullptr.
+  */
+  SCurveResult Fit( const double* x, const double* y, const double* ey, int n, const double* seed = nullptr );
+
+  //! The histogram is fitted in the same way as TH1::Fit. Under and overflow bins are not used.
+  SCurveResult Fit( const TH1* hist, const double* seed = nullptr );
+
+  /*!
+    @brief The S-curves of all channels are fitted
+    @param x The bin centers shared by the channels
+    @param counts The contents of nchannels x nbins, counts[ channel * nbins + bin ]
+    @param errors The errors in the same order, or nullptr for sqrt(counts)
+    @retval The results in the order of the channels
+  */
+  std::vector < SCurveResult > FitAll( const double* x, const double* counts, const double* errors, int nbins, int nchannels );
+
+  //! The parameters, errors, chi2, and NDF are set to the TF1 made with GetFormula
+  static void SetResult( TF1* function, const SCurveResult& result );
+
+private:
+  double min_[kNPars];
+  double max_[kNPars];
+  int max_iterations_ = 100;
+  double tolerance_ = 1e-6;
+  int model_ = kSCurve;
+  double offset_ = 0;
+
+  // buffers of Fit( TH1* ) and the weights 1 / error^2 of the bins
+  std::vector < double > x_;
+  std::vector < double > y_;
+  std::vector < double > ey_;
+  std::vector < double > weight_;
+
+  bool IsLimited( int par ) const { return min_[par] < max_[par]; };
+  double Clamp( int par, double value ) const;
+
+  //! The chi2 and, if alpha and beta are given, J^T W J and J^T W r
+  double Chi2( const double* x, const double* y, const double* weight, int n, const double* par,
+	       double alpha[kNPars][kNPars] = nullptr, double beta[kNPars] = nullptr ) const;
+
+  //! x of the first crossing of the level, interpolated between the bins
+  double Crossing( const double* x, const double* y, int n, double level ) const;
+};
+
+#ifndef SCURVE_FITTER_source
+#define SCURVE_FITTER_source
+
+#include "SCurveFitter.cc"
+#endif //  SCURVE_FITTER_source
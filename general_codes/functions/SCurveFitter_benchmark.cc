@@ -0,0 +1,129 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <TH1D.h>
+#include <TF1.h>
+#include "SCurveFitter.hh"
+
+using std::string;
+
+/*!
+  @fn int SCurveFitter_benchmark( int nchannels, int npulses, string option )
+  @brief Random S-curves are fitted by TF1 and by SCurveFitter, and the time and the differences of the parameters are shown.
+  @param nchannels The number of S-curves (26 chips x 128 channels = 3328 for a ladder)
+  @param npulses The number of test pulses at each amplitude, it's the height of the S-curves
+  @param option The option of TH1::Fit for TF1
+  @details Usage: root -l -b -q 'functions/SCurveFitter_benchmark.cc+O( 3328 )'
+  The S-curves have turn on 20-50, width 0.5-4.5, and 70 bins in [0, 70] as the ampl histograms of the calibration.
+  TF1 starts from turn on 30, width 2, and the height as the calibration did.
+  The differences are divided by the errors of TF1. They should be much less than 1 for the fits converged to the same minimum.
+*/
+int SCurveFitter_benchmark( int nchannels = 3328, int npulses = 10, string option = "NQ" )
+{
+  TH1::AddDirectory( false );
+
+  const int nbins = 70;
+  std::vector < double > x( nbins ), counts( (size_t)nchannels * nbins );
+  for( int i=0; i<nbins; i++ )
+    x[i] = i + 0.5;
+
+  // the same curves for both
+  std::mt19937 engine( 20200217 );
+  std::uniform_real_distribution < double > uniform( 0, 1 );
+  for( int ch=0; ch<nchannels; ch++ ){
+    double turn_on = 20 + 30 * uniform( engine );
+    double width = 0.5 + 4 * uniform( engine );
+    for( int i=0; i<nbins; i++ ){
+      std::binomial_distribution < int > binomial( npulses, 0.5 * ( 1 + std::erf( ( x[i] - turn_on ) / width / M_SQRT2 ) ) );
+      counts[ (size_t)ch * nbins + i ] = binomial( engine );
+    }
+  }
+
+  TH1D* hist = new TH1D( "scurve", "S-curve", nbins, 0, nbins );
+  TF1* function = new TF1( "scurve_tf1", SCurveFitter::GetFormula().c_str(), 0, nbins );
+  std::vector < SCurveResult > results_tf1( nchannels );
+
+  auto start = std::chrono::steady_clock::now();
+  for( int ch=0; ch<nchannels; ch++ ){
+    hist->Reset();
+    for( int i=0; i<nbins; i++ ){
+      hist->SetBinContent( i + 1, counts[ (size_t)ch * nbins + i ] );
+      hist->SetBinError( i + 1, std::sqrt( counts[ (size_t)ch * nbins + i ] ) );
+    }
+
+    function->SetParameters( 30, 2, npulses );
+    hist->Fit( function, option.c_str() );
+    for( int j=0; j<SCurveFitter::kNPars; j++ ){
+      results_tf1[ch].par[j] = function->GetParameter( j );
+      results_tf1[ch].err[j] = function->GetParError( j );
+    }
+
+    results_tf1[ch].chi2 = function->GetChisquare();
+    results_tf1[ch].ndf = function->GetNDF();
+  }
+  double seconds_tf1 = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+
+  SCurveFitter fitter;
+  start = std::chrono::steady_clock::now();
+  std::vector < SCurveResult > results = fitter.FitAll( x.data(), counts.data(), nullptr, nbins, nchannels );
+  double seconds_fitter = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+
+  // differences in the errors of TF1, and the channels where one of them has a smaller chi2
+  std::string names[SCurveFitter::kNPars] = { "turn_on", "width", "height" };
+  double mean_difference[SCurveFitter::kNPars] = { 0, 0, 0 }, max_difference[SCurveFitter::kNPars] = { 0, 0, 0 };
+  int compared = 0, better_tf1 = 0, better_fitter = 0;
+  for( int ch=0; ch<nchannels; ch++ ){
+    if( results[ch].is_empty )
+      continue;
+
+    double chi2_tolerance = 1e-3 * ( results_tf1[ch].chi2 + 1 );
+    if( results_tf1[ch].chi2 < results[ch].chi2 - chi2_tolerance )
+      better_tf1++;
+    else if( results[ch].chi2 < results_tf1[ch].chi2 - chi2_tolerance )
+      better_fitter++;
+
+    bool is_compared = true;
+    for( int j=0; j<SCurveFitter::kNPars; j++ )
+      if( results_tf1[ch].err[j] <= 0 )
+	is_compared = false;
+
+    if( is_compared == false )
+      continue;
+
+    compared++;
+    for( int j=0; j<SCurveFitter::kNPars; j++ ){
+      double difference = std::fabs( results[ch].par[j] - results_tf1[ch].par[j] ) / results_tf1[ch].err[j];
+      mean_difference[j] += difference;
+      if( max_difference[j] < difference )
+	max_difference[j] = difference;
+    }
+  }
+
+  std::cout << std::setw(16) << "method"
+	    << std::setw(12) << "seconds"
+	    << std::setw(16) << "us/channel" << std::endl;
+  std::cout << std::setw(16) << "TF1"
+	    << std::setw(12) << std::fixed << std::setprecision(3) << seconds_tf1
+	    << std::setw(16) << std::setprecision(1) << seconds_tf1 / nchannels * 1e6 << std::endl;
+  std::cout << std::setw(16) << "SCurveFitter"
+	    << std::setw(12) << std::setprecision(3) << seconds_fitter
+	    << std::setw(16) << std::setprecision(1) << seconds_fitter / nchannels * 1e6 << std::endl;
+  std::cout << "  x" << std::setprecision(1) << seconds_tf1 / seconds_fitter << " faster" << std::endl;
+
+  std::cout << std::setw(16) << "parameter"
+	    << std::setw(16) << "mean |diff|/err"
+	    << std::setw(16) << "max |diff|/err" << std::endl;
+  for( int j=0; j<SCurveFitter::kNPars; j++ )
+    std::cout << std::setw(16) << names[j]
+	      << std::setw(16) << std::setprecision(4) << ( compared == 0 ? 0 : mean_difference[j] / compared )
+	      << std::setw(16) << max_difference[j] << std::endl;
+
+  std::cout << "  " << compared << " channels compared, smaller chi2 by TF1 in " << better_tf1
+	    << " channels and by SCurveFitter in " << better_fitter << " channels" << std::endl;
+
+  delete hist;
+  delete function;
+  return 0;
+}
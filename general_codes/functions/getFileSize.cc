@@ -1,7 +1,7 @@
 #include "getFileSize.hh"
 
 // returns the size of file
-int getFileSize(std::ifstream& f) {
+Long64_t getFileSize(std::ifstream& f) {
   f.seekg(0, std::ifstream::end);
 
   if (f.fail()) {
@@ -13,7 +13,7 @@ int getFileSize(std::ifstream& f) {
     return 0;
   }
 
-  int size = f.tellg();
+  Long64_t size = f.tellg();
   if (size < 0) {
     std::ifstream::iostate state = f.rdstate();
     std::cout << "error in tellg, read state = " << state << std::endl;
@@ -1,5 +1,5 @@
 #pragma once
-int getFileSize(std::ifstream& f);
+Long64_t getFileSize(std::ifstream& f);
 
 
 // it's necessary for macro if you want to include only header files.
@@ -0,0 +1,52 @@
+/*!
+  @file generate_raw_data.cc
+  @brief A synthetic .dat file is written for tests and benchmarks of MakeTree (check_chip_prototypeMaximum7.c) and fphx_raw2root.C
+  @details See functions/RawDataGenerator.hh for the details. The same arguments and seed give the same file on the same platform.
+  Usage:
+    root -l -b -q 'generate_raw_data.cc+O( "data/synthetic_felix.dat", 1e9 )'              // 1 GB of FELIX data
+    root -l -b -q 'generate_raw_data.cc+O( "data/synthetic_fphx8.dat", 1e8, 8 )'           // 100 MB of fphxrev 8
+    root -l -b -q 'generate_raw_data.cc+O( "data/synthetic_camac.dat", 1e8, -1, 0.005, 10, 4, 0.01 )' // with noisy channels, CAMAC words, and corrupt records
+*/
+
+#include "functions/RawDataGenerator.hh"
+
+/*!
+  @fn int generate_raw_data
+  @param fname A name of the output file
+  @param bytes The size of the file in bytes (about)
+  @param fphxrev -1 for the FELIX layout (MakeTree), 0 and 3-8 for the revisions of FPHX hit words (fphx_raw2root)
+  @param occupancy The mean fraction of the channels with a hit in an event
+  @param noisy_channels The number of noisy channels which fire in half of the events
+  @param camac_channels The number of CAMAC ADC and TDC words after each record, for the modes "camac" and "camac_clustering" of MakeTree
+  @param corrupt_fraction The fraction of data records with a flipped bit
+  @param seed Seed of the random numbers
+  @param truncate If true, the last record is written partially
+*/
+int generate_raw_data
+(
+ string fname = "data/synthetic_felix.dat",
+ double bytes = 1e8,
+ int fphxrev = -1,
+ double occupancy = 0.005,
+ int noisy_channels = 0,
+ int camac_channels = 0,
+ double corrupt_fraction = 0,
+ ULong64_t seed = 1,
+ bool truncate = false
+ )
+{
+  RawDataGenerator generator( seed );
+  generator.fphxrev_ = fphxrev;
+  generator.occupancy_ = occupancy;
+  generator.noisy_channels_ = noisy_channels;
+  generator.camac_channels_ = camac_channels;
+  generator.corrupt_fraction_ = corrupt_fraction;
+  generator.truncate_last_ = truncate;
+
+  if( generator.Generate( fname, (Long64_t)bytes ) < 0 )
+    return -1;
+
+  generator.Print();
+  cout << "output: " << fname << endl;
+  return 0;
+}
@@ -1,7 +1,7 @@
 #include "DrawPlots.hh"
 
 
-TH2D* GetHitmap( TTree* tree, string cut_base )
+TH2D* GetHitmap( TTree* tree, string cut_base, TH2D* hitmap_filled = nullptr )
 {
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -26,7 +26,10 @@ TH2D* GetHitmap( TTree* tree, string cut_base )
   //                       Schematic figure of what will be drawn                                 //
   //////////////////////////////////////////////////////////////////////////////////////////////////
 
-  TH2D* hitmap = new TH2D("hitmap", "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257);
+  // the hit map filled by StatusHistograms is used if it's given
+  TH2D* hitmap = hitmap_filled;
+  if( hitmap == nullptr )
+    hitmap = new TH2D("hitmap", "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257);
 
   // Super long expression to draw a hit map in one execution:
   //   int(chip_id / 14) * 256+ pow(-1, int(chip_id / 14)) * chan_id: -chip_id+ (1 + int(chip_id / 14)) * 13"
@@ -52,7 +55,8 @@ TH2D* GetHitmap( TTree* tree, string cut_base )
     + "+ (1 + int(chip_id / 14)) * 13"               // In addition to above, offset is needed. 
     + ">> hitmap";
 	
-  tree->Draw(expression.c_str(), cut_base.c_str(), "goff");
+  if( hitmap_filled == nullptr )
+    tree->Draw(expression.c_str(), cut_base.c_str(), "goff");
   //hitmap->Draw("colz");
   
   hitmap->GetXaxis()->SetNdivisions(15);
@@ -97,15 +101,19 @@ TH2D* GetHitmap( TTree* tree, string cut_base )
   return hitmap;
 }
 
-vector < TH1D* > GetAdcChps( TTree* tree, string cut_base )
+vector < TH1D* > GetAdcChps( TTree* tree, string cut_base, TH2D* hist_adc_chip = nullptr )
 {
 
   int chip_order[26] = { 26,25,24,23,22,21,20,19,18,17,16,15,14,
 			 13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
 
-  TH2D* hist_adc_chip = new TH2D("adc_chip", "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26);
-  string expression_adc_chip = string("chip_id:adc>>") + hist_adc_chip->GetName();
-  tree->Draw(expression_adc_chip.c_str(), cut_base.c_str(), "goff");
+  // the histogram filled by StatusHistograms is used if it's given
+  if( hist_adc_chip == nullptr )
+    {
+      hist_adc_chip = new TH2D("adc_chip", "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26);
+      string expression_adc_chip = string("chip_id:adc>>") + hist_adc_chip->GetName();
+      tree->Draw(expression_adc_chip.c_str(), cut_base.c_str(), "goff");
+    }
 
   vector < int > bin_contents_adc;
   vector < TH1D* > hists;
@@ -145,18 +153,22 @@ vector < TH1D* > GetAdcChps( TTree* tree, string cut_base )
 
 }
 
-vector < TH1D* > GetChChps( TTree* tree, string cut_base, int module )
+vector < TH1D* > GetChChps( TTree* tree, string cut_base, int module, TH2D* hist_ch_chip = nullptr )
 {
 
   int chip_order[26] = { 26,25,24,23,22,21,20,19,18,17,16,15,14,
 			 13,12,11,10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
 
-  string hist_name = string("ch_chip_mod") + to_string( module );
-  TH2D* hist_ch_chip = new TH2D( hist_name.c_str(), "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26);
+  // the histogram filled by StatusHistograms is used if it's given
+  if( hist_ch_chip == nullptr )
+    {
+      string hist_name = string("ch_chip_mod") + to_string( module );
+      hist_ch_chip = new TH2D( hist_name.c_str(), "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26);
 
-  //string expression_ch_chip = string("chip_id:chan_id>>") + hist_ch_chip->GetName();
-  string expression_ch_chip = string("chip_id:chan_id * (chip_id<14) + (127-chan_id) * (chip_id>=14)>>") + hist_ch_chip->GetName();
-  tree->Draw(expression_ch_chip.c_str(), cut_base.c_str(), "goff");
+      //string expression_ch_chip = string("chip_id:chan_id>>") + hist_ch_chip->GetName();
+      string expression_ch_chip = string("chip_id:chan_id * (chip_id<14) + (127-chan_id) * (chip_id>=14)>>") + hist_ch_chip->GetName();
+      tree->Draw(expression_ch_chip.c_str(), cut_base.c_str(), "goff");
+    }
 
   vector < int > bin_contents_ch;
   vector < TH1D* > hists;
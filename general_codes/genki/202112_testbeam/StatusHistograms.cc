@@ -0,0 +1,315 @@
+#include "StatusHistograms.hh"
+
+void StatusModuleHists::Book( int module_id, string suffix )
+{
+  module = module_id;
+  string tag = "_mod" + to_string( module ) + suffix;
+
+  adc_chip = new TH2D( ( "adc_chip" + tag ).c_str(), "ADC vs Chip;Adc;Chip", 8, 0, 8, 26, 0, 26 );
+  ch_chip = new TH2D( ( "ch_chip" + tag ).c_str(), "Channel vs Chip;Channel;Chip", 130, 0, 130, 26, 0, 26 );
+  hitmap = new TH2D( ( "hitmap" + tag ).c_str(), "Hit map; chip_id; chan_id", 13, 0, 13, 257, 0, 257 );
+
+  // they aren't owned by the file of a thread
+  adc_chip->SetDirectory( nullptr );
+  ch_chip->SetDirectory( nullptr );
+  hitmap->SetDirectory( nullptr );
+}
+
+void StatusModuleHists::Add( const StatusModuleHists& another )
+{
+  adc_chip->Add( another.adc_chip );
+  ch_chip->Add( another.ch_chip );
+  hitmap->Add( another.hitmap );
+}
+
+void StatusModuleHists::Delete()
+{
+  delete adc_chip;
+  delete ch_chip;
+  delete hitmap;
+  adc_chip = ch_chip = hitmap = nullptr;
+}
+
+void StatusVariableHists::Book( string expression_arg, int bin, double xmin, double xmax, Long64_t entries, string suffix )
+{
+  expression = expression_arg;
+
+  // the same names as DrawVariables, e.g. "Length$(adc)" -> "hist_Length_adc"
+  string name = "";
+  for( auto& letter : expression )
+    {
+      if( letter == '(' )
+	name += '_';
+      else if( letter != '$' && letter != ')' )
+	name += letter;
+    }
+
+  int entry_bin = entries < StatusHistograms::kEntryBin ? ( entries > 0 ? entries : 1 ) : StatusHistograms::kEntryBin;
+  hist = new TH1D( ( "hist_" + name + suffix ).c_str(), ( "hist_" + name ).c_str(), bin, xmin, xmax );
+  hist_vs_entry = new TH2D( ( "hist2d_" + name + suffix ).c_str(), ( "hist2d_" + name ).c_str(),
+			    entry_bin, 0, entries, bin, xmin, xmax );
+
+  hist->SetDirectory( nullptr );
+  hist_vs_entry->SetDirectory( nullptr );
+}
+
+void StatusVariableHists::Add( const StatusVariableHists& another )
+{
+  hist->Add( another.hist );
+  hist_vs_entry->Add( another.hist_vs_entry );
+}
+
+void StatusVariableHists::Delete()
+{
+  delete hist;
+  delete hist_vs_entry;
+  hist = nullptr;
+  hist_vs_entry = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// StatusHistograms
+/////////////////////////////////////////////////////////////////////////////////////////////
+StatusHistograms::StatusHistograms( vector < int > modules, vector < string > variables )
+{
+  for( int i=0; i<16; i++ )
+    index_of_module_[i] = -1;
+
+  for( auto& module : modules )
+    {
+      if( module < 0 || 16 <= module )
+	{
+	  cerr << "StatusHistograms: module " << module << " is out of range, skipped" << endl;
+	  continue;
+	}
+
+      index_of_module_[module] = modules_.size();
+      modules_.push_back( module );
+    }
+
+  variables_ = variables;
+  ranges_ = vector < Range >( variables_.size() );
+}
+
+StatusHistograms::~StatusHistograms()
+{
+  for( auto& hists : module_hists_ )
+    hists.Delete();
+
+  for( auto& hists : variable_hists_ )
+    hists.Delete();
+}
+
+void StatusHistograms::SetRange( string variable, int bin, double xmin, double xmax )
+{
+  for( int i=0; i<variables_.size(); i++ )
+    {
+      if( variables_[i] != variable )
+	continue;
+
+      ranges_[i].bin = bin;
+      ranges_[i].xmin = xmin;
+      ranges_[i].xmax = xmax;
+    }
+}
+
+StatusModuleHists* StatusHistograms::GetModuleHists( int module )
+{
+  if( module < 0 || 16 <= module || index_of_module_[module] < 0 || module_hists_.size() == 0 )
+    return nullptr;
+
+  return &module_hists_[ index_of_module_[module] ];
+}
+
+StatusVariableHists* StatusHistograms::GetVariableHists( string variable )
+{
+  for( auto& hists : variable_hists_ )
+    if( hists.expression == variable )
+      return &hists;
+
+  return nullptr;
+}
+
+void StatusHistograms::Book( vector < StatusModuleHists >& module_hists, vector < StatusVariableHists >& variable_hists, string suffix )
+{
+  module_hists = vector < StatusModuleHists >( modules_.size() );
+  for( int i=0; i<modules_.size(); i++ )
+    module_hists[i].Book( modules_[i], suffix );
+
+  variable_hists = vector < StatusVariableHists >( variables_.size() );
+  for( int i=0; i<variables_.size(); i++ )
+    variable_hists[i].Book( variables_[i], ranges_[i].bin, ranges_[i].xmin, ranges_[i].xmax, entries_, suffix );
+}
+
+bool StatusHistograms::FillRange( string data, string cut_arg, Long64_t first, Long64_t last,
+				  vector < StatusModuleHists >& module_hists, vector < StatusVariableHists >& variable_hists )
+{
+  TFile* tf = new TFile( data.c_str(), "READ" );
+  TTree* tr = (TTree*)tf->Get( "tree_both" );
+  if( tr == nullptr )
+    {
+      tf->Close();
+      delete tf;
+      return false;
+    }
+
+  vector < int > *adc = nullptr, *ampl = nullptr, *chip_id = nullptr, *module = nullptr, *chan_id = nullptr;
+  tr->SetBranchAddress( "adc"		, &adc       );
+  tr->SetBranchAddress( "ampl"		, &ampl      );
+  tr->SetBranchAddress( "chip_id"	, &chip_id   );
+  tr->SetBranchAddress( "module"	, &module    );
+  tr->SetBranchAddress( "chan_id"	, &chan_id   );
+
+  // all branches are read by GetEntry, and the formulas use the values already read
+  TTreeFormula* cut = cut_arg == "" ? nullptr : new TTreeFormula( "status_cut", cut_arg.c_str(), tr );
+  vector < TTreeFormula* > formulas;
+  for( int i=0; i<variables_.size(); i++ )
+    formulas.push_back( new TTreeFormula( Form( "status_variable%d", i ), variables_[i].c_str(), tr ) );
+
+  const HitMapLookup& hitmap_lookup = HitMapLookup::Get( HitMapLookup::kChipDescending );
+  vector < bool > passed; // results of the cut for each instance
+  for( Long64_t entry=first; entry<last; entry++ )
+    {
+      tr->GetEntry( entry );
+      tr->LoadTree( entry );
+
+      // the cut for each hit, or for the event if it doesn't have vector branches
+      bool is_cut_array = cut != nullptr && cut->GetMultiplicity() != 0;
+      int cut_num = cut == nullptr ? 1 : cut->GetNdata();
+      passed.assign( cut_num, true );
+      if( cut != nullptr )
+	for( int i=0; i<cut_num; i++ )
+	  passed[i] = cut->EvalInstance( i ) != 0;
+
+      // the cut of DrawStatus
+      for( int i=0; i<module->size(); i++ )
+	{
+	  int mod = module->at( i ), chip = chip_id->at( i ), chan = chan_id->at( i );
+	  if( mod < 0 || 16 <= mod || index_of_module_[mod] < 0 )
+	    continue;
+
+	  if( chip <= 0 || 27 <= chip || chan <= -1 || 129 <= chan || ampl->at( i ) != 0 )
+	    continue;
+
+	  if( ( is_cut_array && ( cut_num <= i || passed[i] == false ) ) || ( is_cut_array == false && passed[0] == false ) )
+	    continue;
+
+	  StatusModuleHists& hists = module_hists[ index_of_module_[mod] ];
+	  hists.adc_chip->Fill( adc->at( i ), chip );
+	  hists.ch_chip->Fill( chip < 14 ? chan : 127 - chan, chip );
+	  hitmap_lookup.Fill( hists.hitmap, chip, chan );
+	}
+
+      // the variables, instances are taken as TTree::Draw does
+      for( int j=0; j<formulas.size(); j++ )
+	{
+	  bool is_variable_array = formulas[j]->GetMultiplicity() != 0;
+	  int variable_num = formulas[j]->GetNdata();
+	  int instance_num = 1;
+	  if( is_cut_array && is_variable_array )
+	    instance_num = min( cut_num, variable_num );
+	  else if( is_cut_array )
+	    instance_num = cut_num;
+	  else if( is_variable_array )
+	    instance_num = variable_num;
+
+	  for( int i=0; i<instance_num; i++ )
+	    {
+	      if( passed[ is_cut_array ? i : 0 ] == false )
+		continue;
+
+	      double value = formulas[j]->EvalInstance( is_variable_array ? i : 0 );
+	      variable_hists[j].hist->Fill( value );
+	      variable_hists[j].hist_vs_entry->Fill( entry, value );
+	    }
+	}
+    }
+
+  delete cut;
+  for( auto& formula : formulas )
+    delete formula;
+
+  tr->ResetBranchAddresses();
+  tf->Close();
+  delete tf;
+  return true;
+}
+
+bool StatusHistograms::Fill( string data, string cut_arg, int nthreads )
+{
+  auto start = std::chrono::steady_clock::now();
+
+  TFile* tf = new TFile( data.c_str(), "READ" );
+  TTree* tr = (TTree*)tf->Get( "tree_both" );
+  if( tr == nullptr )
+    {
+      cerr << "StatusHistograms::Fill: tree_both is not found in " << data << endl;
+      tf->Close();
+      delete tf;
+      return false;
+    }
+
+  entries_ = tr->GetEntries();
+  tf->Close();
+  delete tf;
+
+  if( nthreads < 1 )
+    nthreads = 1;
+
+  for( auto& hists : module_hists_ )
+    hists.Delete();
+
+  for( auto& hists : variable_hists_ )
+    hists.Delete();
+
+  // the x-axis of the variable vs entry histograms depends on the number of entries
+  this->Book( module_hists_, variable_hists_, "" );
+
+  // each range is filled to its own histograms, and they are added in the order of the ranges at the end
+  vector < vector < StatusModuleHists > > thread_module_hists( nthreads );
+  vector < vector < StatusVariableHists > > thread_variable_hists( nthreads );
+  for( int part=1; part<nthreads; part++ )
+    this->Book( thread_module_hists[part], thread_variable_hists[part], "_thread" + to_string( part ) );
+
+  bool is_ok = true;
+  if( nthreads == 1 )
+    {
+      is_ok = this->FillRange( data, cut_arg, 0, entries_, module_hists_, variable_hists_ );
+    }
+  else
+    {
+      ROOT::EnableThreadSafety();
+      JobScheduler scheduler( nthreads );
+      for( int part=0; part<nthreads; part++ )
+	{
+	  Long64_t first = entries_ * part / nthreads;
+	  Long64_t last = entries_ * ( part + 1 ) / nthreads;
+	  string name = "status " + data + " [" + to_string( first ) + ", " + to_string( last ) + ")";
+	  scheduler.Submit( name, [&, part, first, last]() {
+	    return this->FillRange( data, cut_arg, first, last,
+				    part == 0 ? module_hists_ : thread_module_hists[part],
+				    part == 0 ? variable_hists_ : thread_variable_hists[part] );
+	  });
+	}
+
+      is_ok = scheduler.WaitAll();
+    }
+
+  for( int part=1; part<nthreads; part++ )
+    {
+      for( int i=0; i<module_hists_.size(); i++ )
+	{
+	  module_hists_[i].Add( thread_module_hists[part][i] );
+	  thread_module_hists[part][i].Delete();
+	}
+
+      for( int i=0; i<variable_hists_.size(); i++ )
+	{
+	  variable_hists_[i].Add( thread_variable_hists[part][i] );
+	  thread_variable_hists[part][i].Delete();
+	}
+    }
+
+  seconds_ = std::chrono::duration < double >( std::chrono::steady_clock::now() - start ).count();
+  return is_ok;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../../functions/JobScheduler.hh"
+#include "../../functions/HitMapLookup.hh"
+
+/*!
+  @struct StatusModuleHists
+  @brief Histograms of a module for DrawStatus. The binning is the same as GetAdcChps, GetChChps, and GetHitmap in DrawPlots.cc.
+*/
+struct StatusModuleHists
+{
+  int module = -1;
+  TH2D* adc_chip = nullptr; //!< chip_id : adc
+  TH2D* ch_chip = nullptr;  //!< chip_id : chan_id (127 - chan_id for chips 14-26)
+  TH2D* hitmap = nullptr;   //!< the hit map, see GetHitmap and HitMapLookup::kChipDescending
+
+  //! The histograms are made without the directory. suffix is added to the names.
+  void Book( int module_id, string suffix = "" );
+  void Add( const StatusModuleHists& another );
+  void Delete();
+};
+
+/*!
+  @struct StatusVariableHists
+  @brief Histograms of a variable for DrawVariables. The binning of the value is given by GetRange in show_status.cc.
+*/
+struct StatusVariableHists
+{
+  string expression = "";          //!< a branch name or an expression like "camac_adc[1]" or "Length$(adc)"
+  TH1D* hist = nullptr;            //!< the distribution
+  TH2D* hist_vs_entry = nullptr;   //!< the value as a function of the entry
+
+  void Book( string expression_arg, int bin, double xmin, double xmax, Long64_t entries, string suffix = "" );
+  void Add( const StatusVariableHists& another );
+  void Delete();
+};
+
+/*!
+  @class StatusHistograms
+  @brief All histograms of show_status are filled in one loop over tree_both
+  @details DrawStatus called TTree::Draw 3 times for each module, and DrawVariables called it twice for each variable.
+  All vector branches of tree_both were read again for each call, so it took hours for all runs of the beam test.
+  Here the entries are read once. The hits are filled to the histograms of their module with the cut of DrawStatus
+  (0 < chip_id < 27, -1 < chan_id < 129, ampl == 0), and the variables are evaluated by TTreeFormula and filled.
+  The cut given to show_status is also evaluated by TTreeFormula once for each entry and used by both.
+
+  A value of a variable is filled for each hit passing the cut, as TTree::Draw does.
+  For example, camac_adc[1] is filled as many times as the number of hits passing the cut in the event.
+
+  With nthreads > 1, the entries are divided into nthreads ranges filled by JobScheduler.
+  Each job opens the file by itself, and the histograms of the jobs are added at the end.
+
+  How to use:
+    StatusHistograms status( { 1, 2, 3 }, { "adc", "chan_id", "camac_adc[1]", "Length$(adc)" } );
+    status.SetRange( "Length$(adc)", 500, 0, 500 ); // 10 bins in [0, 10] are used otherwise
+    status.Fill( "data/ELPH/NWU_fphx_raw_20211128-0947_0.root", "chip_id != 14", 4 );
+    status.GetModuleHists( 1 )->hitmap->Draw( "colz" );
+    status.GetVariableHists( "adc" )->hist->Draw();
+*/
+class StatusHistograms
+{
+public:
+  StatusHistograms( vector < int > modules, vector < string > variables );
+  ~StatusHistograms();
+
+  //! The binning of the variable
+  void SetRange( string variable, int bin, double xmin, double xmax );
+
+  /*!
+    @brief tree_both in the file is read once and all histograms are filled
+    @param data The ROOT file
+    @param cut_arg A cut in the TTree::Draw syntax, "" for nothing
+    @param nthreads The number of ranges of entries filled in parallel
+    @retval false if the file or the tree cannot be read
+  */
+  bool Fill( string data, string cut_arg = "", int nthreads = 1 );
+
+  //! nullptr if the module or the variable isn't given to the constructor
+  StatusModuleHists* GetModuleHists( int module );
+  StatusVariableHists* GetVariableHists( string variable );
+
+  //! Bins of the entry axis of the variable vs entry histograms
+  static const int kEntryBin = 50;
+
+  Long64_t GetEntries(){ return entries_; };
+  double GetTime(){ return seconds_; };
+
+private:
+  struct Range
+  {
+    int bin = 10;
+    double xmin = 0;
+    double xmax = 10;
+  };
+
+  vector < int > modules_;
+  vector < string > variables_;
+  vector < Range > ranges_;
+  int index_of_module_[16];
+
+  vector < StatusModuleHists > module_hists_;
+  vector < StatusVariableHists > variable_hists_;
+
+  Long64_t entries_ = 0;
+  double seconds_ = 0;
+
+  void Book( vector < StatusModuleHists >& module_hists, vector < StatusVariableHists >& variable_hists, string suffix );
+
+  //! Entries in [first, last) are filled. false is returned in the case of an error.
+  bool FillRange( string data, string cut_arg, Long64_t first, Long64_t last,
+		  vector < StatusModuleHists >& module_hists, vector < StatusVariableHists >& variable_hists );
+};
+
+#ifdef __CINT__
+#include "StatusHistograms.cc"
+#endif // __CINT__
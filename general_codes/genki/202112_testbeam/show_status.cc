@@ -10,6 +10,7 @@
 
 #include "DrawPlots.hh"
 #include "Database.hh"
+#include "StatusHistograms.hh"
 
 pair < int, int > GetRange( string target )
 {
@@ -67,7 +68,8 @@ void DrawParameter( TTree* tr, string target, int module, string cut_base, int b
 */
 }
 
-void DrawStatus( TCanvas* c, TTree* tr, int module, int module_num, int total_module_num, string cut_arg )
+// The histograms filled by StatusHistograms are drawn if hists is given, otherwise they are filled by TTree::Draw
+void DrawStatus( TCanvas* c, TTree* tr, int module, int module_num, int total_module_num, string cut_arg, StatusModuleHists* hists = nullptr )
 {
 
   stringstream cut_base;
@@ -83,7 +85,7 @@ void DrawStatus( TCanvas* c, TTree* tr, int module, int module_num, int total_mo
   // adc
   TVirtualPad* pad_adc = c->cd( 1 );
   pad_adc->Divide(13, 2, 0, 0 );
-  auto hists_adc = GetAdcChps( tr, cut_base.str() );
+  auto hists_adc = GetAdcChps( tr, cut_base.str(), hists == nullptr ? nullptr : hists->adc_chip );
 
   vector < double > adc_max;
   for( auto& hist : hists_adc )
@@ -104,7 +106,7 @@ void DrawStatus( TCanvas* c, TTree* tr, int module, int module_num, int total_mo
   // CH
   TVirtualPad* pad_ch = c->cd( 2 );
   pad_ch->Divide(13, 2, 0, 0 );
-  auto hists_ch = GetChChps( tr, cut_base.str(), module );
+  auto hists_ch = GetChChps( tr, cut_base.str(), module, hists == nullptr ? nullptr : hists->ch_chip );
 
   vector < double > ch_max;
   for( auto& hist : hists_ch )
@@ -134,19 +136,16 @@ void DrawStatus( TCanvas* c, TTree* tr, int module, int module_num, int total_mo
   // hit map
   c->cd( 3 );
   gPad->SetGrid( true, true );
-  auto hitmap = GetHitmap( tr, cut_base.str() );
+  auto hitmap = GetHitmap( tr, cut_base.str(), hists == nullptr ? nullptr : hists->hitmap );
   hitmap->Draw( "colz" );
   //  DrawStats( hitmap, 0.0, 0.0, 0.08, 0.3 );
 
   
 }
 
-void DrawVariables( TCanvas* c, TTree* tr, string cut_arg )
+// Branches and expressions drawn by DrawVariables
+vector < string > GetStatusVariables( TTree* tr )
 {
-  c->Clear();
-  gStyle->SetOptStat( 11111 );
-  c->Divide( 2, 1 );
-  c->cd(1);
   auto branch_list = tr->GetListOfBranches();
 
   vector < string > branch_names;
@@ -174,13 +173,40 @@ void DrawVariables( TCanvas* c, TTree* tr, string cut_arg )
   branch_names.push_back( "camac_tdc[4]" );
   //branch_names.push_back( "camac_tdc[5]" );
   branch_names.push_back( "Length$(adc)" );
-  
+
+  return branch_names;
+}
+
+// The histograms filled by StatusHistograms are drawn if status is given, otherwise they are filled by TTree::Draw
+void DrawVariables( TCanvas* c, TTree* tr, string cut_arg, StatusHistograms* status = nullptr )
+{
+  c->Clear();
+  gStyle->SetOptStat( 11111 );
+  c->Divide( 2, 1 );
+  c->cd(1);
+  auto branch_names = GetStatusVariables( tr );
+
   for( int i=0; i<branch_names.size(); i++ )
     { 
       stringstream expression;
       expression << branch_names[i];
       c->cd(1);
       gPad->SetGrid(true, true );
+
+      if( status != nullptr )
+	{
+	  auto hists = status->GetVariableHists( branch_names[i] );
+	  hists->hist->Draw();
+	  DrawStats( hists->hist, 0.9, 0.9, 1.0, 1.0 );
+
+	  c->cd(2);
+	  gPad->SetGrid(true, true );
+	  hists->hist_vs_entry->Draw( "colz" );
+	  DrawStats( hists->hist_vs_entry, 0.9, 0.9, 1.0, 1.0 );
+
+	  c->Print( c->GetName() );
+	  continue;
+	}
       
       string hist_name = "hist_" + Replace( branch_names[i], "$", "" );
       hist_name = Replace( Replace( hist_name, "(", "_" ) , ")", "" );
@@ -230,7 +256,13 @@ void DrawVariables( TCanvas* c, TTree* tr, string cut_arg )
 
 }
 
-int show_status( string data = "data/ELPH/NWU_fphx_raw_20211128-0947_0.root", string cut_arg = "" )
+/*!
+  @fn int show_status( string data, string cut_arg, int nthreads )
+  @brief Status plots of all modules and distributions of the variables are printed to results/ELPH/(data name).pdf
+  @param nthreads The histograms are filled in one loop over tree_both by StatusHistograms with this number of threads.
+  If it's 0, TTree::Draw is used for each plot as before.
+*/
+int show_status( string data = "data/ELPH/NWU_fphx_raw_20211128-0947_0.root", string cut_arg = "", int nthreads = 4 )
 {
 
   string mask_cut = string("!(module==6 && chip_id==14 && chan_id==0)")
@@ -261,6 +293,31 @@ int show_status( string data = "data/ELPH/NWU_fphx_raw_20211128-0947_0.root", st
     }
 
   TTree* tr = (TTree*)tf->Get( "tree_both" );
+
+  // all histograms are filled at once
+  StatusHistograms* status = nullptr;
+  if( nthreads > 0 )
+    {
+      auto variables = GetStatusVariables( tr );
+      status = new StatusHistograms( module_num, variables );
+      for( auto& variable : variables )
+	{
+	  auto range = GetRange( variable );
+	  int val_bin  = range.second - range.first;
+	  if( val_bin > 5e3 )
+	    val_bin = 200;
+
+	  status->SetRange( variable, val_bin, range.first, range.second );
+	}
+
+      if( status->Fill( data, cut_arg, nthreads ) == false )
+	{
+	  cerr << "StatusHistograms cannot fill histograms of " << data << endl;
+	  return -1;
+	}
+
+      cout << status->GetEntries() << " entries are filled in " << status->GetTime() << " s" << endl;
+    }
     
   string output = "results/ELPH/" + data_name + ".pdf";
   cout << "Output: " << output << endl;
@@ -273,14 +330,16 @@ int show_status( string data = "data/ELPH/NWU_fphx_raw_20211128-0947_0.root", st
     {
       c->Clear();
       c->Divide( 1, 3 );
-      DrawStatus( c, tr, module_num[i], i, module_num.size(), cut_arg );
+      DrawStatus( c, tr, module_num[i], i, module_num.size(), cut_arg,
+		  status == nullptr ? nullptr : status->GetModuleHists( module_num[i] ) );
       c->Print( c->GetName() );
 
     }
 
-  DrawVariables( c, tr, cut_arg );
+  DrawVariables( c, tr, cut_arg, status );
   
   c->Print( ((string)c->GetName() + "]").c_str() );
 
+  delete status;
   return 0;
 }
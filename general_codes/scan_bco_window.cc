@@ -0,0 +1,81 @@
+/*!
+  @file scan_bco_window.cc
+  @brief The number of clusters is counted for BCO windows from +-0 to +-max_window to choose the window of INTTClusterer::SetBcoWindow
+  @details Hits in "tree" made by MakeTree are grouped into events by consecutive entries with the same bco_full.
+  Each event is clustered with each window (INTTClusterer::ScanBcoWindow), and the numbers of clusters are shown.
+  If the number stops decreasing at a window, charge split over BCOs is merged at that window.
+  Usage: root -l -b -q 'scan_bco_window.cc+O( "data/calib_packv1_220927_1700.root", 5 )'
+*/
+
+#include "functions/INTTClusterer.hh"
+
+/*!
+  @fn int scan_bco_window
+  @param fname A ROOT file made by MakeTree
+  @param max_window The largest window to be tried
+  @param mask Bad channels to be ignored, "module=bad_channel_summary.root[:ladder_id]" separated by "," (see ChannelMask)
+  @param max_events The number of events to be used, all events if it's 0 or negative
+*/
+int scan_bco_window
+(
+ string fname = "data/calib_packv1_220927_1700.root",
+ int max_window = 5,
+ string mask = "",
+ Long64_t max_events = 0
+ )
+{
+  TFile* tf = new TFile( fname.c_str(), "READ" );
+  TTree* tree = (TTree*)tf->Get( "tree" );
+  if( tree == nullptr ){
+    cerr << "tree is not found in " << fname << endl;
+    return -1;
+  }
+
+  int adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event;
+  tree->SetBranchAddress( "adc", &adc );
+  tree->SetBranchAddress( "ampl", &ampl );
+  tree->SetBranchAddress( "chip_id", &chip_id );
+  tree->SetBranchAddress( "fpga_id", &fpga_id );
+  tree->SetBranchAddress( "module", &module );
+  tree->SetBranchAddress( "chan_id", &chan_id );
+  tree->SetBranchAddress( "fem_id", &fem_id );
+  tree->SetBranchAddress( "bco", &bco );
+  tree->SetBranchAddress( "bco_full", &bco_full );
+  tree->SetBranchAddress( "event", &event );
+
+  ChannelMask channel_mask;
+  INTTClusterer clusterer;
+  if( mask != "" ){
+    if( channel_mask.Load( mask ) < 0 )
+      return -1;
+
+    clusterer.SetMask( &channel_mask );
+  }
+
+  clusterer.Clear();
+  Long64_t events = 0;
+  int last_bco_full = -1;
+  for( Long64_t i=0; i<tree->GetEntries(); i++ ){
+    tree->GetEntry( i );
+
+    // a new event starts with a new bco_full
+    if( bco_full != last_bco_full && clusterer.GetHitNum() != 0 ){
+      clusterer.ScanBcoWindow( max_window );
+      clusterer.Clear();
+      events++;
+
+      if( 0 < max_events && max_events <= events )
+	break;
+    }
+
+    clusterer.Add( adc, ampl, chip_id, fpga_id, module, chan_id, fem_id, bco, bco_full, event );
+    last_bco_full = bco_full;
+  }
+
+  if( clusterer.GetHitNum() != 0 && ( max_events <= 0 || events < max_events ) )
+    clusterer.ScanBcoWindow( max_window );
+
+  clusterer.PrintBcoWindowScan();
+  tf->Close();
+  return 0;
+}